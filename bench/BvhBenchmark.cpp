@@ -0,0 +1,263 @@
+/*
+ * BvhBenchmark.cpp - Build time of the triangle BVH and ray throughput of
+ * single rays and 4 and 8 ray packets, on one core and on all cores.
+ *
+ * Usage: bin/BvhBenchmark [modelDirectory] [runs]
+ *
+ * Created: October 16, 2026
+ */
+
+/* System headers */
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+/* Application headers */
+#include <MODEL/MaterialMerger.h>
+#include <MODEL/ObjParser.h>
+#include <MODEL/ParkMesh.h>
+#include <MODEL/TriangleBvh.h>
+#include <SYNC/ThreadPool.h>
+#include <UTIL/System.h>
+
+static const std::string PARK_MODEL("fenwaypark.obj");
+/* Camera image traced for the coherent rays */
+static const unsigned int IMAGE_WIDTH = 1024;
+static const unsigned int IMAGE_HEIGHT = 768;
+/* Rows traced per task */
+static const unsigned int ROWS_PER_TASK = 16;
+
+/*
+ * now - Wall clock in seconds.
+ */
+static double now(void) {
+	TimeVal time;
+	SystemPosix::gettimeofday(&time);
+	return time.tv_sec + time.tv_usec * 1.0e-6;
+} // end now()
+
+/*
+ * TraceMode - How the rays of a row are traced.
+ */
+enum TraceMode {
+	SINGLE_RAYS, PACKETS_4, PACKETS_8
+};
+
+/*
+ * TraceRows - parallelFor body tracing bands of rows. Coherent rays come from
+ * a pinhole camera above the park looking at its center, incoherent ones
+ * join random points of the park's bounding box.
+ */
+struct TraceRows {
+	const TriangleBvh& bvh;
+	TraceMode mode;
+	bool coherent;
+	float eye[3];
+	float forward[3];
+	float right[3];
+	float up[3];
+	float low[3];
+	float size[3];
+	std::vector<unsigned int> hits;
+
+	TraceRows(const TriangleBvh& _bvh, const ParkMesh& mesh) :
+		bvh(_bvh), mode(SINGLE_RAYS), coherent(true), hits(IMAGE_HEIGHT
+				/ ROWS_PER_TASK, 0) {
+		float center[3];
+		float radius = 0.0f;
+		for (int i = 0; i < 3; ++i) {
+			low[i] = mesh.boundsMin[i];
+			size[i] = mesh.boundsMax[i] - mesh.boundsMin[i];
+			center[i] = low[i] + 0.5f * size[i];
+			radius = std::max(radius, 0.5f * size[i]);
+		}
+		/* Look down at 30 degrees from the side of the x axis: */
+		const float distance = 2.0f * radius;
+		eye[0] = center[0] - distance * 0.866f;
+		eye[1] = center[1];
+		eye[2] = center[2] + distance * 0.5f;
+		forward[0] = 0.866f;
+		forward[1] = 0.0f;
+		forward[2] = -0.5f;
+		right[0] = 0.0f;
+		right[1] = -1.0f;
+		right[2] = 0.0f;
+		up[0] = 0.5f;
+		up[1] = 0.0f;
+		up[2] = 0.866f;
+	}
+
+	void getRay(unsigned int x, unsigned int y, unsigned int& seed,
+			float origin[3], float direction[3]) const {
+		if (coherent) {
+			const float sx = (x + 0.5f) / IMAGE_WIDTH - 0.5f;
+			const float sy = ((y + 0.5f) / IMAGE_HEIGHT - 0.5f) * IMAGE_HEIGHT
+					/ IMAGE_WIDTH;
+			for (int i = 0; i < 3; ++i) {
+				origin[i] = eye[i];
+				direction[i] = forward[i] + sx * right[i] - sy * up[i];
+			}
+			return;
+		}
+		for (int i = 0; i < 3; ++i) {
+			seed = seed * 1664525u + 1013904223u;
+			origin[i] = low[i] + size[i] * (seed >> 8) * (1.0f / 16777216.0f);
+			seed = seed * 1664525u + 1013904223u;
+			direction[i] = low[i] + size[i] * (seed >> 8)
+					* (1.0f / 16777216.0f) - origin[i];
+		}
+	}
+
+	void operator()(unsigned int task) {
+		unsigned int seed = task * 7919u + 1u;
+		unsigned int numHits = 0;
+		for (unsigned int y = task * ROWS_PER_TASK; y < (task + 1)
+				* ROWS_PER_TASK; y += mode == SINGLE_RAYS ? 1 : 2) {
+			if (mode == SINGLE_RAYS) {
+				for (unsigned int x = 0; x < IMAGE_WIDTH; ++x) {
+					float origin[3];
+					float direction[3];
+					getRay(x, y, seed, origin, direction);
+					BvhHit hit;
+					numHits += bvh.intersectRay(origin, direction, FLT_MAX, hit);
+				}
+			} else if (mode == PACKETS_4) {
+				/* 2x2 tiles */
+				for (unsigned int x = 0; x < IMAGE_WIDTH; x += 2) {
+					RayPacket<4> packet;
+					for (unsigned int l = 0; l < 4; ++l) {
+						float origin[3];
+						float direction[3];
+						getRay(x + l % 2, y + l / 2, seed, origin, direction);
+						for (int i = 0; i < 3; ++i) {
+							packet.origin[i][l] = origin[i];
+							packet.direction[i][l] = direction[i];
+						}
+						packet.maxDistance[l] = FLT_MAX;
+					}
+					BvhHit packetHits[4];
+					bvh.intersectPacket(packet, packetHits);
+					for (unsigned int l = 0; l < 4; ++l)
+						numHits += packetHits[l].triangle
+								!= TriangleBvh::NO_TRIANGLE;
+				}
+			} else {
+				/* 4x2 tiles */
+				for (unsigned int x = 0; x < IMAGE_WIDTH; x += 4) {
+					RayPacket<8> packet;
+					for (unsigned int l = 0; l < 8; ++l) {
+						float origin[3];
+						float direction[3];
+						getRay(x + l % 4, y + l / 4, seed, origin, direction);
+						for (int i = 0; i < 3; ++i) {
+							packet.origin[i][l] = origin[i];
+							packet.direction[i][l] = direction[i];
+						}
+						packet.maxDistance[l] = FLT_MAX;
+					}
+					BvhHit packetHits[8];
+					bvh.intersectPacket(packet, packetHits);
+					for (unsigned int l = 0; l < 8; ++l)
+						numHits += packetHits[l].triangle
+								!= TriangleBvh::NO_TRIANGLE;
+				}
+			}
+		}
+		hits[task] = numHits;
+	}
+};
+
+/*
+ * timeTrace - Best throughput of one trace mode in millions of rays per
+ * second.
+ */
+static double timeTrace(TraceRows& trace, TraceMode mode, bool coherent,
+		ThreadPool& pool, int runs, unsigned int& numHits) {
+	trace.mode = mode;
+	trace.coherent = coherent;
+	double best = 1e30;
+	for (int run = 0; run < runs; ++run) {
+		const double start = now();
+		pool.parallelFor(IMAGE_HEIGHT / ROWS_PER_TASK, trace);
+		best = std::min(best, now() - start);
+	}
+	numHits = 0;
+	for (size_t t = 0; t < trace.hits.size(); ++t)
+		numHits += trace.hits[t];
+	return double(IMAGE_WIDTH) * IMAGE_HEIGHT / best * 1.0e-6;
+} // end timeTrace()
+
+/*
+ * timeBuild - Best build time of the hierarchy.
+ */
+static double timeBuild(const ParkMesh& mesh, ThreadPool& pool, int runs,
+		TriangleBvh& bvh) {
+	double best = 1e30;
+	for (int run = 0; run < runs; ++run) {
+		const double start = now();
+		bvh.build(mesh, &pool);
+		best = std::min(best, now() - start);
+	}
+	return best;
+} // end timeBuild()
+
+/*
+ * main - The benchmark main method.
+ */
+int main(int argc, char* argv[]) {
+	const std::string directory = argc > 1 ? argv[1] : "models";
+	const int runs = argc > 2 ? std::atoi(argv[2]) : 5;
+
+	try {
+		ThreadPool serialPool(1);
+		ThreadPool parallelPool;
+		ParkMesh mesh;
+		ObjParser::parse(directory, PARK_MODEL, mesh, parallelPool);
+		MaterialMerger::merge(mesh);
+
+		TriangleBvh bvh;
+		const double serialBuild = timeBuild(mesh, serialPool, runs, bvh);
+		const double parallelBuild = timeBuild(mesh, parallelPool, runs, bvh);
+		std::cout << PARK_MODEL << ": " << bvh.getNumTriangles()
+				<< " triangles, " << bvh.getNumNodes() << " nodes of "
+				<< sizeof(BvhNode) << " bytes, depth " << bvh.getDepth()
+				<< ", " << bvh.getBytes() / 1024 << " KB" << std::endl;
+		std::cout << std::fixed << std::setprecision(1);
+		std::cout << "  build, 1 thread                " << serialBuild
+				* 1000.0 << " ms" << std::endl;
+		std::cout << "  build, " << std::setw(2) << parallelPool.getNumThreads()
+				<< " threads              " << parallelBuild * 1000.0 << " ms"
+				<< std::endl;
+
+		TraceRows trace(bvh, mesh);
+		static const char * const MODES[] = { "single rays", "4-ray packets",
+				"8-ray packets" };
+		for (int coherent = 1; coherent >= 0; --coherent) {
+			std::cout << (coherent ? "  camera rays " : "  random rays ")
+					<< IMAGE_WIDTH << "x" << IMAGE_HEIGHT << ", Mrays/s:"
+					<< std::endl;
+			for (int mode = 0; mode < 3; ++mode) {
+				unsigned int numHits;
+				const double serial = timeTrace(trace, TraceMode(mode),
+						coherent != 0, serialPool, runs, numHits);
+				const double parallel = timeTrace(trace, TraceMode(mode),
+						coherent != 0, parallelPool, runs, numHits);
+				std::cout << "    " << std::left << std::setw(14) << MODES[mode]
+						<< std::right << " 1 thread " << std::setw(6) << serial
+						<< ", " << std::setw(2) << parallelPool.getNumThreads()
+						<< " threads " << std::setw(6) << parallel << "  ("
+						<< numHits << " hits)" << std::endl;
+			}
+		}
+	} catch (std::runtime_error& err) {
+		std::cerr << "Caught exception " << err.what() << std::endl;
+		return 1;
+	}
+	return 0;
+} // end main()
@@ -0,0 +1,208 @@
+/*
+ * ParserBenchmark.cpp - Compares the osgDB OBJ reader with the native
+ * parallel ObjParser on the shipped park and on a synthetic 10x replica.
+ *
+ * Usage: bin/ParserBenchmark [modelDirectory] [runs]
+ *
+ * Created: October 16, 2026
+ */
+
+/* System headers */
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <iterator>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+
+/* osg includes */
+#include <osg/Node>
+#include <osgDB/ReadFile>
+
+/* Application headers */
+#include <MODEL/MaterialMerger.h>
+#include <MODEL/ObjParser.h>
+#include <MODEL/ParkMesh.h>
+#include <MODEL/SceneBuilder.h>
+#include <SYNC/ThreadPool.h>
+#include <UTIL/System.h>
+
+static const std::string PARK_MODEL("fenwaypark.obj");
+static const std::string REPLICA_MODEL(".benchmark_x10.obj");
+
+/*
+ * now - Wall clock in seconds.
+ */
+static double now(void) {
+	TimeVal time;
+	SystemPosix::gettimeofday(&time);
+	return time.tv_sec + time.tv_usec * 1.0e-6;
+} // end now()
+
+/*
+ * offsetIndices - Shifts the positive indices of an f statement.
+ */
+static std::string offsetIndices(const std::string& line, const long offsets[3]) {
+	std::istringstream corners(line.substr(1));
+	std::ostringstream result;
+	result << "f";
+	std::string corner;
+	while (corners >> corner) {
+		result << ' ';
+		int attribute = 0;
+		std::string::size_type start = 0;
+		while (true) {
+			std::string::size_type slash = corner.find('/', start);
+			std::string index = corner.substr(start, slash == std::string::npos
+					? std::string::npos : slash - start);
+			if (!index.empty()) {
+				long value = std::atol(index.c_str());
+				result << (value > 0 ? value + offsets[attribute] : value);
+			}
+			if (slash == std::string::npos)
+				break;
+			result << '/';
+			start = slash + 1;
+			++attribute;
+		}
+	}
+	return result.str();
+} // end offsetIndices()
+
+/*
+ * writeReplica - Writes copies of the model side by side into one OBJ.
+ */
+static void writeReplica(const std::string& source, const std::string& target,
+		int copies) {
+	std::ifstream in(source.c_str());
+	std::string content((std::istreambuf_iterator<char>(in)),
+			std::istreambuf_iterator<char>());
+	long counts[3] = { 0, 0, 0 };
+	std::istringstream lines(content);
+	std::string line;
+	while (std::getline(lines, line)) {
+		if (line.compare(0, 2, "v ") == 0)
+			++counts[0];
+		else if (line.compare(0, 3, "vt ") == 0)
+			++counts[1];
+		else if (line.compare(0, 3, "vn ") == 0)
+			++counts[2];
+	}
+
+	std::ofstream out(target.c_str());
+	for (int copy = 0; copy < copies; ++copy) {
+		const long offsets[3] = { copy * counts[0], copy * counts[1], copy
+				* counts[2] };
+		std::istringstream copyLines(content);
+		while (std::getline(copyLines, line)) {
+			if (line.compare(0, 2, "f ") == 0) {
+				out << offsetIndices(line, offsets) << '\n';
+			} else if (line.compare(0, 2, "v ") == 0) {
+				float x, y, z;
+				std::sscanf(line.c_str() + 2, "%f %f %f", &x, &y, &z);
+				out << "v " << x + copy * 400.0f << ' ' << y << ' ' << z << '\n';
+			} else if (copy == 0 || line.compare(0, 7, "mtllib ") != 0) {
+				out << line << '\n';
+			}
+		}
+	}
+} // end writeReplica()
+
+/*
+ * timeOsgDB - Best time of the osgDB reader, textures included.
+ */
+static double timeOsgDB(const std::string& path, int runs) {
+	double best = 1e30;
+	for (int run = 0; run < runs; ++run) {
+		const double start = now();
+		osg::ref_ptr<osg::Node> node = osgDB::readNodeFile(path);
+		const double elapsed = now() - start;
+		if (!node.valid()) {
+			std::cerr << "osgDB could not read " << path << std::endl;
+			return 0.0;
+		}
+		best = std::min(best, elapsed);
+	}
+	return best;
+} // end timeOsgDB()
+
+/*
+ * timeObjParser - Best time of the native parser, optionally including
+ * building the scene graph (which loads the textures).
+ */
+static double timeObjParser(const std::string& directory,
+		const std::string& file, ThreadPool& pool, bool build, int runs,
+		ParkMesh& mesh) {
+	double best = 1e30;
+	for (int run = 0; run < runs; ++run) {
+		const double start = now();
+		ObjParser::parse(directory, file, mesh, pool);
+		if (build) {
+			SceneBuilder::ImageMap images;
+			SceneBuilder::loadImages(mesh, directory, 0, images);
+			SceneBuilder::buildAtlases(mesh, images, directory);
+			MaterialMerger::merge(mesh);
+			osg::ref_ptr<osg::Node> node = SceneBuilder::buildNode(mesh,
+					images);
+		}
+		best = std::min(best, now() - start);
+	}
+	return best;
+} // end timeObjParser()
+
+/*
+ * benchmark - Prints one table row per loader for a model.
+ */
+static void benchmark(const std::string& directory, const std::string& file,
+		const std::string& label, int runs) {
+	ThreadPool serialPool(1);
+	ThreadPool parallelPool;
+	ParkMesh mesh;
+
+	const double osgTime = timeOsgDB(directory + "/" + file, runs);
+	const double serialTime = timeObjParser(directory, file, serialPool,
+			false, runs, mesh);
+	const double parallelTime = timeObjParser(directory, file, parallelPool,
+			false, runs, mesh);
+	const double buildTime = timeObjParser(directory, file, parallelPool,
+			true, runs, mesh);
+
+	std::cout << label << ": " << mesh.getNumTriangles() << " triangles, "
+			<< mesh.groups.size() << " groups" << std::endl;
+	std::cout << std::fixed << std::setprecision(1);
+	std::cout << "  osgDB reader (with textures)      " << osgTime * 1000.0
+			<< " ms" << std::endl;
+	std::cout << "  ObjParser, 1 thread                " << serialTime * 1000.0
+			<< " ms" << std::endl;
+	std::cout << "  ObjParser, " << std::setw(2)
+			<< parallelPool.getNumThreads() << " threads              "
+			<< parallelTime * 1000.0 << " ms" << std::endl;
+	std::cout << "  ObjParser + SceneBuilder (atlases)  " << buildTime
+			* 1000.0 << " ms" << std::endl;
+} // end benchmark()
+
+/*
+ * main - The benchmark main method.
+ */
+int main(int argc, char* argv[]) {
+	const std::string directory = argc > 1 ? argv[1] : "models";
+	const int runs = argc > 2 ? std::atoi(argv[2]) : 5;
+
+	try {
+		benchmark(directory, PARK_MODEL, "fenwaypark.obj", runs);
+
+		writeReplica(directory + "/" + PARK_MODEL, directory + "/"
+				+ REPLICA_MODEL, 10);
+		benchmark(directory, REPLICA_MODEL, "10x replica", runs);
+		std::remove((directory + "/" + REPLICA_MODEL).c_str());
+	} catch (std::runtime_error& err) {
+		std::remove((directory + "/" + REPLICA_MODEL).c_str());
+		std::cerr << "Caught exception " << err.what() << std::endl;
+		return 1;
+	}
+	return 0;
+} // end main()
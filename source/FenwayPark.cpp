@@ -41,7 +41,10 @@
 #include <GLMotif/RowColumn.h>
 #include <GLMotif/TextField.h>
 #include <Vrui/CoordinateManager.h>
+#include <Vrui/DisplayState.h>
 #include <Vrui/Tools/SurfaceNavigationTool.h>
+#include <Vrui/Viewer.h>
+#include <Vrui/VRScreen.h>
 #include <Vrui/Vrui.h>
 #include <Vrui/Application.h>
 
@@ -49,9 +52,98 @@
 #include <ANALYSIS/ClippingPlane.h>
 #include <ANALYSIS/ClippingPlaneLocator.h>
 #include <MODEL/Fenway.h>
+#include <MODEL/TextureResidency.h>
+#include <SYNC/Guard.h>
 
 #include "FenwayPark.h"
 
+/* Views whose culling the render dialog lists */
+static const int MAX_CULL_VIEWS = 4;
+
+/*
+ * toOsgMatrix - The OSG matrix of a Vrui one; Vrui multiplies column
+ * vectors and OSG row vectors, so one is the transpose of the other.
+ */
+static osg::Matrixd toOsgMatrix(const Vrui::PTransform::Matrix& matrix) {
+	osg::Matrixd result;
+	for (int i = 0; i < 4; ++i)
+		for (int j = 0; j < 4; ++j)
+			result(j, i) = matrix(i, j);
+	return result;
+} // end toOsgMatrix()
+
+/*
+ * getEye - The eye of the viewer a view is drawn from.
+ *
+ * parameter displayState - const Vrui::DisplayState&, of the view
+ * return - int, a Vrui::Viewer::Eye, or -1 for none of them
+ */
+static int getEye(const Vrui::DisplayState& displayState) {
+	const Vrui::Viewer * viewer = displayState.viewer;
+	const Vrui::Point left = viewer->getEyePosition(Vrui::Viewer::LEFT);
+	const Vrui::Point right = viewer->getEyePosition(Vrui::Viewer::RIGHT);
+	const Vrui::Scalar tolerance = Geometry::sqrDist(left, right)
+			* Vrui::Scalar(0.01);
+	if (Geometry::sqrDist(displayState.eyePosition, left) <= tolerance)
+		return Vrui::Viewer::LEFT;
+	if (Geometry::sqrDist(displayState.eyePosition, right) <= tolerance)
+		return Vrui::Viewer::RIGHT;
+	if (Geometry::sqrDist(displayState.eyePosition, viewer->getEyePosition(
+			Vrui::Viewer::MONO)) <= tolerance)
+		return Vrui::Viewer::MONO;
+	return -1;
+} // end getEye()
+
+/*
+ * getScreenDistance - How far a view's eye is in front of its screen.
+ *
+ * parameter displayState - const Vrui::DisplayState&, of the view
+ * return - Vrui::Scalar
+ */
+static Vrui::Scalar getScreenDistance(const Vrui::DisplayState& displayState) {
+	return -displayState.modelviewPhysical.transform(
+			displayState.screen->getScreenTransformation().transform(
+					Vrui::Point::origin))[2];
+} // end getScreenDistance()
+
+/*
+ * moveEye - The navigation to clip matrix of a view drawn from another eye
+ * position through the same screen rectangle. The view's eye coordinates
+ * have the screen's axes, so the new view is the old one moved by the eye
+ * offset, with the frustum scaled and sheared to keep the rectangle in
+ * place.
+ *
+ * parameter projection - const Vrui::PTransform::Matrix&, of the view
+ * parameter modelviewPhysical - const Vrui::NavTransform&, of the view
+ * parameter screenDistance - Vrui::Scalar, of the view's eye
+ * parameter eye - const Vrui::Point&, in physical coordinates
+ * parameter navigation - const Vrui::NavTransform&
+ * parameter clip - osg::Matrixd&
+ * return - bool, false if either eye is not in front of the screen
+ */
+static bool moveEye(const Vrui::PTransform::Matrix& projection,
+		const Vrui::NavTransform& modelviewPhysical,
+		Vrui::Scalar screenDistance, const Vrui::Point& eye,
+		const Vrui::NavTransform& navigation, osg::Matrixd& clip) {
+	/* The new eye in the view's eye coordinates: */
+	const Vrui::Point offset = modelviewPhysical.transform(eye);
+	const Vrui::Scalar distance = screenDistance + offset[2];
+	if (screenDistance <= Vrui::Scalar(0) || distance <= Vrui::Scalar(0))
+		return false;
+
+	Vrui::PTransform::Matrix moved = projection;
+	for (int i = 0; i < 2; ++i) {
+		moved(i, 2) -= moved(i, i) * offset[i] / screenDistance;
+		moved(i, i) *= distance / screenDistance;
+	}
+	Vrui::PTransform::Matrix modelview;
+	(modelviewPhysical * navigation).writeMatrix(modelview);
+	for (int i = 0; i < 3; ++i)
+		modelview(i, 3) -= offset[i];
+	clip = toOsgMatrix(modelview) * toOsgMatrix(moved);
+	return true;
+} // end moveEye()
+
 /*****************************************
  Methods of class FenwayPark::DataItem:
  *****************************************/
@@ -62,7 +154,8 @@
 /*
  * DataItem - constructor
  */
-FenwayPark::DataItem::DataItem(void) {
+FenwayPark::DataItem::DataItem(void) :
+	maxClipPlanes(0) {
 } // end DataItem()
 
 /*
@@ -84,7 +177,7 @@ FenwayPark::DataItem::~DataItem(void) {
  */
 FenwayPark::FenwayPark(int& argc, char**& argv, char**& appDefaults) :
 	Vrui::Application(argc, argv, appDefaults), analysisTool(0),
-			clippingPlanes(0), mainMenu(0), renderDialog(0) {
+			clippingPlanes(0), mainMenu(0), renderDialog(0), textureLabel(0) {
 
 	/* Create the Fenway Scene */
 	fenway = new Fenway();
@@ -281,6 +374,19 @@ GLMotif::PopupWindow * FenwayPark::createRenderDialog(void) {
 	lightToggleRD->setToggle(true);
 	lightToggleRD->getValueChangedCallbacks().add(this,
 			&FenwayPark::menuToggleSelectCallback);
+	new GLMotif::Label("LightSpacer", rowColumn, "");
+
+	for (int view = 0; view < MAX_CULL_VIEWS; ++view) {
+		char name[32];
+		char title[32];
+		snprintf(name, sizeof(name), "CullLabel%d", view);
+		snprintf(title, sizeof(title), "View %d Culling", view + 1);
+		new GLMotif::Label(name, rowColumn, title);
+		snprintf(name, sizeof(name), "CullStatistics%d", view);
+		cullLabels.push_back(new GLMotif::Label(name, rowColumn, "-"));
+	}
+	new GLMotif::Label("TextureLabel", rowColumn, "Textures");
+	textureLabel = new GLMotif::Label("TextureStatistics", rowColumn, "-");
 
 	rowColumn->manageChild();
 
@@ -330,7 +436,10 @@ GLMotif::Popup * FenwayPark::createRenderTogglesMenu(void) {
 } // end createRenderTogglesMenu
 
 /*
- * display
+ * display - Draws the park with the active clipping planes. The view's
+ * viewport and matrices come from Vrui's display state, and the park
+ * restores the state it changes, so nothing is read back from GL or pushed
+ * on the attribute stacks.
  *
  * parameter glContextData - GLContextData &
  */
@@ -338,24 +447,13 @@ void FenwayPark::display(GLContextData & glContextData) const {
 
 	/* Get context data item: */
 	DataItem* dataItem = glContextData.retrieveDataItem<DataItem> (this);
-
-	glPushAttrib(GL_ALL_ATTRIB_BITS);
-	glPushAttrib(GL_TRANSFORM_BIT);
-	glPushAttrib(GL_VIEWPORT_BIT);
-	glPushClientAttrib(GL_CLIENT_ALL_ATTRIB_BITS);
-	glMatrixMode(GL_MODELVIEW);
-	glPushMatrix();
-	glMatrixMode(GL_PROJECTION);
-	glPushMatrix();
-	glMatrixMode(GL_TEXTURE);
-	glPushMatrix();
+	const Vrui::DisplayState& displayState = Vrui::getDisplayState(
+			glContextData);
 
 	/* Enable all clipping planes: */
-	int numberOfSupportedClippingPlanes;
-	glGetIntegerv(GL_MAX_CLIP_PLANES, &numberOfSupportedClippingPlanes);
 	int clippingPlaneIndex = 0;
 	for (int i = 0; i < numberOfClippingPlanes && clippingPlaneIndex
-			< numberOfSupportedClippingPlanes; ++i) {
+			< dataItem->maxClipPlanes; ++i) {
 		if (clippingPlanes[i].isActive()) {
 			/* Enable the clipping plane: */
 			glEnable(GL_CLIP_PLANE0 + clippingPlaneIndex);
@@ -369,12 +467,39 @@ void FenwayPark::display(GLContextData & glContextData) const {
 		}
 	}
 
-	fenway->display(glContextData);
+	Vrui::PTransform::Matrix modelview;
+	displayState.modelviewNavigational.writeMatrix(modelview);
+	const int eye = getEye(displayState);
+	const Vrui::Scalar screenDistance = getScreenDistance(displayState);
+	/* Stereo views cull for both eyes at once: */
+	osg::Matrixd otherEye;
+	const bool stereo = (eye == Vrui::Viewer::LEFT || eye
+			== Vrui::Viewer::RIGHT) && moveEye(
+			displayState.projection.getMatrix(),
+			displayState.modelviewPhysical, screenDistance,
+			displayState.viewer->getEyePosition(eye == Vrui::Viewer::LEFT
+					? Vrui::Viewer::RIGHT : Vrui::Viewer::LEFT),
+			Vrui::getNavigationTransformation(), otherEye);
+	/* The next frame expects the view again: */
+	if (eye >= 0) {
+		DrawnView view;
+		view.viewer = displayState.viewer;
+		view.eye = eye;
+		view.projection = displayState.projection.getMatrix();
+		view.modelviewPhysical = displayState.modelviewPhysical;
+		view.screenDistance = screenDistance;
+		Guard<MutexPosix> drawnViewsGuard(drawnViewsLock);
+		drawnViews.push_back(view);
+	}
+	fenway->display(glContextData, displayState.viewport,
+			toOsgMatrix(modelview),
+			toOsgMatrix(displayState.projection.getMatrix()),
+			stereo ? &otherEye : 0);
 
 	/* Disable all clipping planes: */
 	clippingPlaneIndex = 0;
 	for (int i = 0; i < numberOfClippingPlanes && clippingPlaneIndex
-			< numberOfSupportedClippingPlanes; ++i) {
+			< dataItem->maxClipPlanes; ++i) {
 		if (clippingPlanes[i].isActive()) {
 			/* Disable the clipping plane: */
 			glDisable(GL_CLIP_PLANE0 + clippingPlaneIndex);
@@ -382,24 +507,68 @@ void FenwayPark::display(GLContextData & glContextData) const {
 			++clippingPlaneIndex;
 		}
 	}
-
-	glMatrixMode(GL_TEXTURE);
-	glPopMatrix();
-	glMatrixMode(GL_PROJECTION);
-	glPopMatrix();
-	glMatrixMode(GL_MODELVIEW);
-	glPopMatrix();
-	glPopClientAttrib();
-	glPopAttrib();
-	glPopAttrib();
-	glPopAttrib();
 } // end display()
 
 /*
  * frame
  */
 void FenwayPark::frame(void) {
+	/* The planes display() enables, so the park can skip what they cut: */
+	std::vector<osg::Plane> planes;
+	for (int i = 0; i < numberOfClippingPlanes; ++i) {
+		if (clippingPlanes[i].isActive()) {
+			const Vrui::Plane plane = clippingPlanes[i].getPlane();
+			planes.push_back(osg::Plane(plane.getNormal()[0],
+					plane.getNormal()[1], plane.getNormal()[2],
+					-plane.getOffset()));
+		}
+	}
+	fenway->setClippingPlanes(planes);
+
+	/* The views of the last frame are expected again, from the eyes' new
+	 * positions, and culled together: */
+	std::vector<osg::Matrixd> views;
+	{
+		Guard<MutexPosix> drawnViewsGuard(drawnViewsLock);
+		for (size_t v = 0; v < drawnViews.size(); ++v) {
+			const DrawnView& view = drawnViews[v];
+			osg::Matrixd clip;
+			if (moveEye(view.projection, view.modelviewPhysical,
+					view.screenDistance, view.viewer->getEyePosition(
+							Vrui::Viewer::Eye(view.eye)),
+					Vrui::getNavigationTransformation(), clip))
+				views.push_back(clip);
+		}
+		drawnViews.clear();
+	}
+	fenway->setExpectedViews(views);
 	fenway->frame();
+
+	/* Show the culling of the last frame's views: */
+	std::vector<CullStatistics> statistics;
+	fenway->getCullStatistics(statistics);
+	for (size_t view = 0; view < cullLabels.size(); ++view) {
+		char text[96] = "-";
+		if (view < statistics.size())
+			snprintf(text, sizeof(text),
+					"%u visible, %u culled, %u clipped, %u occluded, "
+						"%.3f + %.3f ms", statistics[view].numVisible,
+					statistics[view].numCulled, statistics[view].numClipped,
+					statistics[view].numOccluded, statistics[view].cullTime
+							* 1000.0, statistics[view].occlusionTime * 1000.0);
+		cullLabels[view]->setLabel(text);
+	}
+
+	/* Show the texture residency since the last frame: */
+	TextureStatistics textures;
+	fenway->getTextureStatistics(textures);
+	char text[96];
+	snprintf(text, sizeof(text),
+			"%u hits, %u misses, %u evicted, %u/%u decoded, %.1f MB",
+			textures.numHits, textures.numMisses, textures.numEvicted,
+			textures.numDecoded, textures.numTextures,
+			textures.residentBytes / 1048576.0);
+	textureLabel->setLabel(text);
 } // end frame()
 
 /*
@@ -428,6 +597,8 @@ int FenwayPark::getNumberOfClippingPlanes(void) {
 void FenwayPark::initContext(GLContextData & glContextData) const {
 	/* Create a new context data item: */
 	DataItem* dataItem = new DataItem();
+	/* A limit of the context, so display() need not ask each view: */
+	glGetIntegerv(GL_MAX_CLIP_PLANES, &dataItem->maxClipPlanes);
 
 	glContextData.addDataItem(this, dataItem);
 } // end initContext()
@@ -14,21 +14,28 @@
 #include <GLMotif/Slider.h>
 #include <GLMotif/ToggleButton.h>
 #include <Misc/CallbackData.h>
+#include <Vrui/Geometry.h>
 #include <Vrui/Tools/LocatorTool.h>
 #include <Vrui/LocatorToolAdapter.h>
 #include <Vrui/ToolManager.h>
 #include <Vrui/Application.h>
 
+#include <SYNC/MutexPosix.h>
+
 /* Begin Forward declarations: */
 class Fenway;
 class ClippingPlane;
 
 namespace GLMotif {
+class Label;
 class Popup;
 class PopupMenu;
 class PopupWindow;
 class TextField;
 }
+namespace Vrui {
+class Viewer;
+}
 /* End Forward declarations: */
 
 class FenwayPark: public Vrui::Application, public GLObject {
@@ -39,11 +46,26 @@ private:
 	public:
 		/* Elements: */
 		int data;
+		/* Clipping planes the context supports */
+		GLint maxClipPlanes;
 		/* Constructors and destructors: */
 		DataItem(void);
 		virtual ~DataItem(void);
 	};
 
+	/*
+	 * DrawnView - A view drawn in the last frame, kept to expect it again
+	 * from its eye's new position.
+	 */
+	struct DrawnView {
+		const Vrui::Viewer * viewer;
+		/* A Vrui::Viewer::Eye */
+		int eye;
+		Vrui::PTransform::Matrix projection;
+		Vrui::NavTransform modelviewPhysical;
+		Vrui::Scalar screenDistance;
+	};
+
 public:
 	/* Constructors and destructors: */
 	FenwayPark(int& argc, char**& argv, char**& appDefaults);
@@ -69,6 +91,13 @@ private:
 	GLMotif::PopupMenu* mainMenu;
 	int numberOfClippingPlanes;
 	GLMotif::PopupWindow* renderDialog;
+	/* Culling statistics of the first views in the render dialog */
+	std::vector<GLMotif::Label*> cullLabels;
+	/* Texture residency in the render dialog */
+	GLMotif::Label* textureLabel;
+	/* Views drawn since the last frame, by every window's thread */
+	mutable MutexPosix drawnViewsLock;
+	mutable std::vector<DrawnView> drawnViews;
 	GLMotif::ToggleButton * lightToggle;
 	GLMotif::ToggleButton * lightToggleRD;
 	GLMotif::ToggleButton * showParkToggle;
@@ -0,0 +1,307 @@
+/*
+ * AssetWatcher.cpp - Methods for reading park assets edited on disk.
+ *
+ * Created: October 17, 2026
+ */
+
+/* System headers */
+#include <cctype>
+#include <cstring>
+#include <exception>
+#include <iostream>
+#include <sstream>
+
+/* Application headers */
+#include <MODEL/AssetWatcher.h>
+#include <MODEL/ObjParser.h>
+#include <MODEL/TextureAtlas.h>
+#include <SYNC/Guard.h>
+#include <UTIL/DirectoryWatcher.h>
+#include <UTIL/ResourceException.h>
+#include <UTIL/System.h>
+
+/* Longest wait for changes before checking for cancellation */
+static const Uint32 POLL_MILLISECONDS = 100;
+
+/*
+ * now - Wall clock in seconds.
+ */
+static double now(void) {
+	TimeVal time;
+	SystemPosix::gettimeofday(&time);
+	return time.tv_sec + time.tv_usec * 1.0e-6;
+} // end now()
+
+/*
+ * isLibrary - Whether a file name has the extension of a material library.
+ */
+static bool isLibrary(const std::string& name) {
+	static const char EXTENSION[] = ".mtl";
+	const size_t length = sizeof(EXTENSION) - 1;
+	if (name.size() <= length)
+		return false;
+	for (size_t i = 0; i < length; ++i)
+		if (std::tolower(name[name.size() - length + i]) != EXTENSION[i])
+			return false;
+	return true;
+} // end isLibrary()
+
+/*****************************************
+ Methods of struct AssetChanges:
+ *****************************************/
+/*
+ * AssetChanges constructor
+ */
+AssetChanges::AssetChanges(void) :
+	reload(false) {
+} // end AssetChanges()
+
+/*
+ * merge - Adds later changes, which win over these.
+ *
+ * parameter newer - const AssetChanges&
+ */
+void AssetChanges::merge(const AssetChanges& newer) {
+	for (size_t n = 0; n < newer.materials.size(); ++n) {
+		size_t m = 0;
+		while (m < materials.size() && materials[m].name
+				!= newer.materials[n].name)
+			++m;
+		if (m == materials.size())
+			materials.push_back(newer.materials[n]);
+		else
+			materials[m] = newer.materials[n];
+	}
+	for (SceneBuilder::ImageMap::const_iterator it = newer.images.begin(); it
+			!= newer.images.end(); ++it)
+		images[it->first] = it->second;
+	reload = reload || newer.reload;
+} // end merge()
+
+/****************************************************
+ Constructors and Destructors of class AssetWatcher:
+ ****************************************************/
+/*
+ * AssetWatcher constructor
+ *
+ * parameter modelDirectory - const std::string&
+ * parameter objFile - const std::string&, relative to the model directory
+ */
+AssetWatcher::AssetWatcher(const std::string& _modelDirectory,
+		const std::string& _objFile) :
+	modelDirectory(_modelDirectory), objFile(_objFile), started(false),
+			pending(0), cancelled(false) {
+} // end AssetWatcher()
+
+/*
+ * ~AssetWatcher - Stops watching and joins the thread.
+ */
+AssetWatcher::~AssetWatcher(void) {
+	{
+		Guard<MutexPosix> guard(lock);
+		cancelled = true;
+	}
+	if (started)
+		pthread_join(thread, NULL);
+	delete pending;
+} // end ~AssetWatcher()
+
+/*******************************
+ Methods of class AssetWatcher:
+ *******************************/
+
+/*
+ * start - Starts the watcher thread.
+ *
+ * @throw ResourceException is thrown if the thread cannot be created.
+ */
+void AssetWatcher::start(void) {
+	const int result = pthread_create(&thread, NULL,
+			&AssetWatcher::watcherMain, this);
+	if (result != 0) {
+		std::ostringstream msg_stream;
+		msg_stream << "Asset watcher thread creation failed: "
+				<< std::strerror(result);
+		throw ResourceException(msg_stream.str(), LOCATION);
+	}
+	started = true;
+} // end start()
+
+/*
+ * setMaterials - Tells which materials and textures the displayed park
+ * uses; changes are reported against these.
+ *
+ * parameter parkMaterials - const std::vector<ParkMaterial>&, the park mesh's
+ * materials; those of atlas pages are skipped
+ */
+void AssetWatcher::setMaterials(const std::vector<ParkMaterial>& parkMaterials) {
+	Guard<MutexPosix> guard(lock);
+	materials.clear();
+	textures.clear();
+	for (size_t m = 0; m < parkMaterials.size(); ++m) {
+		const ParkMaterial& material = parkMaterials[m];
+		if (TextureAtlas::isPageName(material.texture))
+			continue;
+		materials[material.name] = material;
+		if (!material.texture.empty())
+			textures.insert(material.texture);
+	}
+} // end setMaterials()
+
+/*
+ * takeChanges - Hands the changes read since the last call to the caller.
+ *
+ * parameter changes - AssetChanges&, overwritten
+ * return - bool, false if nothing changed
+ */
+bool AssetWatcher::takeChanges(AssetChanges& changes) {
+	Guard<MutexPosix> guard(lock);
+	if (pending == 0)
+		return false;
+	changes.materials.swap(pending->materials);
+	changes.images.swap(pending->images);
+	changes.reload = pending->reload;
+	delete pending;
+	pending = 0;
+	return true;
+} // end takeChanges()
+
+/*
+ * watcherMain - Thread entry point.
+ */
+void * AssetWatcher::watcherMain(void * watcher) {
+	try {
+		static_cast<AssetWatcher*> (watcher)->watch();
+	} catch (std::exception& err) {
+		std::cerr << "Asset watching stopped: " << err.what() << std::endl;
+	}
+	return NULL;
+} // end watcherMain()
+
+/*
+ * watch - Collects the names of written files until the directory has been
+ * quiet for SETTLE_MILLISECONDS, so an editor saving in several steps is
+ * read once, then reads them and publishes what changed.
+ */
+void AssetWatcher::watch(void) {
+	DirectoryWatcher directory(modelDirectory);
+	std::set<std::string> changed;
+	double lastChange = 0.0;
+	while (!isCancelled()) {
+		std::vector<std::string> names;
+		if (directory.wait(POLL_MILLISECONDS, names)) {
+			changed.insert(names.begin(), names.end());
+			lastChange = now();
+		}
+		if (changed.empty() || now() - lastChange < SETTLE_MILLISECONDS
+				* 1.0e-3)
+			continue;
+
+		AssetChanges * changes = new AssetChanges();
+		readChanges(changed, *changes);
+		changed.clear();
+		if (changes->materials.empty() && changes->images.empty()
+				&& !changes->reload) {
+			delete changes;
+			continue;
+		}
+		Guard<MutexPosix> guard(lock);
+		if (pending == 0)
+			pending = changes;
+		else {
+			pending->merge(*changes);
+			delete changes;
+		}
+	}
+} // end watch()
+
+/*
+ * readChanges - Parses the written material libraries and decodes the
+ * written textures the park uses, along with the textures that changed
+ * materials switch to. A file that cannot be read is reported and skipped;
+ * saving it again retries.
+ *
+ * parameter names - const std::set<std::string>&, written files
+ * parameter changes - AssetChanges&, filled in
+ */
+void AssetWatcher::readChanges(const std::set<std::string>& names,
+		AssetChanges& changes) {
+	std::map<std::string, ParkMaterial> known;
+	std::set<std::string> used;
+	{
+		Guard<MutexPosix> guard(lock);
+		known = materials;
+		used = textures;
+	}
+
+	std::set<std::string> decode;
+	for (std::set<std::string>::const_iterator nIt = names.begin(); nIt
+			!= names.end(); ++nIt) {
+		const std::string& name = *nIt;
+		if (name == objFile) {
+			changes.reload = true;
+		} else if (isLibrary(name)) {
+			ParkMesh library;
+			std::map<std::string, Uint32> materialIndices;
+			try {
+				ObjParser::parseMaterials(modelDirectory + "/" + name, library,
+						materialIndices);
+			} catch (ResourceException& err) {
+				std::cerr << "Material library not reloaded: "
+						<< err.getDescription() << std::endl;
+				continue;
+			}
+			for (size_t m = 0; m < library.materials.size(); ++m) {
+				const ParkMaterial& material = library.materials[m];
+				std::map<std::string, ParkMaterial>::const_iterator knownIt =
+						known.find(material.name);
+				if (knownIt == known.end() || material.hasSameProperties(
+						knownIt->second))
+					continue;
+				changes.materials.push_back(material);
+				if (!material.texture.empty() && material.texture
+						!= knownIt->second.texture)
+					decode.insert(material.texture);
+			}
+		} else if (used.count(name) != 0) {
+			decode.insert(name);
+		}
+	}
+
+	if (!decode.empty()) {
+		/* Edited files win over the texture pack, which predates them: */
+		ParkMesh textured;
+		for (std::set<std::string>::const_iterator tIt = decode.begin(); tIt
+				!= decode.end(); ++tIt) {
+			textured.materials.push_back(ParkMaterial());
+			textured.materials.back().texture = *tIt;
+		}
+		SceneBuilder::loadImages(textured, modelDirectory, 0, changes.images);
+		for (SceneBuilder::ImageMap::iterator it = changes.images.begin(); it
+				!= changes.images.end();) {
+			if (it->second.image.valid())
+				++it;
+			else
+				changes.images.erase(it++);
+		}
+	}
+
+	/* Report each edit once: */
+	Guard<MutexPosix> guard(lock);
+	for (size_t m = 0; m < changes.materials.size(); ++m) {
+		const ParkMaterial& material = changes.materials[m];
+		materials[material.name] = material;
+		if (!material.texture.empty())
+			textures.insert(material.texture);
+	}
+} // end readChanges()
+
+/*
+ * isCancelled
+ *
+ * return - bool
+ */
+bool AssetWatcher::isCancelled(void) const {
+	Guard<MutexPosix> guard(lock);
+	return cancelled;
+} // end isCancelled()
@@ -0,0 +1,80 @@
+/*
+ * AssetWatcher.h - Background thread reading park assets edited on disk.
+ *
+ * Created: October 17, 2026
+ */
+
+#ifndef ASSETWATCHER_H_
+#define ASSETWATCHER_H_
+
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+#include <pthread.h>
+
+/* Boost includes */
+#include <boost/noncopyable.hpp>
+
+#include <MODEL/ParkMesh.h>
+#include <MODEL/SceneBuilder.h>
+#include <SYNC/MutexPosix.h>
+
+/*
+ * AssetChanges - What changed in the model directory since the last
+ * takeChanges(), read and decoded.
+ */
+struct AssetChanges {
+	/* Library materials whose properties changed, by their new properties */
+	std::vector<ParkMaterial> materials;
+	/* New images of edited textures and of textures the changed materials
+	 * newly use */
+	SceneBuilder::ImageMap images;
+	/* Whether the OBJ file changed, which only loading the park again
+	 * applies */
+	bool reload;
+
+	AssetChanges(void);
+	void merge(const AssetChanges& newer);
+};
+
+/*
+ * AssetWatcher - Watches the model directory on its own thread. Once no file
+ * has been written for SETTLE_MILLISECONDS, the material libraries written
+ * are parsed again and compared with the materials of the displayed park,
+ * and edited textures the park uses are decoded. The results are handed
+ * over through takeChanges(), so the frame thread only patches the scene
+ * graph and never waits for the disk. Files the park does not use, such as
+ * the scene cache the loader writes, are ignored.
+ */
+class AssetWatcher: boost::noncopyable {
+public:
+	static const Uint32 SETTLE_MILLISECONDS = 250;
+
+	AssetWatcher(const std::string& modelDirectory, const std::string& objFile);
+	~AssetWatcher(void);
+	void start(void);
+	void setMaterials(const std::vector<ParkMaterial>& materials);
+	bool takeChanges(AssetChanges& changes);
+
+private:
+	std::string modelDirectory;
+	std::string objFile;
+	pthread_t thread;
+	bool started;
+	mutable MutexPosix lock;
+	/* Library materials of the displayed park by name, as last reported */
+	std::map<std::string, ParkMaterial> materials;
+	/* Texture files of the displayed park */
+	std::set<std::string> textures;
+	/* Changes not taken yet */
+	AssetChanges * pending;
+	bool cancelled;
+
+	static void * watcherMain(void * watcher);
+	void watch(void);
+	void readChanges(const std::set<std::string>& names, AssetChanges& changes);
+	bool isCancelled(void) const;
+};
+
+#endif /* ASSETWATCHER_H_ */
@@ -0,0 +1,404 @@
+/*
+ * ClusterCuller.cpp - Methods for building the cluster culling hierarchy and
+ * culling it against view frustums.
+ *
+ * Created: October 16, 2026
+ */
+
+/* System headers */
+#include <algorithm>
+#include <cfloat>
+#include <cstring>
+#include <vector>
+
+/* Application headers */
+#include <MODEL/ClusterCuller.h>
+#include <MODEL/ParkMesh.h>
+#include <UTIL/System.h>
+
+/* Deepest hierarchy the traversal stack allows */
+static const Uint32 MAX_DEPTH = 32;
+
+/*
+ * Floats4, Ints4 - SSE registers holding one coordinate of four boxes.
+ */
+typedef float Floats4 __attribute__((vector_size(16)));
+typedef Int32 Ints4 __attribute__((vector_size(16)));
+
+/*
+ * now - Wall clock in seconds.
+ */
+static double now(void) {
+	TimeVal time;
+	SystemPosix::gettimeofday(&time);
+	return time.tv_sec + time.tv_usec * 1.0e-6;
+} // end now()
+
+/*
+ * classifyBoxes - Tests the four boxes of a node against the six planes of
+ * a frustum, by the farthest and nearest corner along each plane normal.
+ *
+ * parameter outside - Ints4&, set where a box is outside some plane
+ * parameter inside - Ints4&, set where a box is inside all planes
+ */
+static inline void classifyBoxes(const Floats4 boundsMin[3],
+		const Floats4 boundsMax[3], const float planes[6][4], Ints4& outside,
+		Ints4& inside) {
+	const Ints4 none = { 0, 0, 0, 0 };
+	const Ints4 all = { -1, -1, -1, -1 };
+	outside = none;
+	inside = all;
+	for (int p = 0; p < 6; ++p) {
+		const float * plane = planes[p];
+		Floats4 far = { plane[3], plane[3], plane[3], plane[3] };
+		Floats4 near = far;
+		for (int i = 0; i < 3; ++i) {
+			const bool positive = plane[i] >= 0.0f;
+			far += plane[i] * (positive ? boundsMax[i] : boundsMin[i]);
+			near += plane[i] * (positive ? boundsMin[i] : boundsMax[i]);
+		}
+		const Floats4 zero = { 0.0f, 0.0f, 0.0f, 0.0f };
+		outside |= far < zero;
+		inside &= near >= zero;
+	}
+} // end classifyBoxes()
+
+/*
+ * CullEntry - A node left to walk, the views its box straddles, and those
+ * holding it whole.
+ */
+struct CullEntry {
+	Uint32 node;
+	Uint32 straddled;
+	Uint32 contained;
+};
+
+/*
+ * CenterIsLess - Orders clusters by the center of their box along an axis.
+ */
+struct CenterIsLess {
+	const ParkMesh * mesh;
+	int axis;
+
+	bool operator()(Uint32 a, Uint32 b) const {
+		const ParkCluster& first = mesh->clusters[a];
+		const ParkCluster& second = mesh->clusters[b];
+		return first.boundsMin[axis] + first.boundsMax[axis]
+				< second.boundsMin[axis] + second.boundsMax[axis];
+	}
+};
+
+/*
+ * splitLeaves - Splits a range of the leaf order in two at the median of
+ * the widest axis of the cluster centers.
+ *
+ * return - Uint32, first leaf of the upper half
+ */
+static Uint32 splitLeaves(const ParkMesh& mesh, std::vector<Uint32>& leaves,
+		Uint32 begin, Uint32 end) {
+	float low[3] = { FLT_MAX, FLT_MAX, FLT_MAX };
+	float high[3] = { -FLT_MAX, -FLT_MAX, -FLT_MAX };
+	for (Uint32 l = begin; l < end; ++l) {
+		const ParkCluster& cluster = mesh.clusters[leaves[l]];
+		for (int i = 0; i < 3; ++i) {
+			const float center = cluster.boundsMin[i] + cluster.boundsMax[i];
+			low[i] = std::min(low[i], center);
+			high[i] = std::max(high[i], center);
+		}
+	}
+	CenterIsLess isLess;
+	isLess.mesh = &mesh;
+	isLess.axis = 0;
+	for (int i = 1; i < 3; ++i)
+		if (high[i] - low[i] > high[isLess.axis] - low[isLess.axis])
+			isLess.axis = i;
+	const Uint32 mid = begin + (end - begin) / 2;
+	std::nth_element(leaves.begin() + begin, leaves.begin() + mid,
+			leaves.begin() + end, isLess);
+	return mid;
+} // end splitLeaves()
+
+/*****************************************
+ Methods of struct CullStatistics:
+ *****************************************/
+/*
+ * CullStatistics constructor
+ */
+CullStatistics::CullStatistics(void) :
+	numVisible(0), numCulled(0), numClipped(0), numOccluded(0), numNodes(0),
+			cullTime(0.0), occlusionTime(0.0) {
+} // end CullStatistics()
+
+/*******************************
+ Methods of class ClusterCuller:
+ *******************************/
+
+/*
+ * ClusterCuller constructor
+ */
+ClusterCuller::ClusterCuller(void) {
+} // end ClusterCuller()
+
+/*
+ * ~ClusterCuller
+ */
+ClusterCuller::~ClusterCuller(void) {
+} // end ~ClusterCuller()
+
+/*
+ * build - Builds the hierarchy over the cluster boxes.
+ *
+ * parameter mesh - const ParkMesh&, with cluster bounds computed
+ */
+void ClusterCuller::build(const ParkMesh& mesh) {
+	clear();
+	const Uint32 numClusters = static_cast<Uint32> (mesh.clusters.size());
+	if (numClusters == 0)
+		return;
+	leaves.resize(numClusters);
+	for (Uint32 c = 0; c < numClusters; ++c)
+		leaves[c] = c;
+	buildNode(mesh, 0, numClusters);
+} // end build()
+
+/*
+ * buildNode - Adds the node over a range of the leaf order and the nodes
+ * below it. The range is split in two, and each half in two again; parts
+ * of one cluster become leaf children.
+ *
+ * parameter mesh - const ParkMesh&
+ * parameter begin, end - Uint32, at least two leaves unless the root
+ * return - Uint32, the node's index
+ */
+Uint32 ClusterCuller::buildNode(const ParkMesh& mesh, Uint32 begin, Uint32 end) {
+	const Uint32 index = static_cast<Uint32> (nodes.size());
+	nodes.push_back(CullNode());
+	Uint32 parts[CullNode::WIDTH + 1];
+	Uint32 numParts = 0;
+	parts[0] = begin;
+	if (end - begin <= CullNode::WIDTH) {
+		for (Uint32 l = begin; l < end; ++l)
+			parts[++numParts] = l + 1;
+	} else {
+		const Uint32 mid = splitLeaves(mesh, leaves, begin, end);
+		parts[1] = splitLeaves(mesh, leaves, begin, mid);
+		parts[2] = mid;
+		parts[3] = splitLeaves(mesh, leaves, mid, end);
+		parts[4] = end;
+		numParts = 4;
+	}
+
+	for (Uint32 child = 0; child < CullNode::WIDTH; ++child) {
+		CullNode& node = nodes[index];
+		for (int i = 0; i < 3; ++i) {
+			node.boundsMin[i][child] = FLT_MAX;
+			node.boundsMax[i][child] = -FLT_MAX;
+		}
+		node.children[child] = EMPTY;
+		node.firstLeaf[child] = node.numLeaves[child] = 0;
+	}
+	for (Uint32 p = 0; p < numParts; ++p) {
+		Int32 child;
+		if (parts[p + 1] - parts[p] == 1)
+			child = ~static_cast<Int32> (leaves[parts[p]]);
+		else
+			child = static_cast<Int32> (buildNode(mesh, parts[p], parts[p + 1]));
+		/* nodes may have moved: */
+		CullNode& node = nodes[index];
+		node.children[p] = child;
+		node.firstLeaf[p] = parts[p];
+		node.numLeaves[p] = parts[p + 1] - parts[p];
+		for (Uint32 l = parts[p]; l < parts[p + 1]; ++l) {
+			const ParkCluster& cluster = mesh.clusters[leaves[l]];
+			for (int i = 0; i < 3; ++i) {
+				node.boundsMin[i][p] = std::min(node.boundsMin[i][p],
+						cluster.boundsMin[i]);
+				node.boundsMax[i][p] = std::max(node.boundsMax[i][p],
+						cluster.boundsMax[i]);
+			}
+		}
+	}
+	return index;
+} // end buildNode()
+
+/*
+ * clear
+ */
+void ClusterCuller::clear(void) {
+	std::vector<CullNode>().swap(nodes);
+	std::vector<Uint32>().swap(leaves);
+} // end clear()
+
+/*
+ * getNumClusters
+ *
+ * return - Uint32
+ */
+Uint32 ClusterCuller::getNumClusters(void) const {
+	return static_cast<Uint32> (leaves.size());
+} // end getNumClusters()
+
+/*
+ * cull - Lists the clusters whose box is not entirely outside one of the
+ * frustum planes.
+ *
+ * parameter clipMatrix - const float[16], mesh to clip coordinates, column
+ * major as GL stores it
+ * parameter visible - std::vector<Uint32>&, cluster indices, overwritten
+ * parameter statistics - CullStatistics&
+ */
+void ClusterCuller::cull(const float clipMatrix[16],
+		std::vector<Uint32>& visible, CullStatistics& statistics) const {
+	const double start = now();
+	visible.clear();
+	statistics.numNodes = 0;
+	if (!nodes.empty()) {
+		float planes[6][4];
+		getFrustumPlanes(clipMatrix, planes);
+		Uint32 stack[MAX_DEPTH * (CullNode::WIDTH - 1) + 1];
+		Uint32 stackSize = 0;
+		stack[stackSize++] = 0;
+		while (stackSize > 0) {
+			const CullNode& node = nodes[stack[--stackSize]];
+			++statistics.numNodes;
+			Floats4 boundsMin[3];
+			Floats4 boundsMax[3];
+			for (int i = 0; i < 3; ++i) {
+				std::memcpy(&boundsMin[i], node.boundsMin[i], sizeof(Floats4));
+				std::memcpy(&boundsMax[i], node.boundsMax[i], sizeof(Floats4));
+			}
+
+			Ints4 outside;
+			Ints4 inside;
+			classifyBoxes(boundsMin, boundsMax, planes, outside, inside);
+
+			for (Uint32 child = 0; child < CullNode::WIDTH; ++child) {
+				const Int32 index = node.children[child];
+				if (index == EMPTY || outside[child])
+					continue;
+				if (inside[child])
+					visible.insert(visible.end(), leaves.begin()
+							+ node.firstLeaf[child], leaves.begin()
+							+ node.firstLeaf[child] + node.numLeaves[child]);
+				else if (index < 0)
+					visible.push_back(~index);
+				else
+					stack[stackSize++] = static_cast<Uint32> (index);
+			}
+		}
+	}
+	statistics.numVisible = static_cast<Uint32> (visible.size());
+	statistics.numCulled = getNumClusters() - statistics.numVisible;
+	statistics.cullTime = now() - start;
+} // end cull()
+
+/*
+ * cull - Lists the clusters whose box is not entirely outside the frustum
+ * of every view, and which views see each, in one walk for all views. A
+ * node is tested only against the views its parent straddles; the views
+ * holding the parent whole hold the node too.
+ *
+ * parameter clipMatrices - const float *, sixteen per view, mesh to clip
+ * coordinates, column major
+ * parameter numViews - Uint32, one to MAX_VIEWS
+ * parameter visible - std::vector<Uint32>&, cluster indices, overwritten
+ * parameter views - std::vector<Uint32>&, per visible cluster a bit per
+ * view seeing it, overwritten
+ * parameter statistics - CullStatistics&
+ */
+void ClusterCuller::cull(const float * clipMatrices, Uint32 numViews,
+		std::vector<Uint32>& visible, std::vector<Uint32>& views,
+		CullStatistics& statistics) const {
+	if (numViews == 1) {
+		cull(clipMatrices, visible, statistics);
+		views.assign(visible.size(), 1u);
+		return;
+	}
+	const double start = now();
+	visible.clear();
+	views.clear();
+	statistics.numNodes = 0;
+	if (!nodes.empty()) {
+		float planes[MAX_VIEWS][6][4];
+		for (Uint32 v = 0; v < numViews; ++v)
+			getFrustumPlanes(clipMatrices + 16 * v, planes[v]);
+		CullEntry stack[MAX_DEPTH * (CullNode::WIDTH - 1) + 1];
+		Uint32 stackSize = 0;
+		stack[stackSize].node = 0;
+		stack[stackSize].straddled = numViews == MAX_VIEWS ? ~0u : (1u
+				<< numViews) - 1;
+		stack[stackSize++].contained = 0;
+		while (stackSize > 0) {
+			const CullEntry entry = stack[--stackSize];
+			const CullNode& node = nodes[entry.node];
+			++statistics.numNodes;
+			Floats4 boundsMin[3];
+			Floats4 boundsMax[3];
+			for (int i = 0; i < 3; ++i) {
+				std::memcpy(&boundsMin[i], node.boundsMin[i], sizeof(Floats4));
+				std::memcpy(&boundsMax[i], node.boundsMax[i], sizeof(Floats4));
+			}
+
+			Uint32 straddled[CullNode::WIDTH] = { 0, 0, 0, 0 };
+			Uint32 contained[CullNode::WIDTH];
+			for (Uint32 child = 0; child < CullNode::WIDTH; ++child)
+				contained[child] = entry.contained;
+			for (Uint32 v = 0; v < numViews; ++v) {
+				const Uint32 view = 1u << v;
+				if ((entry.straddled & view) == 0)
+					continue;
+				Ints4 outside;
+				Ints4 inside;
+				classifyBoxes(boundsMin, boundsMax, planes[v], outside, inside);
+				for (Uint32 child = 0; child < CullNode::WIDTH; ++child) {
+					if (inside[child])
+						contained[child] |= view;
+					else if (!outside[child])
+						straddled[child] |= view;
+				}
+			}
+
+			for (Uint32 child = 0; child < CullNode::WIDTH; ++child) {
+				const Int32 index = node.children[child];
+				if (index == EMPTY || (contained[child] | straddled[child])
+						== 0)
+					continue;
+				if (straddled[child] == 0) {
+					visible.insert(visible.end(), leaves.begin()
+							+ node.firstLeaf[child], leaves.begin()
+							+ node.firstLeaf[child] + node.numLeaves[child]);
+					views.resize(visible.size(), contained[child]);
+				} else if (index < 0) {
+					visible.push_back(~index);
+					views.push_back(contained[child] | straddled[child]);
+				} else {
+					stack[stackSize].node = static_cast<Uint32> (index);
+					stack[stackSize].straddled = straddled[child];
+					stack[stackSize++].contained = contained[child];
+				}
+			}
+		}
+	}
+	statistics.numVisible = static_cast<Uint32> (visible.size());
+	statistics.numCulled = getNumClusters() - statistics.numVisible;
+	statistics.cullTime = now() - start;
+} // end cull()
+
+/*
+ * getFrustumPlanes - The six planes bounding the view volume of a clip
+ * matrix, facing inward, unnormalized: left, right, bottom, top, near, far.
+ *
+ * parameter clipMatrix - const float[16], column major
+ * parameter planes - float[6][4], a, b, c, d of ax + by + cz + d >= 0
+ */
+void ClusterCuller::getFrustumPlanes(const float clipMatrix[16],
+		float planes[6][4]) {
+	for (int axis = 0; axis < 3; ++axis) {
+		for (int i = 0; i < 4; ++i) {
+			planes[2 * axis][i] = clipMatrix[4 * i + 3]
+					+ clipMatrix[4 * i + axis];
+			planes[2 * axis + 1][i] = clipMatrix[4 * i + 3]
+					- clipMatrix[4 * i + axis];
+		}
+	}
+} // end getFrustumPlanes()
@@ -0,0 +1,89 @@
+/*
+ * ClusterCuller.h - View frustum culling of the park clusters.
+ *
+ * Created: October 16, 2026
+ */
+
+#ifndef CLUSTERCULLER_H_
+#define CLUSTERCULLER_H_
+
+#include <vector>
+
+#include <UTIL/Types.h>
+
+/* Begin Forward declarations: */
+class ParkMesh;
+/* End Forward declarations: */
+
+/*
+ * CullNode - Four child boxes of the culling hierarchy, one array per
+ * coordinate so a plane is tested against all four in one SIMD operation.
+ */
+struct CullNode {
+	static const Uint32 WIDTH = 4;
+
+	float boundsMin[3][WIDTH];
+	float boundsMax[3][WIDTH];
+	/* Inner child: node index. Leaf child: ~cluster. Unused: EMPTY. */
+	Int32 children[WIDTH];
+	/* Range of the leaf order each child's subtree covers */
+	Uint32 firstLeaf[WIDTH];
+	Uint32 numLeaves[WIDTH];
+};
+
+/*
+ * CullStatistics - What one view's cull did.
+ */
+struct CullStatistics {
+	Uint32 numVisible;
+	Uint32 numCulled;
+	/* Inside the frustum but entirely on the cut side of a clipping plane */
+	Uint32 numClipped;
+	/* Inside the frustum but hidden by the occluders */
+	Uint32 numOccluded;
+	/* Nodes whose four boxes were tested */
+	Uint32 numNodes;
+	double cullTime;
+	double occlusionTime;
+
+	CullStatistics(void);
+};
+
+/*
+ * ClusterCuller - Four-wide bounding volume hierarchy over the cluster
+ * boxes of a ParkMesh. cull() walks it against the six planes of a view
+ * frustum: a child outside a plane is dropped, and a child inside all six
+ * adds its whole subtree to the visible list without further tests.
+ * Several views, such as the eyes of a stereo pair or the walls of a CAVE,
+ * may be culled in one walk that tells which views see each cluster.
+ * Culling only reads the hierarchy, so every view may cull concurrently.
+ */
+class ClusterCuller {
+public:
+	static const Int32 EMPTY = -0x7fffffff - 1;
+	/* Views one walk culls at most */
+	static const Uint32 MAX_VIEWS = 32;
+
+	ClusterCuller(void);
+	~ClusterCuller(void);
+	void build(const ParkMesh& mesh);
+	void clear(void);
+	Uint32 getNumClusters(void) const;
+	void cull(const float clipMatrix[16], std::vector<Uint32>& visible,
+			CullStatistics& statistics) const;
+	void cull(const float * clipMatrices, Uint32 numViews,
+			std::vector<Uint32>& visible, std::vector<Uint32>& views,
+			CullStatistics& statistics) const;
+	static void getFrustumPlanes(const float clipMatrix[16],
+			float planes[6][4]);
+
+private:
+	Uint32 buildNode(const ParkMesh& mesh, Uint32 begin, Uint32 end);
+
+	/* Node 0 is the root */
+	std::vector<CullNode> nodes;
+	/* Clusters in leaf order */
+	std::vector<Uint32> leaves;
+};
+
+#endif /* CLUSTERCULLER_H_ */
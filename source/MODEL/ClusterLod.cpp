@@ -0,0 +1,489 @@
+/*
+ * ClusterLod.cpp - Methods for simplifying the park clusters and selecting
+ * their levels of detail.
+ *
+ * Created: October 16, 2026
+ */
+
+/* System headers */
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <iterator>
+#include <map>
+#include <utility>
+#include <vector>
+
+/* Application headers */
+#include <MODEL/ClusterLod.h>
+#include <MODEL/MeshOptimizer.h>
+#include <MODEL/ParkMesh.h>
+
+const float ClusterLod::ERROR_PIXELS = 1.0f;
+const float ClusterLod::HYSTERESIS = 0.75f;
+
+/* Share of the previous level's triangles each level aims for */
+static const double LEVEL_RATIO = 0.5;
+/* A level keeping more of the previous level than this ends the chain */
+static const double MIN_REDUCTION = 0.85;
+/* Smallest cosine between a triangle's normals before and after a collapse */
+static const double MIN_NORMAL_COSINE = 0.5;
+
+static const Uint32 NONE = 0xffffffffu;
+
+/*
+ * Quadric - Sum of squared distances to a set of planes, as the upper
+ * triangle of a symmetric 4x4 matrix.
+ */
+struct Quadric {
+	double a[10];
+
+	Quadric(void) {
+		std::fill(a, a + 10, 0.0);
+	}
+
+	void addPlane(const double n[3], double d) {
+		a[0] += n[0] * n[0];
+		a[1] += n[0] * n[1];
+		a[2] += n[0] * n[2];
+		a[3] += n[0] * d;
+		a[4] += n[1] * n[1];
+		a[5] += n[1] * n[2];
+		a[6] += n[1] * d;
+		a[7] += n[2] * n[2];
+		a[8] += n[2] * d;
+		a[9] += d * d;
+	}
+
+	void add(const Quadric& other) {
+		for (int i = 0; i < 10; ++i)
+			a[i] += other.a[i];
+	}
+
+	double evaluate(const float p[3]) const {
+		const double x = p[0];
+		const double y = p[1];
+		const double z = p[2];
+		return a[0] * x * x + 2.0 * a[1] * x * y + 2.0 * a[2] * x * z + 2.0
+				* a[3] * x + a[4] * y * y + 2.0 * a[5] * y * z + 2.0 * a[6] * y
+				+ a[7] * z * z + 2.0 * a[8] * z + a[9];
+	}
+};
+
+/*
+ * Collapse - Moving vertex from onto vertex to, at a quadric cost.
+ */
+struct Collapse {
+	double cost;
+	Uint32 from;
+	Uint32 to;
+
+	bool operator<(const Collapse& other) const {
+		return cost < other.cost;
+	}
+};
+
+/*
+ * getNormal - Unnormalized normal of a triangle.
+ */
+static void getNormal(const float* p0, const float* p1, const float* p2,
+		double normal[3]) {
+	const double e1[3] = { p1[0] - p0[0], p1[1] - p0[1], p1[2] - p0[2] };
+	const double e2[3] = { p2[0] - p0[0], p2[1] - p0[1], p2[2] - p0[2] };
+	normal[0] = e1[1] * e2[2] - e1[2] * e2[1];
+	normal[1] = e1[2] * e2[0] - e1[0] * e2[2];
+	normal[2] = e1[0] * e2[1] - e1[1] * e2[0];
+} // end getNormal()
+
+/*
+ * ClusterSimplifier - Edge collapse state of one cluster. Vertices are
+ * renumbered locally; triangles keep the order and group they had at level 0.
+ */
+class ClusterSimplifier {
+public:
+	ClusterSimplifier(const ParkMesh& mesh, const ParkCluster& cluster,
+			std::vector<Uint32>& local);
+	void simplify(Uint32 targetTriangles);
+	void getTriangles(std::vector<Uint32>& indices,
+			std::vector<Uint32>& groups) const;
+
+	Uint32 numAlive;
+	/* Largest quadric distance of a collapse so far */
+	float error;
+
+private:
+	const ParkMesh& mesh;
+	std::vector<Uint32> global;
+	std::vector<Uint32> triangles;
+	std::vector<Uint32> triangleGroups;
+	std::vector<bool> alive;
+	std::vector<std::vector<Uint32> > vertexTriangles;
+	std::vector<Quadric> quadrics;
+	std::vector<bool> locked;
+	/* Scratch of isValid() */
+	mutable std::vector<Uint32> fromNeighbors;
+	mutable std::vector<Uint32> toNeighbors;
+	mutable std::vector<Uint32> shared;
+
+	const float * getPosition(Uint32 vertex) const {
+		return mesh.vertices[global[vertex]].position;
+	}
+	bool isValid(Uint32 from, Uint32 to) const;
+	void collapse(Uint32 from, Uint32 to);
+	bool collapsePass(Uint32 targetTriangles);
+};
+
+/*
+ * ClusterSimplifier constructor - Gathers the level 0 triangles of a cluster
+ * and their plane quadrics, and locks every vertex on an edge not shared by
+ * exactly two of them.
+ *
+ * parameter mesh - const ParkMesh&
+ * parameter cluster - const ParkCluster&
+ * parameter local - std::vector<Uint32>&, NONE for every mesh vertex; left so
+ */
+ClusterSimplifier::ClusterSimplifier(const ParkMesh& _mesh,
+		const ParkCluster& cluster, std::vector<Uint32>& local) :
+	numAlive(cluster.numIndices[0] / 3), error(0.0f), mesh(_mesh) {
+	triangles.resize(cluster.numIndices[0]);
+	for (Uint32 i = 0; i < cluster.numIndices[0]; ++i) {
+		const Uint32 vertex = mesh.indices[cluster.firstIndex[0] + i];
+		if (local[vertex] == NONE) {
+			local[vertex] = static_cast<Uint32> (global.size());
+			global.push_back(vertex);
+		}
+		triangles[i] = local[vertex];
+	}
+	for (size_t v = 0; v < global.size(); ++v)
+		local[global[v]] = NONE;
+
+	triangleGroups.assign(mesh.triangleGroups.begin() + cluster.firstIndex[0]
+			/ 3, mesh.triangleGroups.begin() + (cluster.firstIndex[0]
+			+ cluster.numIndices[0]) / 3);
+	alive.assign(numAlive, true);
+	vertexTriangles.resize(global.size());
+	quadrics.resize(global.size());
+	locked.assign(global.size(), false);
+
+	std::map<std::pair<Uint32, Uint32>, Uint32> edgeUses;
+	for (Uint32 t = 0; t < numAlive; ++t) {
+		const Uint32* vertex = &triangles[3 * t];
+		double normal[3];
+		getNormal(getPosition(vertex[0]), getPosition(vertex[1]),
+				getPosition(vertex[2]), normal);
+		const double length = std::sqrt(normal[0] * normal[0] + normal[1]
+				* normal[1] + normal[2] * normal[2]);
+		for (int k = 0; k < 3; ++k) {
+			vertexTriangles[vertex[k]].push_back(t);
+			++edgeUses[std::make_pair(std::min(vertex[k], vertex[(k + 1) % 3]),
+					std::max(vertex[k], vertex[(k + 1) % 3]))];
+		}
+		if (length == 0.0)
+			continue;
+		for (int i = 0; i < 3; ++i)
+			normal[i] /= length;
+		const float* p = getPosition(vertex[0]);
+		const double d = -(normal[0] * p[0] + normal[1] * p[1] + normal[2]
+				* p[2]);
+		for (int k = 0; k < 3; ++k)
+			quadrics[vertex[k]].addPlane(normal, d);
+	}
+	for (std::map<std::pair<Uint32, Uint32>, Uint32>::const_iterator eIt =
+			edgeUses.begin(); eIt != edgeUses.end(); ++eIt) {
+		if (eIt->second != 2) {
+			locked[eIt->first.first] = true;
+			locked[eIt->first.second] = true;
+		}
+	}
+} // end ClusterSimplifier()
+
+/*
+ * simplify - Collapses edges, cheapest first, until at most targetTriangles
+ * are left or no collapse is possible.
+ *
+ * parameter targetTriangles - Uint32
+ */
+void ClusterSimplifier::simplify(Uint32 targetTriangles) {
+	while (numAlive > targetTriangles && collapsePass(targetTriangles))
+		;
+} // end simplify()
+
+/*
+ * getTriangles - The surviving triangles in level 0 order.
+ *
+ * parameter indices - std::vector<Uint32>&, receives mesh vertex indices
+ * parameter groups - std::vector<Uint32>&, receives the group of each
+ */
+void ClusterSimplifier::getTriangles(std::vector<Uint32>& indices,
+		std::vector<Uint32>& groups) const {
+	indices.clear();
+	groups.clear();
+	for (size_t t = 0; t < alive.size(); ++t) {
+		if (!alive[t])
+			continue;
+		for (int k = 0; k < 3; ++k)
+			indices.push_back(global[triangles[3 * t + k]]);
+		groups.push_back(triangleGroups[t]);
+	}
+} // end getTriangles()
+
+/*
+ * isValid - Whether moving a vertex onto a neighbor keeps the surface a
+ * manifold with the same border (the two vertices share exactly the two
+ * neighbors opposite their edge) and every remaining triangle around it
+ * facing the same way.
+ */
+bool ClusterSimplifier::isValid(Uint32 from, Uint32 to) const {
+	const std::vector<Uint32>& around = vertexTriangles[from];
+	fromNeighbors.clear();
+	toNeighbors.clear();
+	shared.clear();
+	Uint32 numShared = 0;
+	for (size_t a = 0; a < around.size(); ++a) {
+		const Uint32* vertex = &triangles[3 * around[a]];
+		if (!alive[around[a]])
+			continue;
+		fromNeighbors.insert(fromNeighbors.end(), vertex, vertex + 3);
+		if (vertex[0] == to || vertex[1] == to || vertex[2] == to)
+			++numShared;
+	}
+	const std::vector<Uint32>& aroundTo = vertexTriangles[to];
+	for (size_t a = 0; a < aroundTo.size(); ++a) {
+		const Uint32* vertex = &triangles[3 * aroundTo[a]];
+		if (alive[aroundTo[a]])
+			toNeighbors.insert(toNeighbors.end(), vertex, vertex + 3);
+	}
+	std::sort(fromNeighbors.begin(), fromNeighbors.end());
+	fromNeighbors.erase(std::unique(fromNeighbors.begin(),
+			fromNeighbors.end()), fromNeighbors.end());
+	std::sort(toNeighbors.begin(), toNeighbors.end());
+	toNeighbors.erase(std::unique(toNeighbors.begin(), toNeighbors.end()),
+			toNeighbors.end());
+	std::set_intersection(fromNeighbors.begin(), fromNeighbors.end(),
+			toNeighbors.begin(), toNeighbors.end(), std::back_inserter(shared));
+	/* Both neighborhoods contain from and to themselves: */
+	if (numShared != 2 || shared.size() != 4)
+		return false;
+
+	for (size_t a = 0; a < around.size(); ++a) {
+		const Uint32 t = around[a];
+		const Uint32* vertex = &triangles[3 * t];
+		if (!alive[t] || vertex[0] == to || vertex[1] == to || vertex[2] == to)
+			continue;
+		const float* p[3];
+		const float* q[3];
+		for (int k = 0; k < 3; ++k) {
+			p[k] = getPosition(vertex[k]);
+			q[k] = vertex[k] == from ? getPosition(to) : p[k];
+		}
+		double before[3];
+		double after[3];
+		getNormal(p[0], p[1], p[2], before);
+		getNormal(q[0], q[1], q[2], after);
+		const double dot = before[0] * after[0] + before[1] * after[1]
+				+ before[2] * after[2];
+		const double lengths = std::sqrt((before[0] * before[0] + before[1]
+				* before[1] + before[2] * before[2]) * (after[0] * after[0]
+				+ after[1] * after[1] + after[2] * after[2]));
+		if (lengths == 0.0 || dot < MIN_NORMAL_COSINE * lengths)
+			return false;
+	}
+	return true;
+} // end isValid()
+
+/*
+ * collapse - Moves a vertex onto a neighbor and drops the triangles that
+ * became degenerate.
+ */
+void ClusterSimplifier::collapse(Uint32 from, Uint32 to) {
+	std::vector<Uint32>& around = vertexTriangles[from];
+	for (size_t a = 0; a < around.size(); ++a) {
+		const Uint32 t = around[a];
+		if (!alive[t])
+			continue;
+		Uint32* vertex = &triangles[3 * t];
+		if (vertex[0] == to || vertex[1] == to || vertex[2] == to) {
+			alive[t] = false;
+			--numAlive;
+			continue;
+		}
+		for (int k = 0; k < 3; ++k) {
+			if (vertex[k] == from)
+				vertex[k] = to;
+		}
+		vertexTriangles[to].push_back(t);
+	}
+	around.clear();
+	quadrics[to].add(quadrics[from]);
+} // end collapse()
+
+/*
+ * collapsePass - Finds the cheapest valid collapse of every free vertex and
+ * performs them in order of cost, skipping those whose neighborhood an
+ * earlier collapse of the pass changed.
+ *
+ * return - bool, false if nothing was collapsed
+ */
+bool ClusterSimplifier::collapsePass(Uint32 targetTriangles) {
+	const Uint32 numVertices = static_cast<Uint32> (global.size());
+	std::vector<Collapse> candidates;
+	std::vector<Collapse> options;
+	for (Uint32 v = 0; v < numVertices; ++v) {
+		if (locked[v] || vertexTriangles[v].empty())
+			continue;
+		/* The cheapest neighbor the vertex may move onto: */
+		options.clear();
+		const std::vector<Uint32>& around = vertexTriangles[v];
+		for (size_t a = 0; a < around.size(); ++a) {
+			if (!alive[around[a]])
+				continue;
+			for (int k = 0; k < 3; ++k) {
+				Collapse option;
+				option.from = v;
+				option.to = triangles[3 * around[a] + k];
+				if (option.to == v)
+					continue;
+				option.cost = std::max(quadrics[v].evaluate(getPosition(
+						option.to)), 0.0);
+				options.push_back(option);
+			}
+		}
+		std::sort(options.begin(), options.end());
+		for (size_t o = 0; o < options.size(); ++o) {
+			if (isValid(v, options[o].to)) {
+				candidates.push_back(options[o]);
+				break;
+			}
+		}
+	}
+	std::sort(candidates.begin(), candidates.end());
+
+	std::vector<bool> touched(numVertices, false);
+	bool collapsed = false;
+	for (size_t c = 0; c < candidates.size() && numAlive > targetTriangles; ++c) {
+		const Collapse& candidate = candidates[c];
+		const std::vector<Uint32>& around = vertexTriangles[candidate.from];
+		bool free = !touched[candidate.to];
+		for (size_t a = 0; a < around.size() && free; ++a) {
+			for (int k = 0; k < 3; ++k)
+				free = free && !touched[triangles[3 * around[a] + k]];
+		}
+		if (!free)
+			continue;
+		for (size_t a = 0; a < around.size(); ++a) {
+			for (int k = 0; k < 3; ++k)
+				touched[triangles[3 * around[a] + k]] = true;
+		}
+		error = std::max(error, float(std::sqrt(candidate.cost)));
+		collapse(candidate.from, candidate.to);
+		collapsed = true;
+	}
+	return collapsed;
+} // end collapsePass()
+
+/*******************************
+ Methods of class ClusterLod:
+ *******************************/
+
+/*
+ * buildLevels - Simplifies every cluster of a merged and optimized mesh and
+ * appends the levels to the index array: all clusters' level 1, then level
+ * 2 and so on, each in batch order so that neighboring clusters at the same
+ * level form one range. Level triangles are ordered for the vertex cache
+ * and keep their group in triangleGroups.
+ *
+ * parameter mesh - ParkMesh&
+ */
+void ClusterLod::buildLevels(ParkMesh& mesh) {
+	const Uint32 numClusters = static_cast<Uint32> (mesh.clusters.size());
+	std::vector<std::vector<Uint32> > levelIndices(numClusters
+			* ParkCluster::MAX_LEVELS);
+	std::vector<std::vector<Uint32> > levelGroups(numClusters
+			* ParkCluster::MAX_LEVELS);
+	std::vector<Uint32> local(mesh.vertices.size(), NONE);
+
+	for (Uint32 c = 0; c < numClusters; ++c) {
+		ParkCluster& cluster = mesh.clusters[c];
+		cluster.numLevels = 1;
+		ClusterSimplifier simplifier(mesh, cluster, local);
+		Uint32 previous = simplifier.numAlive;
+		for (Uint32 l = 1; l < ParkCluster::MAX_LEVELS; ++l) {
+			simplifier.simplify(static_cast<Uint32> (previous * LEVEL_RATIO));
+			if (simplifier.numAlive == 0 || simplifier.numAlive > previous
+					* MIN_REDUCTION)
+				break;
+			simplifier.getTriangles(levelIndices[c * ParkCluster::MAX_LEVELS + l],
+					levelGroups[c * ParkCluster::MAX_LEVELS + l]);
+			cluster.error[l] = simplifier.error;
+			cluster.numLevels = l + 1;
+			previous = simplifier.numAlive;
+		}
+	}
+
+	for (Uint32 l = 1; l < ParkCluster::MAX_LEVELS; ++l) {
+		for (Uint32 c = 0; c < numClusters; ++c) {
+			ParkCluster& cluster = mesh.clusters[c];
+			if (l >= cluster.numLevels)
+				continue;
+			std::vector<Uint32>& indices = levelIndices[c
+					* ParkCluster::MAX_LEVELS + l];
+			const std::vector<Uint32>& groups = levelGroups[c
+					* ParkCluster::MAX_LEVELS + l];
+			MeshOptimizer::reorderTriangles(&indices[0],
+					static_cast<Uint32> (indices.size() / 3),
+					static_cast<Uint32> (mesh.vertices.size()));
+			cluster.firstIndex[l] = static_cast<Uint32> (mesh.indices.size());
+			cluster.numIndices[l] = static_cast<Uint32> (indices.size());
+			mesh.indices.insert(mesh.indices.end(), indices.begin(),
+					indices.end());
+			mesh.triangleGroups.insert(mesh.triangleGroups.end(),
+					groups.begin(), groups.end());
+		}
+	}
+} // end buildLevels()
+
+/*
+ * getScreenError - Projected error of a cluster level seen from a point.
+ *
+ * parameter cluster - const ParkCluster&
+ * parameter level - Uint32
+ * parameter eye - const float[3], in model coordinates
+ * parameter pixelScale - float, pixels per model unit at unit distance
+ * return - float, pixels
+ */
+float ClusterLod::getScreenError(const ParkCluster& cluster, Uint32 level,
+		const float eye[3], float pixelScale) {
+	if (cluster.error[level] == 0.0f)
+		return 0.0f;
+	float distance2 = 0.0f;
+	for (int i = 0; i < 3; ++i) {
+		const float d = std::max(std::max(cluster.boundsMin[i] - eye[i], 0.0f),
+				eye[i] - cluster.boundsMax[i]);
+		distance2 += d * d;
+	}
+	if (distance2 == 0.0f)
+		return FLT_MAX;
+	return cluster.error[level] * pixelScale / std::sqrt(distance2);
+} // end getScreenError()
+
+/*
+ * selectLevel - Refines a cluster until its projected error is acceptable,
+ * then coarsens it while the next level is clearly acceptable.
+ *
+ * parameter cluster - const ParkCluster&
+ * parameter level - Uint32, the level drawn so far
+ * parameter eye - const float[3], in model coordinates
+ * parameter pixelScale - float, pixels per model unit at unit distance
+ * return - Uint32, the level to draw
+ */
+Uint32 ClusterLod::selectLevel(const ParkCluster& cluster, Uint32 level,
+		const float eye[3], float pixelScale) {
+	level = std::min(level, cluster.numLevels - 1);
+	while (level > 0 && getScreenError(cluster, level, eye, pixelScale)
+			> ERROR_PIXELS)
+		--level;
+	while (level + 1 < cluster.numLevels && getScreenError(cluster, level + 1,
+			eye, pixelScale) < ERROR_PIXELS * HYSTERESIS)
+		++level;
+	return level;
+} // end selectLevel()
@@ -0,0 +1,40 @@
+/*
+ * ClusterLod.h - Post-optimize stage simplifying the park clusters into a
+ * chain of coarser levels, and selection of the level to draw.
+ *
+ * Created: October 16, 2026
+ */
+
+#ifndef CLUSTERLOD_H_
+#define CLUSTERLOD_H_
+
+#include <UTIL/Types.h>
+
+/* Begin Forward declarations: */
+struct ParkCluster;
+class ParkMesh;
+/* End Forward declarations: */
+
+/*
+ * ClusterLod - Builds up to ParkCluster::MAX_LEVELS - 1 coarser levels per
+ * cluster with quadric error metric edge collapses. Collapses move a vertex
+ * onto a neighbor, so the levels share the vertex array, and never move a
+ * vertex on the border of its cluster or on a texture or normal seam, so
+ * neighboring clusters at any level and material boundaries stay watertight.
+ * At run time the coarsest level whose projected error stays below
+ * ERROR_PIXELS is drawn; a coarser level has to undercut it by HYSTERESIS
+ * before it replaces the current one.
+ */
+class ClusterLod {
+public:
+	static const float ERROR_PIXELS;
+	static const float HYSTERESIS;
+
+	static void buildLevels(ParkMesh& mesh);
+	static float getScreenError(const ParkCluster& cluster, Uint32 level,
+			const float eye[3], float pixelScale);
+	static Uint32 selectLevel(const ParkCluster& cluster, Uint32 level,
+			const float eye[3], float pixelScale);
+};
+
+#endif /* CLUSTERLOD_H_ */
@@ -0,0 +1,608 @@
+/*
+ * CrossSection.cpp - Methods for cutting the park along a plane, chaining
+ * the cut into loops and capping them.
+ *
+ * Created: October 17, 2026
+ */
+
+/* System headers */
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <utility>
+#include <vector>
+
+/* Application headers */
+#include <MODEL/CrossSection.h>
+#include <MODEL/TriangleBvh.h>
+
+/* Half width of the slab searched around the plane, relative to the park's
+ * radius; it bounds how far the plane may move with the loops kept */
+static const float SLAB_FRACTION = 1.0e-3f;
+/* Rounding error of a vertex's distance from the plane, relative to the
+ * park's radius */
+static const float ROUNDING_FRACTION = 8.0f * FLT_EPSILON;
+
+/*
+ * CutPoint - One end of the segment a cut triangle contributes, and the
+ * mesh edge it lies on; a vertex on the plane is an edge of zero length.
+ * Ends on the same edge are welded, so nearly coincident cuts of different
+ * edges stay apart however the plane moves.
+ */
+struct CutPoint {
+	float position[3];
+	float edge[6];
+	Uint32 segmentEnd;
+
+	bool operator<(const CutPoint& other) const {
+		for (int i = 0; i < 6; ++i)
+			if (edge[i] != other.edge[i])
+				return edge[i] < other.edge[i];
+		return false;
+	}
+};
+
+/*
+ * PolygonVertex - A loop point in the plane's 2D coordinates.
+ */
+struct PolygonVertex {
+	double x;
+	double y;
+	Uint32 point;
+};
+
+typedef std::vector<PolygonVertex> Polygon;
+
+/*
+ * planeDistance
+ */
+static inline float planeDistance(const float plane[4], const float * point) {
+	return plane[0] * point[0] + plane[1] * point[1] + plane[2] * point[2]
+			+ plane[3];
+} // end planeDistance()
+
+/*
+ * isBefore - Lexicographic order of two positions, making the two triangles
+ * sharing an edge cut it at bitwise the same point.
+ */
+static inline bool isBefore(const float * a, const float * b) {
+	for (int i = 0; i < 3; ++i)
+		if (a[i] != b[i])
+			return a[i] < b[i];
+	return false;
+} // end isBefore()
+
+/*
+ * cutEdge - Where a plane cuts an edge, given the distances of its ends.
+ */
+static void cutEdge(const float * from, const float * to, float fromDistance,
+		float toDistance, float point[3]) {
+	if (fromDistance == 0.0f)
+		std::copy(from, from + 3, point);
+	else if (toDistance == 0.0f)
+		std::copy(to, to + 3, point);
+	else {
+		const float t = fromDistance / (fromDistance - toDistance);
+		for (int i = 0; i < 3; ++i)
+			point[i] = from[i] + t * (to[i] - from[i]);
+	}
+} // end cutEdge()
+
+/*
+ * signedArea - Twice the area of a polygon, positive if counterclockwise.
+ */
+static double signedArea(const Polygon& polygon) {
+	double area = 0.0;
+	for (size_t i = 0, j = polygon.size() - 1; i < polygon.size(); j = i++)
+		area += (polygon[j].x - polygon[i].x) * (polygon[j].y + polygon[i].y);
+	return area;
+} // end signedArea()
+
+/*
+ * containsPoint - Even-odd test of a point against a polygon.
+ */
+static bool containsPoint(const Polygon& polygon, double x, double y) {
+	bool inside = false;
+	for (size_t i = 0, j = polygon.size() - 1; i < polygon.size(); j = i++) {
+		const PolygonVertex& a = polygon[i];
+		const PolygonVertex& b = polygon[j];
+		if ((a.y > y) != (b.y > y) && x < (b.x - a.x) * (y - a.y) / (b.y - a.y)
+				+ a.x)
+			inside = !inside;
+	}
+	return inside;
+} // end containsPoint()
+
+/*
+ * cross - Twice the signed area of the triangle a, b, c.
+ */
+static inline double cross(const PolygonVertex& a, const PolygonVertex& b,
+		const PolygonVertex& c) {
+	return (b.x - a.x) * (c.y - a.y) - (b.y - a.y) * (c.x - a.x);
+} // end cross()
+
+/*
+ * insideTriangle - Whether p lies inside or on the counterclockwise triangle
+ * a, b, c without being one of its corners.
+ */
+static bool insideTriangle(const PolygonVertex& a, const PolygonVertex& b,
+		const PolygonVertex& c, const PolygonVertex& p) {
+	if ((p.x == a.x && p.y == a.y) || (p.x == b.x && p.y == b.y) || (p.x
+			== c.x && p.y == c.y))
+		return false;
+	return cross(a, b, p) >= 0.0 && cross(b, c, p) >= 0.0 && cross(c, a, p)
+			>= 0.0;
+} // end insideTriangle()
+
+/*
+ * bridgeHole - Joins a clockwise hole to a counterclockwise outer polygon by
+ * a pair of coincident edges from the hole's rightmost vertex to an outer
+ * vertex it sees along +x, the way earcut does.
+ *
+ * return - bool, false if no bridge was found
+ */
+static bool bridgeHole(Polygon& outer, const Polygon& hole) {
+	size_t m = 0;
+	for (size_t i = 1; i < hole.size(); ++i)
+		if (hole[i].x > hole[m].x)
+			m = i;
+	const PolygonVertex& hx = hole[m];
+
+	/* Nearest outer edge crossed by the ray to +x: */
+	double nearest = DBL_MAX;
+	size_t bridge = outer.size();
+	for (size_t i = 0; i < outer.size(); ++i) {
+		const PolygonVertex& a = outer[i];
+		const PolygonVertex& b = outer[(i + 1) % outer.size()];
+		if ((a.y > hx.y) == (b.y > hx.y) || a.y == b.y)
+			continue;
+		const double x = a.x + (hx.y - a.y) * (b.x - a.x) / (b.y - a.y);
+		if (x >= hx.x && x < nearest) {
+			nearest = x;
+			bridge = a.x > b.x ? i : (i + 1) % outer.size();
+		}
+	}
+	if (bridge == outer.size())
+		return false;
+
+	/* An outer vertex inside the triangle hole vertex, ray hit, candidate
+	 * would block the bridge; take the one closest in angle to the ray: */
+	PolygonVertex hit = hx;
+	hit.x = nearest;
+	const PolygonVertex candidate = outer[bridge];
+	const bool upper = candidate.y > hx.y;
+	double bestTan = DBL_MAX;
+	for (size_t i = 0; i < outer.size(); ++i) {
+		const PolygonVertex& p = outer[i];
+		if (i == bridge || p.x < hx.x)
+			continue;
+		const bool inside = upper ? insideTriangle(hx, hit, candidate, p)
+				: insideTriangle(hx, candidate, hit, p);
+		if (!inside)
+			continue;
+		const double tangent = std::fabs(p.y - hx.y) / std::max(p.x - hx.x,
+				1.0e-12);
+		if (tangent < bestTan) {
+			bestTan = tangent;
+			bridge = i;
+		}
+	}
+
+	Polygon merged;
+	merged.reserve(outer.size() + hole.size() + 2);
+	merged.insert(merged.end(), outer.begin(), outer.begin() + bridge + 1);
+	for (size_t i = 0; i <= hole.size(); ++i)
+		merged.push_back(hole[(m + i) % hole.size()]);
+	merged.insert(merged.end(), outer.begin() + bridge, outer.end());
+	outer.swap(merged);
+	return true;
+} // end bridgeHole()
+
+/*
+ * clipEars - Triangulates a counterclockwise polygon by ear clipping. Gives
+ * up on what is left if no ear can be found in a full round.
+ */
+static void clipEars(const Polygon& polygon, std::vector<Uint32>& triangles) {
+	const size_t n = polygon.size();
+	std::vector<size_t> prev(n);
+	std::vector<size_t> next(n);
+	for (size_t i = 0; i < n; ++i) {
+		prev[i] = (i + n - 1) % n;
+		next[i] = (i + 1) % n;
+	}
+	size_t remaining = n;
+	size_t current = 0;
+	size_t stalled = 0;
+	while (remaining > 3 && stalled <= remaining) {
+		const size_t p = prev[current];
+		const size_t q = next[current];
+		const double area = cross(polygon[p], polygon[current], polygon[q]);
+		bool ear = area > 0.0;
+		for (size_t r = next[q]; ear && r != p; r = next[r])
+			ear = !insideTriangle(polygon[p], polygon[current], polygon[q],
+					polygon[r]);
+		if (ear || area == 0.0) {
+			if (ear) {
+				triangles.push_back(polygon[p].point);
+				triangles.push_back(polygon[current].point);
+				triangles.push_back(polygon[q].point);
+			}
+			next[p] = q;
+			prev[q] = p;
+			--remaining;
+			stalled = 0;
+			current = q;
+		} else {
+			current = q;
+			++stalled;
+		}
+	}
+	if (remaining == 3 && cross(polygon[prev[current]], polygon[current],
+			polygon[next[current]]) > 0.0) {
+		triangles.push_back(polygon[prev[current]].point);
+		triangles.push_back(polygon[current].point);
+		triangles.push_back(polygon[next[current]].point);
+	}
+} // end clipEars()
+
+/*******************************
+ Methods of class CrossSection:
+ *******************************/
+
+/*
+ * CrossSection constructor
+ */
+CrossSection::CrossSection(void) {
+	clear();
+} // end CrossSection()
+
+/*
+ * ~CrossSection
+ */
+CrossSection::~CrossSection(void) {
+} // end ~CrossSection()
+
+/*
+ * update - Cuts the park along a plane, or slides the points of the last
+ * cut onto it if no vertex changed sides.
+ *
+ * parameter bvh - const TriangleBvh&, the same as in earlier calls
+ * parameter _plane - const float[4], a, b, c, d of ax + by + cz + d = 0,
+ * normalized
+ * return - bool, whether anything changed
+ */
+bool CrossSection::update(const TriangleBvh& bvh, const float _plane[4]) {
+	if (valid && std::equal(_plane, _plane + 4, plane))
+		return false;
+	if (valid) {
+		float normalChange = 0.0f;
+		for (int i = 0; i < 3; ++i)
+			normalChange += (_plane[i] - plane[i]) * (_plane[i] - plane[i]);
+		const float change = std::sqrt(normalChange) * radius + std::fabs(
+				_plane[3] - plane[3]);
+		std::copy(_plane, _plane + 4, plane);
+		if (change < clearance) {
+			clearance -= change;
+			placePoints();
+			return true;
+		}
+	}
+	std::copy(_plane, _plane + 4, plane);
+	build(bvh);
+	return true;
+} // end update()
+
+/*
+ * clear
+ */
+void CrossSection::clear(void) {
+	for (int i = 0; i < 4; ++i)
+		plane[i] = 0.0f;
+	radius = 0.0f;
+	clearance = 0.0f;
+	std::vector<float>().swap(edges);
+	std::vector<float>().swap(points);
+	std::vector<Uint32>().swap(outline);
+	std::vector<Uint32>().swap(caps);
+	numLoops = 0;
+	valid = false;
+} // end clear()
+
+/*
+ * getPlane
+ *
+ * return - const float*, the plane of the last update
+ */
+const float * CrossSection::getPlane(void) const {
+	return plane;
+} // end getPlane()
+
+/*
+ * getPoints
+ *
+ * return - const std::vector<float>&
+ */
+const std::vector<float>& CrossSection::getPoints(void) const {
+	return points;
+} // end getPoints()
+
+/*
+ * getOutline
+ *
+ * return - const std::vector<Uint32>&
+ */
+const std::vector<Uint32>& CrossSection::getOutline(void) const {
+	return outline;
+} // end getOutline()
+
+/*
+ * getCaps
+ *
+ * return - const std::vector<Uint32>&
+ */
+const std::vector<Uint32>& CrossSection::getCaps(void) const {
+	return caps;
+} // end getCaps()
+
+/*
+ * getNumLoops - Closed loops of the outline.
+ *
+ * return - Uint32
+ */
+Uint32 CrossSection::getNumLoops(void) const {
+	return numLoops;
+} // end getNumLoops()
+
+/*
+ * build - Cuts the triangles near the plane, welds the cut points and
+ * connects them into the outline, then caps its closed loops.
+ *
+ * parameter bvh - const TriangleBvh&
+ */
+void CrossSection::build(const TriangleBvh& bvh) {
+	edges.clear();
+	points.clear();
+	outline.clear();
+	caps.clear();
+	numLoops = 0;
+	valid = true;
+	radius = 0.0f;
+	if (bvh.getNumNodes() == 0) {
+		clearance = 0.0f;
+		return;
+	}
+	const BvhNode& root = bvh.getNode(0);
+	for (int i = 0; i < 3; ++i) {
+		const float extent = std::max(std::fabs(root.boundsMin[i]), std::fabs(
+				root.boundsMax[i]));
+		radius += extent * extent;
+	}
+	radius = std::sqrt(radius);
+	const float halfWidth = SLAB_FRACTION * radius;
+	clearance = halfWidth;
+
+	/* Distances this close to zero may have either sign: */
+	const float rounding = ROUNDING_FRACTION * radius;
+
+	std::vector<Uint32> slots;
+	bvh.querySlab(plane, halfWidth, slots);
+	std::vector<CutPoint> cuts;
+	for (size_t s = 0; s < slots.size(); ++s) {
+		const float * v = bvh.getTriangle(slots[s]);
+		float distances[3];
+		int numBelow = 0;
+		for (int k = 0; k < 3; ++k) {
+			distances[k] = planeDistance(plane, v + 3 * k);
+			clearance = std::min(clearance, std::fabs(distances[k]) - rounding);
+			numBelow += distances[k] < 0.0f;
+		}
+		if (numBelow == 0 || numBelow == 3)
+			continue;
+		/* The two edges whose ends lie on different sides: */
+		for (int k = 0; k < 3; ++k) {
+			const int l = (k + 1) % 3;
+			if ((distances[k] < 0.0f) == (distances[l] < 0.0f))
+				continue;
+			const bool ordered = isBefore(v + 3 * k, v + 3 * l);
+			const float * from = v + 3 * (ordered ? k : l);
+			const float * to = v + 3 * (ordered ? l : k);
+			const float fromDistance = distances[ordered ? k : l];
+			const float toDistance = distances[ordered ? l : k];
+			if (fromDistance == 0.0f)
+				to = from;
+			else if (toDistance == 0.0f)
+				from = to;
+			CutPoint cut;
+			cutEdge(from, to, fromDistance, toDistance, cut.position);
+			std::copy(from, from + 3, cut.edge);
+			std::copy(to, to + 3, cut.edge + 3);
+			cut.segmentEnd = static_cast<Uint32> (cuts.size());
+			cuts.push_back(cut);
+		}
+	}
+
+	/* Weld the ends on each edge into points: */
+	std::vector<Uint32> pointOfEnd(cuts.size());
+	std::sort(cuts.begin(), cuts.end());
+	for (size_t c = 0; c < cuts.size(); ++c) {
+		if (c == 0 || cuts[c - 1] < cuts[c]) {
+			points.insert(points.end(), cuts[c].position, cuts[c].position + 3);
+			edges.insert(edges.end(), cuts[c].edge, cuts[c].edge + 6);
+		}
+		pointOfEnd[cuts[c].segmentEnd] = static_cast<Uint32> (points.size() / 3
+				- 1);
+	}
+
+	/* Segments, without the repeats of double-sided walls: */
+	std::vector<std::pair<Uint32, Uint32> > segments;
+	for (size_t e = 0; e + 1 < pointOfEnd.size(); e += 2) {
+		const Uint32 a = pointOfEnd[e];
+		const Uint32 b = pointOfEnd[e + 1];
+		if (a != b)
+			segments.push_back(std::make_pair(std::min(a, b), std::max(a, b)));
+	}
+	std::sort(segments.begin(), segments.end());
+	segments.erase(std::unique(segments.begin(), segments.end()),
+			segments.end());
+	outline.reserve(2 * segments.size());
+	for (size_t s = 0; s < segments.size(); ++s) {
+		outline.push_back(segments[s].first);
+		outline.push_back(segments[s].second);
+	}
+
+	std::vector<std::vector<Uint32> > loops;
+	findLoops(loops);
+	numLoops = static_cast<Uint32> (loops.size());
+	triangulate(loops);
+} // end build()
+
+/*
+ * placePoints - Moves every point to where the plane cuts its edge.
+ */
+void CrossSection::placePoints(void) {
+	for (size_t p = 0; p < points.size() / 3; ++p) {
+		const float * from = &edges[6 * p];
+		const float * to = from + 3;
+		cutEdge(from, to, planeDistance(plane, from), planeDistance(plane, to),
+				&points[3 * p]);
+	}
+} // end placePoints()
+
+/*
+ * findLoops - Walks the outline into closed loops of at least three
+ * points. At points where more than two segments meet, any unused one is
+ * followed; chains that end are outline only.
+ *
+ * parameter loops - std::vector<std::vector<Uint32> >&, point indices
+ */
+void CrossSection::findLoops(std::vector<std::vector<Uint32> >& loops) const {
+	const Uint32 numPoints = static_cast<Uint32> (points.size() / 3);
+	const Uint32 numSegments = static_cast<Uint32> (outline.size() / 2);
+	std::vector<Uint32> firstLink(numPoints + 1, 0);
+	for (size_t e = 0; e < outline.size(); ++e)
+		++firstLink[outline[e] + 1];
+	for (Uint32 p = 0; p < numPoints; ++p)
+		firstLink[p + 1] += firstLink[p];
+	std::vector<Uint32> links(outline.size());
+	std::vector<Uint32> fill(firstLink.begin(), firstLink.end() - 1);
+	for (size_t e = 0; e < outline.size(); ++e)
+		links[fill[outline[e]]++] = static_cast<Uint32> (e / 2);
+
+	std::vector<bool> used(numSegments, false);
+	for (Uint32 s = 0; s < numSegments; ++s) {
+		if (used[s])
+			continue;
+		used[s] = true;
+		const Uint32 start = outline[2 * s];
+		Uint32 current = outline[2 * s + 1];
+		std::vector<Uint32> loop(1, start);
+		while (current != start) {
+			Uint32 link = firstLink[current];
+			while (link < firstLink[current + 1] && used[links[link]])
+				++link;
+			if (link == firstLink[current + 1])
+				break;
+			const Uint32 segment = links[link];
+			used[segment] = true;
+			loop.push_back(current);
+			current = outline[2 * segment] == current ? outline[2 * segment
+					+ 1] : outline[2 * segment];
+		}
+		if (current == start && loop.size() >= 3)
+			loops.push_back(loop);
+	}
+} // end findLoops()
+
+/*
+ * triangulate - Caps the loops. A loop inside an odd number of others is a
+ * hole of the smallest loop around it.
+ *
+ * parameter loops - const std::vector<std::vector<Uint32> >&
+ */
+void CrossSection::triangulate(const std::vector<std::vector<Uint32> >& loops) {
+	/* Basis of the plane: */
+	const int axis = std::fabs(plane[0]) < std::fabs(plane[1]) ? (std::fabs(
+			plane[0]) < std::fabs(plane[2]) ? 0 : 2) : (std::fabs(plane[1])
+			< std::fabs(plane[2]) ? 1 : 2);
+	double u[3] = { 0.0, 0.0, 0.0 };
+	u[axis] = 1.0;
+	const double dot = u[0] * plane[0] + u[1] * plane[1] + u[2] * plane[2];
+	double length = 0.0;
+	for (int i = 0; i < 3; ++i) {
+		u[i] -= dot * plane[i];
+		length += u[i] * u[i];
+	}
+	length = std::sqrt(length);
+	double v[3];
+	for (int i = 0; i < 3; ++i)
+		u[i] /= length;
+	for (int i = 0; i < 3; ++i)
+		v[i] = plane[(i + 1) % 3] * u[(i + 2) % 3] - plane[(i + 2) % 3] * u[(i
+				+ 1) % 3];
+
+	const size_t numPolygons = loops.size();
+	std::vector<Polygon> polygons(numPolygons);
+	std::vector<double> areas(numPolygons);
+	std::vector<double> boxes(4 * numPolygons);
+	for (size_t l = 0; l < numPolygons; ++l) {
+		Polygon& polygon = polygons[l];
+		polygon.resize(loops[l].size());
+		double * box = &boxes[4 * l];
+		box[0] = box[1] = DBL_MAX;
+		box[2] = box[3] = -DBL_MAX;
+		for (size_t i = 0; i < loops[l].size(); ++i) {
+			const float * point = &points[3 * loops[l][i]];
+			PolygonVertex& vertex = polygon[i];
+			vertex.x = u[0] * point[0] + u[1] * point[1] + u[2] * point[2];
+			vertex.y = v[0] * point[0] + v[1] * point[1] + v[2] * point[2];
+			vertex.point = loops[l][i];
+			box[0] = std::min(box[0], vertex.x);
+			box[1] = std::min(box[1], vertex.y);
+			box[2] = std::max(box[2], vertex.x);
+			box[3] = std::max(box[3], vertex.y);
+		}
+		areas[l] = signedArea(polygon);
+	}
+
+	/* Nesting depth and parent of each loop: */
+	std::vector<Uint32> depths(numPolygons, 0);
+	std::vector<size_t> parents(numPolygons, numPolygons);
+	for (size_t l = 0; l < numPolygons; ++l) {
+		const PolygonVertex& probe = polygons[l][0];
+		for (size_t o = 0; o < numPolygons; ++o) {
+			const double * box = &boxes[4 * o];
+			if (o == l || std::fabs(areas[o]) <= std::fabs(areas[l]) || probe.x
+					< box[0] || probe.x > box[2] || probe.y < box[1] || probe.y
+					> box[3] || !containsPoint(polygons[o], probe.x, probe.y))
+				continue;
+			++depths[l];
+			if (parents[l] == numPolygons || std::fabs(areas[o]) < std::fabs(
+					areas[parents[l]]))
+				parents[l] = o;
+		}
+	}
+
+	/* Outer loops counterclockwise, holes clockwise: */
+	for (size_t l = 0; l < numPolygons; ++l)
+		if ((areas[l] > 0.0) != (depths[l] % 2 == 0))
+			std::reverse(polygons[l].begin(), polygons[l].end());
+	std::vector<std::vector<size_t> > holes(numPolygons);
+	for (size_t l = 0; l < numPolygons; ++l)
+		if (depths[l] % 2 == 1)
+			holes[parents[l]].push_back(l);
+
+	for (size_t l = 0; l < numPolygons; ++l) {
+		if (depths[l] % 2 == 1 || areas[l] == 0.0)
+			continue;
+		/* Rightmost holes first, so later bridges may pass through them: */
+		std::vector<std::pair<double, size_t> > order;
+		for (size_t h = 0; h < holes[l].size(); ++h)
+			order.push_back(std::make_pair(-boxes[4 * holes[l][h] + 2],
+					holes[l][h]));
+		std::sort(order.begin(), order.end());
+		Polygon outer = polygons[l];
+		for (size_t h = 0; h < order.size(); ++h)
+			bridgeHole(outer, polygons[order[h].second]);
+		clipEars(outer, caps);
+	}
+} // end triangulate()
@@ -0,0 +1,62 @@
+/*
+ * CrossSection.h - Cut surface of the park along a clipping plane.
+ *
+ * Created: October 17, 2026
+ */
+
+#ifndef CROSSSECTION_H_
+#define CROSSSECTION_H_
+
+#include <vector>
+
+#include <UTIL/Types.h>
+
+/* Begin Forward declarations: */
+class TriangleBvh;
+/* End Forward declarations: */
+
+/*
+ * CrossSection - Where a plane cuts the park's triangles: the outline, one
+ * segment per cut triangle, and caps triangulating the closed outline loops,
+ * with loops inside an odd number of others left open as holes. The cut
+ * triangles are found through the TriangleBvh, so only those near the plane
+ * are touched. Every outline point lies on a mesh edge; as long as the plane
+ * moves too little for any vertex to change sides, update() only slides the
+ * points along their edges and keeps the loops and caps.
+ */
+class CrossSection {
+public:
+	CrossSection(void);
+	~CrossSection(void);
+	bool update(const TriangleBvh& bvh, const float plane[4]);
+	void clear(void);
+	const float * getPlane(void) const;
+	/* Three floats per point, in mesh coordinates */
+	const std::vector<float>& getPoints(void) const;
+	/* Point pairs */
+	const std::vector<Uint32>& getOutline(void) const;
+	/* Point triples */
+	const std::vector<Uint32>& getCaps(void) const;
+	Uint32 getNumLoops(void) const;
+
+private:
+	void build(const TriangleBvh& bvh);
+	void placePoints(void);
+	void findLoops(std::vector<std::vector<Uint32> >& loops) const;
+	void triangulate(const std::vector<std::vector<Uint32> >& loops);
+
+	float plane[4];
+	/* Largest distance of a park vertex from the origin */
+	float radius;
+	/* No vertex of a cut triangle lies closer to the plane than this */
+	float clearance;
+	/* Ends of the mesh edge each point lies on, six floats per point */
+	std::vector<float> edges;
+	std::vector<float> points;
+	std::vector<Uint32> outline;
+	std::vector<Uint32> caps;
+	Uint32 numLoops;
+	bool valid;
+};
+
+#endif /* CROSSSECTION_H_ */
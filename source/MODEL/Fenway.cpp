@@ -8,10 +8,24 @@
  */
 
 /* System headers */
+#include <algorithm>
+#include <cmath>
 #include <iostream>
+#include <set>
 
 /* Application headers */
+#include <MODEL/AssetWatcher.h>
+#include <MODEL/ClusterLod.h>
+#include <MODEL/ParkLoader.h>
+#include <MODEL/ParkMesh.h>
+#include <MODEL/SceneBuilder.h>
+#include <MODEL/TextureResidency.h>
+#include <MODEL/TileStreamer.h>
+#include <MODEL/ViewClusters.h>
 #include <SYNC/Guard.h>
+#include <SYNC/ThreadPool.h>
+#include <UTIL/MappedFile.h>
+#include <UTIL/ResourceException.h>
 
 /* Delta3D headers */
 #include <dtCore/camera.h>
@@ -21,6 +35,9 @@
 #include <dtCore/system.h>
 #include <dtCore/environment.h>
 
+/* osg headers */
+#include <osg/MatrixTransform>
+
 /* ODE headers */
 #include <ode/ode.h>
 
@@ -33,11 +50,42 @@ static bool dophysics = false;
 static double lastTime = 0.0f;
 static double *simulationTime;
 
+static const std::string MODEL_DIRECTORY("models");
+static const std::string PARK_MODEL("fenwaypark.obj");
+/* Draw the park from 16-bit positions and texture coordinates */
+static const bool COMPACT_VERTICES = true;
+/* Tiles of the surrounding neighborhood built by tools/TileBuilder, and the
+ * memory and distance from the viewer they are streamed within */
+static const std::string NEIGHBORHOOD_TILES("neighborhood.tiles");
+static const Uint64 TILE_MEMORY_BUDGET = Uint64(512) << 20;
+static const float TILE_LOAD_DISTANCE = 1000.0f;
+/* Texture archive built by tools/TexturePacker, and the texture memory each
+ * context keeps uploaded beyond what its current view draws */
+static const std::string TEXTURE_PACK("fenwaypark.texpack");
+static const Uint64 TEXTURE_CONTEXT_BUDGET = Uint64(128) << 20;
+/* Largest difference, relative to the largest element, of the clip matrices
+ * of one view */
+static const double SAME_VIEW_TOLERANCE = 1.0e-5;
+
 using namespace std;
 using namespace dtCore;
 using namespace dtABC;
 using namespace dtUtil;
 
+/*
+ * isSameView - Whether two clip matrices are those of one view, up to
+ * rounding.
+ */
+static bool isSameView(const osg::Matrixd& a, const osg::Matrixd& b) {
+	double largest = 0.0;
+	double difference = 0.0;
+	for (int i = 0; i < 16; ++i) {
+		largest = std::max(largest, std::fabs(a.ptr()[i]));
+		difference = std::max(difference, std::fabs(a.ptr()[i] - b.ptr()[i]));
+	}
+	return difference <= SAME_VIEW_TOLERANCE * largest;
+} // end isSameView()
+
 /*****************************************
  Methods of class Fenway::DataItem:
  *****************************************/
@@ -48,7 +96,8 @@ using namespace dtUtil;
 /*
  * DataItem constructor
  */
-Fenway::DataItem::DataItem(void) {
+Fenway::DataItem::DataItem(void) :
+	pairFrame(-1) {
 } // end DataItem()
 
 /*
@@ -64,26 +113,68 @@ Fenway::DataItem::~DataItem(void) {
  * Fenway constructor
  */
 Fenway::Fenway(void) :
-		Application(true), drawMode(true), frameNumber(0) {
+		Application(true), drawMode(true), frameNumber(0), parkComplete(false),
+				reloadPending(false), tileStreamer(0), textureResidency(0),
+				viewScale(0.0f),
+				lodScale(0.0f) {
 
 	fenway = this;
 
-	// Tell osg::Referenced to use thread-safe reference counting. We do
-	// this here for all applications and all configurations though it is
-	// only strictly necessary when Vrui is configured to use
-	// multi-threaded rendering.
-	osg::Referenced::setThreadSafeReferenceCounting(false);
+	// Tell osg::Referenced to use thread-safe reference counting. The park
+	// is built on the loader thread and handed to the frame thread, and
+	// Vrui may be configured to use multi-threaded rendering.
+	osg::Referenced::setThreadSafeReferenceCounting(true);
 
 	/* Initialize update visitor */
 	updateVisitor = new osgUtil::UpdateVisitor();
 	frameStamp = new ::osg::FrameStamp();
 	updateVisitor->setFrameStamp(frameStamp.get());
+
+	viewClusters = new ViewClusters();
+
+	/* Workers for loading, one per processor */
+	workerPool = new ThreadPool();
+	parkLoader = new ParkLoader(MODEL_DIRECTORY, PARK_MODEL, *workerPool,
+			COMPACT_VERTICES, true);
+	/* Edited assets are read on their own thread too: */
+	assetWatcher = new AssetWatcher(MODEL_DIRECTORY, PARK_MODEL);
+	/* Each view waits only for its own culling tasks, but queued behind the
+	 * loader's they would wait for those too: */
+	cullPool = new ThreadPool();
+	/* Textures are decoded the first time a view sees them: */
+	textureResidency = new TextureResidency(MODEL_DIRECTORY, TEXTURE_PACK,
+			TEXTURE_CONTEXT_BUDGET);
+
+	/* The neighborhood is too large to load whole; its tiles stream in on
+	 * their own threads as the viewer moves: */
+	tileGroup = new osg::Group();
+	tileGroup->setName("Neighborhood");
+	const std::string tilePath = MODEL_DIRECTORY + "/" + NEIGHBORHOOD_TILES;
+	if (MappedFile::exists(tilePath)) {
+		try {
+			tileStreamer = new TileStreamer(MODEL_DIRECTORY, NEIGHBORHOOD_TILES,
+					TILE_MEMORY_BUDGET, TILE_LOAD_DISTANCE);
+			std::cout << "Neighborhood: streaming " << tileStreamer->getNumTiles()
+					<< " tiles" << std::endl;
+		} catch (ResourceException& err) {
+			std::cerr << "Ignoring neighborhood tiles: " << err.getDescription()
+					<< std::endl;
+		}
+	}
 } // end Fenway()
 
 /*
  * ~Fenway - destructor
  */
 Fenway::~Fenway(void) {
+	/* Every owner of a thread is joined before the pools it may run on go,
+	 * the loader in particular, as it parses on the workers: */
+	delete tileStreamer;
+	delete textureResidency;
+	delete assetWatcher;
+	delete parkLoader;
+	delete workerPool;
+	delete cullPool;
 } // end ~Fenway()
 
 /*******************************
@@ -102,56 +193,108 @@ void Fenway::addObjects(void) {
 	GetScene()->AddDrawable(park.get());
 } // end addObjects()
 
-/*
- * createPark
- */
-void Fenway::createPark(void) {
-	park = new Object("Park");
-	park->LoadFile("models/fenwaypark.obj");
-} // end createPark
-
 /*
  * config
  */
 void Fenway::config(void) {
-	/* Load the model files */
-	createPark();
-
+	/* The park streams in on the loader thread; frame() swaps its stages in: */
+	park = new Object("Park");
+	park->GetMatrixNode()->addChild(tileGroup.get());
 	addObjects();
+	parkLoader->start();
+	assetWatcher->start();
+	if (tileStreamer != 0)
+		tileStreamer->start();
 } // end config()
 
 /*
- * display
+ * display - Draws the park into the current view. The view's viewport and
+ * matrices are handed in rather than read back from GL, and the GL state
+ * Vrui set is restored afterwards, as far as the viewer changed it. Windows
+ * on different threads call it at once, each with its own context; the
+ * scene is only culled and drawn here, never updated.
  *
  * parameter glContextData - GLContextData &
+ * parameter viewport - const GLint[4]
+ * parameter modelview - const osg::Matrixd&, navigation to eye coordinates
+ * parameter projection - const osg::Matrixd&
+ * parameter otherEye - const osg::Matrixd *, navigation to clip coordinates
+ * of the other eye of the view's stereo pair, or 0 for a single view
  */
-void Fenway::display(GLContextData & glContextData) const {
+void Fenway::display(GLContextData & glContextData, const GLint viewport[4],
+		const osg::Matrixd& modelview, const osg::Matrixd& projection,
+		const osg::Matrixd * otherEye) const {
 
 	/* Get context data item: */
 	DataItem* dataItem = glContextData.retrieveDataItem<DataItem> (this);
 
-	dataItem->viewer->advance(lastFrameTime);
-	if (!dataItem->viewer->done()) {
-		dataItem->viewer->updateTraversal();
-	}
+	/* frame() updated the scene; every view of the frame shares its stamp: */
+	*dataItem->viewer->getFrameStamp() = *frameStamp;
 
-	GLint vp[4];
-	glGetIntegerv(GL_VIEWPORT, vp);
-	GLdouble mv[16], p[16];
-	glGetDoublev(GL_MODELVIEW_MATRIX, mv);
-	glGetDoublev(GL_PROJECTION_MATRIX, p);
+	/* Pixels a unit spans at unit distance, for level of detail selection: */
+	{
+		Guard<MutexPosix> viewScaleGuard(viewScaleLock);
+		viewScale = std::max(viewScale, float(viewport[3] * projection(1, 1)
+				* 0.5));
+	}
 
-	dataItem->viewer->getCamera()->setViewport(vp[0], vp[1], vp[2], vp[3]);
-	dataItem->viewer->getCamera()->setProjectionMatrix(osg::Matrix(p));
-	dataItem->viewer->getCamera()->setViewMatrix(osg::Matrix(mv));
+	/* Cull the park clusters against this view, the clipping planes and
+	 * the view's occluders; the cluster draws of this context skip the
+	 * others. The first eye of a stereo pair culls for both, and the second
+	 * draws its list: */
+	osg::State * state =
+			dataItem->viewer->getCamera()->getGraphicsContext()->getState();
+	if (clusterCuller.getNumClusters() != 0) {
+		const osg::Matrixd& parkMatrix = park->GetMatrixNode()->getMatrix();
+		std::vector<osg::Matrixd> clipMatrices(1, parkMatrix * modelview
+				* projection);
+		CullStatistics statistics;
+		if (dataItem->pairFrame == frameNumber && isSameView(clipMatrices[0],
+				dataItem->pairClip)) {
+			statistics.numVisible = static_cast<Uint32> (
+					dataItem->visibleClusters.size());
+			statistics.numCulled = clusterCuller.getNumClusters()
+					- statistics.numVisible;
+			dataItem->pairFrame = -1;
+		} else {
+			if (otherEye != 0)
+				clipMatrices.push_back(parkMatrix * *otherEye);
+			cullViews(dataItem, clipMatrices, statistics);
+			dataItem->pairFrame = otherEye != 0 ? frameNumber : -1;
+			if (otherEye != 0)
+				dataItem->pairClip = clipMatrices[1];
+			viewClusters->setVisible(state->getContextID(),
+					dataItem->visibleClusters, clusterCuller.getNumClusters());
+			textureResidency->use(state->getContextID(), frameNumber,
+					dataItem->visibleClusters, parkMesh);
+		}
+		Guard<MutexPosix> cullStatisticsGuard(cullStatisticsLock);
+		viewStatistics.push_back(statistics);
+	} else
+		textureResidency->useAll(state->getContextID(), frameNumber);
+	/* Make room for the textures this view uploads: */
+	textureResidency->evict(*state);
+
+	dataItem->viewer->getCamera()->setViewport(viewport[0], viewport[1],
+			viewport[2], viewport[3]);
+	dataItem->viewer->getCamera()->setProjectionMatrix(projection);
+	dataItem->viewer->getCamera()->setViewMatrix(modelview);
 
 	/* Render all opaque surfaces: */
+	if (!dataItem->stateShadow.isCaptured())
+		dataItem->stateShadow.capture(*state);
+	dataItem->stateShadow.save(*state);
 	dataItem->viewer->renderingTraversals();
 
+	/* Close the cut surfaces: */
+	drawSections(modelview, projection);
+	dataItem->stateShadow.restore(*state, viewport, modelview, projection);
+
 } // end display()
 
 /*
- * frame
+ * frame - Brings in the park changes of the frame and runs the scene's
+ * update traversal, once for all views.
  */
 void Fenway::frame(void) {
 	/* Get the current application time: */
@@ -164,13 +307,303 @@ void Fenway::frame(void) {
 	frameStamp->setReferenceTime(newFrameTime);
 	frameStamp->setSimulationTime(newFrameTime);
 
-	// Set up the time and frame number so time-dependent things (animations,
-	// particle system) function correctly.
+	/* Vrui does not render while frame() runs, so this is the one place the
+	 * displayed park may change: */
+	ParkStage stage;
+	if (parkLoader->takeStage(stage))
+		installPark(stage);
+	AssetChanges changes;
+	if (assetWatcher->takeChanges(changes))
+		applyAssetChanges(changes);
+	if (reloadPending && parkLoader->isFinished())
+		reloadPark();
+	textureResidency->update();
+	streamTiles();
+	selectLevels();
+	classifyClusters();
+	cacheVisibility();
+	cutSections();
+
+	/* Animations and update callbacks see the finished scene, once per
+	 * frame however many eyes and windows draw it: */
+	updateVisitor->reset();
 	updateVisitor->setTraversalNumber(frameNumber);
+	GetRootNode()->accept(*updateVisitor);
 
-	lastFrameTime = newFrameTime;
+	Guard<MutexPosix> cullStatisticsGuard(cullStatisticsLock);
+	frameStatistics.swap(viewStatistics);
+	viewStatistics.clear();
 } // end frame()
 
+/*
+ * applyAssetChanges - Patches edited materials and textures into the
+ * displayed park, or has the park loaded again where a patch could not
+ * match what loading builds: after OBJ edits, while the proxy is shown, and
+ * for the cases patchMaterial() and SceneBuilder::updateTile() refuse.
+ *
+ * parameter changes - AssetChanges&
+ */
+void Fenway::applyAssetChanges(AssetChanges& changes) {
+	if (changes.reload || !parkComplete) {
+		reloadPending = true;
+		return;
+	}
+	bool transparencyChanged = false;
+	for (size_t m = 0; m < changes.materials.size(); ++m) {
+		if (!patchMaterial(changes.materials[m], changes, transparencyChanged)) {
+			reloadPending = true;
+			return;
+		}
+	}
+	for (SceneBuilder::ImageMap::const_iterator it = changes.images.begin(); it
+			!= changes.images.end(); ++it) {
+		TextureAtlas::TileMap::const_iterator tileIt = atlasTiles.find(
+				it->first);
+		if (tileIt != atlasTiles.end() && !SceneBuilder::updateTile(
+				parkGeode.get(), parkMesh, tileIt->second, *it->second.image)) {
+			reloadPending = true;
+			return;
+		}
+		SceneBuilder::updateImage(parkGeode.get(), parkMesh, it->first,
+				it->second.image.get());
+	}
+	/* Patches may have made textures or given them images: */
+	textureResidency->manage(parkGeode.get(), parkMesh);
+	/* Only opaque materials occlude: */
+	if (transparencyChanged)
+		occlusionCuller.build(parkMesh);
+	std::cout << "Park: patched " << changes.materials.size()
+			<< " materials and " << changes.images.size() << " images"
+			<< std::endl;
+} // end applyAssetChanges()
+
+/*
+ * cacheVisibility - Culls the views expected in this frame, in one walk for
+ * all of them, so the views drawn as expected only look their clusters up.
+ */
+void Fenway::cacheVisibility(void) {
+	const osg::Matrix& parkMatrix = park->GetMatrixNode()->getMatrix();
+	std::vector<float> clipMatrices(16 * expectedViews.size());
+	for (size_t v = 0; v < expectedViews.size(); ++v) {
+		const osg::Matrixd clip = parkMatrix * expectedViews[v];
+		for (int i = 0; i < 16; ++i)
+			clipMatrices[16 * v + i] = float(clip.ptr()[i]);
+	}
+	visibilityCache.update(clusterCuller, clipMatrices);
+} // end cacheVisibility()
+
+/*
+ * classifyClusters - Moves the clipping planes into mesh coordinates and
+ * sorts the park clusters into those entirely cut away, which are never
+ * submitted, those a plane cuts through, which are drawn with the planes
+ * enabled, and the rest, which are drawn with them disabled.
+ */
+void Fenway::classifyClusters(void) {
+	meshClippingPlanes.clear();
+	const osg::Matrix& parkMatrix = park->GetMatrixNode()->getMatrix();
+	for (size_t p = 0; p < clippingPlanes.size(); ++p) {
+		osg::Plane plane = clippingPlanes[p];
+		plane.transformProvidingInverse(parkMatrix);
+		for (int i = 0; i < 4; ++i)
+			meshClippingPlanes.push_back(float(plane[i]));
+	}
+
+	const Uint32 numClusters = static_cast<Uint32> (parkMesh.clusters.size());
+	clippedClusters.assign(numClusters, false);
+	std::vector<bool> straddling(numClusters, false);
+	for (Uint32 c = 0; c < numClusters; ++c) {
+		const ParkCluster& cluster = parkMesh.clusters[c];
+		for (size_t p = 0; p < meshClippingPlanes.size()
+				&& !clippedClusters[c]; p += 4) {
+			const float * plane = &meshClippingPlanes[p];
+			float far = plane[3];
+			float near = plane[3];
+			for (int i = 0; i < 3; ++i) {
+				const bool positive = plane[i] >= 0.0f;
+				far += plane[i] * (positive ? cluster.boundsMax[i]
+						: cluster.boundsMin[i]);
+				near += plane[i] * (positive ? cluster.boundsMin[i]
+						: cluster.boundsMax[i]);
+			}
+			if (far < 0.0f)
+				clippedClusters[c] = true;
+			else if (near < 0.0f)
+				straddling[c] = true;
+		}
+	}
+	viewClusters->setClipping(static_cast<Uint32> (clippingPlanes.size()),
+			straddling);
+} // end classifyClusters()
+
+/*
+ * cullViews - Lists the park clusters any of a context's views sees: the
+ * frame's cached culling if the views were expected, else one walk of the
+ * culling hierarchy against all their frustums; then the clipping
+ * planes, and the occluders of each view, a cluster being hidden only if
+ * every view's occluders hide it.
+ *
+ * parameter dataItem - DataItem *, of the context
+ * parameter clipMatrices - const std::vector<osg::Matrixd>&, mesh to clip
+ * coordinates of each view
+ * parameter statistics - CullStatistics&
+ */
+void Fenway::cullViews(DataItem * dataItem,
+		const std::vector<osg::Matrixd>& clipMatrices,
+		CullStatistics& statistics) const {
+	const Uint32 numViews = static_cast<Uint32> (clipMatrices.size());
+	std::vector<float> clip(16 * numViews);
+	for (Uint32 v = 0; v < numViews; ++v)
+		for (int i = 0; i < 16; ++i)
+			clip[16 * v + i] = float(clipMatrices[v].ptr()[i]);
+	std::vector<Uint32>& visible = dataItem->visibleClusters;
+	if (!visibilityCache.lookup(&clip[0], numViews, visible, statistics)) {
+		std::vector<Uint32> views;
+		clusterCuller.cull(&clip[0], numViews, visible, views, statistics);
+	}
+	if (!meshClippingPlanes.empty()) {
+		std::vector<Uint32>::iterator out = visible.begin();
+		for (std::vector<Uint32>::const_iterator vIt = visible.begin(); vIt
+				!= visible.end(); ++vIt)
+			if (!clippedClusters[*vIt])
+				*out++ = *vIt;
+		statistics.numClipped = static_cast<Uint32> (visible.end() - out);
+		visible.erase(out, visible.end());
+		statistics.numVisible = static_cast<Uint32> (visible.size());
+	}
+	/* Nothing hides anything in wireframe: */
+	if (!drawMode)
+		return;
+
+	/* Each further view tests only what the views before hid: */
+	std::vector<Uint32> hidden = visible;
+	visible.clear();
+	double occlusionTime = 0.0;
+	for (Uint32 v = 0; v < numViews && !hidden.empty(); ++v) {
+		std::vector<Uint32> seen = hidden;
+		occlusionCuller.cull(&clip[16 * v], groupVisibility,
+				meshClippingPlanes, seen, dataItem->occlusionBuffer,
+				*cullPool, statistics);
+		occlusionTime += statistics.occlusionTime;
+		/* seen keeps the order of hidden: */
+		std::vector<Uint32>::iterator out = hidden.begin();
+		std::vector<Uint32>::const_iterator sIt = seen.begin();
+		for (std::vector<Uint32>::const_iterator hIt = hidden.begin(); hIt
+				!= hidden.end(); ++hIt) {
+			if (sIt != seen.end() && *sIt == *hIt)
+				++sIt;
+			else
+				*out++ = *hIt;
+		}
+		hidden.erase(out, hidden.end());
+		visible.insert(visible.end(), seen.begin(), seen.end());
+	}
+	statistics.numOccluded = static_cast<Uint32> (hidden.size());
+	statistics.numVisible = static_cast<Uint32> (visible.size());
+	statistics.occlusionTime = occlusionTime;
+} // end cullViews()
+
+/*
+ * cutSections - Cuts the park along each clipping plane the plane moved
+ * since the last frame.
+ */
+void Fenway::cutSections(void) {
+	const size_t numPlanes = meshClippingPlanes.size() / 4;
+	sections.resize(numPlanes);
+	for (size_t p = 0; p < numPlanes; ++p) {
+		/* The park transform may scale, but the cut wants unit normals: */
+		const float * meshPlane = &meshClippingPlanes[4 * p];
+		const float length = std::sqrt(meshPlane[0] * meshPlane[0]
+				+ meshPlane[1] * meshPlane[1] + meshPlane[2] * meshPlane[2]);
+		if (length == 0.0f) {
+			sections[p].clear();
+			continue;
+		}
+		float plane[4];
+		for (int i = 0; i < 4; ++i)
+			plane[i] = meshPlane[i] / length;
+		sections[p].update(parkBvh, plane);
+	}
+} // end cutSections()
+
+/*
+ * drawSections - Draws the cut of every clipping plane: caps over its closed
+ * loops, then the outline. The cut of a plane is clipped by the others but
+ * not by its own plane. Leaves the matrices for display() to restore.
+ *
+ * parameter modelview - const osg::Matrixd&, navigation to eye coordinates
+ * parameter projection - const osg::Matrixd&
+ */
+void Fenway::drawSections(const osg::Matrixd& modelview,
+		const osg::Matrixd& projection) const {
+	bool empty = true;
+	for (size_t s = 0; s < sections.size(); ++s)
+		empty = empty && sections[s].getOutline().empty();
+	if (empty)
+		return;
+
+	glPushAttrib(GL_ENABLE_BIT | GL_CURRENT_BIT | GL_LINE_BIT
+			| GL_POLYGON_BIT);
+	glMatrixMode(GL_PROJECTION);
+	glLoadMatrixd(projection.ptr());
+	glMatrixMode(GL_MODELVIEW);
+	glLoadMatrixd(modelview.ptr());
+	glMultMatrixd(park->GetMatrixNode()->getMatrix().ptr());
+	glDisable(GL_LIGHTING);
+	glDisable(GL_TEXTURE_2D);
+	glDisable(GL_CULL_FACE);
+	glEnable(GL_DEPTH_TEST);
+	glLineWidth(2.0f);
+
+	for (size_t s = 0; s < sections.size(); ++s) {
+		const CrossSection& section = sections[s];
+		const std::vector<float>& points = section.getPoints();
+		const std::vector<Uint32>& caps = section.getCaps();
+		const std::vector<Uint32>& outline = section.getOutline();
+		if (outline.empty())
+			continue;
+		glDisable(GL_CLIP_PLANE0 + GLenum(s));
+
+		/* Behind the outline drawn on them: */
+		glEnable(GL_POLYGON_OFFSET_FILL);
+		glPolygonOffset(1.0f, 1.0f);
+		glColor3f(0.75f, 0.7f, 0.6f);
+		glBegin(GL_TRIANGLES);
+		for (size_t c = 0; c < caps.size(); ++c)
+			glVertex3fv(&points[3 * caps[c]]);
+		glEnd();
+		glDisable(GL_POLYGON_OFFSET_FILL);
+
+		glColor3f(0.15f, 0.15f, 0.15f);
+		glBegin(GL_LINES);
+		for (size_t o = 0; o < outline.size(); ++o)
+			glVertex3fv(&points[3 * outline[o]]);
+		glEnd();
+
+		glEnable(GL_CLIP_PLANE0 + GLenum(s));
+	}
+
+	glPopAttrib();
+} // end drawSections()
+
+/*
+ * getCullStatistics - Cluster culling of each view drawn in the last frame.
+ *
+ * parameter statistics - std::vector<CullStatistics>&, in drawing order
+ */
+void Fenway::getCullStatistics(std::vector<CullStatistics>& statistics) const {
+	statistics = frameStatistics;
+} // end getCullStatistics()
+
+/*
+ * getTextureStatistics - Texture residency of the views drawn since the
+ * last call.
+ *
+ * parameter statistics - TextureStatistics&
+ */
+void Fenway::getTextureStatistics(TextureStatistics& statistics) const {
+	textureResidency->getStatistics(statistics);
+} // end getTextureStatistics()
+
 /*
  * initContext
  *
@@ -180,7 +613,9 @@ void Fenway::initContext(GLContextData & glContextData) const {
 	/* Create a new context data item: */
 	DataItem* dataItem = new DataItem();
 
-	// Create the osgViewer instance
+	// Create the osgViewer instance. The embedded context is current only
+	// on the thread Vrui draws the window on, so the viewer culls and draws
+	// there itself; windows on other threads draw with their own viewers.
 	osg::ref_ptr<osgViewer::Viewer> viewer = new osgViewer::Viewer;
 	viewer->setThreadingModel(osgViewer::Viewer::SingleThreaded);
 
@@ -204,7 +639,6 @@ void Fenway::initContext(GLContextData & glContextData) const {
 	root->addChild(fenway->GetRootNode());
 
 	// Add the tree to the viewer and set properties
-	Guard<MutexPosix> viewerGuard(dataItem->viewerLock);
 	viewer->setSceneData(root);
 
 	dataItem->viewer = viewer;
@@ -212,6 +646,235 @@ void Fenway::initContext(GLContextData & glContextData) const {
 	glContextData.addDataItem(this, dataItem);
 } // end initContext()
 
+/*
+ * installPark - Replaces the displayed park with a newer stage from the
+ * loader, keeping hidden groups hidden.
+ *
+ * parameter stage - ParkStage&, emptied
+ */
+void Fenway::installPark(ParkStage& stage) {
+	parkMesh.swap(stage.mesh);
+	sourceMaterials.swap(stage.sourceMaterials);
+	atlasTiles.swap(stage.tiles);
+	parkComplete = stage.complete;
+	if (parkComplete)
+		assetWatcher->setMaterials(parkMesh.materials);
+	parkBvh.swap(stage.bvh);
+	/* Cut the new triangles from scratch: */
+	sections.clear();
+	parkGeode = stage.geode;
+	osg::MatrixTransform * matrixNode = park->GetMatrixNode();
+	matrixNode->removeChildren(0, matrixNode->getNumChildren());
+	matrixNode->addChild(stage.node.get());
+	matrixNode->addChild(tileGroup.get());
+
+	groupVisibility.resize(parkMesh.groups.size(), true);
+	clusterLevels.assign(parkMesh.clusters.size(), 0);
+	/* Split the batches into cullable clusters: */
+	clusterCuller.build(parkMesh);
+	occlusionCuller.build(parkMesh);
+	for (Uint32 b = 0; b < parkMesh.batches.size(); ++b)
+		SceneBuilder::updateBatch(parkGeode.get(), parkMesh, b,
+				groupVisibility, clusterLevels, viewClusters.get());
+	SceneBuilder::updateInstances(parkGeode.get(), parkMesh, groupVisibility);
+	textureResidency->manage(parkGeode.get(), parkMesh);
+
+	std::cout << "Park: " << (stage.complete ? "textured park"
+			: "untextured proxy") << " shown " << stage.loadTime
+			<< " s after loading started" << std::endl;
+} // end installPark()
+
+/*
+ * patchMaterial - Gives the batches drawing a library material its new
+ * properties. Groups moved onto an atlas page are drawn with a page
+ * material shared by all library materials of equal properties; it can only
+ * follow the edit if the edited material is its only source and keeps its
+ * texture.
+ *
+ * parameter changed - const ParkMaterial&, new properties
+ * parameter changes - const AssetChanges&, with the images of new textures
+ * parameter transparencyChanged - bool&, set if the material became
+ * transparent or opaque
+ * return - bool, false if the park has to be loaded again
+ */
+bool Fenway::patchMaterial(const ParkMaterial& changed,
+		const AssetChanges& changes, bool& transparencyChanged) {
+	Uint32 source = 0;
+	while (source < parkMesh.materials.size()
+			&& (parkMesh.materials[source].name != changed.name
+					|| TextureAtlas::isPageName(
+							parkMesh.materials[source].texture)))
+		++source;
+	if (source == parkMesh.materials.size())
+		return true;
+
+	/* The materials the source's groups are drawn with: */
+	std::set<Uint32> drawn;
+	for (size_t g = 0; g < sourceMaterials.size(); ++g)
+		if (sourceMaterials[g] == source)
+			drawn.insert(parkMesh.groups[g].material);
+	for (std::set<Uint32>::const_iterator dIt = drawn.begin(); dIt
+			!= drawn.end(); ++dIt) {
+		if (*dIt == source)
+			continue;
+		if (changed.texture != parkMesh.materials[source].texture)
+			return false;
+		for (size_t g = 0; g < sourceMaterials.size(); ++g)
+			if (parkMesh.groups[g].material == *dIt && sourceMaterials[g]
+					!= source)
+				return false;
+	}
+
+	transparencyChanged = transparencyChanged || changed.isTransparent()
+			!= parkMesh.materials[source].isTransparent();
+	parkMesh.materials[source] = changed;
+	for (std::set<Uint32>::const_iterator dIt = drawn.begin(); dIt
+			!= drawn.end(); ++dIt) {
+		ParkMaterial& material = parkMesh.materials[*dIt];
+		if (*dIt != source) {
+			const std::string name = material.name;
+			const std::string texture = material.texture;
+			material = changed;
+			material.name = name;
+			material.texture = texture;
+		}
+		SceneBuilder::updateMaterial(parkGeode.get(), parkMesh, *dIt,
+				changes.images);
+	}
+	return true;
+} // end patchMaterial()
+
+/*
+ * reloadPark - Loads the park again in the background. The displayed park
+ * stays until the new one replaces it, without the proxy in between.
+ */
+void Fenway::reloadPark(void) {
+	reloadPending = false;
+	delete parkLoader;
+	parkLoader = new ParkLoader(MODEL_DIRECTORY, PARK_MODEL, *workerPool,
+			COMPACT_VERTICES, false);
+	parkLoader->start();
+	std::cout << "Park: loading edited assets again" << std::endl;
+} // end reloadPark()
+
+/*
+ * setClippingPlanes - Tells which clipping planes are enabled, from
+ * GL_CLIP_PLANE0 on, while the park is drawn. Takes effect in the next
+ * frame().
+ *
+ * parameter planes - const std::vector<osg::Plane>&, in navigation
+ * coordinates, keeping the points of positive distance
+ */
+void Fenway::setClippingPlanes(const std::vector<osg::Plane>& planes) {
+	clippingPlanes = planes;
+} // end setClippingPlanes()
+
+/*
+ * setExpectedViews - Tells which views the coming frame is expected to
+ * draw, so they can be culled together. Takes effect in the next frame().
+ *
+ * parameter views - const std::vector<osg::Matrixd>&, navigation to clip
+ * coordinates
+ */
+void Fenway::setExpectedViews(const std::vector<osg::Matrixd>& views) {
+	expectedViews = views;
+} // end setExpectedViews()
+
+/*
+ * setGroupVisible - Shows or hides a single OBJ group of the park. Groups
+ * not loaded yet are ignored.
+ *
+ * parameter group - Uint32
+ * parameter visible - bool
+ */
+void Fenway::setGroupVisible(Uint32 group, bool visible) {
+	if (group >= groupVisibility.size() || groupVisibility[group] == visible)
+		return;
+	groupVisibility[group] = visible;
+	/* Groups folded into instances have no triangles of their own: */
+	if (parkMesh.groups[group].numIndices == 0) {
+		SceneBuilder::updateInstances(parkGeode.get(), parkMesh,
+				groupVisibility);
+		return;
+	}
+	SceneBuilder::updateBatch(parkGeode.get(), parkMesh,
+			parkMesh.groups[group].batch, groupVisibility, clusterLevels,
+			viewClusters.get());
+} // end setGroupVisible()
+
+/*
+ * selectLevels - Picks the level of detail of every park cluster for the
+ * current head position and redraws the batches whose clusters changed.
+ * Uses the view scale of the frames drawn since the last call, or the one
+ * before if nothing was drawn.
+ */
+void Fenway::selectLevels(void) {
+	{
+		Guard<MutexPosix> viewScaleGuard(viewScaleLock);
+		if (viewScale > 0.0f)
+			lodScale = viewScale;
+		viewScale = 0.0f;
+	}
+	if (lodScale == 0.0f || parkMesh.clusters.empty())
+		return;
+
+	const Vrui::Point head =
+			Vrui::getInverseNavigationTransformation().transform(
+					Vrui::getHeadPosition());
+	const float eye[3] = { float(head[0]), float(head[1]), float(head[2]) };
+	std::vector<bool> changed(parkMesh.batches.size(), false);
+	for (Uint32 c = 0; c < parkMesh.clusters.size(); ++c) {
+		const ParkCluster& cluster = parkMesh.clusters[c];
+		const Uint32 level = ClusterLod::selectLevel(cluster, clusterLevels[c],
+				eye, lodScale);
+		if (level != clusterLevels[c]) {
+			clusterLevels[c] = level;
+			changed[cluster.batch] = true;
+		}
+	}
+	for (Uint32 b = 0; b < parkMesh.batches.size(); ++b) {
+		if (changed[b])
+			SceneBuilder::updateBatch(parkGeode.get(), parkMesh, b,
+					groupVisibility, clusterLevels, viewClusters.get());
+	}
+} // end selectLevels()
+
+/*
+ * streamTiles - Tells the tile streamer where the head is in park
+ * coordinates, and shows the tiles it built and hides those it evicted since
+ * the last frame. Never waits for the streamer's workers.
+ */
+void Fenway::streamTiles(void) {
+	if (tileStreamer == 0)
+		return;
+
+	const Vrui::Point head =
+			Vrui::getInverseNavigationTransformation().transform(
+					Vrui::getHeadPosition());
+	const osg::Vec3 parkHead = osg::Vec3(head[0], head[1], head[2])
+			* osg::Matrix::inverse(park->GetMatrixNode()->getMatrix());
+	const float eye[3] = { parkHead.x(), parkHead.y(), parkHead.z() };
+	tileStreamer->setViewpoint(eye);
+
+	std::vector<StreamedTile> loaded;
+	std::vector<Uint32> evicted;
+	tileStreamer->takeChanges(loaded, evicted);
+	for (std::vector<Uint32>::const_iterator eIt = evicted.begin(); eIt
+			!= evicted.end(); ++eIt) {
+		std::map<Uint32, osg::ref_ptr<osg::Node> >::iterator nodeIt =
+				tileNodes.find(*eIt);
+		if (nodeIt == tileNodes.end())
+			continue;
+		tileGroup->removeChild(nodeIt->second.get());
+		tileNodes.erase(nodeIt);
+	}
+	for (std::vector<StreamedTile>::const_iterator lIt = loaded.begin(); lIt
+			!= loaded.end(); ++lIt) {
+		tileGroup->addChild(lIt->node.get());
+		tileNodes[lIt->tile] = lIt->node;
+	}
+} // end streamTiles()
+
 /*
  * toggleLight
  */
@@ -9,6 +9,8 @@
 #ifndef FENWAY_H_
 #define FENWAY_H_
 
+#include <map>
+
 /* Vrui includes */
 #include <GL/GLContextData.h>
 #include <GL/GLObject.h>
@@ -24,11 +26,20 @@
 #include <osg/Group>
 #include <osg/Node>
 #include <osg/Camera>
+#include <osg/Plane>
 
 #include <osgUtil/UpdateVisitor>
 
 #include <osgViewer/Viewer>
 
+#include <MODEL/ClusterCuller.h>
+#include <MODEL/CrossSection.h>
+#include <MODEL/OcclusionCuller.h>
+#include <MODEL/ParkMesh.h>
+#include <MODEL/StateShadow.h>
+#include <MODEL/TextureAtlas.h>
+#include <MODEL/TriangleBvh.h>
+#include <MODEL/VisibilityCache.h>
 #include <SYNC/MutexPosix.h>
 #include <SYNC/NullMutex.h>
 
@@ -43,6 +54,15 @@ class InfiniteLight;
 class Object;
 }
 class dMass;
+struct AssetChanges;
+class AssetWatcher;
+class ParkLoader;
+struct ParkStage;
+class TextureResidency;
+struct TextureStatistics;
+class ThreadPool;
+class TileStreamer;
+class ViewClusters;
 
 class Fenway: public Application , public GLObject {
 public:
@@ -56,7 +76,16 @@ private:
 		int data;
 		osg::Group * root;
 		osg::ref_ptr<osgViewer::Viewer> viewer;
-		MutexPosix viewerLock;
+		/* Clusters the view being drawn sees */
+		std::vector<Uint32> visibleClusters;
+		/* Frame and clip matrix of the second eye of the stereo pair the
+		 * visible clusters were culled for, or -1 after a single view */
+		int pairFrame;
+		osg::Matrixd pairClip;
+		/* Occluders of the view being drawn */
+		OcclusionBuffer occlusionBuffer;
+		/* Vrui's state, restored after the viewer draws */
+		StateShadow stateShadow;
 		/* Constructors and destructors: */
 		DataItem(void);
 		virtual ~DataItem(void);
@@ -64,9 +93,16 @@ private:
 public:
 	void addObjects(void);
 	virtual void config(void);
-	virtual void display(GLContextData& contextData) const;
+	void display(GLContextData& contextData, const GLint viewport[4],
+			const osg::Matrixd& modelview, const osg::Matrixd& projection,
+			const osg::Matrixd * otherEye = 0) const;
 	void frame(void);
+	void getCullStatistics(std::vector<CullStatistics>& statistics) const;
+	void getTextureStatistics(TextureStatistics& statistics) const;
 	virtual void initContext(GLContextData& contextData) const;
+	void setClippingPlanes(const std::vector<osg::Plane>& planes);
+	void setExpectedViews(const std::vector<osg::Matrixd>& views);
+	void setGroupVisible(Uint32 group, bool visible);
 	void toggleLight(void);
 	void togglePark(void);
 	void toggleWireframe(void);
@@ -74,12 +110,79 @@ public:
 	bool drawMode;
 	int frameNumber;
 	osg::ref_ptr<osg::FrameStamp> frameStamp;
-	double lastFrameTime;
 	RefPtr<Object> park;
+	ParkMesh parkMesh;
+	/* Library material of each park group, and the atlas tile of each
+	 * atlased texture, for patching edited assets */
+	std::vector<Uint32> sourceMaterials;
+	TextureAtlas::TileMap atlasTiles;
+	/* False while the untextured proxy is shown */
+	bool parkComplete;
+	osg::ref_ptr<osg::Geode> parkGeode;
+	std::vector<bool> groupVisibility;
+	/* Level of detail drawn for each park cluster */
+	std::vector<Uint32> clusterLevels;
+	ClusterCuller clusterCuller;
+	OcclusionCuller occlusionCuller;
+	osg::ref_ptr<ViewClusters> viewClusters;
 	RefPtr<InfiniteLight> globalInfinite;
 	osg::ref_ptr<osg::NodeVisitor> updateVisitor;
+	ThreadPool * workerPool;
+	/* Workers for culling views, apart from the loader's */
+	ThreadPool * cullPool;
+	ParkLoader * parkLoader;
+	AssetWatcher * assetWatcher;
+	/* Set when edited assets cannot be patched in; the park is loaded again
+	 * once the loader is done */
+	bool reloadPending;
+	/* Streams the neighborhood tiles around the viewer, if there are any */
+	TileStreamer * tileStreamer;
+	/* Parent of the tiles shown, in park coordinates, and each tile's graph */
+	osg::ref_ptr<osg::Group> tileGroup;
+	std::map<Uint32, osg::ref_ptr<osg::Node> > tileNodes;
+	/* Decodes the park textures on first sight and keeps each context's
+	 * uploads in budget */
+	TextureResidency * textureResidency;
 private:
-	void createPark(void);
+	/* Largest pixels per unit at unit distance of the views drawn since the
+	 * last frame, and the value the levels were selected with */
+	mutable MutexPosix viewScaleLock;
+	mutable float viewScale;
+	float lodScale;
+	/* Clipping planes enabled while the park is drawn, in navigation
+	 * coordinates; the same planes in mesh coordinates, four floats each;
+	 * and the clusters entirely on their cut side */
+	std::vector<osg::Plane> clippingPlanes;
+	std::vector<float> meshClippingPlanes;
+	std::vector<bool> clippedClusters;
+	/* The views the coming frame is expected to draw, navigation to clip
+	 * coordinates, and their culling */
+	std::vector<osg::Matrixd> expectedViews;
+	VisibilityCache visibilityCache;
+	/* The park's triangles, and its cut along each clipping plane */
+	TriangleBvh parkBvh;
+	std::vector<CrossSection> sections;
+	/* Culling of the views drawn since the last frame, and of those drawn
+	 * in the frame before */
+	mutable MutexPosix cullStatisticsLock;
+	mutable std::vector<CullStatistics> viewStatistics;
+	std::vector<CullStatistics> frameStatistics;
+
+	void applyAssetChanges(AssetChanges& changes);
+	void cacheVisibility(void);
+	void classifyClusters(void);
+	void cullViews(DataItem * dataItem,
+			const std::vector<osg::Matrixd>& clipMatrices,
+			CullStatistics& statistics) const;
+	void cutSections(void);
+	void drawSections(const osg::Matrixd& modelview,
+			const osg::Matrixd& projection) const;
+	void installPark(ParkStage& stage);
+	bool patchMaterial(const ParkMaterial& changed,
+			const AssetChanges& changes, bool& transparencyChanged);
+	void reloadPark(void);
+	void selectLevels(void);
+	void streamTiles(void);
 };
 
 #endif
@@ -0,0 +1,667 @@
+/*
+ * GroupInstancer.cpp - Methods for folding repeated park groups into
+ * instances of one shared mesh.
+ *
+ * Created: October 17, 2026
+ */
+
+/* System headers */
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+/* Application headers */
+#include <MODEL/GroupInstancer.h>
+#include <MODEL/ParkMesh.h>
+
+const float GroupInstancer::POSITION_TOLERANCE = 1.0e-3f;
+const float GroupInstancer::NORMAL_COSINE = 0.999f;
+const float GroupInstancer::TEX_COORD_TOLERANCE = 1.0e-4f;
+
+/* Share of the largest spread two spreads must differ by for the principal
+ * axes to be told apart */
+static const double AXIS_SEPARATION = 1.0e-2;
+/* Largest spreads of shapes compared are at least this share of each other */
+static const double SPREAD_WINDOW = 0.8;
+/* Sweeps after which the eigen solver gives up refining */
+static const int JACOBI_SWEEPS = 16;
+
+static const Uint32 NONE = 0xffffffffu;
+
+/*
+ * GroupShape - The vertex set of one group, numbered in order of first use,
+ * with its centroid and principal axes.
+ */
+struct GroupShape {
+	Uint32 group;
+	Uint32 material;
+	Uint32 numTriangles;
+	/* Range of shapeVertices, local vertex order */
+	Uint32 firstVertex;
+	Uint32 numVertices;
+	double centroid[3];
+	/* Variance along each principal axis, largest first */
+	double spread[3];
+	/* Unit principal axes, matching spread */
+	double axes[3][3];
+	double radius;
+};
+
+/*
+ * ShapeOrder - Orders shapes so candidates for one class are adjacent:
+ * by material and size, then by their largest spread.
+ */
+struct ShapeOrder {
+	bool operator()(const GroupShape& a, const GroupShape& b) const {
+		if (a.material != b.material)
+			return a.material < b.material;
+		if (a.numTriangles != b.numTriangles)
+			return a.numTriangles < b.numTriangles;
+		if (a.numVertices != b.numVertices)
+			return a.numVertices < b.numVertices;
+		if (a.spread[0] != b.spread[0])
+			return a.spread[0] < b.spread[0];
+		return a.group < b.group;
+	}
+};
+
+/*
+ * InstanceOrder - Orders instances by prototype, then by group.
+ */
+struct InstanceOrder {
+	bool operator()(const ParkInstance& a, const ParkInstance& b) const {
+		if (a.prototype != b.prototype)
+			return a.prototype < b.prototype;
+		return a.group < b.group;
+	}
+};
+
+/*
+ * XOrder - Orders local vertices of a group by their x coordinate.
+ */
+struct XOrder {
+	const ParkMesh * mesh;
+	const Uint32 * vertices;
+
+	bool operator()(Uint32 a, Uint32 b) const {
+		return mesh->vertices[vertices[a]].position[0]
+				< mesh->vertices[vertices[b]].position[0];
+	}
+};
+
+/*
+ * Rigid - Rotation and translation of doubles, row-major.
+ */
+struct Rigid {
+	double rotation[3][3];
+	double translation[3];
+
+	void apply(const float p[3], double result[3]) const {
+		for (int i = 0; i < 3; ++i)
+			result[i] = rotation[i][0] * p[0] + rotation[i][1] * p[1]
+					+ rotation[i][2] * p[2] + translation[i];
+	}
+
+	void rotate(const float n[3], double result[3]) const {
+		for (int i = 0; i < 3; ++i)
+			result[i] = rotation[i][0] * n[0] + rotation[i][1] * n[1]
+					+ rotation[i][2] * n[2];
+	}
+};
+
+/*
+ * cross - Cross product.
+ */
+static void cross(const double a[3], const double b[3], double result[3]) {
+	result[0] = a[1] * b[2] - a[2] * b[1];
+	result[1] = a[2] * b[0] - a[0] * b[2];
+	result[2] = a[0] * b[1] - a[1] * b[0];
+} // end cross()
+
+/*
+ * normalize - Scales a vector to unit length.
+ *
+ * return - bool, false if it has no length
+ */
+static bool normalize(double v[3]) {
+	const double length = std::sqrt(v[0] * v[0] + v[1] * v[1] + v[2] * v[2]);
+	if (length == 0.0)
+		return false;
+	for (int i = 0; i < 3; ++i)
+		v[i] /= length;
+	return true;
+} // end normalize()
+
+/*
+ * solveEigen - Eigenvalues and unit eigenvectors of a symmetric 3x3 matrix
+ * by cyclic Jacobi rotations, largest eigenvalue first.
+ *
+ * parameter matrix - double[3][3], destroyed
+ * parameter values - double[3]
+ * parameter vectors - double[3][3], vectors[k] belongs to values[k]
+ */
+static void solveEigen(double matrix[3][3], double values[3],
+		double vectors[3][3]) {
+	double v[3][3] = { { 1.0, 0.0, 0.0 }, { 0.0, 1.0, 0.0 }, { 0.0, 0.0, 1.0 } };
+	for (int sweep = 0; sweep < JACOBI_SWEEPS; ++sweep) {
+		const double offDiagonal = std::fabs(matrix[0][1]) + std::fabs(
+				matrix[0][2]) + std::fabs(matrix[1][2]);
+		if (offDiagonal == 0.0)
+			break;
+		for (int p = 0; p < 2; ++p) {
+			for (int q = p + 1; q < 3; ++q) {
+				if (matrix[p][q] == 0.0)
+					continue;
+				const double theta = (matrix[q][q] - matrix[p][p]) / (2.0
+						* matrix[p][q]);
+				const double t = (theta >= 0.0 ? 1.0 : -1.0) / (std::fabs(
+						theta) + std::sqrt(theta * theta + 1.0));
+				const double c = 1.0 / std::sqrt(t * t + 1.0);
+				const double s = t * c;
+				for (int k = 0; k < 3; ++k) {
+					const double kp = matrix[k][p];
+					const double kq = matrix[k][q];
+					matrix[k][p] = c * kp - s * kq;
+					matrix[k][q] = s * kp + c * kq;
+				}
+				for (int k = 0; k < 3; ++k) {
+					const double pk = matrix[p][k];
+					const double qk = matrix[q][k];
+					matrix[p][k] = c * pk - s * qk;
+					matrix[q][k] = s * pk + c * qk;
+				}
+				for (int k = 0; k < 3; ++k) {
+					const double kp = v[k][p];
+					const double kq = v[k][q];
+					v[k][p] = c * kp - s * kq;
+					v[k][q] = s * kp + c * kq;
+				}
+			}
+		}
+	}
+
+	int order[3] = { 0, 1, 2 };
+	for (int i = 0; i < 2; ++i)
+		for (int j = i + 1; j < 3; ++j)
+			if (matrix[order[j]][order[j]] > matrix[order[i]][order[i]])
+				std::swap(order[i], order[j]);
+	for (int k = 0; k < 3; ++k) {
+		values[k] = matrix[order[k]][order[k]];
+		for (int i = 0; i < 3; ++i)
+			vectors[k][i] = v[i][order[k]];
+	}
+} // end solveEigen()
+
+/*
+ * GroupMatcher - Finds the rigid transform taking one group onto another of
+ * the same shape, if there is one.
+ */
+class GroupMatcher {
+public:
+	GroupMatcher(const ParkMesh& _mesh,
+			const std::vector<Uint32>& _shapeVertices,
+			const std::vector<Uint32>& _localIndices) :
+		mesh(_mesh), shapeVertices(_shapeVertices), localIndices(
+				_localIndices) {
+	}
+
+	bool match(const GroupShape& prototype, const GroupShape& shape,
+			Rigid& rigid);
+
+private:
+	const ParkMesh& mesh;
+	const std::vector<Uint32>& shapeVertices;
+	/* Indices of each group's triangles in its local vertex order, at the
+	 * group's firstIndex */
+	const std::vector<Uint32>& localIndices;
+	/* Scratch of verify() */
+	std::vector<Uint32> byX;
+	std::vector<Uint32> matched;
+	std::vector<bool> used;
+	std::vector<Uint32> prototypeTriangles;
+	std::vector<Uint32> shapeTriangles;
+
+	const ParkVertex& getVertex(const GroupShape& shape, Uint32 local) const {
+		return mesh.vertices[shapeVertices[shape.firstVertex + local]];
+	}
+	bool getPointFrame(const GroupShape& shape, Uint32 a, Uint32 b,
+			double frame[3][3]) const;
+	bool verify(const GroupShape& prototype, const GroupShape& shape,
+			const Rigid& rigid);
+	bool matchVertex(const GroupShape& shape, const double position[3],
+			const double normal[3], const float texCoord[2], double tolerance,
+			Uint32 local);
+	void getTriangles(const GroupShape& shape, const Uint32 * map,
+			std::vector<Uint32>& triangles) const;
+};
+
+/*
+ * setRigid - The transform taking a prototype frame onto a shape frame, both
+ * rows of unit axes about the centroids.
+ */
+static void setRigid(const GroupShape& prototype, const double from[3][3],
+		const GroupShape& shape, const double to[3][3], Rigid& rigid) {
+	for (int i = 0; i < 3; ++i)
+		for (int j = 0; j < 3; ++j)
+			rigid.rotation[i][j] = to[0][i] * from[0][j] + to[1][i]
+					* from[1][j] + to[2][i] * from[2][j];
+	for (int i = 0; i < 3; ++i)
+		rigid.translation[i] = shape.centroid[i] - (rigid.rotation[i][0]
+				* prototype.centroid[0] + rigid.rotation[i][1]
+				* prototype.centroid[1] + rigid.rotation[i][2]
+				* prototype.centroid[2]);
+} // end setRigid()
+
+/*
+ * match - Tries the frame of the two vertices furthest out, which fits
+ * copies that kept the vertex order, then the principal axes in each of
+ * their four right-handed orientations if the spreads tell them apart.
+ *
+ * parameter prototype - const GroupShape&
+ * parameter shape - const GroupShape&, of the same size
+ * parameter rigid - Rigid&, receives the transform
+ * return - bool
+ */
+bool GroupMatcher::match(const GroupShape& prototype, const GroupShape& shape,
+		Rigid& rigid) {
+	/* The vertex furthest from the centroid, and the one furthest from the
+	 * line through both: */
+	Uint32 a = 0;
+	double best = -1.0;
+	for (Uint32 v = 0; v < prototype.numVertices; ++v) {
+		const float * p = getVertex(prototype, v).position;
+		double distance = 0.0;
+		for (int i = 0; i < 3; ++i)
+			distance += (p[i] - prototype.centroid[i]) * (p[i]
+					- prototype.centroid[i]);
+		if (distance > best) {
+			best = distance;
+			a = v;
+		}
+	}
+	double axis[3];
+	for (int i = 0; i < 3; ++i)
+		axis[i] = getVertex(prototype, a).position[i] - prototype.centroid[i];
+	Uint32 b = a;
+	if (normalize(axis)) {
+		best = 0.0;
+		for (Uint32 v = 0; v < prototype.numVertices; ++v) {
+			const float * p = getVertex(prototype, v).position;
+			double offset[3];
+			for (int i = 0; i < 3; ++i)
+				offset[i] = p[i] - prototype.centroid[i];
+			double normal[3];
+			cross(axis, offset, normal);
+			const double distance = normal[0] * normal[0] + normal[1]
+					* normal[1] + normal[2] * normal[2];
+			if (distance > best) {
+				best = distance;
+				b = v;
+			}
+		}
+	}
+	double from[3][3];
+	double to[3][3];
+	if (getPointFrame(prototype, a, b, from) && getPointFrame(shape, a, b, to)) {
+		setRigid(prototype, from, shape, to, rigid);
+		if (verify(prototype, shape, rigid))
+			return true;
+	}
+
+	const double separation = AXIS_SEPARATION * prototype.spread[0];
+	if (prototype.spread[0] - prototype.spread[1] <= separation
+			|| prototype.spread[1] - prototype.spread[2] <= separation)
+		return false;
+	for (int i = 0; i < 3; ++i) {
+		from[0][i] = prototype.axes[0][i];
+		from[1][i] = prototype.axes[1][i];
+	}
+	cross(from[0], from[1], from[2]);
+	for (int signs = 0; signs < 4; ++signs) {
+		for (int i = 0; i < 3; ++i) {
+			to[0][i] = signs & 1 ? -shape.axes[0][i] : shape.axes[0][i];
+			to[1][i] = signs & 2 ? -shape.axes[1][i] : shape.axes[1][i];
+		}
+		cross(to[0], to[1], to[2]);
+		setRigid(prototype, from, shape, to, rigid);
+		if (verify(prototype, shape, rigid))
+			return true;
+	}
+	return false;
+} // end match()
+
+/*
+ * getPointFrame - Right-handed frame spanned by two vertices about the
+ * centroid.
+ *
+ * return - bool, false if they do not span a plane
+ */
+bool GroupMatcher::getPointFrame(const GroupShape& shape, Uint32 a, Uint32 b,
+		double frame[3][3]) const {
+	double second[3];
+	for (int i = 0; i < 3; ++i) {
+		frame[0][i] = getVertex(shape, a).position[i] - shape.centroid[i];
+		second[i] = getVertex(shape, b).position[i] - shape.centroid[i];
+	}
+	if (!normalize(frame[0]))
+		return false;
+	cross(frame[0], second, frame[2]);
+	if (!normalize(frame[2]))
+		return false;
+	cross(frame[2], frame[0], frame[1]);
+	return true;
+} // end getPointFrame()
+
+/*
+ * verify - Whether the transform takes every prototype vertex onto its own
+ * vertex of the shape, and the prototype's triangles onto the shape's.
+ */
+bool GroupMatcher::verify(const GroupShape& prototype, const GroupShape& shape,
+		const Rigid& rigid) {
+	const double tolerance = GroupInstancer::POSITION_TOLERANCE
+			* std::max(prototype.radius, shape.radius);
+	byX.resize(shape.numVertices);
+	for (Uint32 v = 0; v < shape.numVertices; ++v)
+		byX[v] = v;
+	used.assign(shape.numVertices, false);
+	matched.resize(prototype.numVertices);
+
+	bool sorted = false;
+	for (Uint32 v = 0; v < prototype.numVertices; ++v) {
+		const ParkVertex& vertex = getVertex(prototype, v);
+		double position[3];
+		double normal[3];
+		rigid.apply(vertex.position, position);
+		rigid.rotate(vertex.normal, normal);
+		/* Copies usually keep the order; search only if this one did not: */
+		if (matchVertex(shape, position, normal, vertex.texCoord, tolerance, v)) {
+			matched[v] = v;
+			used[v] = true;
+			continue;
+		}
+		if (!sorted) {
+			XOrder order;
+			order.mesh = &mesh;
+			order.vertices = &shapeVertices[shape.firstVertex];
+			std::sort(byX.begin(), byX.end(), order);
+			sorted = true;
+		}
+		Uint32 lower = 0;
+		Uint32 upper = shape.numVertices;
+		while (lower < upper) {
+			const Uint32 middle = (lower + upper) / 2;
+			if (getVertex(shape, byX[middle]).position[0] < position[0]
+					- tolerance)
+				lower = middle + 1;
+			else
+				upper = middle;
+		}
+		matched[v] = NONE;
+		for (Uint32 i = lower; i < shape.numVertices && getVertex(shape,
+				byX[i]).position[0] <= position[0] + tolerance; ++i) {
+			if (matchVertex(shape, position, normal, vertex.texCoord,
+					tolerance, byX[i])) {
+				matched[v] = byX[i];
+				used[byX[i]] = true;
+				break;
+			}
+		}
+		if (matched[v] == NONE)
+			return false;
+	}
+
+	getTriangles(prototype, &matched[0], prototypeTriangles);
+	getTriangles(shape, 0, shapeTriangles);
+	return prototypeTriangles == shapeTriangles;
+} // end verify()
+
+/*
+ * matchVertex - Whether an unused shape vertex agrees with a transformed
+ * prototype vertex.
+ */
+bool GroupMatcher::matchVertex(const GroupShape& shape,
+		const double position[3], const double normal[3],
+		const float texCoord[2], double tolerance, Uint32 local) {
+	if (local >= shape.numVertices || used[local])
+		return false;
+	const ParkVertex& vertex = getVertex(shape, local);
+	double distance = 0.0;
+	double cosine = 0.0;
+	for (int i = 0; i < 3; ++i) {
+		distance += (vertex.position[i] - position[i]) * (vertex.position[i]
+				- position[i]);
+		cosine += vertex.normal[i] * normal[i];
+	}
+	return distance <= tolerance * tolerance && cosine
+			>= GroupInstancer::NORMAL_COSINE && std::fabs(vertex.texCoord[0]
+			- texCoord[0]) <= GroupInstancer::TEX_COORD_TOLERANCE
+			&& std::fabs(vertex.texCoord[1] - texCoord[1])
+					<= GroupInstancer::TEX_COORD_TOLERANCE;
+} // end matchVertex()
+
+/*
+ * getTriangles - The triangles of a shape in local vertex numbers, mapped if
+ * a map is given, each starting at its smallest vertex with its winding
+ * kept, sorted.
+ */
+void GroupMatcher::getTriangles(const GroupShape& shape, const Uint32 * map,
+		std::vector<Uint32>& triangles) const {
+	const Uint32 firstIndex = mesh.groups[shape.group].firstIndex;
+	triangles.resize(3 * shape.numTriangles);
+	for (Uint32 t = 0; t < shape.numTriangles; ++t) {
+		Uint32 corners[3];
+		for (int k = 0; k < 3; ++k) {
+			const Uint32 local = localIndices[firstIndex + 3 * t + k];
+			corners[k] = map != 0 ? map[local] : local;
+		}
+		int first = 0;
+		for (int k = 1; k < 3; ++k)
+			if (corners[k] < corners[first])
+				first = k;
+		for (int k = 0; k < 3; ++k)
+			triangles[3 * t + k] = corners[(first + k) % 3];
+	}
+	/* Sort whole triangles: */
+	std::vector<Uint64> keys(shape.numTriangles);
+	for (Uint32 t = 0; t < shape.numTriangles; ++t)
+		keys[t] = (Uint64(triangles[3 * t]) << 42) | (Uint64(triangles[3 * t
+				+ 1]) << 21) | triangles[3 * t + 2];
+	std::sort(keys.begin(), keys.end());
+	for (Uint32 t = 0; t < shape.numTriangles; ++t) {
+		triangles[3 * t] = static_cast<Uint32> (keys[t] >> 42);
+		triangles[3 * t + 1] = static_cast<Uint32> (keys[t] >> 21) & 0x1fffff;
+		triangles[3 * t + 2] = static_cast<Uint32> (keys[t]) & 0x1fffff;
+	}
+} // end getTriangles()
+
+/*
+ * measureShape - Numbers a group's vertices in order of first use and
+ * finds their centroid and principal axes.
+ */
+static void measureShape(const ParkMesh& mesh, Uint32 g,
+		std::vector<Uint32>& localOf, std::vector<Uint32>& shapeVertices,
+		std::vector<Uint32>& localIndices, GroupShape& shape) {
+	const ParkGroup& group = mesh.groups[g];
+	shape.group = g;
+	shape.material = group.material;
+	shape.numTriangles = group.numIndices / 3;
+	shape.firstVertex = static_cast<Uint32> (shapeVertices.size());
+	for (Uint32 index = group.firstIndex; index < group.firstIndex
+			+ group.numIndices; ++index) {
+		const Uint32 vertex = mesh.indices[index];
+		if (localOf[vertex] == NONE) {
+			localOf[vertex] = static_cast<Uint32> (shapeVertices.size())
+					- shape.firstVertex;
+			shapeVertices.push_back(vertex);
+		}
+		localIndices[index] = localOf[vertex];
+	}
+	shape.numVertices = static_cast<Uint32> (shapeVertices.size())
+			- shape.firstVertex;
+
+	for (int i = 0; i < 3; ++i)
+		shape.centroid[i] = 0.0;
+	for (Uint32 v = shape.firstVertex; v < shape.firstVertex
+			+ shape.numVertices; ++v) {
+		localOf[shapeVertices[v]] = NONE;
+		for (int i = 0; i < 3; ++i)
+			shape.centroid[i] += mesh.vertices[shapeVertices[v]].position[i];
+	}
+	for (int i = 0; i < 3; ++i)
+		shape.centroid[i] /= shape.numVertices;
+
+	double covariance[3][3] = { { 0.0 } };
+	shape.radius = 0.0;
+	for (Uint32 v = shape.firstVertex; v < shape.firstVertex
+			+ shape.numVertices; ++v) {
+		double offset[3];
+		for (int i = 0; i < 3; ++i)
+			offset[i] = mesh.vertices[shapeVertices[v]].position[i]
+					- shape.centroid[i];
+		for (int i = 0; i < 3; ++i)
+			for (int j = 0; j < 3; ++j)
+				covariance[i][j] += offset[i] * offset[j] / shape.numVertices;
+		shape.radius = std::max(shape.radius, std::sqrt(offset[0] * offset[0]
+				+ offset[1] * offset[1] + offset[2] * offset[2]));
+	}
+	solveEigen(covariance, shape.spread, shape.axes);
+} // end measureShape()
+
+/*
+ * haveSameSpread - Whether two shapes could be rigid copies judging by the
+ * spread along their principal axes.
+ */
+static bool haveSameSpread(const GroupShape& a, const GroupShape& b) {
+	const double tolerance = GroupInstancer::POSITION_TOLERANCE * std::max(
+			a.radius, b.radius);
+	const double allowed = 2.0 * std::sqrt(std::max(a.spread[0],
+			b.spread[0])) * tolerance + tolerance * tolerance;
+	for (int k = 0; k < 3; ++k)
+		if (std::fabs(a.spread[k] - b.spread[k]) > allowed)
+			return false;
+	return true;
+} // end haveSameSpread()
+
+/*******************************
+ Methods of class GroupInstancer:
+ *******************************/
+
+/*
+ * fold - Replaces every group that is a rigid copy of an earlier group by an
+ * instance of it, and drops the copies' triangles and the vertices no
+ * longer used. Run before MaterialMerger::merge(); the index array is
+ * rewritten in group order.
+ *
+ * parameter mesh - ParkMesh&
+ * return - InstancingStatistics
+ */
+InstancingStatistics GroupInstancer::fold(ParkMesh& mesh) {
+	InstancingStatistics statistics;
+	statistics.numPrototypes = 0;
+	statistics.numFolded = 0;
+	statistics.bytesSaved = 0;
+
+	std::vector<GroupShape> shapes;
+	std::vector<Uint32> shapeVertices;
+	std::vector<Uint32> localIndices(mesh.indices.size());
+	std::vector<Uint32> localOf(mesh.vertices.size(), NONE);
+	for (Uint32 g = 0; g < mesh.groups.size(); ++g) {
+		if (mesh.groups[g].numIndices == 0)
+			continue;
+		shapes.push_back(GroupShape());
+		measureShape(mesh, g, localOf, shapeVertices, localIndices,
+				shapes.back());
+	}
+	std::sort(shapes.begin(), shapes.end(), ShapeOrder());
+
+	/* Within a run of equal size, each shape joins the nearest earlier
+	 * prototype it matches; prototypes are made in order of spread, so the
+	 * search stops at the first one spread far less: */
+	GroupMatcher matcher(mesh, shapeVertices, localIndices);
+	std::vector<ParkInstance> instances;
+	std::vector<Uint32> prototypes;
+	std::vector<bool> isPrototype(mesh.groups.size(), false);
+	for (size_t s = 0; s < shapes.size(); ++s) {
+		const GroupShape& shape = shapes[s];
+		if (s == 0 || shapes[s - 1].material != shape.material
+				|| shapes[s - 1].numTriangles != shape.numTriangles
+				|| shapes[s - 1].numVertices != shape.numVertices)
+			prototypes.clear();
+
+		bool folded = false;
+		for (size_t p = prototypes.size(); p-- > 0 && !folded;) {
+			const GroupShape& prototype = shapes[prototypes[p]];
+			if (prototype.spread[0] < SPREAD_WINDOW * shape.spread[0])
+				break;
+			if (!haveSameSpread(prototype, shape))
+				continue;
+			Rigid rigid;
+			if (!matcher.match(prototype, shape, rigid))
+				continue;
+			ParkInstance instance;
+			instance.group = shape.group;
+			instance.prototype = prototype.group;
+			for (int i = 0; i < 3; ++i) {
+				for (int j = 0; j < 3; ++j)
+					instance.rotation[3 * i + j]
+							= static_cast<float> (rigid.rotation[i][j]);
+				instance.translation[i]
+						= static_cast<float> (rigid.translation[i]);
+			}
+			instances.push_back(instance);
+			isPrototype[prototype.group] = true;
+			folded = true;
+		}
+		if (!folded)
+			prototypes.push_back(static_cast<Uint32> (s));
+	}
+	if (instances.empty())
+		return statistics;
+	std::sort(instances.begin(), instances.end(), InstanceOrder());
+
+	/* Keep the triangles of all other groups, and the vertices they use: */
+	std::vector<bool> isCopy(mesh.groups.size(), false);
+	for (size_t i = 0; i < instances.size(); ++i)
+		isCopy[instances[i].group] = true;
+	std::vector<Uint32> indices;
+	indices.reserve(mesh.indices.size());
+	for (Uint32 g = 0; g < mesh.groups.size(); ++g) {
+		ParkGroup& group = mesh.groups[g];
+		const Uint32 firstIndex = static_cast<Uint32> (indices.size());
+		if (isCopy[g])
+			group.numIndices = 0;
+		else
+			indices.insert(indices.end(), mesh.indices.begin()
+					+ group.firstIndex, mesh.indices.begin() + group.firstIndex
+					+ group.numIndices);
+		group.firstIndex = firstIndex;
+	}
+	std::vector<Uint32> newVertex(mesh.vertices.size(), NONE);
+	std::vector<ParkVertex> vertices;
+	for (std::vector<Uint32>::iterator iIt = indices.begin(); iIt
+			!= indices.end(); ++iIt) {
+		if (newVertex[*iIt] == NONE) {
+			newVertex[*iIt] = static_cast<Uint32> (vertices.size());
+			vertices.push_back(mesh.vertices[*iIt]);
+		}
+		*iIt = newVertex[*iIt];
+	}
+
+	const size_t bytesBefore = mesh.getGeometryBytes();
+	mesh.vertices.swap(vertices);
+	mesh.indices.swap(indices);
+	mesh.instances.insert(mesh.instances.end(), instances.begin(),
+			instances.end());
+	std::sort(mesh.instances.begin(), mesh.instances.end(), InstanceOrder());
+	mesh.computeBounds();
+
+	for (size_t g = 0; g < isPrototype.size(); ++g)
+		if (isPrototype[g])
+			++statistics.numPrototypes;
+	statistics.numFolded = static_cast<Uint32> (instances.size());
+	const size_t bytesAfter = mesh.getGeometryBytes() + instances.size()
+			* sizeof(ParkInstance);
+	statistics.bytesSaved = bytesBefore > bytesAfter ? bytesBefore
+			- bytesAfter : 0;
+	return statistics;
+} // end fold()
@@ -0,0 +1,56 @@
+/*
+ * GroupInstancer.h - Load-time stage folding repeated park groups into
+ * instances of one shared mesh.
+ *
+ * Created: October 17, 2026
+ */
+
+#ifndef GROUPINSTANCER_H_
+#define GROUPINSTANCER_H_
+
+#include <cstddef>
+
+#include <UTIL/Types.h>
+
+/* Begin Forward declarations: */
+class ParkMesh;
+/* End Forward declarations: */
+
+/*
+ * InstancingStatistics - What folding the repeated groups achieved.
+ */
+struct InstancingStatistics {
+	/* Groups drawing their own triangles that others are copies of */
+	Uint32 numPrototypes;
+	/* Groups replaced by a transform of their prototype */
+	Uint32 numFolded;
+	/* Vertex and index bytes dropped, less the transforms kept */
+	size_t bytesSaved;
+};
+
+/*
+ * GroupInstancer - Finds groups that are rigid transforms of one another,
+ * such as the seats, rail segments and light towers the model converter
+ * baked into groups of their own. Groups of one material and equal vertex
+ * and triangle counts are compared by the principal axes of their vertex
+ * sets: equal spreads along the axes make them candidates, and the axes, or
+ * where they are ambiguous the frame of two matching vertices, give the
+ * rotation. A candidate is accepted if every vertex lands on a vertex of
+ * the other group within POSITION_TOLERANCE of the group's size, with a
+ * matching normal and texture coordinate, and the triangles agree. The
+ * copies keep their group ids, but their triangles are replaced by
+ * ParkMesh::instances entries.
+ */
+class GroupInstancer {
+public:
+	/* Largest vertex mismatch, as a share of the group's radius */
+	static const float POSITION_TOLERANCE;
+	/* Smallest cosine between matching normals */
+	static const float NORMAL_COSINE;
+	/* Largest texture coordinate mismatch */
+	static const float TEX_COORD_TOLERANCE;
+
+	static InstancingStatistics fold(ParkMesh& mesh);
+};
+
+#endif /* GROUPINSTANCER_H_ */
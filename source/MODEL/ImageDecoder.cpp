@@ -0,0 +1,344 @@
+/*
+ * ImageDecoder.cpp - Methods for decoding park texture files, with JPEG
+ * mipmaps scaled in the DCT domain.
+ *
+ * Created: October 17, 2026
+ */
+
+/* System headers */
+#include <algorithm>
+#include <cctype>
+#include <csetjmp>
+#include <cstdio>
+#include <cstring>
+#include <istream>
+#include <vector>
+
+/* libjpeg is C and leaves the linkage to its includer */
+extern "C" {
+#include <jpeglib.h>
+}
+
+/* osg includes */
+#include <osgDB/ReaderWriter>
+#include <osgDB/Registry>
+
+/* Application headers */
+#include <MODEL/ImageDecoder.h>
+#include <MODEL/TexturePack.h>
+#include <UTIL/MappedFile.h>
+#include <UTIL/MemoryStreamBuf.h>
+
+/* PNG file signature */
+static const unsigned char PNG_SIGNATURE[8] = { 0x89, 'P', 'N', 'G', '\r',
+		'\n', 0x1A, '\n' };
+
+/*
+ * JpegError - libjpeg error manager that unwinds to the decoder instead of
+ * exiting.
+ */
+struct JpegError {
+	struct jpeg_error_mgr manager;
+	jmp_buf jump;
+};
+
+/*
+ * exitJpeg - Fatal libjpeg errors end the decode.
+ */
+static void exitJpeg(j_common_ptr info) {
+	longjmp(reinterpret_cast<JpegError*> (info->err)->jump, 1);
+} // end exitJpeg()
+
+/*
+ * ignoreJpegMessage - Warnings about recoverable damage are not printed.
+ */
+static void ignoreJpegMessage(j_common_ptr) {
+} // end ignoreJpegMessage()
+
+/*
+ * JpegLevel - One decoded mipmap level, tightly packed, bottom row first.
+ */
+struct JpegLevel {
+	Uint32 width;
+	Uint32 height;
+	std::vector<unsigned char> pixels;
+};
+
+/*
+ * decodeJpeg - Decodes a JPEG at 1/denominator scale. Only grayscale and
+ * YCbCr files are accepted; the OSG plugin handles the rest.
+ */
+static bool decodeJpeg(const char * data, size_t size,
+		unsigned int denominator, int& components, JpegLevel& level) {
+	jpeg_decompress_struct info;
+	JpegError error;
+	info.err = jpeg_std_error(&error.manager);
+	error.manager.error_exit = exitJpeg;
+	error.manager.output_message = ignoreJpegMessage;
+	if (setjmp(error.jump)) {
+		jpeg_destroy_decompress(&info);
+		return false;
+	}
+	jpeg_create_decompress(&info);
+	jpeg_mem_src(&info, reinterpret_cast<unsigned char*> (const_cast<char*> (
+			data)), static_cast<unsigned long> (size));
+	jpeg_read_header(&info, TRUE);
+	if (info.jpeg_color_space != JCS_GRAYSCALE && info.jpeg_color_space
+			!= JCS_YCbCr) {
+		jpeg_destroy_decompress(&info);
+		return false;
+	}
+	info.out_color_space =
+			info.jpeg_color_space == JCS_GRAYSCALE ? JCS_GRAYSCALE : JCS_RGB;
+	info.scale_num = 1;
+	info.scale_denom = denominator;
+	jpeg_start_decompress(&info);
+
+	components = info.output_components;
+	level.width = info.output_width;
+	level.height = info.output_height;
+	const size_t stride = size_t(level.width) * components;
+	level.pixels.resize(stride * level.height);
+	/* OSG images start with the bottom row: */
+	while (info.output_scanline < info.output_height) {
+		JSAMPROW row = &level.pixels[stride * (level.height - 1
+				- info.output_scanline)];
+		jpeg_read_scanlines(&info, &row, 1);
+	}
+	jpeg_finish_decompress(&info);
+	jpeg_destroy_decompress(&info);
+	return true;
+} // end decodeJpeg()
+
+/*
+ * shrinkLevel - Box-filters a level to the next mipmap level, whose extents
+ * are halved and rounded down as GL expects.
+ */
+static void shrinkLevel(const JpegLevel& source, int components,
+		JpegLevel& level) {
+	level.width = std::max<Uint32> (1, source.width / 2);
+	level.height = std::max<Uint32> (1, source.height / 2);
+	level.pixels.resize(size_t(level.width) * level.height * components);
+	const Uint32 xStep = source.width > 1 ? 1 : 0;
+	const Uint32 yStep = source.height > 1 ? 1 : 0;
+	for (Uint32 y = 0; y < level.height; ++y) {
+		const unsigned char * row0 = &source.pixels[size_t(2 * y)
+				* source.width * components];
+		const unsigned char * row1 = row0 + size_t(yStep) * source.width
+				* components;
+		unsigned char * out = &level.pixels[size_t(y) * level.width
+				* components];
+		for (Uint32 x = 0; x < level.width; ++x) {
+			const Uint32 left = 2 * x * components;
+			const Uint32 right = (2 * x + xStep) * components;
+			for (int c = 0; c < components; ++c)
+				*out++ = static_cast<unsigned char> ((row0[left + c]
+						+ row0[right + c] + row1[left + c] + row1[right + c]
+						+ 2) / 4);
+		}
+	}
+} // end shrinkLevel()
+
+/*
+ * decodeJpegMipmaps - Decodes a JPEG with its complete mipmap chain. A level
+ * down to MAX_DCT_LEVEL is decoded at its scale when the scaled extents are
+ * exact, which they are for the usual power-of-two textures.
+ */
+static osg::Image * decodeJpegMipmaps(const char * data, size_t size) {
+	std::vector<JpegLevel> levels(1);
+	int components = 0;
+	if (!decodeJpeg(data, size, 1, components, levels[0]))
+		return 0;
+	const Uint32 width = levels[0].width;
+	const Uint32 height = levels[0].height;
+	size_t totalSize = levels[0].pixels.size();
+	for (Uint32 l = 1; levels.back().width > 1 || levels.back().height > 1;
+			++l) {
+		levels.push_back(JpegLevel());
+		JpegLevel& level = levels.back();
+		const Uint32 scale = 1u << l;
+		int scaledComponents = 0;
+		if (l > ImageDecoder::MAX_DCT_LEVEL || width % scale != 0 || height
+				% scale != 0 || !decodeJpeg(data, size, scale,
+				scaledComponents, level) || level.width != width / scale
+				|| level.height != height / scale)
+			shrinkLevel(levels[l - 1], components, level);
+		totalSize += level.pixels.size();
+	}
+
+	unsigned char * pixels = new unsigned char[totalSize];
+	osg::Image::MipmapDataType offsets;
+	size_t offset = 0;
+	for (size_t l = 0; l < levels.size(); ++l) {
+		if (l != 0)
+			offsets.push_back(static_cast<unsigned int> (offset));
+		std::memcpy(pixels + offset, &levels[l].pixels[0],
+				levels[l].pixels.size());
+		offset += levels[l].pixels.size();
+	}
+	const GLenum format = components == 1 ? GL_LUMINANCE : GL_RGB;
+	osg::Image * image = new osg::Image();
+	image->setImage(width, height, 1, format, format, GL_UNSIGNED_BYTE, pixels,
+			osg::Image::USE_NEW_DELETE, 1);
+	image->setMipmapLevels(offsets);
+	return image;
+} // end decodeJpegMipmaps()
+
+/*
+ * readBigEndian16 - Reads an unsigned 16-bit big-endian header field.
+ */
+static Uint32 readBigEndian16(const unsigned char * bytes) {
+	return (Uint32(bytes[0]) << 8) | bytes[1];
+} // end readBigEndian16()
+
+/*
+ * readLittleEndian32 - Reads a signed 32-bit little-endian header field.
+ */
+static Int32 readLittleEndian32(const unsigned char * bytes) {
+	return static_cast<Int32> (Uint32(bytes[0]) | (Uint32(bytes[1]) << 8)
+			| (Uint32(bytes[2]) << 16) | (Uint32(bytes[3]) << 24));
+} // end readLittleEndian32()
+
+/*
+ * readJpegSize - Finds the frame header among the JPEG markers.
+ */
+static bool readJpegSize(const unsigned char * bytes, size_t size,
+		Uint32& width, Uint32& height) {
+	size_t p = 2;
+	while (p + 4 <= size) {
+		if (bytes[p] != 0xFF)
+			return false;
+		const unsigned char marker = bytes[p + 1];
+		/* Fill bytes, and markers without a segment: */
+		if (marker == 0xFF) {
+			++p;
+			continue;
+		}
+		if (marker == 0x01 || (marker >= 0xD0 && marker <= 0xD8)) {
+			p += 2;
+			continue;
+		}
+		const size_t length = readBigEndian16(bytes + p + 2);
+		/* Start of frame, except DHT, JPG and DAC which share the range: */
+		if (marker >= 0xC0 && marker <= 0xCF && marker != 0xC4 && marker
+				!= 0xC8 && marker != 0xCC) {
+			if (p + 9 > size)
+				return false;
+			height = readBigEndian16(bytes + p + 5);
+			width = readBigEndian16(bytes + p + 7);
+			return width != 0 && height != 0;
+		}
+		p += 2 + length;
+	}
+	return false;
+} // end readJpegSize()
+
+/*******************************
+ Methods of class ImageDecoder:
+ *******************************/
+
+/*
+ * decode - Decodes texture file contents.
+ *
+ * parameter data - const char *
+ * parameter size - size_t
+ * parameter extension - const std::string&, lower case, picks the OSG
+ * plugin for formats other than JPEG
+ * return - osg::ref_ptr<osg::Image>, null if the contents cannot be decoded
+ */
+osg::ref_ptr<osg::Image> ImageDecoder::decode(const char * data,
+		size_t size, const std::string& extension) {
+	const unsigned char * bytes = reinterpret_cast<const unsigned char*> (data);
+	if (size > 2 && bytes[0] == 0xFF && bytes[1] == 0xD8) {
+		osg::ref_ptr<osg::Image> image = decodeJpegMipmaps(data, size);
+		if (image.valid())
+			return image;
+	}
+
+	osgDB::ReaderWriter * readerWriter =
+			osgDB::Registry::instance()->getReaderWriterForExtension(extension);
+	if (readerWriter == 0)
+		return 0;
+	MemoryStreamBuf buffer(data, size);
+	std::istream stream(&buffer);
+	osgDB::ReaderWriter::ReadResult result = readerWriter->readImage(stream);
+	return result.getImage();
+} // end decode()
+
+/*
+ * readSize - Reads the extents of a JPEG, PNG or BMP image from its header.
+ *
+ * parameter data - const char *
+ * parameter size - size_t
+ * parameter width - Uint32&
+ * parameter height - Uint32&
+ * return - bool, false for other formats and damaged headers
+ */
+bool ImageDecoder::readSize(const char * data, size_t size, Uint32& width,
+		Uint32& height) {
+	const unsigned char * bytes = reinterpret_cast<const unsigned char*> (data);
+	if (size > 2 && bytes[0] == 0xFF && bytes[1] == 0xD8)
+		return readJpegSize(bytes, size, width, height);
+	if (size >= 24 && std::memcmp(bytes, PNG_SIGNATURE, sizeof(PNG_SIGNATURE))
+			== 0 && std::memcmp(bytes + 12, "IHDR", 4) == 0) {
+		width = (readBigEndian16(bytes + 16) << 16) | readBigEndian16(bytes
+				+ 18);
+		height = (readBigEndian16(bytes + 20) << 16) | readBigEndian16(bytes
+				+ 22);
+		return width != 0 && height != 0;
+	}
+	if (size >= 26 && bytes[0] == 'B' && bytes[1] == 'M') {
+		const Int32 headerSize = readLittleEndian32(bytes + 14);
+		if (headerSize == 12) {
+			width = bytes[18] | (Uint32(bytes[19]) << 8);
+			height = bytes[20] | (Uint32(bytes[21]) << 8);
+		} else if (headerSize >= 40) {
+			const Int32 bmpWidth = readLittleEndian32(bytes + 18);
+			const Int32 bmpHeight = readLittleEndian32(bytes + 22);
+			/* Top-down files have negative heights: */
+			width = static_cast<Uint32> (std::max(bmpWidth, 0));
+			height = static_cast<Uint32> (bmpHeight < 0 ? -bmpHeight
+					: bmpHeight);
+		} else
+			return false;
+		return width != 0 && height != 0;
+	}
+	return false;
+} // end readSize()
+
+/*
+ * load - Decodes a texture file from the texture pack when it lists the
+ * name, else from the model directory.
+ *
+ * parameter name - const std::string&, relative to the model directory
+ * parameter modelDirectory - const std::string&
+ * parameter texturePack - const TexturePack *, or null
+ * return - osg::ref_ptr<osg::Image>, null if the file cannot be decoded
+ *
+ * throw ResourceException if the file cannot be read.
+ */
+osg::ref_ptr<osg::Image> ImageDecoder::load(const std::string& name,
+		const std::string& modelDirectory, const TexturePack * texturePack) {
+	TexturePack::Image packed;
+	if (texturePack != 0 && texturePack->find(name, packed))
+		return decode(packed.data, packed.size, packed.extension);
+	MappedFile file(modelDirectory + "/" + name);
+	return decode(file.getData(), file.getSize(), getExtension(name));
+} // end load()
+
+/*
+ * getExtension - Lower-case extension of a file name, without the dot.
+ *
+ * parameter name - const std::string&
+ * return - std::string, empty if there is none
+ */
+std::string ImageDecoder::getExtension(const std::string& name) {
+	const std::string::size_type dot = name.find_last_of("./");
+	if (dot == std::string::npos || name[dot] != '.')
+		return std::string();
+	std::string extension = name.substr(dot + 1);
+	for (size_t i = 0; i < extension.size(); ++i)
+		extension[i] = static_cast<char> (std::tolower(
+				static_cast<unsigned char> (extension[i])));
+	return extension;
+} // end getExtension()
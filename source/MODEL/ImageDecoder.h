@@ -0,0 +1,47 @@
+/*
+ * ImageDecoder.h - Decoding of park texture files, with JPEG mipmaps scaled
+ * in the DCT domain.
+ *
+ * Created: October 17, 2026
+ */
+
+#ifndef IMAGEDECODER_H_
+#define IMAGEDECODER_H_
+
+#include <cstddef>
+#include <string>
+
+/* osg includes */
+#include <osg/Image>
+
+#include <UTIL/Types.h>
+
+/* Begin Forward declarations: */
+class TexturePack;
+/* End Forward declarations: */
+
+/*
+ * ImageDecoder - Turns texture file contents into OSG images. JPEG files,
+ * most of the park's textures, are decoded with libjpeg into a complete
+ * mipmap chain: libjpeg scales levels 1 to MAX_DCT_LEVEL while decoding, by
+ * dropping the high-frequency DCT coefficients, which costs a fraction of
+ * decoding level 0 and filters better than a box; the levels below are
+ * box-filtered. Other formats go through the OSG plugin for their
+ * extension. The size of JPEG, PNG and BMP files can be read from their
+ * headers without decoding them.
+ */
+class ImageDecoder {
+public:
+	/* Deepest mipmap level libjpeg decodes directly, at 1/8 scale */
+	static const Uint32 MAX_DCT_LEVEL = 3;
+
+	static osg::ref_ptr<osg::Image> decode(const char * data, size_t size,
+			const std::string& extension);
+	static bool readSize(const char * data, size_t size, Uint32& width,
+			Uint32& height);
+	static osg::ref_ptr<osg::Image> load(const std::string& name,
+			const std::string& modelDirectory, const TexturePack * texturePack);
+	static std::string getExtension(const std::string& name);
+};
+
+#endif /* IMAGEDECODER_H_ */
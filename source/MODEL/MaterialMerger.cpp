@@ -0,0 +1,182 @@
+/*
+ * MaterialMerger.cpp - Methods for collapsing park groups into one draw batch
+ * per material.
+ *
+ * Created: October 16, 2026
+ */
+
+/* System headers */
+#include <algorithm>
+#include <vector>
+
+/* Application headers */
+#include <MODEL/MaterialMerger.h>
+#include <MODEL/ParkMesh.h>
+
+/* Triangles at which a cluster is closed; larger groups form their own */
+static const Uint32 CLUSTER_TRIANGLES = 512;
+
+/*
+ * MaterialOrder - Orders materials so opaque batches come before transparent
+ * ones and batches sharing a texture are adjacent.
+ */
+struct MaterialOrder {
+	const std::vector<ParkMaterial>* materials;
+
+	bool operator()(Uint32 a, Uint32 b) const {
+		const ParkMaterial& ma = (*materials)[a];
+		const ParkMaterial& mb = (*materials)[b];
+		if (ma.isTransparent() != mb.isTransparent())
+			return !ma.isTransparent();
+		if (ma.texture != mb.texture)
+			return ma.texture < mb.texture;
+		return a < b;
+	}
+};
+
+/*
+ * GroupOrder - Orders groups along a Morton curve through the centers of
+ * their bounds, so runs of groups are spatially compact.
+ */
+struct GroupOrder {
+	const std::vector<Uint32>* codes;
+
+	bool operator()(Uint32 a, Uint32 b) const {
+		if ((*codes)[a] != (*codes)[b])
+			return (*codes)[a] < (*codes)[b];
+		return a < b;
+	}
+};
+
+/*
+ * spreadBits - Moves the low 10 bits of a value to every third bit.
+ */
+static Uint32 spreadBits(Uint32 value) {
+	value &= 0x3ff;
+	value = (value | value << 16) & 0x030000ff;
+	value = (value | value << 8) & 0x0300f00f;
+	value = (value | value << 4) & 0x030c30c3;
+	value = (value | value << 2) & 0x09249249;
+	return value;
+} // end spreadBits()
+
+/*
+ * getMortonCodes - 30-bit Morton code of every group's center within the
+ * mesh bounds.
+ */
+static void getMortonCodes(const ParkMesh& mesh, std::vector<Uint32>& codes) {
+	codes.resize(mesh.groups.size());
+	for (size_t g = 0; g < mesh.groups.size(); ++g) {
+		const ParkGroup& group = mesh.groups[g];
+		Uint32 code = 0;
+		for (int i = 0; i < 3; ++i) {
+			const float extent = mesh.boundsMax[i] - mesh.boundsMin[i];
+			float t = extent > 0.0f ? ((group.boundsMin[i] + group.boundsMax[i])
+					* 0.5f - mesh.boundsMin[i]) / extent : 0.0f;
+			t = std::min(std::max(t, 0.0f), 1.0f);
+			code |= spreadBits(static_cast<Uint32> (t * 1023.0f)) << i;
+		}
+		codes[g] = code;
+	}
+} // end getMortonCodes()
+
+/*******************************
+ Methods of class MaterialMerger:
+ *******************************/
+
+/*
+ * merge - Rewrites the index array so that all groups of a material are
+ * contiguous and fills in the batch tables. Groups keep their position in
+ * the group array (their id), only their index ranges move; within a batch
+ * groups follow a Morton curve and are cut into clusters of about
+ * CLUSTER_TRIANGLES triangles. The vertex array is not touched.
+ *
+ * parameter mesh - ParkMesh&
+ */
+void MaterialMerger::merge(ParkMesh& mesh) {
+	const Uint32 numMaterials = static_cast<Uint32> (mesh.materials.size());
+	const Uint32 numGroups = static_cast<Uint32> (mesh.groups.size());
+
+	/* Bucket the groups by material, keeping file order in each bucket: */
+	std::vector<Uint32> bucketStart(numMaterials + 1, 0);
+	for (Uint32 g = 0; g < numGroups; ++g)
+		++bucketStart[mesh.groups[g].material + 1];
+	for (Uint32 m = 0; m < numMaterials; ++m)
+		bucketStart[m + 1] += bucketStart[m];
+	std::vector<Uint32> bucketed(numGroups);
+	std::vector<Uint32> bucketFill(bucketStart.begin(), bucketStart.end() - 1);
+	for (Uint32 g = 0; g < numGroups; ++g)
+		bucketed[bucketFill[mesh.groups[g].material]++] = g;
+	std::vector<Uint32> codes;
+	getMortonCodes(mesh, codes);
+	GroupOrder groupOrder;
+	groupOrder.codes = &codes;
+	for (Uint32 m = 0; m < numMaterials; ++m)
+		std::sort(bucketed.begin() + bucketStart[m], bucketed.begin()
+				+ bucketStart[m + 1], groupOrder);
+
+	std::vector<Uint32> materialOrder(numMaterials);
+	for (Uint32 m = 0; m < numMaterials; ++m)
+		materialOrder[m] = m;
+	MaterialOrder order;
+	order.materials = &mesh.materials;
+	std::sort(materialOrder.begin(), materialOrder.end(), order);
+
+	std::vector<Uint32> indices;
+	indices.reserve(mesh.indices.size());
+	mesh.batches.clear();
+	mesh.batchGroups.clear();
+	mesh.clusters.clear();
+	mesh.batchGroups.reserve(numGroups);
+	mesh.triangleGroups.resize(mesh.indices.size() / 3);
+
+	for (Uint32 o = 0; o < numMaterials; ++o) {
+		const Uint32 m = materialOrder[o];
+		if (bucketStart[m] == bucketStart[m + 1])
+			continue;
+
+		ParkBatch batch;
+		batch.material = m;
+		batch.firstIndex = static_cast<Uint32> (indices.size());
+		batch.firstGroup = static_cast<Uint32> (mesh.batchGroups.size());
+		batch.numGroups = bucketStart[m + 1] - bucketStart[m];
+		batch.firstCluster = static_cast<Uint32> (mesh.clusters.size());
+
+		for (Uint32 b = bucketStart[m]; b < bucketStart[m + 1]; ++b) {
+			const Uint32 g = bucketed[b];
+			ParkGroup& group = mesh.groups[g];
+			const Uint32 firstIndex = static_cast<Uint32> (indices.size());
+			indices.insert(indices.end(), mesh.indices.begin()
+					+ group.firstIndex, mesh.indices.begin() + group.firstIndex
+					+ group.numIndices);
+			for (Uint32 t = firstIndex / 3; t < (firstIndex
+					+ group.numIndices) / 3; ++t)
+				mesh.triangleGroups[t] = g;
+			group.firstIndex = firstIndex;
+			group.batch = static_cast<Uint32> (mesh.batches.size());
+
+			if (mesh.clusters.size() == batch.firstCluster
+					|| mesh.clusters.back().numIndices[0] + group.numIndices > 3
+							* CLUSTER_TRIANGLES) {
+				ParkCluster cluster;
+				cluster.batch = group.batch;
+				cluster.firstGroup
+						= static_cast<Uint32> (mesh.batchGroups.size());
+				cluster.firstIndex[0] = firstIndex;
+				mesh.clusters.push_back(cluster);
+			}
+			++mesh.clusters.back().numGroups;
+			mesh.clusters.back().numIndices[0] += group.numIndices;
+			mesh.batchGroups.push_back(g);
+		}
+
+		batch.numIndices = static_cast<Uint32> (indices.size())
+				- batch.firstIndex;
+		batch.numClusters = static_cast<Uint32> (mesh.clusters.size())
+				- batch.firstCluster;
+		mesh.batches.push_back(batch);
+	}
+
+	mesh.indices.swap(indices);
+	mesh.computeBounds();
+} // end merge()
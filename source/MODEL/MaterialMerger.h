@@ -0,0 +1,20 @@
+/*
+ * MaterialMerger.h - Post-load stage collapsing park groups into one draw
+ * batch per material.
+ *
+ * Created: October 16, 2026
+ */
+
+#ifndef MATERIALMERGER_H_
+#define MATERIALMERGER_H_
+
+/* Begin Forward declarations: */
+class ParkMesh;
+/* End Forward declarations: */
+
+class MaterialMerger {
+public:
+	static void merge(ParkMesh& mesh);
+};
+
+#endif /* MATERIALMERGER_H_ */
@@ -0,0 +1,440 @@
+/*
+ * MeshOptimizer.cpp - Methods for welding, cleaning and cache ordering the
+ * park mesh.
+ *
+ * Created: October 16, 2026
+ */
+
+/* System headers */
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <map>
+#include <set>
+#include <vector>
+
+/* Application headers */
+#include <MODEL/MeshOptimizer.h>
+#include <MODEL/ParkMesh.h>
+
+/* Weld tolerances: positions relative to the mesh diagonal, normals and
+ * texture coordinates absolute (a 2048 texel atlas page is 4.9e-4 per texel) */
+static const double POSITION_TOLERANCE = 1.0e-6;
+static const double NORMAL_TOLERANCE = 1.0e-3;
+static const double TEXCOORD_TOLERANCE = 1.0e-5;
+
+static const Uint32 NONE = 0xffffffffu;
+
+/*
+ * WeldKey - Vertex attributes snapped to the weld tolerances.
+ */
+struct WeldKey {
+	long long value[8];
+
+	bool operator<(const WeldKey& other) const {
+		return std::lexicographical_compare(value, value + 8, other.value,
+				other.value + 8);
+	}
+};
+
+/*
+ * TriangleKey - A triangle rotated to start at its smallest index, which
+ * keeps the winding so back faces are not taken for repeats.
+ */
+struct TriangleKey {
+	Uint32 index[3];
+
+	TriangleKey(Uint32 a, Uint32 b, Uint32 c) {
+		if (a < b && a < c) {
+			index[0] = a;
+			index[1] = b;
+			index[2] = c;
+		} else if (b < c) {
+			index[0] = b;
+			index[1] = c;
+			index[2] = a;
+		} else {
+			index[0] = c;
+			index[1] = a;
+			index[2] = b;
+		}
+	}
+
+	bool operator<(const TriangleKey& other) const {
+		return std::lexicographical_compare(index, index + 3, other.index,
+				other.index + 3);
+	}
+};
+
+/*
+ * weldVertices - Points every index at the first vertex that agrees with its
+ * own within the tolerances. Vertices left unreferenced are dropped later by
+ * reorderVertices(). Groups may share vertices afterwards.
+ *
+ * return - float, smallest edge length still told apart
+ */
+static float weldVertices(ParkMesh& mesh) {
+	float boundsMin[3] = { FLT_MAX, FLT_MAX, FLT_MAX };
+	float boundsMax[3] = { -FLT_MAX, -FLT_MAX, -FLT_MAX };
+	for (size_t v = 0; v < mesh.vertices.size(); ++v)
+		for (int i = 0; i < 3; ++i) {
+			boundsMin[i] = std::min(boundsMin[i], mesh.vertices[v].position[i]);
+			boundsMax[i] = std::max(boundsMax[i], mesh.vertices[v].position[i]);
+		}
+	double diagonal = 0.0;
+	for (int i = 0; i < 3 && !mesh.vertices.empty(); ++i)
+		diagonal += double(boundsMax[i] - boundsMin[i]) * (boundsMax[i]
+				- boundsMin[i]);
+	const double positionStep = std::max(std::sqrt(diagonal)
+			* POSITION_TOLERANCE, double(FLT_MIN));
+
+	std::map<WeldKey, Uint32> welded;
+	std::vector<Uint32> remap(mesh.vertices.size());
+	for (size_t v = 0; v < mesh.vertices.size(); ++v) {
+		const ParkVertex& vertex = mesh.vertices[v];
+		WeldKey key;
+		for (int i = 0; i < 3; ++i) {
+			key.value[i] = static_cast<long long> (std::floor(
+					vertex.position[i] / positionStep + 0.5));
+			key.value[3 + i] = static_cast<long long> (std::floor(
+					vertex.normal[i] / NORMAL_TOLERANCE + 0.5));
+		}
+		for (int i = 0; i < 2; ++i)
+			key.value[6 + i] = static_cast<long long> (std::floor(
+					vertex.texCoord[i] / TEXCOORD_TOLERANCE + 0.5));
+		remap[v] = welded.insert(std::make_pair(key, Uint32(v))).first->second;
+	}
+	for (size_t i = 0; i < mesh.indices.size(); ++i)
+		mesh.indices[i] = remap[mesh.indices[i]];
+	return static_cast<float> (positionStep);
+} // end weldVertices()
+
+/*
+ * isDegenerate - Whether a triangle repeats a vertex or spans no area at the
+ * weld resolution.
+ */
+static bool isDegenerate(const ParkMesh& mesh, Uint32 a, Uint32 b, Uint32 c,
+		float minLength) {
+	if (a == b || b == c || c == a)
+		return true;
+	const float* p0 = mesh.vertices[a].position;
+	const float* p1 = mesh.vertices[b].position;
+	const float* p2 = mesh.vertices[c].position;
+	const double e1[3] = { p1[0] - p0[0], p1[1] - p0[1], p1[2] - p0[2] };
+	const double e2[3] = { p2[0] - p0[0], p2[1] - p0[1], p2[2] - p0[2] };
+	const double cross[3] = { e1[1] * e2[2] - e1[2] * e2[1], e1[2] * e2[0]
+			- e1[0] * e2[2], e1[0] * e2[1] - e1[1] * e2[0] };
+	const double area2 = std::sqrt(cross[0] * cross[0] + cross[1] * cross[1]
+			+ cross[2] * cross[2]);
+	return area2 <= double(minLength) * minLength;
+} // end isDegenerate()
+
+/*
+ * removeTriangles - Compacts the index array in batch order, dropping
+ * degenerate triangles and triangles repeated within their group, and moves
+ * the group, batch and cluster ranges along.
+ */
+static void removeTriangles(ParkMesh& mesh, float minLength) {
+	std::vector<Uint32> indices;
+	indices.reserve(mesh.indices.size());
+	for (size_t b = 0; b < mesh.batches.size(); ++b) {
+		ParkBatch& batch = mesh.batches[b];
+		batch.firstIndex = static_cast<Uint32> (indices.size());
+		for (Uint32 bg = batch.firstGroup; bg < batch.firstGroup
+				+ batch.numGroups; ++bg) {
+			ParkGroup& group = mesh.groups[mesh.batchGroups[bg]];
+			const Uint32 firstIndex = static_cast<Uint32> (indices.size());
+			std::set<TriangleKey> seen;
+			for (Uint32 i = group.firstIndex; i < group.firstIndex
+					+ group.numIndices; i += 3) {
+				const Uint32 a = mesh.indices[i];
+				const Uint32 b = mesh.indices[i + 1];
+				const Uint32 c = mesh.indices[i + 2];
+				if (isDegenerate(mesh, a, b, c, minLength)
+						|| !seen.insert(TriangleKey(a, b, c)).second)
+					continue;
+				indices.push_back(a);
+				indices.push_back(b);
+				indices.push_back(c);
+			}
+			group.firstIndex = firstIndex;
+			group.numIndices = static_cast<Uint32> (indices.size()) - firstIndex;
+		}
+		batch.numIndices = static_cast<Uint32> (indices.size())
+				- batch.firstIndex;
+	}
+	mesh.indices.swap(indices);
+
+	for (size_t c = 0; c < mesh.clusters.size(); ++c) {
+		ParkCluster& cluster = mesh.clusters[c];
+		cluster.firstIndex[0]
+				= mesh.groups[mesh.batchGroups[cluster.firstGroup]].firstIndex;
+		cluster.numIndices[0] = 0;
+		for (Uint32 bg = cluster.firstGroup; bg < cluster.firstGroup
+				+ cluster.numGroups; ++bg)
+			cluster.numIndices[0]
+					+= mesh.groups[mesh.batchGroups[bg]].numIndices;
+	}
+
+	mesh.triangleGroups.resize(mesh.indices.size() / 3);
+	for (size_t g = 0; g < mesh.groups.size(); ++g) {
+		const ParkGroup& group = mesh.groups[g];
+		std::fill(mesh.triangleGroups.begin() + group.firstIndex / 3,
+				mesh.triangleGroups.begin() + (group.firstIndex
+						+ group.numIndices) / 3, Uint32(g));
+	}
+} // end removeTriangles()
+
+/*
+ * getVertexScore - Forsyth's vertex score: recently used vertices and
+ * vertices with few triangles left are preferred.
+ */
+static float getVertexScore(int cachePosition, Uint32 remaining) {
+	if (remaining == 0)
+		return -1.0f;
+	float score = 0.0f;
+	if (cachePosition >= 0) {
+		if (cachePosition < 3)
+			score = 0.75f;
+		else
+			score = std::pow(1.0f - (cachePosition - 3) * (1.0f
+					/ (MeshOptimizer::CACHE_SIZE - 3)), 1.5f);
+	}
+	return score + 2.0f / std::sqrt(float(remaining));
+} // end getVertexScore()
+
+/*
+ * ForsythState - Scratch tables for ordering one group, reused across
+ * groups. Vertices are renumbered locally so the tables stay group sized.
+ */
+struct ForsythState {
+	/* Local number of each mesh vertex, NONE outside the current group */
+	std::vector<Uint32> local;
+	std::vector<Uint32> global;
+	std::vector<Uint32> triangles;
+	std::vector<Uint32> remaining;
+	std::vector<Uint32> adjacencyStart;
+	std::vector<Uint32> adjacency;
+	std::vector<int> cachePosition;
+	std::vector<float> vertexScore;
+	std::vector<float> triangleScore;
+	std::vector<bool> emitted;
+	std::vector<Uint32> cache;
+	std::vector<Uint32> newCache;
+};
+
+/*
+ * reorderGroup - Forsyth's linear-speed vertex cache optimization on the
+ * triangles of one index range.
+ */
+static void reorderGroup(Uint32 * indices, Uint32 numTriangles,
+		ForsythState& state) {
+	if (numTriangles < 2)
+		return;
+	const Uint32 CACHE_SIZE = MeshOptimizer::CACHE_SIZE;
+
+	state.global.clear();
+	state.triangles.resize(numTriangles * 3);
+	for (Uint32 i = 0; i < numTriangles * 3; ++i) {
+		Uint32& local = state.local[indices[i]];
+		if (local == NONE) {
+			local = static_cast<Uint32> (state.global.size());
+			state.global.push_back(indices[i]);
+		}
+		state.triangles[i] = local;
+	}
+	const Uint32 numVertices = static_cast<Uint32> (state.global.size());
+
+	state.remaining.assign(numVertices, 0);
+	for (Uint32 i = 0; i < numTriangles * 3; ++i)
+		++state.remaining[state.triangles[i]];
+	state.adjacencyStart.assign(numVertices + 1, 0);
+	for (Uint32 v = 0; v < numVertices; ++v)
+		state.adjacencyStart[v + 1] = state.adjacencyStart[v]
+				+ state.remaining[v];
+	state.adjacency.resize(numTriangles * 3);
+	std::vector<Uint32> fill(state.adjacencyStart.begin(),
+			state.adjacencyStart.end() - 1);
+	for (Uint32 i = 0; i < numTriangles * 3; ++i)
+		state.adjacency[fill[state.triangles[i]]++] = i / 3;
+
+	state.cachePosition.assign(numVertices, -1);
+	state.vertexScore.resize(numVertices);
+	for (Uint32 v = 0; v < numVertices; ++v)
+		state.vertexScore[v] = getVertexScore(-1, state.remaining[v]);
+	state.triangleScore.resize(numTriangles);
+	for (Uint32 t = 0; t < numTriangles; ++t)
+		state.triangleScore[t] = state.vertexScore[state.triangles[3 * t]]
+				+ state.vertexScore[state.triangles[3 * t + 1]]
+				+ state.vertexScore[state.triangles[3 * t + 2]];
+	state.emitted.assign(numTriangles, false);
+	state.cache.clear();
+
+	std::vector<Uint32> order;
+	order.reserve(numTriangles);
+	Uint32 cursor = 0;
+	while (order.size() < numTriangles) {
+		/* Best triangle touching the cache, else the next one in input order */
+		Uint32 best = NONE;
+		float bestScore = -FLT_MAX;
+		for (size_t c = 0; c < state.cache.size(); ++c) {
+			const Uint32 v = state.cache[c];
+			for (Uint32 a = state.adjacencyStart[v]; a
+					< state.adjacencyStart[v + 1]; ++a) {
+				const Uint32 t = state.adjacency[a];
+				if (!state.emitted[t] && state.triangleScore[t] > bestScore) {
+					best = t;
+					bestScore = state.triangleScore[t];
+				}
+			}
+		}
+		if (best == NONE) {
+			while (state.emitted[cursor])
+				++cursor;
+			best = cursor;
+		}
+		state.emitted[best] = true;
+		order.push_back(best);
+
+		/* Move the triangle's vertices to the front of the LRU cache: */
+		state.newCache.clear();
+		for (int k = 0; k < 3; ++k) {
+			const Uint32 v = state.triangles[3 * best + k];
+			--state.remaining[v];
+			state.newCache.push_back(v);
+		}
+		for (size_t c = 0; c < state.cache.size(); ++c) {
+			const Uint32 v = state.cache[c];
+			if (v != state.newCache[0] && v != state.newCache[1] && v
+					!= state.newCache[2])
+				state.newCache.push_back(v);
+		}
+		for (size_t c = 0; c < state.newCache.size(); ++c) {
+			const Uint32 v = state.newCache[c];
+			state.cachePosition[v] = c < CACHE_SIZE ? int(c) : -1;
+			state.vertexScore[v] = getVertexScore(state.cachePosition[v],
+					state.remaining[v]);
+		}
+		for (size_t c = 0; c < state.newCache.size(); ++c) {
+			const Uint32 v = state.newCache[c];
+			for (Uint32 a = state.adjacencyStart[v]; a
+					< state.adjacencyStart[v + 1]; ++a) {
+				const Uint32 t = state.adjacency[a];
+				if (!state.emitted[t])
+					state.triangleScore[t] = state.vertexScore[state.triangles[3
+							* t]] + state.vertexScore[state.triangles[3 * t
+							+ 1]] + state.vertexScore[state.triangles[3 * t
+							+ 2]];
+			}
+		}
+		if (state.newCache.size() > CACHE_SIZE)
+			state.newCache.resize(CACHE_SIZE);
+		state.cache.swap(state.newCache);
+	}
+
+	for (Uint32 t = 0; t < numTriangles; ++t)
+		for (int k = 0; k < 3; ++k)
+			indices[3 * t + k] = state.global[state.triangles[3 * order[t] + k]];
+	for (Uint32 v = 0; v < numVertices; ++v)
+		state.local[state.global[v]] = NONE;
+} // end reorderGroup()
+
+/*
+ * reorderVertices - Numbers the vertices in the order the index array first
+ * fetches them and drops the ones no triangle uses.
+ */
+static void reorderVertices(ParkMesh& mesh) {
+	std::vector<Uint32> remap(mesh.vertices.size(), NONE);
+	std::vector<ParkVertex> vertices;
+	vertices.reserve(mesh.vertices.size());
+	for (size_t i = 0; i < mesh.indices.size(); ++i) {
+		Uint32& index = remap[mesh.indices[i]];
+		if (index == NONE) {
+			index = static_cast<Uint32> (vertices.size());
+			vertices.push_back(mesh.vertices[mesh.indices[i]]);
+		}
+		mesh.indices[i] = index;
+	}
+	mesh.vertices.swap(vertices);
+} // end reorderVertices()
+
+/*******************************
+ Methods of class MeshOptimizer:
+ *******************************/
+
+/*
+ * optimize - Welds, cleans and reorders a mesh that has been through
+ * MaterialMerger::merge() but has no coarser cluster levels yet. Triangles
+ * are only reordered inside their group, so visibility per group keeps
+ * working on contiguous ranges.
+ *
+ * parameter mesh - ParkMesh&
+ */
+void MeshOptimizer::optimize(ParkMesh& mesh) {
+	const float minLength = weldVertices(mesh);
+	removeTriangles(mesh, minLength);
+
+	ForsythState state;
+	state.local.assign(mesh.vertices.size(), NONE);
+	for (size_t g = 0; g < mesh.groups.size(); ++g) {
+		const ParkGroup& group = mesh.groups[g];
+		if (group.numIndices != 0)
+			reorderGroup(&mesh.indices[group.firstIndex], group.numIndices / 3,
+					state);
+	}
+
+	reorderVertices(mesh);
+	mesh.computeBounds();
+} // end optimize()
+
+/*
+ * reorderTriangles - Orders a triangle list for the post-transform cache.
+ *
+ * parameter indices - Uint32 *, three per triangle, reordered in place
+ * parameter numTriangles - Uint32
+ * parameter numVertices - Uint32, bound on the indices
+ */
+void MeshOptimizer::reorderTriangles(Uint32 * indices, Uint32 numTriangles,
+		Uint32 numVertices) {
+	ForsythState state;
+	state.local.assign(numVertices, NONE);
+	reorderGroup(indices, numTriangles, state);
+} // end reorderTriangles()
+
+/*
+ * measure - Vertex and triangle counts, ACMR and geometry size of a mesh.
+ *
+ * parameter mesh - const ParkMesh&
+ * return - MeshStatistics
+ */
+MeshStatistics MeshOptimizer::measure(const ParkMesh& mesh) {
+	MeshStatistics statistics;
+	statistics.numVertices = static_cast<Uint32> (mesh.vertices.size());
+	statistics.numTriangles = mesh.getNumTriangles();
+	statistics.acmr = computeAcmr(mesh.indices, statistics.numVertices);
+	statistics.bytes = mesh.getGeometryBytes();
+	return statistics;
+} // end measure()
+
+/*
+ * computeAcmr - Simulates a FIFO post-transform cache over an index array.
+ *
+ * parameter indices - const std::vector<Uint32>&, triangle list
+ * parameter numVertices - Uint32
+ * parameter cacheSize - Uint32
+ * return - float, cache misses per triangle
+ */
+float MeshOptimizer::computeAcmr(const std::vector<Uint32>& indices,
+		Uint32 numVertices, Uint32 cacheSize) {
+	if (indices.size() < 3)
+		return 0.0f;
+	/* A vertex is cached while fewer than cacheSize misses followed its own */
+	std::vector<Uint32> missTime(numVertices, NONE);
+	Uint32 misses = 0;
+	for (size_t i = 0; i < indices.size(); ++i) {
+		Uint32& time = missTime[indices[i]];
+		if (time == NONE || misses - time >= cacheSize)
+			time = misses++;
+	}
+	return float(misses) / float(indices.size() / 3);
+} // end computeAcmr()
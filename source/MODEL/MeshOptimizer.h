@@ -0,0 +1,53 @@
+/*
+ * MeshOptimizer.h - Post-merge stage welding, cleaning and reordering the
+ * park mesh for the GPU vertex caches.
+ *
+ * Created: October 16, 2026
+ */
+
+#ifndef MESHOPTIMIZER_H_
+#define MESHOPTIMIZER_H_
+
+#include <cstddef>
+#include <vector>
+
+#include <UTIL/Types.h>
+
+/* Begin Forward declarations: */
+class ParkMesh;
+/* End Forward declarations: */
+
+/*
+ * MeshStatistics - Size and vertex cache efficiency of a mesh.
+ */
+struct MeshStatistics {
+	Uint32 numVertices;
+	Uint32 numTriangles;
+	/* Average cache miss ratio: transformed vertices per triangle */
+	float acmr;
+	size_t bytes;
+};
+
+/*
+ * MeshOptimizer - Welds vertices that agree in position, normal and texture
+ * coordinate within a tolerance, drops zero-area and repeated triangles,
+ * orders the triangles of every group for the post-transform cache (Forsyth)
+ * and finally numbers the vertices in the order they are fetched. Group and
+ * batch index ranges stay contiguous and group ids are kept.
+ */
+class MeshOptimizer {
+public:
+	/* Entries of the modeled post-transform cache, LRU for ordering */
+	static const Uint32 CACHE_SIZE = 32;
+	/* Entries of the FIFO cache the ACMR is measured with */
+	static const Uint32 FIFO_SIZE = 16;
+
+	static void optimize(ParkMesh& mesh);
+	static void reorderTriangles(Uint32 * indices, Uint32 numTriangles,
+			Uint32 numVertices);
+	static MeshStatistics measure(const ParkMesh& mesh);
+	static float computeAcmr(const std::vector<Uint32>& indices,
+			Uint32 numVertices, Uint32 cacheSize = FIFO_SIZE);
+};
+
+#endif /* MESHOPTIMIZER_H_ */
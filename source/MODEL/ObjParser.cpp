@@ -0,0 +1,814 @@
+/*
+ * ObjParser.cpp - Methods for the native parallel OBJ/MTL reader.
+ *
+ * Created: October 16, 2026
+ */
+
+/* System headers */
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <sstream>
+#include <vector>
+
+/* Application headers */
+#include <MODEL/ObjParser.h>
+#include <MODEL/ParkMesh.h>
+#include <SYNC/ThreadPool.h>
+#include <UTIL/MappedFile.h>
+#include <UTIL/ResourceException.h>
+
+/* Relative (negative) OBJ indices are stored as RELATIVE_BIAS plus the
+ * chunk-local zero-based index until the chunk offsets are known. */
+static const Int32 RELATIVE_BIAS = -(1 << 30);
+
+/* Chunks are never split below this size; smaller files parse serially. */
+static const size_t MIN_CHUNK_SIZE = 64 * 1024;
+
+/* Exact powers of ten representable in a double. */
+static const double POWERS_OF_TEN[] = { 1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6,
+		1e7, 1e8, 1e9, 1e10, 1e11, 1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18,
+		1e19, 1e20, 1e21, 1e22 };
+
+/*
+ * ChunkGroup - A run of triangles of one group and material in a chunk. An
+ * empty material name inherits the material in effect before the chunk.
+ * Corner positions count Int32 entries of ObjChunk::corners, three per
+ * triangle corner.
+ */
+struct ChunkGroup {
+	std::string material;
+	Uint32 firstCorner;
+	Uint32 numCorners;
+	Uint32 firstIndex;
+};
+
+/*
+ * ObjChunk - Input range and results of one parse task.
+ */
+struct ObjChunk {
+	const char * begin;
+	const char * end;
+	/* Tokenized statements */
+	std::vector<float> positions;
+	std::vector<float> normals;
+	std::vector<float> texCoords;
+	std::vector<Int32> corners;
+	std::vector<ChunkGroup> groups;
+	std::vector<std::string> libraries;
+	/* Offsets of the chunk's tables in the stitched tables */
+	Uint32 positionOffset;
+	Uint32 normalOffset;
+	Uint32 texCoordOffset;
+	/* Chunk-local results of the vertex building pass */
+	std::vector<ParkVertex> vertices;
+	std::vector<Uint32> indices;
+	Uint32 vertexOffset;
+	std::string error;
+};
+
+/*
+ * StitchedTables - Global attribute tables shared read-only by all chunks
+ * while building vertices.
+ */
+struct StitchedTables {
+	std::vector<float> positions;
+	std::vector<float> normals;
+	std::vector<float> texCoords;
+};
+
+/*
+ * isSpace - Blank within a statement.
+ */
+static inline bool isSpace(char c) {
+	return c == ' ' || c == '\t';
+} // end isSpace()
+
+/*
+ * skipSpace
+ */
+static inline const char * skipSpace(const char * cursor, const char * end) {
+	while (cursor < end && isSpace(*cursor))
+		++cursor;
+	return cursor;
+} // end skipSpace()
+
+/*
+ * nextLine - Returns the start of the line following the cursor.
+ */
+static inline const char * nextLine(const char * cursor, const char * end) {
+	const char * newline = static_cast<const char*> (std::memchr(cursor, '\n',
+			end - cursor));
+	return newline != 0 ? newline + 1 : end;
+} // end nextLine()
+
+/*
+ * lineArgument - Returns the rest of the statement, trimmed.
+ */
+static std::string lineArgument(const char * cursor, const char * end) {
+	cursor = skipSpace(cursor, end);
+	const char * last = cursor;
+	while (last < end && *last != '\n')
+		++last;
+	while (last > cursor && (isSpace(last[-1]) || last[-1] == '\r'))
+		--last;
+	return std::string(cursor, last);
+} // end lineArgument()
+
+/*
+ * isKeyword - Tells if the statement at the cursor starts with a keyword
+ * followed by a blank, ignoring case.
+ */
+static inline bool isKeyword(const char * cursor, const char * end,
+		const char * keyword) {
+	const size_t length = std::strlen(keyword);
+	if (static_cast<size_t> (end - cursor) <= length)
+		return false;
+	for (size_t i = 0; i < length; ++i) {
+		char c = cursor[i];
+		if (c >= 'A' && c <= 'Z')
+			c = c - 'A' + 'a';
+		if (c != keyword[i])
+			return false;
+	}
+	return isSpace(cursor[length]);
+} // end isKeyword()
+
+/*
+ * parseInt - Reads a signed decimal integer.
+ */
+static inline const char * parseInt(const char * cursor, const char * end,
+		Int32& value) {
+	bool negative = false;
+	if (cursor < end && (*cursor == '-' || *cursor == '+')) {
+		negative = *cursor == '-';
+		++cursor;
+	}
+	Int32 result = 0;
+	const char * start = cursor;
+	while (cursor < end && *cursor >= '0' && *cursor <= '9') {
+		result = result * 10 + (*cursor - '0');
+		++cursor;
+	}
+	if (cursor == start)
+		return 0;
+	value = negative ? -result : result;
+	return cursor;
+} // end parseInt()
+
+/*
+ * parseFloats - Reads up to count floats of a statement, leaving missing
+ * values untouched.
+ */
+static int parseFloats(const char * cursor, const char * end, float * values,
+		int count) {
+	int parsed = 0;
+	while (parsed < count) {
+		cursor = skipSpace(cursor, end);
+		const char * next = ObjParser::parseFloat(cursor, end, values[parsed]);
+		if (next == cursor)
+			break;
+		cursor = next;
+		++parsed;
+	}
+	return parsed;
+} // end parseFloats()
+
+/*
+ * encodeIndex - Converts an OBJ index to the chunk encoding: positive
+ * indices are global and kept, negative ones are made chunk-relative.
+ */
+static inline Int32 encodeIndex(Int32 index, size_t localCount) {
+	if (index > 0)
+		return index;
+	return RELATIVE_BIAS + static_cast<Int32> (localCount) + index;
+} // end encodeIndex()
+
+/*
+ * decodeIndex - Converts an encoded index to a zero-based global index, or
+ * -1 if the corner has no such attribute.
+ */
+static inline Int64 decodeIndex(Int32 index, Uint32 chunkOffset) {
+	if (index > 0)
+		return Int64(index) - 1;
+	if (index == 0)
+		return -1;
+	return Int64(chunkOffset) + (index - RELATIVE_BIAS);
+} // end decodeIndex()
+
+/*
+ * parseFace - Tokenizes an f statement and fans it into triangles.
+ */
+static bool parseFace(const char * cursor, const char * end, ObjChunk& chunk) {
+	Int32 polygon[3 * 64];
+	int numCorners = 0;
+	while (numCorners < 64) {
+		cursor = skipSpace(cursor, end);
+		if (cursor >= end || *cursor == '\n' || *cursor == '\r' || *cursor
+				== '#')
+			break;
+		Int32 v = 0, vt = 0, vn = 0;
+		cursor = parseInt(cursor, end, v);
+		if (cursor == 0 || v == 0)
+			return false;
+		if (cursor < end && *cursor == '/') {
+			++cursor;
+			if (cursor < end && *cursor != '/') {
+				const char * next = parseInt(cursor, end, vt);
+				if (next != 0)
+					cursor = next;
+			}
+			if (cursor < end && *cursor == '/') {
+				++cursor;
+				const char * next = parseInt(cursor, end, vn);
+				if (next != 0)
+					cursor = next;
+			}
+		}
+		polygon[3 * numCorners + 0] = encodeIndex(v, chunk.positions.size() / 3);
+		polygon[3 * numCorners + 1] = vt != 0 ? encodeIndex(vt,
+				chunk.texCoords.size() / 2) : 0;
+		polygon[3 * numCorners + 2] = vn != 0 ? encodeIndex(vn,
+				chunk.normals.size() / 3) : 0;
+		++numCorners;
+	}
+
+	for (int i = 1; i + 1 < numCorners; ++i) {
+		chunk.corners.insert(chunk.corners.end(), polygon, polygon + 3);
+		chunk.corners.insert(chunk.corners.end(), polygon + 3 * i, polygon + 3
+				* i + 6);
+	}
+	return numCorners >= 3;
+} // end parseFace()
+
+/*
+ * parseChunk - Tokenizes the statements of one chunk.
+ */
+static void parseChunk(ObjChunk& chunk) {
+	const char * cursor = chunk.begin;
+	const char * end = chunk.end;
+	Uint32 lineNumber = 0;
+
+	/* Statements before the first g belong to an implicit group: */
+	ChunkGroup group;
+	group.firstCorner = 0;
+	group.numCorners = 0;
+	group.firstIndex = 0;
+
+	while (cursor < end) {
+		const char * line = skipSpace(cursor, end);
+		cursor = nextLine(line, end);
+		++lineNumber;
+		if (line >= end)
+			break;
+
+		bool ok = true;
+		if (line[0] == 'v') {
+			float values[3] = { 0.0f, 0.0f, 0.0f };
+			if (isSpace(line[1])) {
+				ok = parseFloats(line + 2, end, values, 3) == 3;
+				chunk.positions.insert(chunk.positions.end(), values, values + 3);
+			} else if (line[1] == 'n' && isSpace(line[2])) {
+				ok = parseFloats(line + 3, end, values, 3) == 3;
+				chunk.normals.insert(chunk.normals.end(), values, values + 3);
+			} else if (line[1] == 't' && isSpace(line[2])) {
+				ok = parseFloats(line + 3, end, values, 2) >= 1;
+				chunk.texCoords.insert(chunk.texCoords.end(), values, values + 2);
+			}
+		} else if (line[0] == 'f' && isSpace(line[1])) {
+			ok = parseFace(line + 2, end, chunk);
+		} else if (line[0] == 'g' && (line + 1 == end || isSpace(line[1])
+				|| line[1] == '\n' || line[1] == '\r')) {
+			group.numCorners = static_cast<Uint32> (chunk.corners.size())
+					- group.firstCorner;
+			if (group.numCorners > 0)
+				chunk.groups.push_back(group);
+			/* A new group keeps the material in effect: */
+			group.firstCorner = static_cast<Uint32> (chunk.corners.size());
+		} else if (isKeyword(line, end, "usemtl")) {
+			group.numCorners = static_cast<Uint32> (chunk.corners.size())
+					- group.firstCorner;
+			if (group.numCorners > 0) {
+				chunk.groups.push_back(group);
+				group.firstCorner = static_cast<Uint32> (chunk.corners.size());
+			}
+			group.material = lineArgument(line + 6, end);
+		} else if (isKeyword(line, end, "mtllib")) {
+			chunk.libraries.push_back(lineArgument(line + 6, end));
+		}
+
+		if (!ok) {
+			std::ostringstream msg_stream;
+			msg_stream << "Malformed statement in chunk line " << lineNumber
+					<< ": " << lineArgument(line, end);
+			chunk.error = msg_stream.str();
+			return;
+		}
+	}
+
+	group.numCorners = static_cast<Uint32> (chunk.corners.size())
+			- group.firstCorner;
+	if (group.numCorners > 0)
+		chunk.groups.push_back(group);
+} // end parseChunk()
+
+/*
+ * CornerTable - Open addressing hash of (position, texcoord, normal) corners
+ * to chunk-local vertices. Bumping the generation empties it in O(1).
+ */
+class CornerTable {
+public:
+	CornerTable(size_t numCorners) :
+		generation(1) {
+		size_t size = 16;
+		while (size < 2 * numCorners)
+			size *= 2;
+		mask = size - 1;
+		slots.assign(size, Slot());
+	}
+
+	void clear(void) {
+		++generation;
+	}
+
+	/* Returns the slot for a key; slot.vertex is ~0 if it is new. */
+	Uint32& find(Int64 v, Int64 vt, Int64 vn) {
+		Uint64 hash = Uint64(v) * 0x9E3779B97F4A7C15ULL;
+		hash ^= Uint64(vt) * 0xC2B2AE3D27D4EB4FUL;
+		hash ^= Uint64(vn) * 0x165667B19E3779F9ULL;
+		size_t index = (hash ^ (hash >> 29)) & mask;
+		while (slots[index].generation == generation && (slots[index].v != v
+				|| slots[index].vt != vt || slots[index].vn != vn))
+			index = (index + 1) & mask;
+		Slot& slot = slots[index];
+		if (slot.generation != generation) {
+			slot.generation = generation;
+			slot.v = v;
+			slot.vt = vt;
+			slot.vn = vn;
+			slot.vertex = ~0U;
+		}
+		return slot.vertex;
+	}
+
+private:
+	struct Slot {
+		Int64 v;
+		Int64 vt;
+		Int64 vn;
+		Uint32 vertex;
+		Uint32 generation;
+		Slot(void) :
+			v(0), vt(0), vn(0), vertex(~0U), generation(0) {
+		}
+	};
+	std::vector<Slot> slots;
+	size_t mask;
+	Uint32 generation;
+};
+
+/*
+ * buildVertices - Resolves the corners of a chunk against the stitched
+ * tables and creates unique vertices per group, so the result does not
+ * depend on how the file was chunked. Corners without a normal get the
+ * area-weighted average of their group's faces' normals.
+ */
+static void buildVertices(ObjChunk& chunk, const StitchedTables& tables) {
+	const Int64 numPositions = tables.positions.size() / 3;
+	const Int64 numNormals = tables.normals.size() / 3;
+	const Int64 numTexCoords = tables.texCoords.size() / 2;
+
+	Uint32 largestGroup = 0;
+	for (std::vector<ChunkGroup>::const_iterator gIt = chunk.groups.begin(); gIt
+			!= chunk.groups.end(); ++gIt)
+		largestGroup = std::max(largestGroup, gIt->numCorners / 3);
+	CornerTable cornerTable(largestGroup);
+	std::vector<bool> smoothed;
+	chunk.indices.resize(chunk.corners.size() / 3);
+
+	for (std::vector<ChunkGroup>::const_iterator gIt = chunk.groups.begin(); gIt
+			!= chunk.groups.end(); ++gIt) {
+		cornerTable.clear();
+		for (size_t c = gIt->firstCorner; c < gIt->firstCorner
+				+ gIt->numCorners; c += 3) {
+			const Int64 v = decodeIndex(chunk.corners[c], chunk.positionOffset);
+			const Int64 vt = decodeIndex(chunk.corners[c + 1],
+					chunk.texCoordOffset);
+			const Int64 vn = decodeIndex(chunk.corners[c + 2],
+					chunk.normalOffset);
+			if (v < 0 || v >= numPositions || vt >= numTexCoords || vn
+					>= numNormals) {
+				chunk.error = "Face index out of range";
+				return;
+			}
+
+			Uint32& vertex = cornerTable.find(v, vt, vn);
+			if (vertex == ~0U) {
+				vertex = static_cast<Uint32> (chunk.vertices.size());
+				ParkVertex parkVertex;
+				for (int i = 0; i < 3; ++i) {
+					parkVertex.position[i] = tables.positions[3 * v + i];
+					parkVertex.normal[i] = vn >= 0 ? tables.normals[3 * vn + i]
+							: 0.0f;
+				}
+				parkVertex.texCoord[0] = vt >= 0 ? tables.texCoords[2 * vt]
+						: 0.0f;
+				parkVertex.texCoord[1] = vt >= 0 ? tables.texCoords[2 * vt + 1]
+						: 0.0f;
+				chunk.vertices.push_back(parkVertex);
+				smoothed.push_back(vn < 0);
+			}
+			chunk.indices[c / 3] = vertex;
+		}
+	}
+
+	/* Accumulate face normals into corners that did not specify one: */
+	bool anySmoothed = false;
+	for (size_t t = 0; t < chunk.indices.size(); t += 3) {
+		ParkVertex * corner[3];
+		bool needed = false;
+		for (int i = 0; i < 3; ++i) {
+			corner[i] = &chunk.vertices[chunk.indices[t + i]];
+			needed = needed || smoothed[chunk.indices[t + i]];
+		}
+		if (!needed)
+			continue;
+		anySmoothed = true;
+		float e1[3], e2[3];
+		for (int i = 0; i < 3; ++i) {
+			e1[i] = corner[1]->position[i] - corner[0]->position[i];
+			e2[i] = corner[2]->position[i] - corner[0]->position[i];
+		}
+		const float normal[3] = { e1[1] * e2[2] - e1[2] * e2[1], e1[2] * e2[0]
+				- e1[0] * e2[2], e1[0] * e2[1] - e1[1] * e2[0] };
+		for (int c = 0; c < 3; ++c) {
+			if (!smoothed[chunk.indices[t + c]])
+				continue;
+			for (int i = 0; i < 3; ++i)
+				corner[c]->normal[i] += normal[i];
+		}
+	}
+	if (anySmoothed) {
+		for (size_t v = 0; v < chunk.vertices.size(); ++v) {
+			if (!smoothed[v])
+				continue;
+			float * normal = chunk.vertices[v].normal;
+			const float length = std::sqrt(normal[0] * normal[0] + normal[1]
+					* normal[1] + normal[2] * normal[2]);
+			if (length > 0.0f) {
+				for (int i = 0; i < 3; ++i)
+					normal[i] /= length;
+			} else {
+				normal[2] = 1.0f;
+			}
+		}
+	}
+} // end buildVertices()
+
+/*
+ * ParseBody - parallelFor body tokenizing chunk i.
+ */
+struct ParseBody {
+	std::vector<ObjChunk>* chunks;
+	void operator()(unsigned int i) {
+		parseChunk((*chunks)[i]);
+	}
+};
+
+/*
+ * StitchBody - parallelFor body copying the tables of chunk i into the
+ * global tables.
+ */
+struct StitchBody {
+	std::vector<ObjChunk>* chunks;
+	StitchedTables* tables;
+	void operator()(unsigned int i) {
+		ObjChunk& chunk = (*chunks)[i];
+		std::copy(chunk.positions.begin(), chunk.positions.end(),
+				tables->positions.begin() + 3 * chunk.positionOffset);
+		std::copy(chunk.normals.begin(), chunk.normals.end(),
+				tables->normals.begin() + 3 * chunk.normalOffset);
+		std::copy(chunk.texCoords.begin(), chunk.texCoords.end(),
+				tables->texCoords.begin() + 2 * chunk.texCoordOffset);
+		std::vector<float>().swap(chunk.positions);
+		std::vector<float>().swap(chunk.normals);
+		std::vector<float>().swap(chunk.texCoords);
+	}
+};
+
+/*
+ * VertexBody - parallelFor body building the vertices of chunk i.
+ */
+struct VertexBody {
+	std::vector<ObjChunk>* chunks;
+	const StitchedTables* tables;
+	void operator()(unsigned int i) {
+		buildVertices((*chunks)[i], *tables);
+	}
+};
+
+/*
+ * MergeBody - parallelFor body copying chunk i's vertices and indices into
+ * the mesh.
+ */
+struct MergeBody {
+	std::vector<ObjChunk>* chunks;
+	ParkMesh* mesh;
+	void operator()(unsigned int i) {
+		ObjChunk& chunk = (*chunks)[i];
+		std::copy(chunk.vertices.begin(), chunk.vertices.end(),
+				mesh->vertices.begin() + chunk.vertexOffset);
+		Uint32 * indices = &mesh->indices[0];
+		for (std::vector<ChunkGroup>::const_iterator gIt = chunk.groups.begin(); gIt
+				!= chunk.groups.end(); ++gIt) {
+			for (Uint32 c = 0; c < gIt->numCorners / 3; ++c)
+				indices[gIt->firstIndex + c] = chunk.indices[gIt->firstCorner
+						/ 3 + c] + chunk.vertexOffset;
+		}
+	}
+};
+
+/*
+ * splitChunks - Cuts the file into roughly equal ranges that each start at a
+ * g statement (or at the start of the file).
+ */
+static void splitChunks(const char * data, size_t size,
+		unsigned int numChunks, std::vector<ObjChunk>& chunks) {
+	const char * end = data + size;
+	const char * begin = data;
+	for (unsigned int i = 1; i <= numChunks && begin < end; ++i) {
+		const char * split = end;
+		if (i < numChunks) {
+			split = data + size / numChunks * i;
+			if (split < begin)
+				split = begin;
+			/* Advance to the next line that starts a group: */
+			while (split < end) {
+				split = nextLine(split, end);
+				if (split < end && split[0] == 'g' && (split + 1 == end
+						|| isSpace(split[1]) || split[1] == '\n' || split[1]
+						== '\r'))
+					break;
+			}
+		}
+		if (split > begin) {
+			ObjChunk chunk;
+			chunk.begin = begin;
+			chunk.end = split;
+			chunks.push_back(chunk);
+			begin = split;
+		}
+	}
+} // end splitChunks()
+
+/*******************************
+ Methods of class ObjParser:
+ *******************************/
+
+/*
+ * parseFloat - Locale-independent decimal float reader. Handles an optional
+ * sign, fraction and exponent; mantissa digits beyond the nineteenth only
+ * shift the exponent.
+ *
+ * parameter cursor - const char *
+ * parameter end - const char *
+ * parameter value - float&, untouched if no number was read
+ * return - const char *, the first character after the number or cursor
+ */
+const char * ObjParser::parseFloat(const char * cursor, const char * end,
+		float& value) {
+	const char * start = cursor;
+	bool negative = false;
+	if (cursor < end && (*cursor == '-' || *cursor == '+')) {
+		negative = *cursor == '-';
+		++cursor;
+	}
+
+	Uint64 mantissa = 0;
+	int exponent = 0;
+	int digits = 0;
+	bool any = false;
+	while (cursor < end && *cursor >= '0' && *cursor <= '9') {
+		if (digits < 19) {
+			mantissa = mantissa * 10 + (*cursor - '0');
+			if (mantissa != 0)
+				++digits;
+		} else {
+			++exponent;
+		}
+		any = true;
+		++cursor;
+	}
+	if (cursor < end && *cursor == '.') {
+		++cursor;
+		while (cursor < end && *cursor >= '0' && *cursor <= '9') {
+			if (digits < 19) {
+				mantissa = mantissa * 10 + (*cursor - '0');
+				if (mantissa != 0)
+					++digits;
+				--exponent;
+			}
+			any = true;
+			++cursor;
+		}
+	}
+	if (!any)
+		return start;
+
+	if (cursor < end && (*cursor == 'e' || *cursor == 'E')) {
+		Int32 exponentValue = 0;
+		const char * next = parseInt(cursor + 1, end, exponentValue);
+		if (next != 0) {
+			exponent += exponentValue;
+			cursor = next;
+		}
+	}
+
+	double result = static_cast<double> (mantissa);
+	if (mantissa != 0) {
+		while (exponent > 22) {
+			result *= 1e22;
+			exponent -= 22;
+		}
+		while (exponent < -22) {
+			result /= 1e22;
+			exponent += 22;
+		}
+		if (exponent >= 0)
+			result *= POWERS_OF_TEN[exponent];
+		else
+			result /= POWERS_OF_TEN[-exponent];
+	}
+
+	value = static_cast<float> (negative ? -result : result);
+	return cursor;
+} // end parseFloat()
+
+/*
+ * parseMaterials - Appends the materials of an MTL file to the mesh. Keywords
+ * are matched without regard to case since exporters disagree on it.
+ *
+ * parameter path - const std::string&
+ * parameter mesh - ParkMesh&
+ * parameter materialIndices - std::map<std::string, Uint32>&, name lookup
+ *
+ * throw ResourceException if the file cannot be read.
+ */
+void ObjParser::parseMaterials(const std::string& path, ParkMesh& mesh,
+		std::map<std::string, Uint32>& materialIndices) {
+	MappedFile file(path);
+	const char * cursor = file.getData();
+	const char * end = cursor + file.getSize();
+	ParkMaterial * material = 0;
+
+	while (cursor < end) {
+		const char * line = skipSpace(cursor, end);
+		cursor = nextLine(line, end);
+
+		if (isKeyword(line, end, "newmtl")) {
+			const std::string name = lineArgument(line + 6, end);
+			std::map<std::string, Uint32>::iterator mIt = materialIndices.find(
+					name);
+			if (mIt == materialIndices.end()) {
+				mIt = materialIndices.insert(std::make_pair(name,
+						static_cast<Uint32> (mesh.materials.size()))).first;
+				mesh.materials.push_back(ParkMaterial());
+				mesh.materials.back().name = name;
+			}
+			material = &mesh.materials[mIt->second];
+		} else if (material == 0) {
+			continue;
+		} else if (isKeyword(line, end, "ka")) {
+			parseFloats(line + 2, end, material->ambient, 3);
+		} else if (isKeyword(line, end, "kd")) {
+			parseFloats(line + 2, end, material->diffuse, 3);
+		} else if (isKeyword(line, end, "ks")) {
+			parseFloats(line + 2, end, material->specular, 3);
+		} else if (isKeyword(line, end, "d")) {
+			parseFloats(line + 1, end, &material->diffuse[3], 1);
+		} else if (isKeyword(line, end, "tr")) {
+			float transparency = 0.0f;
+			parseFloats(line + 2, end, &transparency, 1);
+			material->diffuse[3] = 1.0f - transparency;
+		} else if (isKeyword(line, end, "ns")) {
+			parseFloats(line + 2, end, &material->shininess, 1);
+		} else if (isKeyword(line, end, "illum")) {
+			Int32 illum = material->illum;
+			parseInt(skipSpace(line + 5, end), end, illum);
+			material->illum = illum;
+		} else if (isKeyword(line, end, "map_kd")) {
+			material->texture = lineArgument(line + 6, end);
+		}
+	}
+} // end parseMaterials()
+
+/*
+ * parse - Reads an OBJ file and its material libraries into the mesh. The
+ * mesh gets one group per (g, usemtl) run, in file order.
+ *
+ * parameter modelDirectory - const std::string&
+ * parameter objFile - const std::string&
+ * parameter mesh - ParkMesh&
+ * parameter pool - ThreadPool&, workers for the parallel passes
+ *
+ * throw ResourceException if a file cannot be read or is malformed.
+ */
+void ObjParser::parse(const std::string& modelDirectory,
+		const std::string& objFile, ParkMesh& mesh, ThreadPool& pool) {
+	const std::string path = modelDirectory + "/" + objFile;
+	MappedFile file(path);
+	mesh.clear();
+
+	/* Pass 1: tokenize chunks concurrently. */
+	unsigned int numChunks = 4 * pool.getNumThreads();
+	if (file.getSize() / numChunks < MIN_CHUNK_SIZE)
+		numChunks = static_cast<unsigned int> (file.getSize() / MIN_CHUNK_SIZE)
+				+ 1;
+	std::vector<ObjChunk> chunks;
+	splitChunks(file.getData(), file.getSize(), numChunks, chunks);
+	ParseBody parseBody;
+	parseBody.chunks = &chunks;
+	pool.parallelFor(static_cast<unsigned int> (chunks.size()), parseBody);
+
+	/* Stitch: chunk offsets, inherited materials and libraries, serially. */
+	Uint32 numPositions = 0, numNormals = 0, numTexCoords = 0;
+	std::vector<std::string> libraries;
+	std::string material;
+	for (std::vector<ObjChunk>::iterator cIt = chunks.begin(); cIt
+			!= chunks.end(); ++cIt) {
+		if (!cIt->error.empty())
+			throw ResourceException(path + ": " + cIt->error, LOCATION);
+		cIt->positionOffset = numPositions;
+		cIt->normalOffset = numNormals;
+		cIt->texCoordOffset = numTexCoords;
+		numPositions += static_cast<Uint32> (cIt->positions.size() / 3);
+		numNormals += static_cast<Uint32> (cIt->normals.size() / 3);
+		numTexCoords += static_cast<Uint32> (cIt->texCoords.size() / 2);
+		libraries.insert(libraries.end(), cIt->libraries.begin(),
+				cIt->libraries.end());
+		for (std::vector<ChunkGroup>::iterator gIt = cIt->groups.begin(); gIt
+				!= cIt->groups.end(); ++gIt) {
+			if (gIt->material.empty())
+				gIt->material = material;
+			material = gIt->material;
+		}
+	}
+
+	std::map<std::string, Uint32> materialIndices;
+	for (std::vector<std::string>::iterator lIt = libraries.begin(); lIt
+			!= libraries.end(); ++lIt)
+		parseMaterials(modelDirectory + "/" + *lIt, mesh, materialIndices);
+
+	StitchedTables tables;
+	tables.positions.resize(3 * size_t(numPositions));
+	tables.normals.resize(3 * size_t(numNormals));
+	tables.texCoords.resize(2 * size_t(numTexCoords));
+	StitchBody stitchBody;
+	stitchBody.chunks = &chunks;
+	stitchBody.tables = &tables;
+	pool.parallelFor(static_cast<unsigned int> (chunks.size()), stitchBody);
+
+	/* Pass 2: resolve corners to unique vertices concurrently. */
+	VertexBody vertexBody;
+	vertexBody.chunks = &chunks;
+	vertexBody.tables = &tables;
+	pool.parallelFor(static_cast<unsigned int> (chunks.size()), vertexBody);
+
+	/* Lay out groups and vertices, then copy the chunks in concurrently. */
+	Uint32 numVertices = 0, numIndices = 0;
+	for (std::vector<ObjChunk>::iterator cIt = chunks.begin(); cIt
+			!= chunks.end(); ++cIt) {
+		if (!cIt->error.empty())
+			throw ResourceException(path + ": " + cIt->error, LOCATION);
+		cIt->vertexOffset = numVertices;
+		numVertices += static_cast<Uint32> (cIt->vertices.size());
+		for (std::vector<ChunkGroup>::iterator gIt = cIt->groups.begin(); gIt
+				!= cIt->groups.end(); ++gIt) {
+			std::map<std::string, Uint32>::iterator mIt = materialIndices.find(
+					gIt->material);
+			if (mIt == materialIndices.end()) {
+				/* Unknown or missing material: use OBJ defaults. */
+				mIt = materialIndices.insert(std::make_pair(gIt->material,
+						static_cast<Uint32> (mesh.materials.size()))).first;
+				mesh.materials.push_back(ParkMaterial());
+				mesh.materials.back().name = gIt->material;
+			}
+			ParkGroup group;
+			group.material = mIt->second;
+			group.firstIndex = numIndices;
+			group.numIndices = gIt->numCorners / 3;
+			gIt->firstIndex = numIndices;
+			numIndices += group.numIndices;
+			mesh.groups.push_back(group);
+		}
+	}
+
+	mesh.vertices.resize(numVertices);
+	mesh.indices.resize(numIndices);
+	MergeBody mergeBody;
+	mergeBody.chunks = &chunks;
+	mergeBody.mesh = &mesh;
+	pool.parallelFor(static_cast<unsigned int> (chunks.size()), mergeBody);
+
+	mesh.computeBounds();
+} // end parse()
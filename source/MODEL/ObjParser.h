@@ -0,0 +1,36 @@
+/*
+ * ObjParser.h - Native parallel reader for Wavefront OBJ/MTL park models.
+ *
+ * Created: October 16, 2026
+ */
+
+#ifndef OBJPARSER_H_
+#define OBJPARSER_H_
+
+#include <map>
+#include <string>
+
+#include <UTIL/Types.h>
+
+/* Begin Forward declarations: */
+class ParkMesh;
+class ThreadPool;
+/* End Forward declarations: */
+
+/*
+ * ObjParser - Maps the OBJ file, splits it at group statements into chunks
+ * that are tokenized concurrently, then stitches the chunk-local vertex,
+ * normal and texture coordinate tables into one ParkMesh. Numbers are read
+ * with a locale-independent parser, so results do not depend on LC_NUMERIC.
+ */
+class ObjParser {
+public:
+	static void parse(const std::string& modelDirectory,
+			const std::string& objFile, ParkMesh& mesh, ThreadPool& pool);
+	static void parseMaterials(const std::string& path, ParkMesh& mesh,
+			std::map<std::string, Uint32>& materialIndices);
+	static const char * parseFloat(const char * cursor, const char * end,
+			float& value);
+};
+
+#endif /* OBJPARSER_H_ */
@@ -0,0 +1,599 @@
+/*
+ * OcclusionCuller.cpp - Methods for choosing the park's occluders, drawing
+ * them into masked depth buffers and testing cluster boxes against those.
+ *
+ * Created: October 16, 2026
+ */
+
+/* System headers */
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <utility>
+#include <vector>
+
+/* Application headers */
+#include <MODEL/ClusterCuller.h>
+#include <MODEL/OcclusionCuller.h>
+#include <MODEL/ParkMesh.h>
+#include <SYNC/ThreadPool.h>
+#include <UTIL/System.h>
+
+static const Uint32 TILES_X = OcclusionCuller::WIDTH
+		/ OcclusionCuller::TILE_WIDTH;
+static const Uint32 TILES_Y = OcclusionCuller::HEIGHT
+		/ OcclusionCuller::TILE_HEIGHT;
+static const Uint32 FULL_MASK = 0xffffffffu;
+/* Occluders set up per task, and tile rows rasterized per task */
+static const Uint32 CHUNK_TRIANGLES = 1024;
+static const Uint32 BAND_TILE_ROWS = 4;
+/* Clipping a triangle against the near and four side planes leaves at most
+ * eight corners */
+static const int MAX_POLYGON = 8;
+/* Smallest w kept after clipping */
+static const float MIN_W = 1.0e-6f;
+
+/*
+ * now - Wall clock in seconds.
+ */
+static double now(void) {
+	TimeVal time;
+	SystemPosix::gettimeofday(&time);
+	return time.tv_sec + time.tv_usec * 1.0e-6;
+} // end now()
+
+/*
+ * transformPoint - Clip coordinates of a mesh point.
+ */
+static void transformPoint(const float clipMatrix[16], const float point[3],
+		float clip[4]) {
+	for (int i = 0; i < 4; ++i)
+		clip[i] = clipMatrix[i] * point[0] + clipMatrix[4 + i] * point[1]
+				+ clipMatrix[8 + i] * point[2] + clipMatrix[12 + i];
+} // end transformPoint()
+
+/*
+ * planeDistance - Signed distance of a clip coordinate point from the near
+ * plane (0) or the left, right, bottom and top planes (1 to 4).
+ */
+static float planeDistance(int plane, const float clip[4]) {
+	switch (plane) {
+	case 0:
+		return clip[3] + clip[2];
+	case 1:
+		return clip[3] + clip[0];
+	case 2:
+		return clip[3] - clip[0];
+	case 3:
+		return clip[3] + clip[1];
+	default:
+		return clip[3] - clip[1];
+	}
+} // end planeDistance()
+
+/*
+ * clipPolygon - Clips a convex polygon in clip coordinates against the near
+ * and side planes that some corner lies outside of.
+ *
+ * return - int, number of corners left
+ */
+static int clipPolygon(float polygon[MAX_POLYGON][4], int numCorners,
+		int outsidePlanes) {
+	for (int plane = 0; plane < 5 && numCorners > 0; ++plane) {
+		if ((outsidePlanes & (1 << plane)) == 0)
+			continue;
+		float clipped[MAX_POLYGON][4];
+		int numClipped = 0;
+		for (int c = 0; c < numCorners; ++c) {
+			const float * from = polygon[c];
+			const float * to = polygon[(c + 1) % numCorners];
+			const float fromDistance = planeDistance(plane, from);
+			const float toDistance = planeDistance(plane, to);
+			if (fromDistance >= 0.0f)
+				std::copy(from, from + 4, clipped[numClipped++]);
+			if ((fromDistance >= 0.0f) != (toDistance >= 0.0f)) {
+				const float t = fromDistance / (fromDistance - toDistance);
+				for (int i = 0; i < 4; ++i)
+					clipped[numClipped][i] = from[i] + t * (to[i] - from[i]);
+				++numClipped;
+			}
+		}
+		for (int c = 0; c < numClipped; ++c)
+			std::copy(clipped[c], clipped[c] + 4, polygon[c]);
+		numCorners = numClipped;
+	}
+	return numCorners;
+} // end clipPolygon()
+
+/*
+ * setupTriangle - Sets up a triangle of buffer coordinates for rasterizing.
+ *
+ * parameter corners - const float[3][3], pixel x, y and window depth
+ * return - bool, false if it covers no area
+ */
+static bool setupTriangle(const float corners[3][3],
+		OcclusionTriangle& triangle) {
+	const float * a = corners[0];
+	const float * b = corners[1];
+	const float * c = corners[2];
+	const float area = (b[0] - a[0]) * (c[1] - a[1]) - (c[0] - a[0]) * (b[1]
+			- a[1]);
+	if (!(std::fabs(area) > 1.0e-8f))
+		return false;
+	const float sign = area > 0.0f ? 1.0f : -1.0f;
+	for (int e = 0; e < 3; ++e) {
+		const float * from = corners[e];
+		const float * to = corners[(e + 1) % 3];
+		triangle.edges[e][0] = sign * (from[1] - to[1]);
+		triangle.edges[e][1] = sign * (to[0] - from[0]);
+		triangle.edges[e][2] = sign * (from[0] * to[1] - to[0] * from[1]);
+	}
+	/* Depth plane z = depth[0] + depth[1] * x + depth[2] * y: */
+	triangle.depth[1] = ((b[2] - a[2]) * (c[1] - a[1]) - (c[2] - a[2]) * (b[1]
+			- a[1])) / area;
+	triangle.depth[2] = ((c[2] - a[2]) * (b[0] - a[0]) - (b[2] - a[2]) * (c[0]
+			- a[0])) / area;
+	triangle.depth[0] = a[2] - triangle.depth[1] * a[0] - triangle.depth[2]
+			* a[1];
+	triangle.maxDepth = std::max(a[2], std::max(b[2], c[2]));
+	for (int i = 0; i < 2; ++i) {
+		const float low = std::min(a[i], std::min(b[i], c[i]));
+		const float high = std::max(a[i], std::max(b[i], c[i]));
+		triangle.pixelMin[i] = static_cast<Int32> (std::floor(low));
+		triangle.pixelMax[i] = static_cast<Int32> (std::floor(high));
+	}
+	triangle.pixelMax[0] = std::min(triangle.pixelMax[0],
+			Int32(OcclusionCuller::WIDTH) - 1);
+	triangle.pixelMax[1] = std::min(triangle.pixelMax[1],
+			Int32(OcclusionCuller::HEIGHT) - 1);
+	triangle.pixelMin[0] = std::max(triangle.pixelMin[0], 0);
+	triangle.pixelMin[1] = std::max(triangle.pixelMin[1], 0);
+	return triangle.pixelMin[0] <= triangle.pixelMax[0] && triangle.pixelMin[1]
+			<= triangle.pixelMax[1];
+} // end setupTriangle()
+
+/*
+ * getSpan - Pixels of a row whose centers a triangle covers.
+ *
+ * return - bool, false if none
+ */
+static bool getSpan(const OcclusionTriangle& triangle, Int32 y, Int32& first,
+		Int32& last) {
+	const float center = y + 0.5f;
+	float low = triangle.pixelMin[0] + 0.5f;
+	float high = triangle.pixelMax[0] + 0.5f;
+	for (int e = 0; e < 3; ++e) {
+		const float * edge = triangle.edges[e];
+		const float offset = edge[1] * center + edge[2];
+		if (edge[0] > 0.0f)
+			low = std::max(low, -offset / edge[0]);
+		else if (edge[0] < 0.0f)
+			high = std::min(high, -offset / edge[0]);
+		else if (offset < 0.0f)
+			return false;
+	}
+	if (!(low <= high))
+		return false;
+	first = static_cast<Int32> (std::ceil(low - 0.5f));
+	last = static_cast<Int32> (std::floor(high - 0.5f));
+	return first <= last;
+} // end getSpan()
+
+/*
+ * updateTile - Merges a triangle's coverage of a tile into the tile's two
+ * layers. A full working layer becomes the new base layer.
+ *
+ * parameter coverage - Uint32, bit 8 * row + column per covered pixel
+ * parameter depth - float, farthest depth of the triangle in the tile
+ */
+static void updateTile(OcclusionTile& tile, Uint32 coverage, float depth) {
+	if (depth >= tile.zMax0)
+		return;
+	if (coverage == FULL_MASK) {
+		tile.zMax0 = depth;
+		if (tile.zMax1 >= depth) {
+			tile.zMax1 = 0.0f;
+			tile.mask = 0;
+		}
+		return;
+	}
+	tile.zMax1 = std::max(tile.zMax1, depth);
+	tile.mask |= coverage;
+	if (tile.mask == FULL_MASK) {
+		tile.zMax0 = tile.zMax1;
+		tile.zMax1 = 0.0f;
+		tile.mask = 0;
+	}
+} // end updateTile()
+
+/*
+ * SetupOccluders - parallelFor body transforming, clipping and setting up
+ * one chunk of occluders per index.
+ */
+struct SetupOccluders {
+	const std::vector<float>& occluders;
+	const std::vector<Uint32>& occluderGroups;
+	const std::vector<bool>& groupVisibility;
+	const std::vector<float>& clipPlanes;
+	const float * clipMatrix;
+	OcclusionBuffer& buffer;
+
+	SetupOccluders(const std::vector<float>& _occluders,
+			const std::vector<Uint32>& _occluderGroups,
+			const std::vector<bool>& _groupVisibility,
+			const std::vector<float>& _clipPlanes, const float * _clipMatrix,
+			OcclusionBuffer& _buffer) :
+		occluders(_occluders), occluderGroups(_occluderGroups),
+				groupVisibility(_groupVisibility), clipPlanes(_clipPlanes),
+				clipMatrix(_clipMatrix), buffer(_buffer) {
+	}
+
+	bool isCut(const float * triangle) const {
+		for (size_t p = 0; p < clipPlanes.size(); p += 4)
+			for (int c = 0; c < 3; ++c)
+				if (clipPlanes[p] * triangle[3 * c] + clipPlanes[p + 1]
+						* triangle[3 * c + 1] + clipPlanes[p + 2] * triangle[3
+						* c + 2] + clipPlanes[p + 3] < 0.0f)
+					return true;
+		return false;
+	}
+
+	void operator()(unsigned int chunk) {
+		std::vector<OcclusionTriangle>& triangles = buffer.chunks[chunk];
+		triangles.clear();
+		const Uint32 end = std::min(Uint32(occluderGroups.size()), (chunk + 1)
+				* CHUNK_TRIANGLES);
+		for (Uint32 t = chunk * CHUNK_TRIANGLES; t < end; ++t) {
+			const Uint32 group = occluderGroups[t];
+			if ((group < groupVisibility.size() && !groupVisibility[group])
+					|| isCut(&occluders[9 * t]))
+				continue;
+			float polygon[MAX_POLYGON][4];
+			int outside[3];
+			for (int c = 0; c < 3; ++c) {
+				transformPoint(clipMatrix, &occluders[9 * t + 3 * c], polygon[c]);
+				outside[c] = 0;
+				for (int plane = 0; plane < 5; ++plane)
+					if (planeDistance(plane, polygon[c]) < 0.0f)
+						outside[c] |= 1 << plane;
+			}
+			if ((outside[0] & outside[1] & outside[2]) != 0)
+				continue;
+			const int numCorners = clipPolygon(polygon, 3, outside[0]
+					| outside[1] | outside[2]);
+
+			/* To buffer pixels and window depth, then fan into triangles: */
+			float corners[MAX_POLYGON][3];
+			bool valid = numCorners >= 3;
+			for (int c = 0; c < numCorners && valid; ++c) {
+				const float w = polygon[c][3];
+				valid = w > MIN_W;
+				corners[c][0] = (polygon[c][0] / w + 1.0f) * 0.5f
+						* OcclusionCuller::WIDTH;
+				corners[c][1] = (polygon[c][1] / w + 1.0f) * 0.5f
+						* OcclusionCuller::HEIGHT;
+				corners[c][2] = std::max(0.0f, std::min(1.0f, (polygon[c][2]
+						/ w + 1.0f) * 0.5f));
+			}
+			if (!valid)
+				continue;
+			for (int c = 2; c < numCorners; ++c) {
+				float fan[3][3];
+				std::copy(corners[0], corners[0] + 3, fan[0]);
+				std::copy(corners[c - 1], corners[c - 1] + 3, fan[1]);
+				std::copy(corners[c], corners[c] + 3, fan[2]);
+				OcclusionTriangle triangle;
+				if (setupTriangle(fan, triangle))
+					triangles.push_back(triangle);
+			}
+		}
+	}
+};
+
+/*
+ * RasterizeBand - parallelFor body drawing all set up triangles, in
+ * occluder order, into one band of tile rows per index.
+ */
+struct RasterizeBand {
+	OcclusionBuffer& buffer;
+
+	RasterizeBand(OcclusionBuffer& _buffer) :
+		buffer(_buffer) {
+	}
+
+	void operator()(unsigned int band) {
+		const Int32 bandMin = band * BAND_TILE_ROWS
+				* OcclusionCuller::TILE_HEIGHT;
+		const Int32 bandMax = bandMin + BAND_TILE_ROWS
+				* OcclusionCuller::TILE_HEIGHT - 1;
+		for (size_t chunk = 0; chunk < buffer.chunks.size(); ++chunk) {
+			const std::vector<OcclusionTriangle>& triangles =
+					buffer.chunks[chunk];
+			for (size_t t = 0; t < triangles.size(); ++t) {
+				const OcclusionTriangle& triangle = triangles[t];
+				if (triangle.pixelMax[1] < bandMin || triangle.pixelMin[1]
+						> bandMax)
+					continue;
+				const Int32 rowMin = std::max(triangle.pixelMin[1], bandMin);
+				const Int32 rowMax = std::min(triangle.pixelMax[1], bandMax);
+				for (Int32 tileY = rowMin / Int32(OcclusionCuller::TILE_HEIGHT); tileY
+						<= rowMax / Int32(OcclusionCuller::TILE_HEIGHT); ++tileY)
+					drawTileRow(triangle, tileY);
+			}
+		}
+	}
+
+	void drawTileRow(const OcclusionTriangle& triangle, Int32 tileY) {
+		const Int32 tileHeight = OcclusionCuller::TILE_HEIGHT;
+		const Int32 tileWidth = OcclusionCuller::TILE_WIDTH;
+		Int32 first[OcclusionCuller::TILE_HEIGHT];
+		Int32 last[OcclusionCuller::TILE_HEIGHT];
+		Int32 columnMin = OcclusionCuller::WIDTH;
+		Int32 columnMax = -1;
+		for (Int32 row = 0; row < tileHeight; ++row) {
+			if (!getSpan(triangle, tileY * tileHeight + row, first[row],
+					last[row])) {
+				first[row] = 0;
+				last[row] = -1;
+				continue;
+			}
+			columnMin = std::min(columnMin, first[row]);
+			columnMax = std::max(columnMax, last[row]);
+		}
+		for (Int32 tileX = std::max(columnMin, 0) / tileWidth; tileX
+				<= columnMax / tileWidth; ++tileX) {
+			const Int32 left = tileX * tileWidth;
+			Uint32 coverage = 0;
+			for (Int32 row = 0; row < tileHeight; ++row) {
+				const Int32 low = std::max(first[row], left);
+				const Int32 high = std::min(last[row], left + tileWidth - 1);
+				if (low <= high)
+					coverage |= ((0xffu >> (tileWidth - 1 - (high - low)))
+							<< (low - left)) << (row * tileWidth);
+			}
+			if (coverage == 0)
+				continue;
+			/* Farthest point of the depth plane over the tile: */
+			const float x = triangle.depth[1] > 0.0f ? left + tileWidth : left;
+			const float y = triangle.depth[2] > 0.0f ? (tileY + 1) * tileHeight
+					: tileY * tileHeight;
+			const float depth = std::min(triangle.maxDepth, triangle.depth[0]
+					+ triangle.depth[1] * x + triangle.depth[2] * y);
+			updateTile(buffer.tiles[tileY * TILES_X + tileX], coverage, depth);
+		}
+	}
+};
+
+/*
+ * TriangleIsLarger - Orders occluder candidates by decreasing area.
+ */
+struct TriangleIsLarger {
+	bool operator()(const std::pair<float, Uint32>& a, const std::pair<float,
+			Uint32>& b) const {
+		return a.first > b.first || (a.first == b.first && a.second < b.second);
+	}
+};
+
+/*******************************
+ Methods of class OcclusionCuller:
+ *******************************/
+
+/*
+ * OcclusionCuller constructor
+ */
+OcclusionCuller::OcclusionCuller(void) {
+} // end OcclusionCuller()
+
+/*
+ * ~OcclusionCuller
+ */
+OcclusionCuller::~OcclusionCuller(void) {
+} // end ~OcclusionCuller()
+
+/*
+ * build - Chooses the occluders of a mesh: the MAX_OCCLUDER_TRIANGLES
+ * largest triangles of the batches with opaque materials, at full detail.
+ *
+ * parameter mesh - const ParkMesh&, merged, with cluster bounds computed
+ */
+void OcclusionCuller::build(const ParkMesh& mesh) {
+	clear();
+	std::vector<std::pair<float, Uint32> > candidates;
+	for (std::vector<ParkBatch>::const_iterator bIt = mesh.batches.begin(); bIt
+			!= mesh.batches.end(); ++bIt) {
+		if (mesh.materials[bIt->material].isTransparent())
+			continue;
+		for (Uint32 index = bIt->firstIndex; index < bIt->firstIndex
+				+ bIt->numIndices; index += 3) {
+			const float * a = mesh.vertices[mesh.indices[index]].position;
+			const float * b = mesh.vertices[mesh.indices[index + 1]].position;
+			const float * c = mesh.vertices[mesh.indices[index + 2]].position;
+			float cross[3];
+			for (int i = 0; i < 3; ++i) {
+				const int j = (i + 1) % 3;
+				const int k = (i + 2) % 3;
+				cross[i] = (b[j] - a[j]) * (c[k] - a[k]) - (b[k] - a[k]) * (c[j]
+						- a[j]);
+			}
+			candidates.push_back(std::make_pair(cross[0] * cross[0] + cross[1]
+					* cross[1] + cross[2] * cross[2], index / 3));
+		}
+	}
+	if (candidates.size() > MAX_OCCLUDER_TRIANGLES) {
+		std::nth_element(candidates.begin(), candidates.begin()
+				+ MAX_OCCLUDER_TRIANGLES, candidates.end(), TriangleIsLarger());
+		candidates.resize(MAX_OCCLUDER_TRIANGLES);
+	}
+	/* Draw the largest first, so they fill the tiles' base layers: */
+	std::sort(candidates.begin(), candidates.end(), TriangleIsLarger());
+
+	occluders.reserve(9 * candidates.size());
+	occluderGroups.reserve(candidates.size());
+	for (size_t t = 0; t < candidates.size(); ++t) {
+		const Uint32 triangle = candidates[t].second;
+		for (int c = 0; c < 3; ++c) {
+			const float * position =
+					mesh.vertices[mesh.indices[3 * triangle + c]].position;
+			occluders.insert(occluders.end(), position, position + 3);
+		}
+		occluderGroups.push_back(mesh.getGroupOfTriangle(triangle));
+	}
+
+	clusterBounds.reserve(6 * mesh.clusters.size());
+	for (std::vector<ParkCluster>::const_iterator cIt = mesh.clusters.begin(); cIt
+			!= mesh.clusters.end(); ++cIt) {
+		clusterBounds.insert(clusterBounds.end(), cIt->boundsMin,
+				cIt->boundsMin + 3);
+		clusterBounds.insert(clusterBounds.end(), cIt->boundsMax,
+				cIt->boundsMax + 3);
+	}
+} // end build()
+
+/*
+ * clear
+ */
+void OcclusionCuller::clear(void) {
+	std::vector<float>().swap(occluders);
+	std::vector<Uint32>().swap(occluderGroups);
+	std::vector<float>().swap(clusterBounds);
+} // end clear()
+
+/*
+ * getNumOccluders
+ *
+ * return - Uint32, triangles
+ */
+Uint32 OcclusionCuller::getNumOccluders(void) const {
+	return static_cast<Uint32> (occluderGroups.size());
+} // end getNumOccluders()
+
+/*
+ * render - Clears a buffer and draws the occluders of the visible groups
+ * into it.
+ *
+ * parameter clipMatrix - const float[16], mesh to clip coordinates, column
+ * major as GL stores it
+ * parameter groupVisibility - const std::vector<bool>&
+ * parameter clipPlanes - const std::vector<float>&, a, b, c, d of each GL
+ * clipping plane in mesh coordinates, keeping ax + by + cz + d >= 0
+ * parameter buffer - OcclusionBuffer&
+ * parameter pool - ThreadPool&, not used by anyone waiting for this call
+ */
+void OcclusionCuller::render(const float clipMatrix[16],
+		const std::vector<bool>& groupVisibility,
+		const std::vector<float>& clipPlanes, OcclusionBuffer& buffer,
+		ThreadPool& pool) const {
+	OcclusionTile empty;
+	empty.zMax0 = 1.0f;
+	empty.zMax1 = 0.0f;
+	empty.mask = 0;
+	buffer.tiles.assign(TILES_X * TILES_Y, empty);
+	buffer.chunks.resize((getNumOccluders() + CHUNK_TRIANGLES - 1)
+			/ CHUNK_TRIANGLES);
+
+	SetupOccluders setup(occluders, occluderGroups, groupVisibility,
+			clipPlanes, clipMatrix, buffer);
+	pool.parallelFor(static_cast<unsigned int> (buffer.chunks.size()), setup);
+	RasterizeBand rasterize(buffer);
+	pool.parallelFor(TILES_Y / BAND_TILE_ROWS, rasterize);
+} // end render()
+
+/*
+ * isOccluded - Whether a box lies behind the occluders of a buffer at every
+ * pixel it may cover. Boxes reaching in front of the near plane never are.
+ *
+ * parameter buffer - const OcclusionBuffer&, rendered with clipMatrix
+ * parameter clipMatrix - const float[16]
+ * parameter boxMin, boxMax - const float[3], in mesh coordinates
+ * return - bool
+ */
+bool OcclusionCuller::isOccluded(const OcclusionBuffer& buffer,
+		const float clipMatrix[16], const float boxMin[3],
+		const float boxMax[3]) {
+	float low[2] = { FLT_MAX, FLT_MAX };
+	float high[2] = { -FLT_MAX, -FLT_MAX };
+	float nearest = FLT_MAX;
+	for (int corner = 0; corner < 8; ++corner) {
+		const float point[3] = { (corner & 1) ? boxMax[0] : boxMin[0], (corner
+				& 2) ? boxMax[1] : boxMin[1], (corner & 4) ? boxMax[2]
+				: boxMin[2] };
+		float clip[4];
+		transformPoint(clipMatrix, point, clip);
+		if (clip[3] <= MIN_W || clip[2] < -clip[3])
+			return false;
+		const float x = (clip[0] / clip[3] + 1.0f) * 0.5f * WIDTH;
+		const float y = (clip[1] / clip[3] + 1.0f) * 0.5f * HEIGHT;
+		low[0] = std::min(low[0], x);
+		high[0] = std::max(high[0], x);
+		low[1] = std::min(low[1], y);
+		high[1] = std::max(high[1], y);
+		nearest = std::min(nearest, (clip[2] / clip[3] + 1.0f) * 0.5f);
+	}
+	const Int32 xMin = Int32(std::floor(std::max(low[0], 0.0f)));
+	const Int32 xMax = Int32(std::floor(std::min(high[0], WIDTH - 1.0f)));
+	const Int32 yMin = Int32(std::floor(std::max(low[1], 0.0f)));
+	const Int32 yMax = Int32(std::floor(std::min(high[1], HEIGHT - 1.0f)));
+	if (buffer.tiles.empty() || xMin > xMax || yMin > yMax)
+		return false;
+
+	const Int32 tileWidth = TILE_WIDTH;
+	const Int32 tileHeight = TILE_HEIGHT;
+	for (Int32 tileY = yMin / tileHeight; tileY <= yMax / tileHeight; ++tileY) {
+		const Int32 rowLow = std::max(yMin - tileY * tileHeight, 0);
+		const Int32 rowHigh = std::min(yMax - tileY * tileHeight, tileHeight
+				- 1);
+		for (Int32 tileX = xMin / tileWidth; tileX <= xMax / tileWidth; ++tileX) {
+			const OcclusionTile& tile = buffer.tiles[tileY * TILES_X + tileX];
+			if (nearest > tile.zMax0)
+				continue;
+			/* Behind the working layer where it covers the box: */
+			const Int32 columnLow = std::max(xMin - tileX * tileWidth, 0);
+			const Int32 columnHigh = std::min(xMax - tileX * tileWidth,
+					tileWidth - 1);
+			Uint32 pixels = 0;
+			const Uint32 rowBits = (0xffu >> (tileWidth - 1 - (columnHigh
+					- columnLow))) << columnLow;
+			for (Int32 row = rowLow; row <= rowHigh; ++row)
+				pixels |= rowBits << (row * tileWidth);
+			if ((pixels & ~tile.mask) != 0 || !(nearest > tile.zMax1))
+				return false;
+		}
+	}
+	return true;
+} // end isOccluded()
+
+/*
+ * cull - Draws the occluders for a view and drops the clusters they hide
+ * from its list of frustum culled clusters.
+ *
+ * parameter clipMatrix - const float[16], mesh to clip coordinates
+ * parameter groupVisibility - const std::vector<bool>&
+ * parameter clipPlanes - const std::vector<float>&, see render()
+ * parameter visible - std::vector<Uint32>&, cluster indices, filtered
+ * parameter buffer - OcclusionBuffer&, the view's
+ * parameter pool - ThreadPool&
+ * parameter statistics - CullStatistics&, occlusion fields are set and
+ * numVisible is reduced
+ */
+void OcclusionCuller::cull(const float clipMatrix[16],
+		const std::vector<bool>& groupVisibility,
+		const std::vector<float>& clipPlanes, std::vector<Uint32>& visible,
+		OcclusionBuffer& buffer, ThreadPool& pool,
+		CullStatistics& statistics) const {
+	const double start = now();
+	statistics.numOccluded = 0;
+	if (getNumOccluders() != 0 && !visible.empty()) {
+		render(clipMatrix, groupVisibility, clipPlanes, buffer, pool);
+		std::vector<Uint32>::iterator out = visible.begin();
+		for (std::vector<Uint32>::const_iterator vIt = visible.begin(); vIt
+				!= visible.end(); ++vIt) {
+			const float * bounds = &clusterBounds[6 * *vIt];
+			if (!isOccluded(buffer, clipMatrix, bounds, bounds + 3))
+				*out++ = *vIt;
+		}
+		statistics.numOccluded = static_cast<Uint32> (visible.end() - out);
+		visible.erase(out, visible.end());
+	}
+	statistics.numVisible = static_cast<Uint32> (visible.size());
+	statistics.occlusionTime = now() - start;
+} // end cull()
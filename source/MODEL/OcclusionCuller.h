@@ -0,0 +1,103 @@
+/*
+ * OcclusionCuller.h - Software occlusion culling of the park clusters.
+ *
+ * Created: October 16, 2026
+ */
+
+#ifndef OCCLUSIONCULLER_H_
+#define OCCLUSIONCULLER_H_
+
+#include <vector>
+
+#include <UTIL/Types.h>
+
+/* Begin Forward declarations: */
+struct CullStatistics;
+class ParkMesh;
+class ThreadPool;
+/* End Forward declarations: */
+
+/*
+ * OcclusionTile - 8x4 pixels of the masked depth buffer. Every pixel lies
+ * at most at depth zMax0; the pixels in mask, covered by the working layer,
+ * lie at most at zMax1. Depths are window depths, 0 near and 1 far.
+ */
+struct OcclusionTile {
+	float zMax0;
+	float zMax1;
+	Uint32 mask;
+};
+
+/*
+ * OcclusionTriangle - An occluder triangle clipped to the view and set up
+ * for rasterization in buffer pixels: three edge functions that are not
+ * negative inside, and the plane of its depths.
+ */
+struct OcclusionTriangle {
+	float edges[3][3];
+	float depth[3];
+	float maxDepth;
+	Int32 pixelMin[2];
+	Int32 pixelMax[2];
+};
+
+/*
+ * OcclusionBuffer - Low resolution masked depth buffer of one view and the
+ * triangles set up for it. Each graphics context keeps its own.
+ */
+struct OcclusionBuffer {
+	std::vector<OcclusionTile> tiles;
+	/* Set up triangles of each chunk of occluders */
+	std::vector<std::vector<OcclusionTriangle> > chunks;
+};
+
+/*
+ * OcclusionCuller - Masked software occlusion culling after the approach of
+ * Intel's Masked Occlusion Culling. The largest opaque triangles of the park,
+ * those of the stands, roofs and walls, are chosen as occluders once per
+ * mesh. Per view they are rasterized on the workers into a WIDTH x HEIGHT
+ * buffer of 8x4 pixel tiles, each band of tile rows by its own task, and a
+ * cluster is dropped when its box lies behind the buffer everywhere it
+ * covers. Only pixels whose center an occluder covers count as covered, so
+ * an object may be lost behind a sub-pixel gap of the low resolution buffer.
+ * Everything runs on the CPU, and the result does not depend on the number
+ * of threads.
+ */
+class OcclusionCuller {
+public:
+	static const Uint32 WIDTH = 256;
+	static const Uint32 HEIGHT = 128;
+	static const Uint32 TILE_WIDTH = 8;
+	static const Uint32 TILE_HEIGHT = 4;
+	/* Occluder budget: the largest triangles of opaque materials */
+	static const Uint32 MAX_OCCLUDER_TRIANGLES = 4096;
+
+	OcclusionCuller(void);
+	~OcclusionCuller(void);
+	void build(const ParkMesh& mesh);
+	void clear(void);
+	Uint32 getNumOccluders(void) const;
+	void render(const float clipMatrix[16],
+			const std::vector<bool>& groupVisibility,
+			const std::vector<float>& clipPlanes, OcclusionBuffer& buffer,
+			ThreadPool& pool) const;
+	static bool isOccluded(const OcclusionBuffer& buffer,
+			const float clipMatrix[16], const float boxMin[3],
+			const float boxMax[3]);
+	void cull(const float clipMatrix[16],
+			const std::vector<bool>& groupVisibility,
+			const std::vector<float>& clipPlanes, std::vector<Uint32>& visible,
+			OcclusionBuffer& buffer, ThreadPool& pool,
+			CullStatistics& statistics) const;
+
+private:
+	/* Nine floats per occluder triangle */
+	std::vector<float> occluders;
+	/* OBJ group of each occluder triangle; hidden groups hide nothing, and
+	 * neither do occluders a clipping plane cuts */
+	std::vector<Uint32> occluderGroups;
+	/* Six floats per cluster: minimum, then maximum */
+	std::vector<float> clusterBounds;
+};
+
+#endif /* OCCLUSIONCULLER_H_ */
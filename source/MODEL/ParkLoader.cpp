@@ -0,0 +1,331 @@
+/*
+ * ParkLoader.cpp - Methods for streaming the park into the scene from a
+ * background thread.
+ *
+ * Created: October 16, 2026
+ */
+
+/* System headers */
+#include <algorithm>
+#include <cstring>
+#include <exception>
+#include <iostream>
+#include <memory>
+#include <sstream>
+
+/* Application headers */
+#include <MODEL/ClusterLod.h>
+#include <MODEL/GroupInstancer.h>
+#include <MODEL/MaterialMerger.h>
+#include <MODEL/MeshOptimizer.h>
+#include <MODEL/ObjParser.h>
+#include <MODEL/ParkLoader.h>
+#include <MODEL/SceneBuilder.h>
+#include <MODEL/SceneCache.h>
+#include <MODEL/TextureAtlas.h>
+#include <MODEL/TexturePack.h>
+#include <MODEL/VertexQuantizer.h>
+#include <SYNC/Guard.h>
+#include <SYNC/ThreadPool.h>
+#include <UTIL/MappedFile.h>
+#include <UTIL/ResourceException.h>
+#include <UTIL/System.h>
+
+static const std::string PARK_CACHE("fenwaypark.cache");
+static const std::string TEXTURE_PACK("fenwaypark.texpack");
+
+/*
+ * now - Wall clock in seconds.
+ */
+static double now(void) {
+	TimeVal time;
+	SystemPosix::gettimeofday(&time);
+	return time.tv_sec + time.tv_usec * 1.0e-6;
+} // end now()
+
+/*****************************************
+ Methods of struct ParkStage:
+ *****************************************/
+/*
+ * ParkStage constructor
+ */
+ParkStage::ParkStage(void) :
+	complete(false), loadTime(0.0) {
+} // end ParkStage()
+
+/****************************************************
+ Constructors and Destructors of class ParkLoader:
+ ****************************************************/
+/*
+ * ParkLoader constructor
+ *
+ * parameter modelDirectory - const std::string&
+ * parameter objFile - const std::string&, relative to the model directory
+ * parameter pool - ThreadPool&, workers for parsing
+ * parameter compactVertices - bool, quantize the textured park's vertices
+ * parameter publishProxy - bool, false when reloading a displayed park
+ */
+ParkLoader::ParkLoader(const std::string& _modelDirectory,
+		const std::string& _objFile, ThreadPool& _pool, bool _compactVertices,
+		bool _publishProxy) :
+	modelDirectory(_modelDirectory), objFile(_objFile), pool(_pool),
+			compactVertices(_compactVertices), publishProxy(_publishProxy),
+			texturePack(0), started(false), startTime(0.0), pending(0),
+			finished(false), cancelled(false) {
+} // end ParkLoader()
+
+/*
+ * ~ParkLoader - Asks the loader to stop after its current step and joins it.
+ */
+ParkLoader::~ParkLoader(void) {
+	{
+		Guard<MutexPosix> guard(lock);
+		cancelled = true;
+	}
+	if (started)
+		pthread_join(thread, NULL);
+	delete pending;
+	delete texturePack;
+} // end ~ParkLoader()
+
+/*******************************
+ Methods of class ParkLoader:
+ *******************************/
+
+/*
+ * start - Starts the loader thread.
+ *
+ * @throw ResourceException is thrown if the thread cannot be created.
+ */
+void ParkLoader::start(void) {
+	startTime = now();
+	const int result = pthread_create(&thread, NULL, &ParkLoader::loaderMain,
+			this);
+	if (result != 0) {
+		std::ostringstream msg_stream;
+		msg_stream << "Loader thread creation failed: " << std::strerror(result);
+		throw ResourceException(msg_stream.str(), LOCATION);
+	}
+	started = true;
+} // end start()
+
+/*
+ * takeStage - Hands the newest finished stage to the caller, which becomes
+ * its only user. Called by the thread that owns the displayed scene.
+ *
+ * parameter stage - ParkStage&, receives the stage
+ * return - bool, false if no new stage is ready
+ */
+bool ParkLoader::takeStage(ParkStage& stage) {
+	Guard<MutexPosix> guard(lock);
+	if (pending == 0)
+		return false;
+	stage.mesh.swap(pending->mesh);
+	stage.bvh.swap(pending->bvh);
+	stage.sourceMaterials.swap(pending->sourceMaterials);
+	stage.tiles.swap(pending->tiles);
+	stage.geode = pending->geode;
+	stage.node = pending->node;
+	stage.complete = pending->complete;
+	stage.loadTime = pending->loadTime;
+	delete pending;
+	pending = 0;
+	return true;
+} // end takeStage()
+
+/*
+ * isFinished - Whether the loader published its last stage or gave up.
+ *
+ * return - bool
+ */
+bool ParkLoader::isFinished(void) const {
+	Guard<MutexPosix> guard(lock);
+	return finished;
+} // end isFinished()
+
+/*
+ * loaderMain - Thread entry point.
+ */
+void * ParkLoader::loaderMain(void * loader) {
+	ParkLoader * self = static_cast<ParkLoader*> (loader);
+	try {
+		self->load();
+	} catch (std::exception& err) {
+		std::cerr << "Park loading failed: " << err.what() << std::endl;
+	}
+	Guard<MutexPosix> guard(self->lock);
+	self->finished = true;
+	return NULL;
+} // end loaderMain()
+
+/*
+ * load - Maps the compiled park scene if it matches the current assets,
+ * otherwise parses the OBJ text on all workers and compiles the scene for
+ * the next launch. Publishes the untextured proxy unless reloading, then
+ * reads the textures on the workers, moves the ones that do not wrap into
+ * atlas pages, folds repeated groups into instances, welds and cache orders
+ * the merged mesh, simplifies its clusters, quantizes the vertices if asked
+ * to, indexes the triangles and publishes the textured park.
+ */
+void ParkLoader::load(void) {
+	ParkMesh mesh;
+	SceneCache sceneCache(modelDirectory + "/" + PARK_CACHE);
+	const Uint64 assetHash = SceneCache::hashAssets(modelDirectory, objFile);
+	if (!sceneCache.load(assetHash, mesh)) {
+		ObjParser::parse(modelDirectory, objFile, mesh, pool);
+
+		/* A read-only model directory only costs the next launch its speed-up: */
+		try {
+			sceneCache.save(assetHash, mesh);
+		} catch (ResourceException& err) {
+			std::cerr << "Scene cache not written: " << err.getDescription()
+					<< std::endl;
+		}
+	}
+	if (isCancelled())
+		return;
+
+	if (publishProxy) {
+		/* Freed if building it throws: */
+		std::auto_ptr<ParkStage> proxy(new ParkStage());
+		proxy->mesh = mesh;
+		MaterialMerger::merge(proxy->mesh);
+		proxy->geode = SceneBuilder::buildNode(proxy->mesh,
+				SceneBuilder::ImageMap());
+		proxy->node = proxy->geode;
+		publish(proxy.release());
+		if (isCancelled())
+			return;
+	}
+
+	/* Prefer the deduplicated texture pack built by tools/TexturePacker; it is
+	 * not checked against the image files, so rebuild it after editing them: */
+	const std::string packPath = modelDirectory + "/" + TEXTURE_PACK;
+	if (MappedFile::exists(packPath)) {
+		try {
+			texturePack = new TexturePack(packPath);
+		} catch (ResourceException& err) {
+			std::cerr << "Ignoring texture pack: " << err.getDescription()
+					<< std::endl;
+		}
+	}
+
+	/* Images and atlas pages transcoded by tools/TextureTranscoder are uploaded
+	 * with their stored mipmaps. The others are decoded when composed into
+	 * an atlas page, or else once a view sees them. Both are read on the
+	 * workers; only the uploads wait for a context: */
+	const double textureStart = now();
+	SceneBuilder::ImageMap images;
+	SceneBuilder::loadImages(mesh, modelDirectory, texturePack, images, true,
+			true, &pool);
+	/* Freed if any step below throws: */
+	std::auto_ptr<ParkStage> park(new ParkStage());
+	park->sourceMaterials.resize(mesh.groups.size());
+	for (size_t g = 0; g < mesh.groups.size(); ++g)
+		park->sourceMaterials[g] = mesh.groups[g].material;
+	const Uint32 texturesBefore = TextureAtlas::countTextures(mesh);
+	const Uint32 numPages = SceneBuilder::buildAtlases(mesh, images,
+			modelDirectory, &park->tiles, texturePack, &pool);
+	std::cout << "Park: " << images.size() << " textures read in "
+			<< (now() - textureStart) * 1000.0 << " ms on "
+			<< pool.getNumThreads() << " workers" << std::endl;
+	std::cout << "Park: " << numPages << " texture atlas pages, texture binds "
+			<< "per frame " << texturesBefore << " before, "
+			<< TextureAtlas::countTextures(mesh) << " after" << std::endl;
+
+	park->mesh.swap(mesh);
+	const InstancingStatistics instancing = GroupInstancer::fold(park->mesh);
+	std::cout << "Park: " << instancing.numFolded << " groups folded into "
+			<< "instances of " << instancing.numPrototypes << " shared meshes, "
+			<< instancing.bytesSaved / 1024 << " KB saved" << std::endl;
+	MaterialMerger::merge(park->mesh);
+	std::cout << "Park: " << park->mesh.groups.size() << " groups merged into "
+			<< park->mesh.batches.size() << " material batches" << std::endl;
+	const MeshStatistics before = MeshOptimizer::measure(park->mesh);
+	MeshOptimizer::optimize(park->mesh);
+	const MeshStatistics after = MeshOptimizer::measure(park->mesh);
+	std::cout << "Park: vertices " << before.numVertices << " -> "
+			<< after.numVertices << ", triangles " << before.numTriangles
+			<< " -> " << after.numTriangles << ", ACMR " << before.acmr << " -> "
+			<< after.acmr << ", geometry " << before.bytes / 1024 << " KB -> "
+			<< after.bytes / 1024 << " KB" << std::endl;
+
+	ClusterLod::buildLevels(park->mesh);
+	Uint32 levelTriangles[ParkCluster::MAX_LEVELS] = { 0 };
+	for (size_t c = 0; c < park->mesh.clusters.size(); ++c) {
+		const ParkCluster& cluster = park->mesh.clusters[c];
+		for (Uint32 l = 0; l < ParkCluster::MAX_LEVELS; ++l)
+			levelTriangles[l] += cluster.numIndices[std::min(l,
+					cluster.numLevels - 1)] / 3;
+	}
+	std::cout << "Park: " << park->mesh.clusters.size()
+			<< " clusters, triangles at levels 0-3:";
+	for (Uint32 l = 0; l < ParkCluster::MAX_LEVELS; ++l)
+		std::cout << " " << levelTriangles[l];
+	std::cout << std::endl;
+
+	/* Fixed-point vertices, unless they stray further than their rounding: */
+	QuantizedMesh quantized;
+	bool useQuantized = false;
+	if (compactVertices) {
+		const Uint32 numCopies = VertexQuantizer::separateBatches(park->mesh);
+		VertexQuantizer::quantize(park->mesh, quantized);
+		const QuantizationError error = VertexQuantizer::check(park->mesh,
+				quantized);
+		useQuantized = error.withinBounds;
+		std::cout << "Park: quantized vertices (" << numCopies
+				<< " copied between batches), largest error " << error.position
+				<< " units, " << error.normalDegrees << " degrees, "
+				<< error.texCoord << " texture units"
+				<< (useQuantized ? "" : "; out of bounds, drawing floats")
+				<< std::endl;
+	}
+	const size_t indexBytes = park->mesh.indices.size()
+			* SceneBuilder::getIndexSize(park->mesh);
+	std::cout << "Park: geometry per context " << (park->mesh.vertices.size()
+			* sizeof(ParkVertex) + park->mesh.indices.size() * sizeof(Uint32))
+			/ 1024 << " KB as floats, " << ((useQuantized
+			? quantized.getVertexBytes() : park->mesh.vertices.size()
+					* sizeof(ParkVertex)) + indexBytes) / 1024 << " KB drawn"
+			<< std::endl;
+
+	park->geode = SceneBuilder::buildNode(park->mesh, images, useQuantized
+			? &quantized : 0);
+	if (useQuantized) {
+		osg::MatrixTransform * dequantization =
+				SceneBuilder::getDequantization(quantized);
+		dequantization->addChild(park->geode.get());
+		park->node = dequantization;
+	} else
+		park->node = park->geode;
+
+	/* For cutting the park along the clipping planes: */
+	park->bvh.build(park->mesh, &pool);
+	std::cout << "Park: triangle BVH of " << park->bvh.getNumNodes()
+			<< " nodes, " << park->bvh.getBytes() / 1024 << " KB" << std::endl;
+	park->complete = true;
+	publish(park.release());
+} // end load()
+
+/*
+ * publish - Makes a stage available to takeStage(), replacing a stage that
+ * was not taken yet.
+ *
+ * parameter stage - ParkStage *, ownership passes to the loader
+ */
+void ParkLoader::publish(ParkStage * stage) {
+	stage->loadTime = now() - startTime;
+	Guard<MutexPosix> guard(lock);
+	delete pending;
+	pending = stage;
+} // end publish()
+
+/*
+ * isCancelled
+ *
+ * return - bool
+ */
+bool ParkLoader::isCancelled(void) const {
+	Guard<MutexPosix> guard(lock);
+	return cancelled;
+} // end isCancelled()
@@ -0,0 +1,94 @@
+/*
+ * ParkLoader.h - Background thread streaming the park into the scene.
+ *
+ * Created: October 16, 2026
+ */
+
+#ifndef PARKLOADER_H_
+#define PARKLOADER_H_
+
+#include <string>
+#include <pthread.h>
+
+/* Boost includes */
+#include <boost/noncopyable.hpp>
+
+/* osg includes */
+#include <osg/Geode>
+
+#include <MODEL/ParkMesh.h>
+#include <MODEL/TextureAtlas.h>
+#include <MODEL/TriangleBvh.h>
+#include <SYNC/MutexPosix.h>
+
+/* Begin Forward declarations: */
+class TexturePack;
+class ThreadPool;
+/* End Forward declarations: */
+
+/*
+ * ParkStage - One displayable state of the park: a merged mesh and the scene
+ * graph built from it. Group ids are the same in every stage.
+ */
+struct ParkStage {
+	ParkMesh mesh;
+	/* Drawable i draws batch i */
+	osg::ref_ptr<osg::Geode> geode;
+	/* What goes into the scene: the geode, or a transform above it */
+	osg::ref_ptr<osg::Node> node;
+	/* Over the mesh's triangles; empty for the proxy */
+	TriangleBvh bvh;
+	/* Material of each group as the library names it, before atlasing; empty
+	 * for the proxy */
+	std::vector<Uint32> sourceMaterials;
+	/* Where the atlased textures went */
+	TextureAtlas::TileMap tiles;
+	/* False for the untextured proxy that precedes the textured park */
+	bool complete;
+	/* Seconds from start() until the stage was ready */
+	double loadTime;
+
+	ParkStage(void);
+};
+
+/*
+ * ParkLoader - Loads the park on its own thread, using the worker pool for
+ * parsing, and publishes each stage as soon as it is built: first the
+ * geometry with material colors only, then the textured, atlased park. The
+ * scene graphs are built entirely on the loader thread and only handed over
+ * through takeStage(), so the displayed graph is never touched concurrently.
+ */
+class ParkLoader: boost::noncopyable {
+public:
+	ParkLoader(const std::string& modelDirectory, const std::string& objFile,
+			ThreadPool& pool, bool compactVertices, bool publishProxy);
+	~ParkLoader(void);
+	void start(void);
+	bool takeStage(ParkStage& stage);
+	bool isFinished(void) const;
+
+private:
+	std::string modelDirectory;
+	std::string objFile;
+	ThreadPool& pool;
+	/* Whether the textured park is drawn from quantized vertices */
+	bool compactVertices;
+	/* Whether the untextured proxy is shown until the park is ready */
+	bool publishProxy;
+	TexturePack * texturePack;
+	pthread_t thread;
+	bool started;
+	double startTime;
+	mutable MutexPosix lock;
+	/* Newest stage not yet taken; a newer stage replaces it */
+	ParkStage * pending;
+	bool finished;
+	bool cancelled;
+
+	static void * loaderMain(void * loader);
+	void load(void);
+	void publish(ParkStage * stage);
+	bool isCancelled(void) const;
+};
+
+#endif /* PARKLOADER_H_ */
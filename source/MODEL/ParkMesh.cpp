@@ -0,0 +1,266 @@
+/*
+ * ParkMesh.cpp - Methods for the park geometry and material tables.
+ *
+ * Created: October 16, 2026
+ */
+
+#include <algorithm>
+#include <cfloat>
+
+#include <MODEL/ParkMesh.h>
+
+/*****************************************
+ Methods of struct ParkMaterial:
+ *****************************************/
+/*
+ * ParkMaterial constructor - Defaults match an OBJ material without entries.
+ */
+ParkMaterial::ParkMaterial(void) :
+	shininess(0.0f), illum(2) {
+	for (int i = 0; i < 3; ++i) {
+		ambient[i] = 0.2f;
+		diffuse[i] = 0.8f;
+		specular[i] = 0.0f;
+	}
+	ambient[3] = diffuse[3] = specular[3] = 1.0f;
+} // end ParkMaterial()
+
+/*
+ * isTransparent
+ *
+ * return - bool
+ */
+bool ParkMaterial::isTransparent(void) const {
+	return diffuse[3] < 1.0f;
+} // end isTransparent()
+
+/*
+ * hasSameProperties - Whether two materials only differ in name.
+ *
+ * parameter other - const ParkMaterial&
+ * return - bool
+ */
+bool ParkMaterial::hasSameProperties(const ParkMaterial& other) const {
+	for (int j = 0; j < 4; ++j) {
+		if (ambient[j] != other.ambient[j] || diffuse[j] != other.diffuse[j]
+				|| specular[j] != other.specular[j])
+			return false;
+	}
+	return shininess == other.shininess && illum == other.illum && texture
+			== other.texture;
+} // end hasSameProperties()
+
+/*****************************************
+ Methods of struct ParkGroup:
+ *****************************************/
+/*
+ * ParkGroup constructor
+ */
+ParkGroup::ParkGroup(void) :
+	material(0), firstIndex(0), numIndices(0), batch(0) {
+	for (int i = 0; i < 3; ++i) {
+		boundsMin[i] = FLT_MAX;
+		boundsMax[i] = -FLT_MAX;
+	}
+} // end ParkGroup()
+
+/*****************************************
+ Methods of struct ParkInstance:
+ *****************************************/
+/*
+ * transform - Moves a point of the prototype onto the instance.
+ *
+ * parameter position - const float[3]
+ * parameter result - float[3]
+ */
+void ParkInstance::transform(const float position[3], float result[3]) const {
+	for (int i = 0; i < 3; ++i)
+		result[i] = rotation[3 * i] * position[0] + rotation[3 * i + 1]
+				* position[1] + rotation[3 * i + 2] * position[2]
+				+ translation[i];
+} // end transform()
+
+/*****************************************
+ Methods of struct ParkCluster:
+ *****************************************/
+/*
+ * ParkCluster constructor
+ */
+ParkCluster::ParkCluster(void) :
+	batch(0), firstGroup(0), numGroups(0), numLevels(1) {
+	for (Uint32 l = 0; l < MAX_LEVELS; ++l) {
+		firstIndex[l] = 0;
+		numIndices[l] = 0;
+		error[l] = 0.0f;
+	}
+	for (int i = 0; i < 3; ++i) {
+		boundsMin[i] = FLT_MAX;
+		boundsMax[i] = -FLT_MAX;
+	}
+} // end ParkCluster()
+
+/****************************************************
+ Constructors and Destructors of class ParkMesh:
+ ****************************************************/
+/*
+ * ParkMesh constructor
+ */
+ParkMesh::ParkMesh(void) {
+	clear();
+} // end ParkMesh()
+
+/*
+ * ~ParkMesh destructor
+ */
+ParkMesh::~ParkMesh(void) {
+} // end ~ParkMesh()
+
+/*******************************
+ Methods of class ParkMesh:
+ *******************************/
+
+/*
+ * clear - Drops all geometry and materials.
+ */
+void ParkMesh::clear(void) {
+	vertices.clear();
+	indices.clear();
+	groups.clear();
+	materials.clear();
+	batches.clear();
+	batchGroups.clear();
+	clusters.clear();
+	triangleGroups.clear();
+	instances.clear();
+	for (int i = 0; i < 3; ++i) {
+		boundsMin[i] = FLT_MAX;
+		boundsMax[i] = -FLT_MAX;
+	}
+} // end clear()
+
+/*
+ * computeBounds - Recomputes the axis-aligned bounds of every group, every
+ * cluster and the whole mesh from the index array. Instanced groups are
+ * bounded by their prototype's bounds moved onto them, and left out of the
+ * clusters, which only draw triangles of their own.
+ */
+void ParkMesh::computeBounds(void) {
+	for (int i = 0; i < 3; ++i) {
+		boundsMin[i] = FLT_MAX;
+		boundsMax[i] = -FLT_MAX;
+	}
+	for (std::vector<ParkGroup>::iterator gIt = groups.begin(); gIt
+			!= groups.end(); ++gIt) {
+		for (int i = 0; i < 3; ++i) {
+			gIt->boundsMin[i] = FLT_MAX;
+			gIt->boundsMax[i] = -FLT_MAX;
+		}
+		for (Uint32 index = gIt->firstIndex; index < gIt->firstIndex
+				+ gIt->numIndices; ++index) {
+			const float* position = vertices[indices[index]].position;
+			for (int i = 0; i < 3; ++i) {
+				if (position[i] < gIt->boundsMin[i])
+					gIt->boundsMin[i] = position[i];
+				if (position[i] > gIt->boundsMax[i])
+					gIt->boundsMax[i] = position[i];
+			}
+		}
+		for (int i = 0; i < 3; ++i) {
+			if (gIt->boundsMin[i] < boundsMin[i])
+				boundsMin[i] = gIt->boundsMin[i];
+			if (gIt->boundsMax[i] > boundsMax[i])
+				boundsMax[i] = gIt->boundsMax[i];
+		}
+	}
+	for (std::vector<ParkInstance>::const_iterator iIt = instances.begin(); iIt
+			!= instances.end(); ++iIt) {
+		const ParkGroup& prototype = groups[iIt->prototype];
+		ParkGroup& group = groups[iIt->group];
+		for (int c = 0; c < 8; ++c) {
+			const float corner[3] = { c & 1 ? prototype.boundsMax[0]
+					: prototype.boundsMin[0], c & 2 ? prototype.boundsMax[1]
+					: prototype.boundsMin[1], c & 4 ? prototype.boundsMax[2]
+					: prototype.boundsMin[2] };
+			float position[3];
+			iIt->transform(corner, position);
+			for (int i = 0; i < 3; ++i) {
+				group.boundsMin[i] = std::min(group.boundsMin[i], position[i]);
+				group.boundsMax[i] = std::max(group.boundsMax[i], position[i]);
+			}
+		}
+		for (int i = 0; i < 3; ++i) {
+			boundsMin[i] = std::min(boundsMin[i], group.boundsMin[i]);
+			boundsMax[i] = std::max(boundsMax[i], group.boundsMax[i]);
+		}
+	}
+	for (std::vector<ParkCluster>::iterator cIt = clusters.begin(); cIt
+			!= clusters.end(); ++cIt) {
+		for (int i = 0; i < 3; ++i) {
+			cIt->boundsMin[i] = FLT_MAX;
+			cIt->boundsMax[i] = -FLT_MAX;
+		}
+		for (Uint32 b = cIt->firstGroup; b < cIt->firstGroup
+				+ cIt->numGroups; ++b) {
+			const ParkGroup& group = groups[batchGroups[b]];
+			if (group.numIndices == 0)
+				continue;
+			for (int i = 0; i < 3; ++i) {
+				cIt->boundsMin[i] = std::min(cIt->boundsMin[i],
+						group.boundsMin[i]);
+				cIt->boundsMax[i] = std::max(cIt->boundsMax[i],
+						group.boundsMax[i]);
+			}
+		}
+	}
+} // end computeBounds()
+
+/*
+ * swap - Exchanges all tables with another mesh without copying them.
+ *
+ * parameter other - ParkMesh&
+ */
+void ParkMesh::swap(ParkMesh& other) {
+	vertices.swap(other.vertices);
+	indices.swap(other.indices);
+	groups.swap(other.groups);
+	materials.swap(other.materials);
+	batches.swap(other.batches);
+	batchGroups.swap(other.batchGroups);
+	clusters.swap(other.clusters);
+	triangleGroups.swap(other.triangleGroups);
+	instances.swap(other.instances);
+	for (int i = 0; i < 3; ++i) {
+		std::swap(boundsMin[i], other.boundsMin[i]);
+		std::swap(boundsMax[i], other.boundsMax[i]);
+	}
+} // end swap()
+
+/*
+ * getGeometryBytes - Size of the vertex and index arrays.
+ *
+ * return - size_t
+ */
+size_t ParkMesh::getGeometryBytes(void) const {
+	return vertices.size() * sizeof(ParkVertex) + indices.size()
+			* sizeof(Uint32);
+} // end getGeometryBytes()
+
+/*
+ * getNumTriangles
+ *
+ * return - Uint32
+ */
+Uint32 ParkMesh::getNumTriangles(void) const {
+	return static_cast<Uint32> (indices.size() / 3);
+} // end getNumTriangles()
+
+/*
+ * getGroupOfTriangle - Maps a triangle of the index array back to the OBJ
+ * group it came from, e.g. for picking.
+ *
+ * parameter triangle - Uint32
+ * return - Uint32
+ */
+Uint32 ParkMesh::getGroupOfTriangle(Uint32 triangle) const {
+	return triangleGroups[triangle];
+} // end getGroupOfTriangle()
@@ -0,0 +1,140 @@
+/*
+ * ParkMesh.h - Plain geometry and material tables for the park model.
+ *
+ * Created: October 16, 2026
+ */
+
+#ifndef PARKMESH_H_
+#define PARKMESH_H_
+
+#include <string>
+#include <vector>
+
+#include <UTIL/Types.h>
+
+/*
+ * ParkVertex - Interleaved vertex as submitted to GL.
+ */
+struct ParkVertex {
+	float position[3];
+	float normal[3];
+	float texCoord[2];
+};
+
+/*
+ * ParkMaterial - One newmtl entry of the model's material library.
+ */
+struct ParkMaterial {
+	std::string name;
+	float ambient[4];
+	float diffuse[4];
+	float specular[4];
+	float shininess;
+	int illum;
+	/* Texture file relative to the model directory, empty if untextured */
+	std::string texture;
+
+	ParkMaterial(void);
+	bool isTransparent(void) const;
+	bool hasSameProperties(const ParkMaterial& other) const;
+};
+
+/*
+ * ParkGroup - One OBJ group: a range of triangles in the index array drawn
+ * with a single material.
+ */
+struct ParkGroup {
+	Uint32 material;
+	Uint32 firstIndex;
+	Uint32 numIndices;
+	/* Batch drawing this group, valid after MaterialMerger::merge() */
+	Uint32 batch;
+	float boundsMin[3];
+	float boundsMax[3];
+
+	ParkGroup(void);
+};
+
+/*
+ * ParkBatch - All groups sharing one material, stored contiguously in the
+ * index array so they can be submitted as a single draw.
+ */
+struct ParkBatch {
+	Uint32 material;
+	Uint32 firstIndex;
+	Uint32 numIndices;
+	/* Range of batchGroups listing the member groups in index order */
+	Uint32 firstGroup;
+	Uint32 numGroups;
+	/* Range of clusters partitioning the batch */
+	Uint32 firstCluster;
+	Uint32 numClusters;
+};
+
+/*
+ * ParkCluster - A spatially compact run of groups of one batch, the unit of
+ * level of detail selection. Level 0 is the groups' own index ranges; the
+ * coarser levels, see ClusterLod, are stored after all batches.
+ */
+struct ParkCluster {
+	static const Uint32 MAX_LEVELS = 4;
+
+	Uint32 batch;
+	/* Range of batchGroups */
+	Uint32 firstGroup;
+	Uint32 numGroups;
+	Uint32 numLevels;
+	Uint32 firstIndex[MAX_LEVELS];
+	Uint32 numIndices[MAX_LEVELS];
+	/* Quadric estimate of the distance of each level from level 0, in model
+	 * units */
+	float error[MAX_LEVELS];
+	float boundsMin[3];
+	float boundsMax[3];
+
+	ParkCluster(void);
+};
+
+/*
+ * ParkInstance - A group drawn as a rigid transform of another group's
+ * triangles instead of its own, see GroupInstancer.
+ */
+struct ParkInstance {
+	Uint32 group;
+	Uint32 prototype;
+	/* Row-major; a prototype position p lands on rotation * p + translation */
+	float rotation[9];
+	float translation[3];
+
+	void transform(const float position[3], float result[3]) const;
+};
+
+class ParkMesh {
+public:
+	ParkMesh(void);
+	~ParkMesh(void);
+	void clear(void);
+	void computeBounds(void);
+	void swap(ParkMesh& other);
+	size_t getGeometryBytes(void) const;
+	Uint32 getNumTriangles(void) const;
+	Uint32 getGroupOfTriangle(Uint32 triangle) const;
+
+	std::vector<ParkVertex> vertices;
+	/* Triangle list, three indices per triangle: the groups, then the coarser
+	 * cluster levels */
+	std::vector<Uint32> indices;
+	std::vector<ParkGroup> groups;
+	std::vector<ParkMaterial> materials;
+	/* Draw batches and their group side tables, see MaterialMerger */
+	std::vector<ParkBatch> batches;
+	std::vector<Uint32> batchGroups;
+	std::vector<ParkCluster> clusters;
+	std::vector<Uint32> triangleGroups;
+	/* Groups without triangles of their own, ordered by prototype */
+	std::vector<ParkInstance> instances;
+	float boundsMin[3];
+	float boundsMax[3];
+};
+
+#endif /* PARKMESH_H_ */
@@ -0,0 +1,1470 @@
+/*
+ * SceneBuilder.cpp - Methods for converting between the park mesh tables and
+ * OSG graphs.
+ *
+ * Created: October 16, 2026
+ */
+
+/* System headers */
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+#include <istream>
+#include <map>
+#include <sstream>
+#include <vector>
+
+/* osg includes */
+#include <osg/Array>
+#include <osg/BlendFunc>
+#include <osg/GL2Extensions>
+#include <osg/Geode>
+#include <osg/Geometry>
+#include <osg/Material>
+#include <osg/MatrixTransform>
+#include <osg/NodeVisitor>
+#include <osg/PrimitiveSet>
+#include <osg/Program>
+#include <osg/RenderInfo>
+#include <osg/Shader>
+#include <osg/StateSet>
+#include <osg/TexMat>
+#include <osg/Texture2D>
+#include <osg/TriangleIndexFunctor>
+#include <osg/Uniform>
+
+/* Application headers */
+#include <MODEL/ImageDecoder.h>
+#include <MODEL/ParkMesh.h>
+#include <MODEL/SceneBuilder.h>
+#include <MODEL/TextureAtlas.h>
+#include <MODEL/TextureCompressor.h>
+#include <MODEL/TexturePack.h>
+#include <MODEL/VertexQuantizer.h>
+#include <MODEL/ViewClusters.h>
+#include <SYNC/ThreadPool.h>
+#include <UTIL/Hash.h>
+#include <UTIL/MappedFile.h>
+#include <UTIL/ResourceException.h>
+
+/* First texture of each content hash, so twins under different names share
+ * its image */
+typedef std::map<Uint64, Uint32> ContentMap;
+/* Textures by image, so materials sharing an image share its texture */
+typedef std::map<const osg::Image*, osg::ref_ptr<osg::Texture2D> > TextureMap;
+
+/*
+ * TriangleCollector - Gathers the triangles of any primitive set as indices
+ * relative to the geometry's vertex array.
+ */
+struct TriangleCollector {
+	std::vector<Uint32>* indices;
+	Uint32 base;
+
+	void operator()(unsigned int i1, unsigned int i2, unsigned int i3) {
+		indices->push_back(base + i1);
+		indices->push_back(base + i2);
+		indices->push_back(base + i3);
+	}
+};
+
+/*
+ * MeshExtractor - Flattens every geometry below a node into a ParkMesh, one
+ * group per geometry, sharing materials by value.
+ */
+class MeshExtractor: public osg::NodeVisitor {
+public:
+	MeshExtractor(ParkMesh& _mesh) :
+		osg::NodeVisitor(osg::NodeVisitor::TRAVERSE_ALL_CHILDREN), mesh(_mesh) {
+	}
+
+	virtual void apply(osg::Geode& geode) {
+		osg::Matrix matrix = osg::computeLocalToWorld(getNodePath());
+		for (unsigned int i = 0; i < geode.getNumDrawables(); ++i) {
+			osg::Geometry * geometry = geode.getDrawable(i)->asGeometry();
+			if (geometry != 0)
+				addGeometry(geode.getStateSet(), geometry, matrix);
+		}
+	}
+
+private:
+	ParkMesh& mesh;
+
+	void addGeometry(const osg::StateSet * geodeState,
+			osg::Geometry * geometry, const osg::Matrix& matrix) {
+		const osg::Vec3Array * positions =
+				dynamic_cast<const osg::Vec3Array*> (geometry->getVertexArray());
+		if (positions == 0 || positions->empty())
+			return;
+		const osg::Vec3Array * normals =
+				dynamic_cast<const osg::Vec3Array*> (geometry->getNormalArray());
+		const bool perVertexNormals = normals != 0
+				&& geometry->getNormalBinding() == osg::Geometry::BIND_PER_VERTEX
+				&& normals->size() == positions->size();
+		const bool overallNormal = normals != 0 && !normals->empty()
+				&& geometry->getNormalBinding() == osg::Geometry::BIND_OVERALL;
+		const osg::Vec2Array * texCoords =
+				dynamic_cast<const osg::Vec2Array*> (geometry->getTexCoordArray(0));
+		if (texCoords != 0 && texCoords->size() != positions->size())
+			texCoords = 0;
+
+		ParkGroup group;
+		group.material = findMaterial(geodeState, geometry->getStateSet());
+		group.firstIndex = static_cast<Uint32> (mesh.indices.size());
+
+		const osg::Matrix inverse = osg::Matrix::inverse(matrix);
+		const Uint32 base = static_cast<Uint32> (mesh.vertices.size());
+		for (unsigned int v = 0; v < positions->size(); ++v) {
+			ParkVertex vertex;
+			osg::Vec3 position = (*positions)[v] * matrix;
+			osg::Vec3 normal(0.0f, 0.0f, 1.0f);
+			if (perVertexNormals)
+				normal = (*normals)[v];
+			else if (overallNormal)
+				normal = (*normals)[0];
+			normal = osg::Matrix::transform3x3(inverse, normal);
+			normal.normalize();
+			for (int j = 0; j < 3; ++j) {
+				vertex.position[j] = position[j];
+				vertex.normal[j] = normal[j];
+			}
+			vertex.texCoord[0] = texCoords != 0 ? (*texCoords)[v][0] : 0.0f;
+			vertex.texCoord[1] = texCoords != 0 ? (*texCoords)[v][1] : 0.0f;
+			mesh.vertices.push_back(vertex);
+		}
+
+		osg::TriangleIndexFunctor<TriangleCollector> collector;
+		collector.indices = &mesh.indices;
+		collector.base = base;
+		geometry->accept(collector);
+
+		group.numIndices = static_cast<Uint32> (mesh.indices.size())
+				- group.firstIndex;
+		if (group.numIndices > 0)
+			mesh.groups.push_back(group);
+	}
+
+	Uint32 findMaterial(const osg::StateSet * geodeState,
+			const osg::StateSet * geometryState) {
+		ParkMaterial material;
+		const osg::StateSet * states[2] = { geodeState, geometryState };
+		for (int s = 0; s < 2; ++s) {
+			if (states[s] == 0)
+				continue;
+			const osg::Material * osgMaterial =
+					dynamic_cast<const osg::Material*> (states[s]->getAttribute(
+							osg::StateAttribute::MATERIAL));
+			if (osgMaterial != 0) {
+				const osg::Material::Face face = osg::Material::FRONT;
+				for (int j = 0; j < 4; ++j) {
+					material.ambient[j] = osgMaterial->getAmbient(face)[j];
+					material.diffuse[j] = osgMaterial->getDiffuse(face)[j];
+					material.specular[j] = osgMaterial->getSpecular(face)[j];
+				}
+				/* Undo the OBJ reader's 0..1000 to 0..128 remapping: */
+				material.shininess = osgMaterial->getShininess(face) * 1000.0f
+						/ 128.0f;
+			}
+			const osg::Texture * texture =
+					dynamic_cast<const osg::Texture*> (states[s]->getTextureAttribute(
+							0, osg::StateAttribute::TEXTURE));
+			if (texture != 0 && texture->getImage(0) != 0) {
+				std::string fileName = texture->getImage(0)->getFileName();
+				std::string::size_type slash = fileName.find_last_of("/\\");
+				material.texture = slash == std::string::npos ? fileName
+						: fileName.substr(slash + 1);
+			}
+			if (!states[s]->getName().empty())
+				material.name = states[s]->getName();
+		}
+
+		for (Uint32 m = 0; m < mesh.materials.size(); ++m) {
+			if (sameMaterial(mesh.materials[m], material))
+				return m;
+		}
+		if (material.name.empty()) {
+			std::ostringstream name;
+			name << "material_" << mesh.materials.size();
+			material.name = name.str();
+		}
+		mesh.materials.push_back(material);
+		return static_cast<Uint32> (mesh.materials.size() - 1);
+	}
+
+	static bool sameMaterial(const ParkMaterial& a, const ParkMaterial& b) {
+		for (int j = 0; j < 4; ++j) {
+			if (a.ambient[j] != b.ambient[j] || a.diffuse[j] != b.diffuse[j]
+					|| a.specular[j] != b.specular[j])
+				return false;
+		}
+		return a.shininess == b.shininess && a.texture == b.texture
+				&& (b.name.empty() || a.name == b.name);
+	}
+};
+
+/*
+ * createPlaceholder - Image of the given extents without pixels, standing in
+ * for an image whose decoding is deferred.
+ */
+static osg::Image * createPlaceholder(Uint32 width, Uint32 height) {
+	osg::Image * image = new osg::Image();
+	image->setImage(width, height, 1, GL_RGB, GL_RGB, GL_UNSIGNED_BYTE, 0,
+			osg::Image::NO_DELETE);
+	return image;
+} // end createPlaceholder()
+
+/*
+ * hashImage - Finds the content hash of a texture file, from the texture
+ * pack when it lists the name, else by hashing the file in the model
+ * directory. Returns false if the file is missing.
+ */
+static bool hashImage(const std::string& name,
+		const std::string& modelDirectory, const TexturePack * texturePack,
+		Uint64& contentHash) {
+	TexturePack::Image packed;
+	if (texturePack != 0 && texturePack->find(name, packed)) {
+		contentHash = packed.contentHash;
+		return true;
+	}
+	try {
+		contentHash = Hash::hashFile(modelDirectory + "/" + name);
+	} catch (ResourceException& err) {
+		std::cerr << "Missing texture: " << err.getDescription() << std::endl;
+		return false;
+	}
+	return true;
+} // end hashImage()
+
+/*
+ * readImage - Returns the image of a texture file's content. A transcoded
+ * KTX file for the content wins; otherwise the image comes from the texture
+ * pack when it lists the name, else from the model directory. When
+ * deferring, a file whose header tells its size becomes a placeholder
+ * instead of being decoded.
+ */
+static osg::ref_ptr<osg::Image> readImage(const std::string& name,
+		Uint64 contentHash, const std::string& modelDirectory,
+		const TexturePack * texturePack, bool useCompressed, bool deferDecode) {
+	osg::ref_ptr<osg::Image> image;
+	CompressedImage compressed;
+	if (useCompressed && TextureCompressor::load(TextureCompressor::getPath(
+			modelDirectory, contentHash), compressed))
+		image = SceneBuilder::createImage(compressed);
+	else {
+		try {
+			TexturePack::Image packed;
+			const bool isPacked = texturePack != 0 && texturePack->find(name,
+					packed);
+			Uint32 width;
+			Uint32 height;
+			if (!deferDecode)
+				image = ImageDecoder::load(name, modelDirectory, texturePack);
+			else if (isPacked && ImageDecoder::readSize(packed.data,
+					packed.size, width, height))
+				image = createPlaceholder(width, height);
+			else if (!isPacked) {
+				MappedFile file(modelDirectory + "/" + name);
+				if (ImageDecoder::readSize(file.getData(), file.getSize(),
+						width, height))
+					image = createPlaceholder(width, height);
+			}
+			if (!image.valid())
+				image = ImageDecoder::load(name, modelDirectory, texturePack);
+		} catch (ResourceException& err) {
+			std::cerr << "Unreadable texture: " << err.getDescription()
+					<< std::endl;
+		}
+	}
+	if (image.valid())
+		image->setFileName(name);
+	return image;
+} // end readImage()
+
+/*
+ * runAll - Calls body(i) for every i in [0, count), on the workers if there
+ * is a pool.
+ */
+template<class BODY>
+static void runAll(ThreadPool * pool, unsigned int count, BODY& body) {
+	if (pool != 0)
+		pool->parallelFor(count, body);
+	else
+		for (unsigned int i = 0; i < count; ++i)
+			body(i);
+} // end runAll()
+
+/*
+ * HashImages - parallelFor body finding the content hash of texture i.
+ */
+struct HashImages {
+	const std::vector<std::string>& names;
+	const std::string& modelDirectory;
+	const TexturePack * texturePack;
+	std::vector<SceneBuilder::SceneImage> results;
+	/* Not a vector<bool>, whose elements share words */
+	std::vector<unsigned char> found;
+
+	HashImages(const std::vector<std::string>& _names,
+			const std::string& _modelDirectory,
+			const TexturePack * _texturePack) :
+		names(_names), modelDirectory(_modelDirectory), texturePack(
+				_texturePack), results(_names.size()), found(_names.size(), 0) {
+	}
+	void operator()(unsigned int i) {
+		found[i] = hashImage(names[i], modelDirectory, texturePack,
+				results[i].contentHash);
+	}
+};
+
+/*
+ * ReadImages - parallelFor body reading the image of the i-th distinct
+ * content.
+ */
+struct ReadImages {
+	HashImages& hashed;
+	const std::vector<Uint32>& readers;
+	bool useCompressed;
+	bool deferDecode;
+
+	ReadImages(HashImages& _hashed, const std::vector<Uint32>& _readers,
+			bool _useCompressed, bool _deferDecode) :
+		hashed(_hashed), readers(_readers), useCompressed(_useCompressed),
+				deferDecode(_deferDecode) {
+	}
+	void operator()(unsigned int i) {
+		SceneBuilder::SceneImage& result = hashed.results[readers[i]];
+		result.image = readImage(hashed.names[readers[i]], result.contentHash,
+				hashed.modelDirectory, hashed.texturePack, useCompressed,
+				deferDecode);
+	}
+};
+
+/*
+ * findTexture - Returns the texture for a named image, creating it on first
+ * use. Atlas pages clamp, since their tiles must not wrap into each other.
+ */
+static osg::Texture2D * findTexture(const std::string& name,
+		const SceneBuilder::ImageMap& images, TextureMap& textures) {
+	SceneBuilder::ImageMap::const_iterator imageIt = images.find(name);
+	if (imageIt == images.end() || !imageIt->second.image.valid())
+		return 0;
+
+	osg::Image * image = imageIt->second.image.get();
+	osg::ref_ptr<osg::Texture2D>& texture = textures[image];
+	if (!texture.valid()) {
+		const osg::Texture::WrapMode wrap =
+				TextureAtlas::isPageName(name) ? osg::Texture::CLAMP_TO_EDGE
+						: osg::Texture::REPEAT;
+		texture = new osg::Texture2D(image);
+		texture->setWrap(osg::Texture::WRAP_S, wrap);
+		texture->setWrap(osg::Texture::WRAP_T, wrap);
+	}
+	return texture.get();
+} // end findTexture()
+
+/*
+ * isReadableFormat - Whether readRgba() can convert the image.
+ */
+static bool isReadableFormat(const osg::Image& image) {
+	if (image.getPixelFormat() == GL_COMPRESSED_RGB_S3TC_DXT1_EXT
+			|| image.getPixelFormat() == GL_COMPRESSED_RGBA_S3TC_DXT5_EXT)
+		return image.r() == 1;
+	if (image.getDataType() != GL_UNSIGNED_BYTE || image.r() != 1)
+		return false;
+	switch (image.getPixelFormat()) {
+	case GL_RGB:
+	case GL_RGBA:
+	case GL_BGR:
+	case GL_BGRA:
+	case GL_LUMINANCE:
+	case GL_LUMINANCE_ALPHA:
+		return true;
+	default:
+		return false;
+	}
+} // end isReadableFormat()
+
+/*
+ * readTexel - Converts one texel of an uncompressed readable image to RGBA.
+ */
+static void readTexel(const osg::Image& image, int column, int row,
+		unsigned char * rgba) {
+	const unsigned char * texel = image.data(column, row);
+	switch (image.getPixelFormat()) {
+	case GL_RGB:
+		rgba[0] = texel[0];
+		rgba[1] = texel[1];
+		rgba[2] = texel[2];
+		rgba[3] = 255;
+		break;
+	case GL_RGBA:
+		std::memcpy(rgba, texel, 4);
+		break;
+	case GL_BGR:
+	case GL_BGRA:
+		rgba[0] = texel[2];
+		rgba[1] = texel[1];
+		rgba[2] = texel[0];
+		rgba[3] = image.getPixelFormat() == GL_BGRA ? texel[3] : 255;
+		break;
+	case GL_LUMINANCE:
+	case GL_LUMINANCE_ALPHA:
+		rgba[0] = rgba[1] = rgba[2] = texel[0];
+		rgba[3] = image.getPixelFormat() == GL_LUMINANCE_ALPHA ? texel[1]
+				: 255;
+		break;
+	}
+} // end readTexel()
+
+/*
+ * copyTile - Copies RGBA texels into their atlas tile and fills the gutter
+ * around them with the nearest edge texels, so that filtering and the first
+ * mipmap levels never pick up a neighbouring tile.
+ */
+static void copyTile(const std::vector<unsigned char>& rgba,
+		const AtlasTile& tile, osg::Image& page) {
+	const int gutter = static_cast<int> (TextureAtlas::GUTTER);
+	const int width = static_cast<int> (tile.width);
+	const int height = static_cast<int> (tile.height);
+	for (int y = -gutter; y < height + gutter; ++y) {
+		const int row = std::min(std::max(y, 0), height - 1);
+		unsigned char * target = page.data(tile.x - gutter, tile.y + y);
+		for (int x = -gutter; x < width + gutter; ++x, target += 4) {
+			const int column = std::min(std::max(x, 0), width - 1);
+			std::memcpy(target, &rgba[(row * width + column) * 4], 4);
+		}
+	}
+} // end copyTile()
+
+/*
+ * ComposeTiles - parallelFor body decoding texture i of the atlas pages if
+ * it is deferred, and copying it into its tile.
+ */
+struct ComposeTiles {
+	const SceneBuilder::ImageMap& images;
+	const std::string& modelDirectory;
+	const TexturePack * texturePack;
+	std::vector<const TextureAtlas::TileMap::value_type*> tiles;
+	std::vector<osg::ref_ptr<osg::Image> > pages;
+
+	ComposeTiles(const SceneBuilder::ImageMap& _images,
+			const std::string& _modelDirectory,
+			const TexturePack * _texturePack, size_t numPages) :
+		images(_images), modelDirectory(_modelDirectory), texturePack(
+				_texturePack), pages(numPages) {
+	}
+	void operator()(unsigned int i) {
+		const std::string& name = tiles[i]->first;
+		const AtlasTile& tile = tiles[i]->second;
+		osg::ref_ptr<osg::Image> image = images.find(name)->second.image;
+		if (SceneBuilder::isDeferred(*image)) {
+			try {
+				image = ImageDecoder::load(name, modelDirectory, texturePack);
+			} catch (ResourceException& err) {
+				std::cerr << "Unreadable texture: " << err.getDescription()
+						<< std::endl;
+				return;
+			}
+		}
+		std::vector<unsigned char> rgba;
+		if (image.valid() && SceneBuilder::readRgba(*image, rgba))
+			copyTile(rgba, tile, *pages[tile.page]);
+	}
+};
+
+/*
+ * getPageKey - Content key of an atlas page: its size and the content and
+ * placement of every tile on it.
+ */
+static Uint64 getPageKey(Uint32 page, const AtlasPage& size,
+		const TextureAtlas::TileMap& tiles,
+		const SceneBuilder::ImageMap& images) {
+	const Uint32 layout[3] = { size.width, size.height, TextureAtlas::GUTTER };
+	Uint64 key = Hash::hashBytes(layout, sizeof(layout));
+	for (TextureAtlas::TileMap::const_iterator it = tiles.begin(); it
+			!= tiles.end(); ++it) {
+		const AtlasTile& tile = it->second;
+		if (tile.page != page)
+			continue;
+		const Uint64 record[5] = { images.find(it->first)->second.contentHash,
+				tile.x, tile.y, tile.width, tile.height };
+		key = Hash::hashBytes(record, sizeof(record), key);
+	}
+	return key;
+} // end getPageKey()
+
+/*
+ * createStateSet - Builds the OSG state for one park material the same way
+ * the OBJ reader does.
+ */
+static osg::StateSet * createStateSet(const ParkMaterial& material,
+		const SceneBuilder::ImageMap& images, TextureMap& textures) {
+	osg::StateSet * stateSet = new osg::StateSet();
+	stateSet->setName(material.name);
+
+	osg::Material * osgMaterial = new osg::Material();
+	osgMaterial->setAmbient(osg::Material::FRONT_AND_BACK, osg::Vec4(
+			material.ambient[0], material.ambient[1], material.ambient[2],
+			material.ambient[3]));
+	osgMaterial->setDiffuse(osg::Material::FRONT_AND_BACK, osg::Vec4(
+			material.diffuse[0], material.diffuse[1], material.diffuse[2],
+			material.diffuse[3]));
+	osgMaterial->setSpecular(osg::Material::FRONT_AND_BACK, osg::Vec4(
+			material.specular[0], material.specular[1], material.specular[2],
+			material.specular[3]));
+	/* OBJ shininess is 0..1000: */
+	osgMaterial->setShininess(osg::Material::FRONT_AND_BACK,
+			material.shininess / 1000.0f * 128.0f);
+	stateSet->setAttribute(osgMaterial);
+
+	if (material.isTransparent()) {
+		stateSet->setMode(GL_BLEND, osg::StateAttribute::ON);
+		stateSet->setAttribute(new osg::BlendFunc(GL_SRC_ALPHA,
+				GL_ONE_MINUS_SRC_ALPHA));
+		stateSet->setRenderingHint(osg::StateSet::TRANSPARENT_BIN);
+	}
+
+	if (!material.texture.empty()) {
+		osg::Texture2D * texture = findTexture(material.texture, images,
+				textures);
+		if (texture != 0)
+			stateSet->setTextureAttributeAndModes(0, texture,
+					osg::StateAttribute::ON);
+	}
+
+	return stateSet;
+} // end createStateSet()
+
+/*
+ * ClusterElements - DrawElements of one cluster, skipped in the contexts
+ * whose current view does not see the cluster. A cluster no clipping plane
+ * cuts is drawn with the planes disabled, sparing its vertices the clip
+ * tests.
+ */
+template<class ELEMENTS>
+class ClusterElements: public ELEMENTS {
+public:
+	ClusterElements(const ViewClusters * _views, Uint32 _cluster,
+			unsigned int numIndices) :
+		ELEMENTS(GL_TRIANGLES, numIndices), views(_views), cluster(_cluster) {
+	}
+
+	virtual void draw(osg::State& state, bool useVertexBufferObjects) const {
+		if (!views->isVisible(state.getContextID(), cluster))
+			return;
+		const Uint32 numClipPlanes = views->getNumClipPlanes();
+		if (numClipPlanes == 0 || views->isStraddling(cluster)) {
+			ELEMENTS::draw(state, useVertexBufferObjects);
+			return;
+		}
+		for (Uint32 p = 0; p < numClipPlanes; ++p)
+			glDisable(GL_CLIP_PLANE0 + p);
+		ELEMENTS::draw(state, useVertexBufferObjects);
+		for (Uint32 p = 0; p < numClipPlanes; ++p)
+			glEnable(GL_CLIP_PLANE0 + p);
+	}
+
+private:
+	osg::ref_ptr<const ViewClusters> views;
+	Uint32 cluster;
+};
+
+/*
+ * fillElements - Copies a range of the index array into DrawElements.
+ */
+template<class ELEMENTS, class INDEX>
+static osg::PrimitiveSet * fillElements(ELEMENTS * elements,
+		const ParkMesh& mesh, Uint32 firstIndex) {
+	for (Uint32 i = 0; i < elements->size(); ++i)
+		(*elements)[i] = static_cast<INDEX> (mesh.indices[firstIndex + i]);
+	return elements;
+} // end fillElements()
+
+/*
+ * createDrawElements - Triangle list for a range of the index array, with
+ * 16-bit indices where the vertex array allows. With views, the range
+ * belongs to the given cluster and is only drawn where it is visible.
+ */
+static osg::PrimitiveSet * createDrawElements(const ParkMesh& mesh,
+		Uint32 firstIndex, Uint32 numIndices, const ViewClusters * views = 0,
+		Uint32 cluster = 0) {
+	if (SceneBuilder::getIndexSize(mesh) == sizeof(Uint32)) {
+		if (views == 0)
+			return new osg::DrawElementsUInt(GL_TRIANGLES, numIndices,
+					&mesh.indices[firstIndex]);
+		return fillElements<osg::DrawElementsUInt, GLuint> (new ClusterElements<
+				osg::DrawElementsUInt> (views, cluster, numIndices), mesh,
+				firstIndex);
+	}
+	if (views == 0)
+		return fillElements<osg::DrawElementsUShort, GLushort> (
+				new osg::DrawElementsUShort(GL_TRIANGLES, numIndices), mesh,
+				firstIndex);
+	return fillElements<osg::DrawElementsUShort, GLushort> (
+			new ClusterElements<osg::DrawElementsUShort> (views, cluster,
+					numIndices), mesh, firstIndex);
+} // end createDrawElements()
+
+/*
+ * QuantizedGeometry - Geometry with fixed-point vertices, which OSG cannot
+ * compute bounds of; its bound is given in stored coordinates.
+ */
+class QuantizedGeometry: public osg::Geometry {
+public:
+	QuantizedGeometry(const osg::BoundingBox& _bound) :
+		bound(_bound) {
+	}
+
+	virtual osg::BoundingBox computeBound(void) const {
+		return bound;
+	}
+
+private:
+	osg::BoundingBox bound;
+};
+
+/*
+ * DrawRuns - Collects index ranges into as few DrawElements as possible by
+ * joining ranges that continue each other. With views, runs stop at cluster
+ * boundaries so each cluster can be culled on its own.
+ */
+struct DrawRuns {
+	osg::Geometry * geometry;
+	const ParkMesh * mesh;
+	const ViewClusters * views;
+	Uint32 cluster;
+	Uint32 runStart;
+	Uint32 runEnd;
+
+	void setCluster(Uint32 _cluster) {
+		if (views == 0)
+			return;
+		flush();
+		cluster = _cluster;
+	}
+
+	void add(Uint32 firstIndex, Uint32 numIndices) {
+		if (numIndices == 0)
+			return;
+		if (runEnd != firstIndex) {
+			flush();
+			runStart = firstIndex;
+		}
+		runEnd = firstIndex + numIndices;
+	}
+
+	void flush(void) {
+		if (runEnd > runStart)
+			geometry->addPrimitiveSet(createDrawElements(*mesh, runStart,
+					runEnd - runStart, views, cluster));
+		runStart = runEnd;
+	}
+};
+
+/*
+ * INSTANCE_SHADER_VERSION - Directives that must open the instance shader,
+ * ahead of the MAX_INSTANCES definition.
+ */
+static const char INSTANCE_SHADER_VERSION[] = "#version 120\n"
+	"#extension GL_EXT_gpu_shader4 : enable\n";
+
+/*
+ * INSTANCE_SHADER - Vertex stage of the instanced draws: places the
+ * prototype by three rows of its instance's transform and lights it the way
+ * the fixed-function pipeline lights the batches, with the lights lightMask
+ * marks enabled and without a local viewer. Fragments stay fixed-function.
+ */
+static const char INSTANCE_SHADER[] =
+	"uniform vec4 instanceRows[3 * MAX_INSTANCES];\n"
+	"uniform int lightMask;\n"
+	"void main(void) {\n"
+	"	int row = 3 * gl_InstanceID;\n"
+	"	vec4 vertex = vec4(dot(instanceRows[row], gl_Vertex),\n"
+	"			dot(instanceRows[row + 1], gl_Vertex),\n"
+	"			dot(instanceRows[row + 2], gl_Vertex), gl_Vertex.w);\n"
+	"	vec3 normal = vec3(dot(instanceRows[row].xyz, gl_Normal),\n"
+	"			dot(instanceRows[row + 1].xyz, gl_Normal),\n"
+	"			dot(instanceRows[row + 2].xyz, gl_Normal));\n"
+	"	vec4 eye = gl_ModelViewMatrix * vertex;\n"
+	"	gl_Position = gl_ProjectionMatrix * eye;\n"
+	"	gl_ClipVertex = eye;\n"
+	"	gl_FogFragCoord = abs(eye.z);\n"
+	"	gl_TexCoord[0] = gl_TextureMatrix[0] * gl_MultiTexCoord0;\n"
+	"	if ((lightMask & 256) == 0) {\n"
+	"		gl_FrontColor = gl_BackColor = gl_Color;\n"
+	"		return;\n"
+	"	}\n"
+	"	normal = normalize(gl_NormalMatrix * normal);\n"
+	"	vec4 color = gl_FrontLightModelProduct.sceneColor;\n"
+	"	for (int i = 0; i < 8; ++i) {\n"
+	"		if ((lightMask & (1 << i)) == 0)\n"
+	"			continue;\n"
+	"		vec3 toLight = gl_LightSource[i].position.xyz;\n"
+	"		float attenuation = 1.0;\n"
+	"		if (gl_LightSource[i].position.w != 0.0) {\n"
+	"			toLight -= eye.xyz;\n"
+	"			float distance = length(toLight);\n"
+	"			attenuation = 1.0 / (gl_LightSource[i].constantAttenuation\n"
+	"					+ gl_LightSource[i].linearAttenuation * distance\n"
+	"					+ gl_LightSource[i].quadraticAttenuation * distance\n"
+	"							* distance);\n"
+	"			if (gl_LightSource[i].spotCutoff <= 90.0) {\n"
+	"				float spot = dot(normalize(-toLight),\n"
+	"						normalize(gl_LightSource[i].spotDirection));\n"
+	"				attenuation *= spot < gl_LightSource[i].spotCosCutoff ? 0.0\n"
+	"						: pow(spot, gl_LightSource[i].spotExponent);\n"
+	"			}\n"
+	"		}\n"
+	"		toLight = normalize(toLight);\n"
+	"		float diffuse = max(dot(normal, toLight), 0.0);\n"
+	"		vec4 lit = gl_FrontLightProduct[i].ambient\n"
+	"				+ diffuse * gl_FrontLightProduct[i].diffuse;\n"
+	"		if (diffuse > 0.0)\n"
+	"			lit += pow(max(dot(normal, normalize(toLight\n"
+	"					+ vec3(0.0, 0.0, 1.0))), 0.0),\n"
+	"					gl_FrontMaterial.shininess)\n"
+	"					* gl_FrontLightProduct[i].specular;\n"
+	"		color += attenuation * lit;\n"
+	"	}\n"
+	"	color.a = gl_FrontMaterial.diffuse.a;\n"
+	"	gl_FrontColor = gl_BackColor = clamp(color, 0.0, 1.0);\n"
+	"}\n";
+
+/* Enable bit of GL_LIGHTING in the lightMask uniform */
+static const GLint LIGHTING_BIT = 1 << 8;
+
+/*
+ * InstanceGeometry - Draws a prototype group once per visible instance with
+ * one instanced draw, sharing the batch geometry's arrays and, apart from
+ * the shader, its state. The rows of the instance transforms, in stored
+ * coordinates, go to the shader as a uniform array; lighting is whatever
+ * the fixed-function state at draw time says, so it follows the lights the
+ * VR environment enables outside the scene graph. Contexts the shader fails
+ * in draw the prototype once per instance instead, under the instance's
+ * transform.
+ */
+class InstanceGeometry: public osg::Geometry {
+public:
+	InstanceGeometry(Uint32 _batch, const std::vector<Uint32>& _groups,
+			const std::vector<osg::Vec4>& _rows,
+			const osg::BoundingBox& _bound, osg::Program * _program,
+			osg::Geometry * _prototype) :
+		batch(_batch), groups(_groups), rows(_rows), bound(_bound),
+				program(_program), prototype(_prototype), numVisible(0) {
+		instanceRows = new osg::Uniform(osg::Uniform::FLOAT_VEC4,
+				"instanceRows", 3 * SceneBuilder::MAX_INSTANCES);
+	}
+
+	Uint32 getBatch(void) const {
+		return batch;
+	}
+
+	/*
+	 * setBatchState - Draws with a copy of the batch's state, sharing its
+	 * material, texture and texture matrix.
+	 */
+	void setBatchState(const osg::StateSet * batchState) {
+		osg::StateSet * stateSet = new osg::StateSet(*batchState,
+				osg::CopyOp::SHALLOW_COPY);
+		stateSet->setAttributeAndModes(program.get(), osg::StateAttribute::ON);
+		stateSet->addUniform(instanceRows.get());
+		setStateSet(stateSet);
+	}
+
+	/*
+	 * setVisible - Drops the instances of hidden groups from the draw.
+	 *
+	 * parameter groupVisibility - const std::vector<bool>&, indexed by group
+	 * id, or empty to draw every instance
+	 */
+	void setVisible(const std::vector<bool>& groupVisibility) {
+		numVisible = 0;
+		for (size_t i = 0; i < groups.size(); ++i) {
+			if (!groupVisibility.empty() && !groupVisibility[groups[i]])
+				continue;
+			for (int r = 0; r < 3; ++r)
+				instanceRows->setElement(3 * numVisible + r, rows[3 * i + r]);
+			++numVisible;
+		}
+		if (getNumPrimitiveSets() != 0)
+			getPrimitiveSet(0)->setNumInstances(numVisible);
+	}
+
+	virtual osg::BoundingBox computeBound(void) const {
+		return bound;
+	}
+
+	virtual void resizeGLObjectBuffers(unsigned int maxSize) {
+		osg::Geometry::resizeGLObjectBuffers(maxSize);
+		prototype->resizeGLObjectBuffers(maxSize);
+	}
+
+	virtual void releaseGLObjects(osg::State * state = 0) const {
+		osg::Geometry::releaseGLObjects(state);
+		prototype->releaseGLObjects(state);
+	}
+
+	virtual void drawImplementation(osg::RenderInfo& renderInfo) const {
+		if (numVisible == 0)
+			return;
+		/* Without the shader every instance would land on the prototype: */
+		osg::State& state = *renderInfo.getState();
+		const osg::Program::PerContextProgram * perContext =
+				state.getLastAppliedProgramObject();
+		if (perContext == 0) {
+			drawEach(renderInfo);
+			return;
+		}
+		/* The state has applied the program; hand it the enabled lights,
+		 * as the state tracks them rather than by asking GL: */
+		GLint lightMask = state.getLastAppliedMode(GL_LIGHTING) ? LIGHTING_BIT
+				: 0;
+		for (GLint l = 0; l < 8; ++l)
+			if (state.getLastAppliedMode(GL_LIGHT0 + l))
+				lightMask |= 1 << l;
+		osg::GL2Extensions::Get(state.getContextID(), true)->glUniform1i(
+				perContext->getUniformLocation("lightMask"), lightMask);
+		osg::Geometry::drawImplementation(renderInfo);
+	}
+
+private:
+	Uint32 batch;
+	/* Group of each instance, and three transform rows per instance */
+	std::vector<Uint32> groups;
+	std::vector<osg::Vec4> rows;
+	osg::BoundingBox bound;
+	osg::ref_ptr<osg::Program> program;
+	/* The prototype drawn once, sharing the arrays */
+	osg::ref_ptr<osg::Geometry> prototype;
+	osg::ref_ptr<osg::Uniform> instanceRows;
+	unsigned int numVisible;
+
+	/*
+	 * drawEach - Draws the visible instances one at a time through the
+	 * fixed-function pipeline, for contexts the shader failed to compile or
+	 * link in. The program's failure left no program applied.
+	 */
+	void drawEach(osg::RenderInfo& renderInfo) const {
+		glMatrixMode(GL_MODELVIEW);
+		for (unsigned int i = 0; i < numVisible; ++i) {
+			osg::Vec4 row[3];
+			for (int r = 0; r < 3; ++r)
+				instanceRows->getElement(3 * i + r, row[r]);
+			const GLfloat transform[16] = { row[0][0], row[1][0], row[2][0],
+					0.0f, row[0][1], row[1][1], row[2][1], 0.0f, row[0][2],
+					row[1][2], row[2][2], 0.0f, row[0][3], row[1][3],
+					row[2][3], 1.0f };
+			glPushMatrix();
+			glMultMatrixf(transform);
+			prototype->drawImplementation(renderInfo);
+			glPopMatrix();
+		}
+	}
+};
+
+/*
+ * addInstances - Appends the instanced draws of the mesh's folded groups to
+ * a geode holding its batch drawables, up to MAX_INSTANCES instances per
+ * draw. The transforms are carried into stored coordinates when the
+ * vertices are quantized: the scale is uniform, so only the translation
+ * changes.
+ */
+static void addInstances(const ParkMesh& mesh, const QuantizedMesh * quantized,
+		osg::Geode * geode) {
+	osg::Geometry * source = geode->getDrawable(0)->asGeometry();
+	std::ostringstream shaderSource;
+	shaderSource << INSTANCE_SHADER_VERSION << "#define MAX_INSTANCES "
+			<< SceneBuilder::MAX_INSTANCES << "\n" << INSTANCE_SHADER;
+	osg::Program * program = new osg::Program();
+	program->setName("ParkInstances");
+	program->addShader(new osg::Shader(osg::Shader::VERTEX,
+			shaderSource.str()));
+
+	size_t i = 0;
+	while (i < mesh.instances.size()) {
+		const Uint32 prototype = mesh.instances[i].prototype;
+		std::vector<Uint32> groups;
+		std::vector<osg::Vec4> rows;
+		osg::BoundingBox bound;
+		for (; i < mesh.instances.size() && mesh.instances[i].prototype
+				== prototype && groups.size() < SceneBuilder::MAX_INSTANCES;
+				++i) {
+			const ParkInstance& instance = mesh.instances[i];
+			const ParkGroup& group = mesh.groups[instance.group];
+			float translation[3];
+			for (int r = 0; r < 3; ++r) {
+				translation[r] = instance.translation[r];
+				if (quantized == 0)
+					continue;
+				/* t' = (R o + t - o) / s for p = s q + o: */
+				for (int c = 0; c < 3; ++c)
+					translation[r] += instance.rotation[3 * r + c]
+							* quantized->positionOffset[c];
+				translation[r] = (translation[r] - quantized->positionOffset[r])
+						/ quantized->positionScale;
+			}
+			for (int r = 0; r < 3; ++r)
+				rows.push_back(osg::Vec4(instance.rotation[3 * r],
+						instance.rotation[3 * r + 1], instance.rotation[3 * r
+								+ 2], translation[r]));
+			groups.push_back(instance.group);
+
+			osg::Vec3 boundsMin(group.boundsMin[0], group.boundsMin[1],
+					group.boundsMin[2]);
+			osg::Vec3 boundsMax(group.boundsMax[0], group.boundsMax[1],
+					group.boundsMax[2]);
+			if (quantized != 0) {
+				const osg::Vec3 offset(quantized->positionOffset[0],
+						quantized->positionOffset[1],
+						quantized->positionOffset[2]);
+				const osg::Vec3 margin(1.0f, 1.0f, 1.0f);
+				boundsMin = (boundsMin - offset) / quantized->positionScale
+						- margin;
+				boundsMax = (boundsMax - offset) / quantized->positionScale
+						+ margin;
+			}
+			bound.expandBy(boundsMin);
+			bound.expandBy(boundsMax);
+		}
+
+		const ParkGroup& group = mesh.groups[prototype];
+		osg::Geometry * single = new osg::Geometry();
+		single->setUseDisplayList(false);
+		single->setUseVertexBufferObjects(true);
+		single->setVertexArray(source->getVertexArray());
+		single->setNormalArray(source->getNormalArray());
+		single->setNormalBinding(osg::Geometry::BIND_PER_VERTEX);
+		single->setTexCoordArray(0, source->getTexCoordArray(0));
+		single->addPrimitiveSet(createDrawElements(mesh, group.firstIndex,
+				group.numIndices));
+		InstanceGeometry * geometry = new InstanceGeometry(group.batch, groups,
+				rows, bound, program, single);
+		geometry->setUseDisplayList(false);
+		geometry->setUseVertexBufferObjects(true);
+		geometry->setVertexArray(source->getVertexArray());
+		geometry->setNormalArray(source->getNormalArray());
+		geometry->setNormalBinding(osg::Geometry::BIND_PER_VERTEX);
+		geometry->setTexCoordArray(0, source->getTexCoordArray(0));
+		geometry->addPrimitiveSet(createDrawElements(mesh, group.firstIndex,
+				group.numIndices));
+		geometry->setVisible(std::vector<bool>());
+		geometry->setBatchState(geode->getDrawable(group.batch)->getStateSet());
+		geode->addDrawable(geometry);
+	}
+} // end addInstances()
+
+/*******************************
+ Methods of class SceneBuilder:
+ *******************************/
+
+/*
+ * loadImages - Reads the texture of every material, preferring transcoded
+ * KTX files. Names whose image cannot be read map to a null image. Deferred
+ * images are placeholders of the right size, see isDeferred(). With a pool,
+ * the files are hashed and read on its workers, and the images only have to
+ * be uploaded by whoever draws them.
+ *
+ * parameter mesh - const ParkMesh&
+ * parameter modelDirectory - const std::string&
+ * parameter texturePack - const TexturePack *, optional image archive
+ * parameter images - ImageMap&
+ * parameter useCompressed - bool, false to always decode the source images
+ * parameter deferDecode - bool, true to leave decoding source images to
+ * whoever draws them
+ * parameter pool - ThreadPool *, workers to read on, or null to read on the
+ * calling thread
+ */
+void SceneBuilder::loadImages(const ParkMesh& mesh,
+		const std::string& modelDirectory, const TexturePack * texturePack,
+		ImageMap& images, bool useCompressed, bool deferDecode,
+		ThreadPool * pool) {
+	std::vector<std::string> names;
+	for (size_t m = 0; m < mesh.materials.size(); ++m) {
+		const std::string& name = mesh.materials[m].texture;
+		if (!name.empty() && images.find(name) == images.end()) {
+			images[name] = SceneImage();
+			names.push_back(name);
+		}
+	}
+	HashImages hashed(names, modelDirectory, texturePack);
+	runAll(pool, static_cast<unsigned int> (names.size()), hashed);
+
+	/* Read each content once, under the first name it has: */
+	ContentMap firsts;
+	std::vector<Uint32> readers;
+	for (Uint32 n = 0; n < names.size(); ++n)
+		if (hashed.found[n] && firsts.insert(std::make_pair(
+				hashed.results[n].contentHash, n)).second)
+			readers.push_back(n);
+	ReadImages read(hashed, readers, useCompressed, deferDecode);
+	runAll(pool, static_cast<unsigned int> (readers.size()), read);
+
+	for (Uint32 n = 0; n < names.size(); ++n) {
+		if (!hashed.found[n])
+			continue;
+		SceneImage& image = images[names[n]];
+		image.contentHash = hashed.results[n].contentHash;
+		image.image = hashed.results[firsts[image.contentHash]].image;
+	}
+} // end loadImages()
+
+/*
+ * isDeferred - Whether an image is a placeholder left by loadImages(), with
+ * the size of the texture file but no pixels. Its file name is the texture
+ * name to decode with ImageDecoder::load().
+ *
+ * parameter image - const osg::Image&
+ * return - bool
+ */
+bool SceneBuilder::isDeferred(const osg::Image& image) {
+	return image.data() == 0 && image.s() > 0;
+} // end isDeferred()
+
+/*
+ * buildAtlases - Runs TextureAtlas::build() on the loaded images and adds
+ * the pages to the image map under their page names. A page is read from its
+ * transcoded KTX file if one matches its content key, otherwise composed as
+ * RGBA from its tiles.
+ *
+ * parameter mesh - ParkMesh&, before MaterialMerger::merge()
+ * parameter images - ImageMap&, as filled by loadImages()
+ * parameter modelDirectory - const std::string&
+ * parameter tiles - TextureAtlas::TileMap *, receives the tile of every
+ * texture moved into a page, or null
+ * parameter texturePack - const TexturePack *, to decode deferred images
+ * composed into pages from
+ * parameter pool - ThreadPool *, workers to decode and copy the tiles on, or
+ * null to compose on the calling thread
+ * return - Uint32, the number of atlas pages
+ */
+Uint32 SceneBuilder::buildAtlases(ParkMesh& mesh, ImageMap& images,
+		const std::string& modelDirectory, TextureAtlas::TileMap * tiles,
+		const TexturePack * texturePack, ThreadPool * pool) {
+	TextureAtlas::SizeMap sizes;
+	for (ImageMap::const_iterator it = images.begin(); it != images.end(); ++it) {
+		const osg::Image * image = it->second.image.get();
+		if (image != 0 && isReadableFormat(*image))
+			sizes[it->first] = std::make_pair(static_cast<Uint32> (image->s()),
+					static_cast<Uint32> (image->t()));
+	}
+
+	TextureAtlas::TileMap pageTiles;
+	std::vector<AtlasPage> pages;
+	TextureAtlas::build(mesh, sizes, pageTiles, pages);
+
+	/* Pages not transcoded are composed from their tiles, which do not
+	 * overlap, so all of them can be copied at once: */
+	ComposeTiles compose(images, modelDirectory, texturePack, pages.size());
+	std::vector<SceneImage> composed(pages.size());
+	for (Uint32 p = 0; p < pages.size(); ++p) {
+		SceneImage page;
+		page.contentHash = getPageKey(p, pages[p], pageTiles, images);
+		CompressedImage compressed;
+		if (TextureCompressor::load(TextureCompressor::getPath(modelDirectory,
+				page.contentHash), compressed) && compressed.width
+				== pages[p].width && compressed.height == pages[p].height) {
+			page.image = createImage(compressed);
+		} else {
+			page.image = new osg::Image();
+			page.image->allocateImage(pages[p].width, pages[p].height, 1,
+					GL_RGBA, GL_UNSIGNED_BYTE);
+			std::memset(page.image->data(), 0,
+					page.image->getTotalSizeInBytes());
+			for (TextureAtlas::TileMap::const_iterator it = pageTiles.begin(); it
+					!= pageTiles.end(); ++it)
+				if (it->second.page == p)
+					compose.tiles.push_back(&*it);
+			compose.pages[p] = page.image;
+		}
+		page.image->setFileName(TextureAtlas::getPageName(p));
+		composed[p] = page;
+	}
+	runAll(pool, static_cast<unsigned int> (compose.tiles.size()), compose);
+	for (Uint32 p = 0; p < pages.size(); ++p)
+		images[composed[p].image->getFileName()] = composed[p];
+
+	if (tiles != 0)
+		tiles->swap(pageTiles);
+	return static_cast<Uint32> (pages.size());
+} // end buildAtlases()
+
+/*
+ * buildNode - Creates a scene graph for a merged mesh: one VBO-backed indexed
+ * geometry per material batch, all of them sharing the same vertex arrays.
+ * Drawable i of the returned geode draws batch i; the instanced draws of
+ * the folded groups follow the batches. With quantized vertices,
+ * each batch's texture matrix restores its texture coordinates and the
+ * geode has to be drawn below getDequantization().
+ *
+ * parameter mesh - const ParkMesh&, after MaterialMerger::merge()
+ * parameter images - const ImageMap&, as filled by loadImages()
+ * parameter quantized - const QuantizedMesh *, made from mesh, or null to
+ * draw the float vertices
+ * return - osg::Geode *
+ */
+osg::Geode * SceneBuilder::buildNode(const ParkMesh& mesh,
+		const ImageMap& images, const QuantizedMesh * quantized) {
+	osg::ref_ptr<osg::Array> positions;
+	osg::ref_ptr<osg::Array> normals;
+	osg::ref_ptr<osg::Array> texCoords;
+	if (quantized != 0) {
+		osg::Vec4sArray * quantizedPositions = new osg::Vec4sArray(
+				mesh.vertices.size());
+		osg::Vec3bArray * quantizedNormals = new osg::Vec3bArray(
+				mesh.vertices.size());
+		osg::Vec2sArray * quantizedTexCoords = new osg::Vec2sArray(
+				mesh.vertices.size());
+		for (size_t v = 0; v < mesh.vertices.size(); ++v) {
+			const Int16 * position = &quantized->positions[4 * v];
+			const Int8 * normal = &quantized->normals[3 * v];
+			const Int16 * texCoord = &quantized->texCoords[2 * v];
+			(*quantizedPositions)[v].set(position[0], position[1], position[2],
+					position[3]);
+			(*quantizedNormals)[v].set(normal[0], normal[1], normal[2]);
+			(*quantizedTexCoords)[v].set(texCoord[0], texCoord[1]);
+		}
+		positions = quantizedPositions;
+		normals = quantizedNormals;
+		texCoords = quantizedTexCoords;
+	} else {
+		osg::Vec3Array * floatPositions = new osg::Vec3Array(
+				mesh.vertices.size());
+		osg::Vec3Array * floatNormals = new osg::Vec3Array(mesh.vertices.size());
+		osg::Vec2Array * floatTexCoords = new osg::Vec2Array(
+				mesh.vertices.size());
+		for (size_t v = 0; v < mesh.vertices.size(); ++v) {
+			const ParkVertex& vertex = mesh.vertices[v];
+			(*floatPositions)[v].set(vertex.position[0], vertex.position[1],
+					vertex.position[2]);
+			(*floatNormals)[v].set(vertex.normal[0], vertex.normal[1],
+					vertex.normal[2]);
+			(*floatTexCoords)[v].set(vertex.texCoord[0], vertex.texCoord[1]);
+		}
+		positions = floatPositions;
+		normals = floatNormals;
+		texCoords = floatTexCoords;
+	}
+
+	TextureMap textures;
+	std::vector<osg::ref_ptr<osg::StateSet> > stateSets;
+	for (size_t m = 0; m < mesh.materials.size(); ++m)
+		stateSets.push_back(createStateSet(mesh.materials[m], images,
+				textures));
+
+	osg::Geode * geode = new osg::Geode();
+	geode->setName("Park");
+	for (size_t b = 0; b < mesh.batches.size(); ++b) {
+		const ParkBatch& batch = mesh.batches[b];
+		osg::Geometry * geometry = 0;
+		if (quantized != 0) {
+			/* The batch bounds in stored coordinates: */
+			osg::BoundingBox bound;
+			for (Uint32 c = batch.firstCluster; c < batch.firstCluster
+					+ batch.numClusters; ++c) {
+				const ParkCluster& cluster = mesh.clusters[c];
+				for (int i = 0; i < 3; ++i) {
+					bound._min[i] = std::min(bound._min[i],
+							(cluster.boundsMin[i] - quantized->positionOffset[i])
+									/ quantized->positionScale - 1.0f);
+					bound._max[i] = std::max(bound._max[i],
+							(cluster.boundsMax[i] - quantized->positionOffset[i])
+									/ quantized->positionScale + 1.0f);
+				}
+			}
+			geometry = new QuantizedGeometry(bound);
+
+			const float * offset = &quantized->texCoordOffsets[2 * b];
+			const float * scale = &quantized->texCoordScales[2 * b];
+			stateSets[batch.material]->setTextureAttribute(0, new osg::TexMat(
+					osg::Matrix::scale(scale[0], scale[1], 1.0)
+							* osg::Matrix::translate(offset[0], offset[1], 0.0)));
+		} else
+			geometry = new osg::Geometry();
+		geometry->setUseDisplayList(false);
+		geometry->setUseVertexBufferObjects(true);
+		geometry->setVertexArray(positions.get());
+		geometry->setNormalArray(normals.get());
+		geometry->setNormalBinding(osg::Geometry::BIND_PER_VERTEX);
+		geometry->setTexCoordArray(0, texCoords.get());
+		geometry->addPrimitiveSet(createDrawElements(mesh, batch.firstIndex,
+				batch.numIndices));
+		geometry->setStateSet(stateSets[batch.material].get());
+		geode->addDrawable(geometry);
+	}
+	if (!mesh.instances.empty())
+		addInstances(mesh, quantized, geode);
+
+	return geode;
+} // end buildNode()
+
+/*
+ * getDequantization - Transform restoring quantized positions, with the
+ * normals renormalized after it.
+ *
+ * parameter quantized - const QuantizedMesh&
+ * return - osg::MatrixTransform *
+ */
+osg::MatrixTransform * SceneBuilder::getDequantization(
+		const QuantizedMesh& quantized) {
+	osg::MatrixTransform * transform = new osg::MatrixTransform(
+			osg::Matrix::scale(quantized.positionScale, quantized.positionScale,
+					quantized.positionScale) * osg::Matrix::translate(
+					quantized.positionOffset[0], quantized.positionOffset[1],
+					quantized.positionOffset[2]));
+	transform->setName("ParkDequantization");
+	transform->getOrCreateStateSet()->setMode(GL_NORMALIZE,
+			osg::StateAttribute::ON);
+	return transform;
+} // end getDequantization()
+
+/*
+ * getIndexSize - Bytes per index the park draws are submitted with.
+ *
+ * parameter mesh - const ParkMesh&
+ * return - size_t
+ */
+size_t SceneBuilder::getIndexSize(const ParkMesh& mesh) {
+	return mesh.vertices.size() <= 65536 ? sizeof(GLushort) : sizeof(Uint32);
+} // end getIndexSize()
+
+/*
+ * createImage - Wraps a block-compressed mipmap chain in an OSG image, which
+ * uploads the levels as they are instead of generating them.
+ *
+ * parameter compressed - const CompressedImage&
+ * return - osg::Image *
+ */
+osg::Image * SceneBuilder::createImage(const CompressedImage& compressed) {
+	const GLenum format = compressed.hasAlpha ? GL_COMPRESSED_RGBA_S3TC_DXT5_EXT
+			: GL_COMPRESSED_RGB_S3TC_DXT1_EXT;
+	unsigned char * data = new unsigned char[compressed.data.size()];
+	std::memcpy(data, &compressed.data[0], compressed.data.size());
+
+	osg::Image * image = new osg::Image();
+	image->setImage(compressed.width, compressed.height, 1, format, format,
+			GL_UNSIGNED_BYTE, data, osg::Image::USE_NEW_DELETE);
+	osg::Image::MipmapDataType levels(compressed.levelOffsets.begin() + 1,
+			compressed.levelOffsets.end());
+	image->setMipmapLevels(levels);
+	return image;
+} // end createImage()
+
+/*
+ * readRgba - Converts level 0 of an image to tightly packed RGBA texels in
+ * OSG row order, decoding BC1/BC3 images.
+ *
+ * parameter image - const osg::Image&
+ * parameter rgba - std::vector<unsigned char>&
+ * return - bool, false if the format is not supported or the image deferred
+ */
+bool SceneBuilder::readRgba(const osg::Image& image,
+		std::vector<unsigned char>& rgba) {
+	if (!isReadableFormat(image) || isDeferred(image))
+		return false;
+	rgba.resize(image.s() * image.t() * 4);
+	if (image.isCompressed()) {
+		TextureCompressor::decompress(image.data(), image.s(), image.t(),
+				image.getPixelFormat() == GL_COMPRESSED_RGBA_S3TC_DXT5_EXT,
+				&rgba[0]);
+		return true;
+	}
+	for (int t = 0; t < image.t(); ++t) {
+		for (int s = 0; s < image.s(); ++s)
+			readTexel(image, s, t, &rgba[(t * image.s() + s) * 4]);
+	}
+	return true;
+} // end readRgba()
+
+/*
+ * updateBatch - Rebuilds the primitive sets of one batch geometry so that it
+ * draws each cluster at its level, and only the visible groups. A cluster
+ * with hidden groups is drawn at level 0. Adjacent ranges are coalesced, so
+ * a fully visible batch at one level stays a single draw.
+ *
+ * parameter geode - osg::Geode *, as returned by buildNode()
+ * parameter mesh - const ParkMesh&
+ * parameter batch - unsigned int
+ * parameter groupVisibility - const std::vector<bool>&, indexed by group id
+ * parameter clusterLevels - const std::vector<Uint32>&, indexed by cluster,
+ * empty for level 0 everywhere
+ * parameter views - const ViewClusters *, to draw each cluster only in the
+ * views that see it, or null
+ */
+void SceneBuilder::updateBatch(osg::Geode * geode, const ParkMesh& mesh,
+		unsigned int batch, const std::vector<bool>& groupVisibility,
+		const std::vector<Uint32>& clusterLevels, const ViewClusters * views) {
+	osg::Geometry * geometry = geode->getDrawable(batch)->asGeometry();
+	geometry->removePrimitiveSet(0, geometry->getNumPrimitiveSets());
+
+	const ParkBatch& parkBatch = mesh.batches[batch];
+	DrawRuns runs;
+	runs.geometry = geometry;
+	runs.mesh = &mesh;
+	runs.views = views;
+	runs.cluster = 0;
+	runs.runStart = runs.runEnd = 0;
+	for (Uint32 c = parkBatch.firstCluster; c < parkBatch.firstCluster
+			+ parkBatch.numClusters; ++c) {
+		const ParkCluster& cluster = mesh.clusters[c];
+		runs.setCluster(c);
+		Uint32 level = clusterLevels.empty() ? 0 : std::min(clusterLevels[c],
+				cluster.numLevels - 1);
+		for (Uint32 b = cluster.firstGroup; b < cluster.firstGroup
+				+ cluster.numGroups && level != 0; ++b) {
+			if (!groupVisibility[mesh.batchGroups[b]])
+				level = 0;
+		}
+		if (level != 0) {
+			runs.add(cluster.firstIndex[level], cluster.numIndices[level]);
+			continue;
+		}
+		for (Uint32 b = cluster.firstGroup; b < cluster.firstGroup
+				+ cluster.numGroups; ++b) {
+			const ParkGroup& group = mesh.groups[mesh.batchGroups[b]];
+			if (groupVisibility[mesh.batchGroups[b]])
+				runs.add(group.firstIndex, group.numIndices);
+		}
+	}
+	runs.flush();
+	geometry->dirtyBound();
+} // end updateBatch()
+
+/*
+ * updateInstances - Leaves the folded groups that are hidden out of the
+ * instanced draws.
+ *
+ * parameter geode - osg::Geode *, as returned by buildNode()
+ * parameter mesh - const ParkMesh&
+ * parameter groupVisibility - const std::vector<bool>&, indexed by group id
+ */
+void SceneBuilder::updateInstances(osg::Geode * geode, const ParkMesh& mesh,
+		const std::vector<bool>& groupVisibility) {
+	for (size_t d = mesh.batches.size(); d < geode->getNumDrawables(); ++d)
+		static_cast<InstanceGeometry*> (geode->getDrawable(d))->setVisible(
+				groupVisibility);
+} // end updateInstances()
+
+/*
+ * updateMaterial - Rebuilds the state of the batch drawing a material whose
+ * properties changed. The batch keeps its texture matrix, and its texture
+ * unless the images hold one for the material.
+ *
+ * parameter geode - osg::Geode *, as returned by buildNode()
+ * parameter mesh - const ParkMesh&, with the changed material
+ * parameter material - Uint32
+ * parameter images - const ImageMap&, new images by texture name
+ */
+void SceneBuilder::updateMaterial(osg::Geode * geode, const ParkMesh& mesh,
+		Uint32 material, const ImageMap& images) {
+	const ParkMaterial& parkMaterial = mesh.materials[material];
+	for (unsigned int b = 0; b < mesh.batches.size(); ++b) {
+		if (mesh.batches[b].material != material)
+			continue;
+		osg::Geometry * geometry = geode->getDrawable(b)->asGeometry();
+		osg::StateSet * previous = geometry->getStateSet();
+		osg::Texture2D * texture = dynamic_cast<osg::Texture2D*> (
+				previous->getTextureAttribute(0,
+						osg::StateAttribute::TEXTURE));
+
+		ImageMap batchImages;
+		TextureMap textures;
+		ImageMap::const_iterator imageIt = images.find(parkMaterial.texture);
+		if (imageIt != images.end())
+			batchImages[parkMaterial.texture] = imageIt->second;
+		else if (texture != 0 && texture->getImage() != 0) {
+			batchImages[parkMaterial.texture].image = texture->getImage();
+			textures[texture->getImage()] = texture;
+		}
+		osg::StateSet * stateSet = createStateSet(parkMaterial, batchImages,
+				textures);
+		osg::StateAttribute * texMat = previous->getTextureAttribute(0,
+				osg::StateAttribute::TEXMAT);
+		if (texMat != 0)
+			stateSet->setTextureAttribute(0, texMat);
+		geometry->setStateSet(stateSet);
+	}
+	for (size_t d = mesh.batches.size(); d < geode->getNumDrawables(); ++d) {
+		InstanceGeometry * instances = static_cast<InstanceGeometry*> (
+				geode->getDrawable(d));
+		if (mesh.batches[instances->getBatch()].material == material)
+			instances->setBatchState(geode->getDrawable(
+					instances->getBatch())->getStateSet());
+	}
+} // end updateMaterial()
+
+/*
+ * updateImage - Gives the texture of the batches drawing a texture file a
+ * new image, uploaded when they are next drawn.
+ *
+ * parameter geode - osg::Geode *, as returned by buildNode()
+ * parameter mesh - const ParkMesh&
+ * parameter name - const std::string&, texture name
+ * parameter image - osg::Image *
+ */
+void SceneBuilder::updateImage(osg::Geode * geode, const ParkMesh& mesh,
+		const std::string& name, osg::Image * image) {
+	for (unsigned int b = 0; b < mesh.batches.size(); ++b) {
+		if (mesh.materials[mesh.batches[b].material].texture != name)
+			continue;
+		osg::Texture2D * texture = dynamic_cast<osg::Texture2D*> (
+				geode->getDrawable(b)->getStateSet()->getTextureAttribute(0,
+						osg::StateAttribute::TEXTURE));
+		if (texture == 0 || texture->getImage() == image)
+			continue;
+		/* The size may differ, so the texture object is made anew: */
+		texture->setImage(image);
+		texture->dirtyTextureObject();
+	}
+} // end updateImage()
+
+/*
+ * updateTile - Copies a new image of an atlased texture into its tile and
+ * marks the page for upload.
+ *
+ * parameter geode - osg::Geode *, as returned by buildNode()
+ * parameter mesh - const ParkMesh&
+ * parameter tile - const AtlasTile&
+ * parameter image - const osg::Image&
+ * return - bool, false if the image no longer fits the tile or the page is
+ * block compressed, so the atlas has to be built again
+ */
+bool SceneBuilder::updateTile(osg::Geode * geode, const ParkMesh& mesh,
+		const AtlasTile& tile, const osg::Image& image) {
+	if (static_cast<Uint32> (image.s()) != tile.width
+			|| static_cast<Uint32> (image.t()) != tile.height)
+		return false;
+	const std::string pageName = TextureAtlas::getPageName(tile.page);
+	osg::Image * page = 0;
+	for (unsigned int b = 0; b < mesh.batches.size() && page == 0; ++b) {
+		if (mesh.materials[mesh.batches[b].material].texture != pageName)
+			continue;
+		osg::Texture2D * texture = dynamic_cast<osg::Texture2D*> (
+				geode->getDrawable(b)->getStateSet()->getTextureAttribute(0,
+						osg::StateAttribute::TEXTURE));
+		if (texture != 0)
+			page = texture->getImage();
+	}
+	if (page == 0)
+		return true;
+
+	std::vector<unsigned char> rgba;
+	if (page->getPixelFormat() != GL_RGBA || page->getDataType()
+			!= GL_UNSIGNED_BYTE || !readRgba(image, rgba))
+		return false;
+	copyTile(rgba, tile, *page);
+	page->dirty();
+	return true;
+} // end updateTile()
+
+/*
+ * extractMesh - Appends all geometry below the node to the mesh and
+ * recomputes its bounds.
+ *
+ * parameter node - osg::Node *
+ * parameter mesh - ParkMesh&
+ */
+void SceneBuilder::extractMesh(osg::Node * node, ParkMesh& mesh) {
+	MeshExtractor extractor(mesh);
+	node->accept(extractor);
+	mesh.computeBounds();
+} // end extractMesh()
@@ -0,0 +1,85 @@
+/*
+ * SceneBuilder.h - Conversion between the park mesh tables and OSG graphs.
+ *
+ * Created: October 16, 2026
+ */
+
+#ifndef SCENEBUILDER_H_
+#define SCENEBUILDER_H_
+
+#include <map>
+#include <string>
+#include <vector>
+
+/* osg includes */
+#include <osg/Geode>
+#include <osg/Image>
+#include <osg/MatrixTransform>
+#include <osg/Node>
+
+#include <MODEL/TextureAtlas.h>
+#include <UTIL/Types.h>
+
+/* Begin Forward declarations: */
+struct CompressedImage;
+class ParkMesh;
+struct QuantizedMesh;
+class TexturePack;
+class ThreadPool;
+class ViewClusters;
+/* End Forward declarations: */
+
+class SceneBuilder {
+public:
+	/* Folded groups drawn per instanced draw, bounded by uniform space */
+	static const unsigned int MAX_INSTANCES = 32;
+
+	/*
+	 * SceneImage - A decoded or block-compressed image and the key of the
+	 * content it was made from.
+	 */
+	struct SceneImage {
+		Uint64 contentHash;
+		osg::ref_ptr<osg::Image> image;
+
+		SceneImage(void) :
+			contentHash(0) {
+		}
+	};
+
+	/* Images by texture name; twins share one image */
+	typedef std::map<std::string, SceneImage> ImageMap;
+
+	static void loadImages(const ParkMesh& mesh,
+			const std::string& modelDirectory, const TexturePack * texturePack,
+			ImageMap& images, bool useCompressed = true, bool deferDecode =
+					false, ThreadPool * pool = 0);
+	static bool isDeferred(const osg::Image& image);
+	static Uint32 buildAtlases(ParkMesh& mesh, ImageMap& images,
+			const std::string& modelDirectory, TextureAtlas::TileMap * tiles =
+					0, const TexturePack * texturePack = 0,
+			ThreadPool * pool = 0);
+	static osg::Geode * buildNode(const ParkMesh& mesh, const ImageMap& images,
+			const QuantizedMesh * quantized = 0);
+	static osg::MatrixTransform * getDequantization(
+			const QuantizedMesh& quantized);
+	static size_t getIndexSize(const ParkMesh& mesh);
+	static osg::Image * createImage(const CompressedImage& compressed);
+	static bool readRgba(const osg::Image& image,
+			std::vector<unsigned char>& rgba);
+	static void extractMesh(osg::Node * node, ParkMesh& mesh);
+	static void updateBatch(osg::Geode * geode, const ParkMesh& mesh,
+			unsigned int batch, const std::vector<bool>& groupVisibility,
+			const std::vector<Uint32>& clusterLevels,
+			const ViewClusters * views = 0);
+	static void updateInstances(osg::Geode * geode, const ParkMesh& mesh,
+			const std::vector<bool>& groupVisibility);
+	static void updateMaterial(osg::Geode * geode, const ParkMesh& mesh,
+			Uint32 material, const ImageMap& images);
+	static void updateImage(osg::Geode * geode, const ParkMesh& mesh,
+			const std::string& texture, osg::Image * image);
+	static bool updateTile(osg::Geode * geode, const ParkMesh& mesh,
+			const AtlasTile& tile, const osg::Image& image);
+};
+
+#endif /* SCENEBUILDER_H_ */
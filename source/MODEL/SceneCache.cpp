@@ -0,0 +1,417 @@
+/*
+ * SceneCache.cpp - Methods for the compiled binary park scene.
+ *
+ * Created: October 16, 2026
+ */
+
+/* System headers */
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <unistd.h>
+
+/* Application headers */
+#include <MODEL/ParkMesh.h>
+#include <MODEL/SceneCache.h>
+#include <UTIL/Hash.h>
+#include <UTIL/MappedFile.h>
+#include <UTIL/ResourceException.h>
+
+/* On-disk layout; bump VERSION whenever a record changes. */
+static const char MAGIC[8] = { 'F', 'N', 'W', 'Y', 'S', 'C', 'N', '\0' };
+static const Uint32 VERSION = 1;
+static const Uint32 ENDIAN_MARKER = 0x01020304;
+static const Uint64 SECTION_ALIGNMENT = 64;
+
+struct CacheHeader {
+	char magic[8];
+	Uint32 version;
+	Uint32 endianMarker;
+	Uint64 assetHash;
+	Uint32 numVertices;
+	Uint32 numIndices;
+	Uint32 numGroups;
+	Uint32 numMaterials;
+	Uint64 vertexOffset;
+	Uint64 indexOffset;
+	Uint64 groupOffset;
+	Uint64 materialOffset;
+	float boundsMin[3];
+	float boundsMax[3];
+};
+
+struct CacheGroup {
+	Uint32 material;
+	Uint32 firstIndex;
+	Uint32 numIndices;
+	Uint32 reserved;
+	float boundsMin[3];
+	float boundsMax[3];
+};
+
+struct CacheMaterial {
+	char name[64];
+	char texture[128];
+	float ambient[4];
+	float diffuse[4];
+	float specular[4];
+	float shininess;
+	Int32 illum;
+};
+
+/*
+ * alignOffset - Rounds an offset up to the section alignment.
+ */
+static Uint64 alignOffset(Uint64 offset) {
+	return (offset + SECTION_ALIGNMENT - 1) & ~(SECTION_ALIGNMENT - 1);
+} // end alignOffset()
+
+/*
+ * copyString - Copies a string into a fixed-size record field.
+ *
+ * @throw ResourceException is thrown if the string does not fit.
+ */
+static void copyString(char* field, size_t fieldSize, const std::string& value) {
+	if (value.size() >= fieldSize) {
+		throw ResourceException("Scene cache string too long: " + value,
+				LOCATION);
+	}
+	std::memset(field, 0, fieldSize);
+	std::memcpy(field, value.data(), value.size());
+} // end copyString()
+
+/*
+ * readString - Reads a fixed-size record field, tolerating a missing NUL.
+ */
+static std::string readString(const char* field, size_t fieldSize) {
+	return std::string(field, strnlen(field, fieldSize));
+} // end readString()
+
+/*
+ * trimArgument - Returns the argument part of an OBJ/MTL statement.
+ */
+static std::string trimArgument(const std::string& line, size_t start) {
+	size_t first = line.find_first_not_of(" \t", start);
+	if (first == std::string::npos)
+		return std::string();
+	size_t last = line.find_last_not_of(" \t\r");
+	return line.substr(first, last - first + 1);
+} // end trimArgument()
+
+/****************************************************
+ Constructors and Destructors of class SceneCache:
+ ****************************************************/
+/*
+ * SceneCache constructor
+ *
+ * parameter _cachePath - const std::string&
+ */
+SceneCache::SceneCache(const std::string& _cachePath) :
+	cachePath(_cachePath) {
+} // end SceneCache()
+
+/*
+ * ~SceneCache destructor
+ */
+SceneCache::~SceneCache(void) {
+} // end ~SceneCache()
+
+/*******************************
+ Methods of class SceneCache:
+ *******************************/
+
+/*
+ * getCachePath
+ *
+ * return - const std::string&
+ */
+const std::string& SceneCache::getCachePath(void) const {
+	return cachePath;
+} // end getCachePath()
+
+/*
+ * listAssets - Collects the OBJ, every material library it names and every
+ * texture map those libraries reference, in file order.
+ *
+ * parameter modelDirectory - const std::string&
+ * parameter objFile - const std::string&
+ * parameter assets - std::vector<std::string>&
+ */
+void SceneCache::listAssets(const std::string& modelDirectory,
+		const std::string& objFile, std::vector<std::string>& assets) {
+	assets.push_back(modelDirectory + "/" + objFile);
+
+	std::vector<std::string> libraries;
+	std::ifstream obj(assets.back().c_str());
+	std::string line;
+	while (std::getline(obj, line)) {
+		if (line.compare(0, 7, "mtllib ") == 0)
+			libraries.push_back(trimArgument(line, 7));
+	}
+
+	for (std::vector<std::string>::iterator lIt = libraries.begin(); lIt
+			!= libraries.end(); ++lIt) {
+		assets.push_back(modelDirectory + "/" + *lIt);
+		std::ifstream mtl(assets.back().c_str());
+		while (std::getline(mtl, line)) {
+			size_t start = line.find_first_not_of(" \t");
+			if (start != std::string::npos && line.compare(start, 4, "map_")
+					== 0) {
+				size_t argument = line.find_first_of(" \t", start);
+				if (argument != std::string::npos)
+					assets.push_back(modelDirectory + "/" + trimArgument(line,
+							argument));
+			}
+		}
+	}
+} // end listAssets()
+
+/*
+ * hashAssets - Hashes the names and contents of all assets of a model.
+ *
+ * parameter modelDirectory - const std::string&
+ * parameter objFile - const std::string&
+ * return - Uint64
+ *
+ * throw ResourceException if an asset cannot be read.
+ */
+Uint64 SceneCache::hashAssets(const std::string& modelDirectory,
+		const std::string& objFile) {
+	std::vector<std::string> assets;
+	listAssets(modelDirectory, objFile, assets);
+
+	Uint64 hash = Hash::hashBytes(&VERSION, sizeof(VERSION));
+	for (std::vector<std::string>::iterator aIt = assets.begin(); aIt
+			!= assets.end(); ++aIt) {
+		hash = Hash::hashString(*aIt, hash);
+		hash = Hash::hashFile(*aIt, hash);
+	}
+	return hash;
+} // end hashAssets()
+
+/*
+ * decode - Fills the mesh from a cache image in memory if it is intact and
+ * was compiled from assets with the given hash.
+ *
+ * parameter data - const char *, aligned for the records
+ * parameter size - Uint64
+ * parameter assetHash - Uint64
+ * parameter mesh - ParkMesh&
+ * return - bool, false if the image does not match
+ */
+bool SceneCache::decode(const char * data, Uint64 size, Uint64 assetHash,
+		ParkMesh& mesh) {
+	if (size < sizeof(CacheHeader))
+		return false;
+
+	const CacheHeader* header = reinterpret_cast<const CacheHeader*> (data);
+	if (std::memcmp(header->magic, MAGIC, sizeof(MAGIC)) != 0
+			|| header->version != VERSION || header->endianMarker
+			!= ENDIAN_MARKER || header->assetHash != assetHash)
+		return false;
+
+	/* Reject truncated files before touching any section: */
+	if (header->vertexOffset + Uint64(header->numVertices)
+			* sizeof(ParkVertex) > size || header->indexOffset
+			+ Uint64(header->numIndices) * sizeof(Uint32) > size
+			|| header->groupOffset + Uint64(header->numGroups)
+					* sizeof(CacheGroup) > size || header->materialOffset
+			+ Uint64(header->numMaterials) * sizeof(CacheMaterial) > size)
+		return false;
+
+	mesh.clear();
+
+	const ParkVertex* vertices = reinterpret_cast<const ParkVertex*> (data
+			+ header->vertexOffset);
+	mesh.vertices.assign(vertices, vertices + header->numVertices);
+
+	const Uint32* indices = reinterpret_cast<const Uint32*> (data
+			+ header->indexOffset);
+	mesh.indices.assign(indices, indices + header->numIndices);
+
+	const CacheGroup* groups = reinterpret_cast<const CacheGroup*> (data
+			+ header->groupOffset);
+	mesh.groups.resize(header->numGroups);
+	for (Uint32 g = 0; g < header->numGroups; ++g) {
+		ParkGroup& group = mesh.groups[g];
+		group.material = groups[g].material;
+		group.firstIndex = groups[g].firstIndex;
+		group.numIndices = groups[g].numIndices;
+		std::memcpy(group.boundsMin, groups[g].boundsMin,
+				sizeof(group.boundsMin));
+		std::memcpy(group.boundsMax, groups[g].boundsMax,
+				sizeof(group.boundsMax));
+	}
+
+	const CacheMaterial* materials =
+			reinterpret_cast<const CacheMaterial*> (data
+					+ header->materialOffset);
+	mesh.materials.resize(header->numMaterials);
+	for (Uint32 m = 0; m < header->numMaterials; ++m) {
+		ParkMaterial& material = mesh.materials[m];
+		material.name = readString(materials[m].name,
+				sizeof(materials[m].name));
+		material.texture = readString(materials[m].texture,
+				sizeof(materials[m].texture));
+		std::memcpy(material.ambient, materials[m].ambient,
+				sizeof(material.ambient));
+		std::memcpy(material.diffuse, materials[m].diffuse,
+				sizeof(material.diffuse));
+		std::memcpy(material.specular, materials[m].specular,
+				sizeof(material.specular));
+		material.shininess = materials[m].shininess;
+		material.illum = materials[m].illum;
+	}
+
+	std::memcpy(mesh.boundsMin, header->boundsMin, sizeof(mesh.boundsMin));
+	std::memcpy(mesh.boundsMax, header->boundsMax, sizeof(mesh.boundsMax));
+
+	/* A group pointing outside the arrays means a corrupt file: */
+	for (std::vector<ParkGroup>::const_iterator gIt = mesh.groups.begin(); gIt
+			!= mesh.groups.end(); ++gIt) {
+		if (gIt->material >= header->numMaterials || Uint64(gIt->firstIndex)
+				+ gIt->numIndices > header->numIndices) {
+			mesh.clear();
+			return false;
+		}
+	}
+	for (std::vector<Uint32>::const_iterator iIt = mesh.indices.begin(); iIt
+			!= mesh.indices.end(); ++iIt) {
+		if (*iIt >= header->numVertices) {
+			mesh.clear();
+			return false;
+		}
+	}
+
+	return true;
+} // end decode()
+
+/*
+ * load - Fills the mesh from the cache file if it exists, is intact and was
+ * compiled from assets with the given hash.
+ *
+ * parameter assetHash - Uint64
+ * parameter mesh - ParkMesh&
+ * return - bool, false on a cache miss
+ */
+bool SceneCache::load(Uint64 assetHash, ParkMesh& mesh) const {
+	if (!MappedFile::exists(cachePath))
+		return false;
+
+	try {
+		MappedFile file(cachePath);
+		return decode(file.getData(), file.getSize(), assetHash, mesh);
+	} catch (ResourceException& err) {
+		std::cerr << "Ignoring scene cache: " << err.getDescription()
+				<< std::endl;
+		mesh.clear();
+		return false;
+	}
+} // end load()
+
+/*
+ * encode - Lays the mesh out as a cache image in memory.
+ *
+ * parameter assetHash - Uint64
+ * parameter mesh - const ParkMesh&
+ * parameter image - std::vector<char>&, overwritten
+ *
+ * throw ResourceException if a name does not fit its record.
+ */
+void SceneCache::encode(Uint64 assetHash, const ParkMesh& mesh,
+		std::vector<char>& image) {
+	CacheHeader header;
+	std::memset(&header, 0, sizeof(header));
+	std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+	header.version = VERSION;
+	header.endianMarker = ENDIAN_MARKER;
+	header.assetHash = assetHash;
+	header.numVertices = static_cast<Uint32> (mesh.vertices.size());
+	header.numIndices = static_cast<Uint32> (mesh.indices.size());
+	header.numGroups = static_cast<Uint32> (mesh.groups.size());
+	header.numMaterials = static_cast<Uint32> (mesh.materials.size());
+	header.vertexOffset = alignOffset(sizeof(CacheHeader));
+	header.indexOffset = alignOffset(header.vertexOffset + Uint64(
+			header.numVertices) * sizeof(ParkVertex));
+	header.groupOffset = alignOffset(header.indexOffset + Uint64(
+			header.numIndices) * sizeof(Uint32));
+	header.materialOffset = alignOffset(header.groupOffset + Uint64(
+			header.numGroups) * sizeof(CacheGroup));
+	const Uint64 size = header.materialOffset + Uint64(header.numMaterials)
+			* sizeof(CacheMaterial);
+	std::memcpy(header.boundsMin, mesh.boundsMin, sizeof(header.boundsMin));
+	std::memcpy(header.boundsMax, mesh.boundsMax, sizeof(header.boundsMax));
+
+	image.assign(size, 0);
+	std::memcpy(&image[0], &header, sizeof(header));
+	if (!mesh.vertices.empty())
+		std::memcpy(&image[header.vertexOffset], &mesh.vertices[0],
+				mesh.vertices.size() * sizeof(ParkVertex));
+	if (!mesh.indices.empty())
+		std::memcpy(&image[header.indexOffset], &mesh.indices[0],
+				mesh.indices.size() * sizeof(Uint32));
+
+	CacheGroup* groups = reinterpret_cast<CacheGroup*> (&image[0]
+			+ header.groupOffset);
+	for (Uint32 g = 0; g < header.numGroups; ++g) {
+		const ParkGroup& group = mesh.groups[g];
+		groups[g].material = group.material;
+		groups[g].firstIndex = group.firstIndex;
+		groups[g].numIndices = group.numIndices;
+		std::memcpy(groups[g].boundsMin, group.boundsMin,
+				sizeof(group.boundsMin));
+		std::memcpy(groups[g].boundsMax, group.boundsMax,
+				sizeof(group.boundsMax));
+	}
+
+	CacheMaterial* materials = reinterpret_cast<CacheMaterial*> (&image[0]
+			+ header.materialOffset);
+	for (Uint32 m = 0; m < header.numMaterials; ++m) {
+		const ParkMaterial& material = mesh.materials[m];
+		copyString(materials[m].name, sizeof(materials[m].name), material.name);
+		copyString(materials[m].texture, sizeof(materials[m].texture),
+				material.texture);
+		std::memcpy(materials[m].ambient, material.ambient,
+				sizeof(material.ambient));
+		std::memcpy(materials[m].diffuse, material.diffuse,
+				sizeof(material.diffuse));
+		std::memcpy(materials[m].specular, material.specular,
+				sizeof(material.specular));
+		materials[m].shininess = material.shininess;
+		materials[m].illum = material.illum;
+	}
+} // end encode()
+
+/*
+ * save - Writes the mesh to the cache file. The file is written under a
+ * temporary name and renamed into place, so render nodes sharing the model
+ * directory never map a partially written cache.
+ *
+ * parameter assetHash - Uint64
+ * parameter mesh - const ParkMesh&
+ *
+ * throw ResourceException if the cache cannot be written.
+ */
+void SceneCache::save(Uint64 assetHash, const ParkMesh& mesh) const {
+	std::vector<char> image;
+	encode(assetHash, mesh, image);
+
+	std::ostringstream tempPath;
+	tempPath << cachePath << ".tmp." << getpid();
+	FILE* file = std::fopen(tempPath.str().c_str(), "wb");
+	if (file == 0) {
+		throw ResourceException("Cannot create scene cache " + tempPath.str(),
+				LOCATION);
+	}
+	const bool written = std::fwrite(&image[0], 1, image.size(), file)
+			== image.size();
+	const bool closed = std::fclose(file) == 0;
+	if (!written || !closed || std::rename(tempPath.str().c_str(),
+			cachePath.c_str()) != 0) {
+		std::remove(tempPath.str().c_str());
+		throw ResourceException("Cannot write scene cache " + cachePath,
+				LOCATION);
+	}
+} // end save()
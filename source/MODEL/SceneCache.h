@@ -0,0 +1,44 @@
+/*
+ * SceneCache.h - Class for the compiled binary park scene.
+ *
+ * Created: October 16, 2026
+ */
+
+#ifndef SCENECACHE_H_
+#define SCENECACHE_H_
+
+#include <string>
+#include <vector>
+
+#include <UTIL/Types.h>
+
+/* Begin Forward declarations: */
+class ParkMesh;
+/* End Forward declarations: */
+
+/*
+ * SceneCache - Memory-mappable binary image of a loaded ParkMesh. The file is
+ * keyed by a hash over the OBJ, its material library and every texture the
+ * library references, so any edit to the assets invalidates it. All sections
+ * are fixed-size records aligned for direct use from the mapping.
+ */
+class SceneCache {
+public:
+	SceneCache(const std::string& _cachePath);
+	~SceneCache(void);
+	static Uint64 hashAssets(const std::string& modelDirectory,
+			const std::string& objFile);
+	static void listAssets(const std::string& modelDirectory,
+			const std::string& objFile, std::vector<std::string>& assets);
+	bool load(Uint64 assetHash, ParkMesh& mesh) const;
+	void save(Uint64 assetHash, const ParkMesh& mesh) const;
+	static bool decode(const char * data, Uint64 size, Uint64 assetHash,
+			ParkMesh& mesh);
+	static void encode(Uint64 assetHash, const ParkMesh& mesh,
+			std::vector<char>& image);
+	const std::string& getCachePath(void) const;
+private:
+	std::string cachePath;
+};
+
+#endif /* SCENECACHE_H_ */
@@ -0,0 +1,157 @@
+/*
+ * StateShadow.cpp - Methods for restoring Vrui's GL state after the park's
+ * OSG viewer.
+ *
+ * Created: October 17, 2026
+ */
+
+/* osg includes */
+#include <osg/BlendFunc>
+#include <osg/CullFace>
+#include <osg/Depth>
+#include <osg/PolygonMode>
+
+/* Application headers */
+#include <MODEL/StateShadow.h>
+
+/* Modes the park's scene graph, or Delta3D's scene above it, sets */
+static const GLenum SHADOWED_MODES[] = { GL_LIGHTING, GL_LIGHT0, GL_LIGHT1,
+		GL_LIGHT2, GL_LIGHT3, GL_LIGHT4, GL_LIGHT5, GL_LIGHT6, GL_LIGHT7,
+		GL_COLOR_MATERIAL, GL_NORMALIZE, GL_RESCALE_NORMAL, GL_DEPTH_TEST,
+		GL_CULL_FACE, GL_BLEND, GL_ALPHA_TEST, GL_POLYGON_OFFSET_FILL,
+		GL_POLYGON_OFFSET_LINE, GL_LINE_SMOOTH, GL_FOG, GL_STENCIL_TEST };
+static const size_t NUM_SHADOWED_MODES = sizeof(SHADOWED_MODES)
+		/ sizeof(SHADOWED_MODES[0]);
+
+/*
+ * toPolygonMode - The OSG polygon mode of a GL one.
+ */
+static osg::PolygonMode::Mode toPolygonMode(GLint mode) {
+	switch (mode) {
+	case GL_POINT:
+		return osg::PolygonMode::POINT;
+	case GL_LINE:
+		return osg::PolygonMode::LINE;
+	default:
+		return osg::PolygonMode::FILL;
+	}
+} // end toPolygonMode()
+
+/****************************************************
+ Constructors and Destructors of class StateShadow:
+ ****************************************************/
+/*
+ * StateShadow constructor - Nothing captured yet.
+ */
+StateShadow::StateShadow(void) :
+	captured(false) {
+} // end StateShadow()
+
+/*******************************
+ Methods of class StateShadow:
+ *******************************/
+
+/*
+ * isCaptured - Whether capture() ran.
+ *
+ * return - bool
+ */
+bool StateShadow::isCaptured(void) const {
+	return captured;
+} // end isCaptured()
+
+/*
+ * capture - Reads the shadowed state Vrui set, and makes it the global
+ * defaults of the context's OSG state. Vrui sets the same state before
+ * every view apart from the lights, so one read per context is enough; a
+ * light the park's state sets leave alone draws as it was at this read.
+ * Called with the context current, before the viewer first draws.
+ *
+ * parameter state - osg::State&, of the context
+ */
+void StateShadow::capture(osg::State& state) {
+	for (size_t m = 0; m < NUM_SHADOWED_MODES; ++m) {
+		const bool enabled = glIsEnabled(SHADOWED_MODES[m]) == GL_TRUE;
+		state.setGlobalDefaultModeValue(SHADOWED_MODES[m], enabled);
+		state.haveAppliedMode(SHADOWED_MODES[m], enabled
+				? osg::StateAttribute::ON : osg::StateAttribute::OFF);
+	}
+	const bool textured = glIsEnabled(GL_TEXTURE_2D) == GL_TRUE;
+	state.setGlobalDefaultTextureModeValue(0, GL_TEXTURE_2D, textured);
+	state.haveAppliedTextureMode(0, GL_TEXTURE_2D, textured
+			? osg::StateAttribute::ON : osg::StateAttribute::OFF);
+
+	GLint source;
+	GLint destination;
+	glGetIntegerv(GL_BLEND_SRC, &source);
+	glGetIntegerv(GL_BLEND_DST, &destination);
+	state.setGlobalDefaultAttribute(new osg::BlendFunc(source, destination));
+	GLint polygonModes[2];
+	glGetIntegerv(GL_POLYGON_MODE, polygonModes);
+	osg::PolygonMode * polygonMode = new osg::PolygonMode();
+	polygonMode->setMode(osg::PolygonMode::FRONT,
+			toPolygonMode(polygonModes[0]));
+	polygonMode->setMode(osg::PolygonMode::BACK,
+			toPolygonMode(polygonModes[1]));
+	state.setGlobalDefaultAttribute(polygonMode);
+	GLint cullFace;
+	glGetIntegerv(GL_CULL_FACE_MODE, &cullFace);
+	state.setGlobalDefaultAttribute(new osg::CullFace(
+			static_cast<osg::CullFace::Mode> (cullFace)));
+	GLint depthFunction;
+	GLboolean depthMask;
+	glGetIntegerv(GL_DEPTH_FUNC, &depthFunction);
+	glGetBooleanv(GL_DEPTH_WRITEMASK, &depthMask);
+	osg::Depth * depth = new osg::Depth(static_cast<osg::Depth::Function> (
+			depthFunction));
+	depth->setWriteMask(depthMask == GL_TRUE);
+	state.setGlobalDefaultAttribute(depth);
+	captured = true;
+} // end capture()
+
+/*
+ * save - Saves the light enables and parameters, which Vrui sets anew for
+ * every view, before the viewer draws, and marks every mode and attribute
+ * OSG tracks as stale, so the viewer applies them all again instead of
+ * skipping those it believes GL still holds; after a previous view's
+ * restore(), the lights may differ. This reads no GL state. Every save() is
+ * followed by a restore().
+ *
+ * parameter state - osg::State&, of the context
+ */
+void StateShadow::save(osg::State& state) const {
+	glPushAttrib(GL_LIGHTING_BIT);
+	state.dirtyAllModes();
+	state.dirtyAllAttributes();
+} // end save()
+
+/*
+ * restore - Reverts what the viewer changed: OSG's state sets are popped,
+ * which reapplies the shadowed values of what they set, the vertex arrays,
+ * buffers and texture units are released, and the viewport and matrices
+ * are those of the view.
+ *
+ * parameter state - osg::State&, of the context
+ * parameter viewport - const GLint[4], of the view
+ * parameter modelview - const osg::Matrixd&, navigation to eye coordinates
+ * parameter projection - const osg::Matrixd&
+ */
+void StateShadow::restore(osg::State& state, const GLint viewport[4],
+		const osg::Matrixd& modelview, const osg::Matrixd& projection) const {
+	state.popAllStateSets();
+	state.apply();
+	state.disableAllVertexArrays();
+	state.unbindVertexBufferObject();
+	state.unbindElementBufferObject();
+	state.setActiveTextureUnit(0);
+	state.setClientActiveTextureUnit(0);
+	glPopAttrib();
+
+	glViewport(viewport[0], viewport[1], viewport[2], viewport[3]);
+	glMatrixMode(GL_TEXTURE);
+	glLoadIdentity();
+	glMatrixMode(GL_PROJECTION);
+	glLoadMatrixd(projection.ptr());
+	glMatrixMode(GL_MODELVIEW);
+	glLoadMatrixd(modelview.ptr());
+} // end restore()
@@ -0,0 +1,43 @@
+/*
+ * StateShadow.h - The GL state Vrui draws with, restored after the park's
+ * OSG viewer without reading GL state back.
+ *
+ * Created: October 17, 2026
+ */
+
+#ifndef STATESHADOW_H_
+#define STATESHADOW_H_
+
+/* osg includes */
+#include <osg/GL>
+#include <osg/Matrix>
+#include <osg/State>
+
+/*
+ * StateShadow - Per graphics context, a shadow of the state the OSG viewer
+ * may change: the enables, blend function, polygon mode, face culling and
+ * depth test Vrui leaves set when it calls the application, read once on
+ * the context's first view and handed to the context's osg::State as its
+ * global defaults. OSG tracks every mode and attribute it applies, so
+ * popping its state sets afterwards reverts what a view changed to those
+ * values. The light enables and parameters follow Vrui's light sources and
+ * change between views, so they are saved on the attribute stack, and
+ * OSG's tracking is marked stale before every view, which makes it apply
+ * what the park asks for rather than trust what it last applied. The
+ * viewport and matrices come from the view being drawn.
+ */
+class StateShadow {
+public:
+	StateShadow(void);
+	bool isCaptured(void) const;
+	void capture(osg::State& state);
+	void save(osg::State& state) const;
+	void restore(osg::State& state, const GLint viewport[4],
+			const osg::Matrixd& modelview,
+			const osg::Matrixd& projection) const;
+
+private:
+	bool captured;
+};
+
+#endif /* STATESHADOW_H_ */
@@ -0,0 +1,249 @@
+/*
+ * TextureAtlas.cpp - Methods for packing the park's small textures into
+ * shared atlas pages.
+ *
+ * Created: October 16, 2026
+ */
+
+/* System headers */
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <set>
+#include <sstream>
+
+/* Application headers */
+#include <MODEL/ParkMesh.h>
+#include <MODEL/TextureAtlas.h>
+
+/* Texture names cannot clash with files in the model directory */
+static const std::string PAGE_PREFIX("atlas:");
+/* Coordinates this far outside [0, 1] are clamped rather than wrapped */
+static const float TOLERANCE = 1.0f / 32.0f;
+
+/*
+ * AtlasCandidate - A texture waiting to be placed, with the size of its cell
+ * including the gutter.
+ */
+struct AtlasCandidate {
+	std::string name;
+	Uint32 width;
+	Uint32 height;
+	Uint32 cellWidth;
+	Uint32 cellHeight;
+
+	/* Tallest cells first fills shelves with the least waste */
+	bool operator<(const AtlasCandidate& other) const {
+		if (cellHeight != other.cellHeight)
+			return cellHeight > other.cellHeight;
+		if (cellWidth != other.cellWidth)
+			return cellWidth > other.cellWidth;
+		return name < other.name;
+	}
+};
+
+/*
+ * alignCell - Rounds a cell extent up to a multiple of the gutter.
+ */
+static Uint32 alignCell(Uint32 extent) {
+	return (extent + TextureAtlas::GUTTER - 1) / TextureAtlas::GUTTER
+			* TextureAtlas::GUTTER;
+} // end alignCell()
+
+/*******************************
+ Methods of class TextureAtlas:
+ *******************************/
+
+/*
+ * build - Chooses the textures that can live in an atlas, packs them onto
+ * shelves and rewrites the mesh to sample the pages. A texture qualifies when
+ * every group using it keeps its coordinates within one repetition of the
+ * image (after moving it by whole repetitions) and its cell fits a page.
+ * Groups must not share vertices, which both loaders guarantee. Call before
+ * MaterialMerger::merge(); unused materials are left in place.
+ *
+ * parameter mesh - ParkMesh&
+ * parameter sizes - const SizeMap&, images that may be atlased
+ * parameter tiles - TileMap&, receives the placement of each atlased texture
+ * parameter pages - std::vector<AtlasPage>&, receives the page dimensions
+ */
+void TextureAtlas::build(ParkMesh& mesh, const SizeMap& sizes, TileMap& tiles,
+		std::vector<AtlasPage>& pages) {
+	tiles.clear();
+	pages.clear();
+	const Uint32 numGroups = static_cast<Uint32> (mesh.groups.size());
+
+	/* Whole repetitions to remove from each group's coordinates: */
+	std::vector<float> shifts(2 * numGroups, 0.0f);
+	std::set<std::string> wrapped;
+	for (Uint32 g = 0; g < numGroups; ++g) {
+		const ParkGroup& group = mesh.groups[g];
+		const std::string& texture = mesh.materials[group.material].texture;
+		if (texture.empty() || sizes.find(texture) == sizes.end())
+			continue;
+
+		float low[2] = { FLT_MAX, FLT_MAX };
+		float high[2] = { -FLT_MAX, -FLT_MAX };
+		for (Uint32 i = group.firstIndex; i < group.firstIndex
+				+ group.numIndices; ++i) {
+			const float * texCoord = mesh.vertices[mesh.indices[i]].texCoord;
+			for (int j = 0; j < 2; ++j) {
+				low[j] = std::min(low[j], texCoord[j]);
+				high[j] = std::max(high[j], texCoord[j]);
+			}
+		}
+		for (int j = 0; j < 2 && group.numIndices > 0; ++j) {
+			const float shift = std::floor(low[j] + TOLERANCE);
+			if (low[j] - shift < -TOLERANCE || high[j] - shift > 1.0f
+					+ TOLERANCE)
+				wrapped.insert(texture);
+			shifts[2 * g + j] = shift;
+		}
+	}
+
+	std::vector<AtlasCandidate> candidates;
+	for (SizeMap::const_iterator it = sizes.begin(); it != sizes.end(); ++it) {
+		AtlasCandidate candidate;
+		candidate.name = it->first;
+		candidate.width = it->second.first;
+		candidate.height = it->second.second;
+		candidate.cellWidth = alignCell(candidate.width + 2 * GUTTER);
+		candidate.cellHeight = alignCell(candidate.height + 2 * GUTTER);
+		if (wrapped.count(candidate.name) == 0 && candidate.width > 0
+				&& candidate.height > 0 && candidate.cellWidth <= PAGE_SIZE
+				&& candidate.cellHeight <= PAGE_SIZE)
+			candidates.push_back(candidate);
+	}
+	std::sort(candidates.begin(), candidates.end());
+
+	/* Shelf packing, opening a new page when a shelf runs off the bottom: */
+	Uint32 shelfX = 0;
+	Uint32 shelfY = 0;
+	Uint32 shelfHeight = 0;
+	for (size_t c = 0; c < candidates.size(); ++c) {
+		const AtlasCandidate& candidate = candidates[c];
+		if (shelfX + candidate.cellWidth > PAGE_SIZE) {
+			shelfY += shelfHeight;
+			shelfX = 0;
+			shelfHeight = 0;
+		}
+		if (pages.empty() || shelfY + candidate.cellHeight > PAGE_SIZE) {
+			AtlasPage page;
+			page.width = PAGE_SIZE;
+			page.height = 0;
+			pages.push_back(page);
+			shelfX = shelfY = shelfHeight = 0;
+		}
+
+		AtlasTile tile;
+		tile.page = static_cast<Uint32> (pages.size() - 1);
+		tile.x = shelfX + GUTTER;
+		tile.y = shelfY + GUTTER;
+		tile.width = candidate.width;
+		tile.height = candidate.height;
+		tiles[candidate.name] = tile;
+
+		shelfX += candidate.cellWidth;
+		shelfHeight = std::max(shelfHeight, candidate.cellHeight);
+		pages.back().height = std::max(pages.back().height, shelfY
+				+ shelfHeight);
+	}
+	for (size_t p = 0; p < pages.size(); ++p) {
+		Uint32 height = 1;
+		while (height < pages[p].height)
+			height *= 2;
+		pages[p].height = height;
+	}
+	if (tiles.empty())
+		return;
+
+	/* Move the coordinates into the tiles and the groups onto page materials: */
+	std::vector<bool> moved(mesh.vertices.size(), false);
+	std::map<Uint32, Uint32> pageMaterials;
+	const size_t firstPageMaterial = mesh.materials.size();
+	for (Uint32 g = 0; g < numGroups; ++g) {
+		ParkGroup& group = mesh.groups[g];
+		TileMap::const_iterator tileIt = tiles.find(
+				mesh.materials[group.material].texture);
+		if (tileIt == tiles.end())
+			continue;
+		const AtlasTile& tile = tileIt->second;
+		const AtlasPage& page = pages[tile.page];
+
+		for (Uint32 i = group.firstIndex; i < group.firstIndex
+				+ group.numIndices; ++i) {
+			const Uint32 v = mesh.indices[i];
+			if (moved[v])
+				continue;
+			moved[v] = true;
+			float * texCoord = mesh.vertices[v].texCoord;
+			const float u = std::min(std::max(texCoord[0] - shifts[2 * g],
+					0.0f), 1.0f);
+			const float t = std::min(std::max(texCoord[1] - shifts[2 * g + 1],
+					0.0f), 1.0f);
+			texCoord[0] = (tile.x + u * tile.width) / page.width;
+			texCoord[1] = (tile.y + t * tile.height) / page.height;
+		}
+
+		std::map<Uint32, Uint32>::iterator materialIt = pageMaterials.find(
+				group.material);
+		if (materialIt == pageMaterials.end()) {
+			ParkMaterial material = mesh.materials[group.material];
+			material.texture = getPageName(tile.page);
+			Uint32 m = static_cast<Uint32> (firstPageMaterial);
+			while (m < mesh.materials.size()
+					&& !mesh.materials[m].hasSameProperties(material))
+				++m;
+			if (m == mesh.materials.size()) {
+				std::ostringstream name;
+				name << material.texture << "#" << m - firstPageMaterial;
+				material.name = name.str();
+				mesh.materials.push_back(material);
+			}
+			materialIt = pageMaterials.insert(std::make_pair(group.material,
+					m)).first;
+		}
+		group.material = materialIt->second;
+	}
+} // end build()
+
+/*
+ * getPageName - Texture name under which a page image is registered.
+ *
+ * parameter page - Uint32
+ * return - std::string
+ */
+std::string TextureAtlas::getPageName(Uint32 page) {
+	std::ostringstream name;
+	name << PAGE_PREFIX << page;
+	return name.str();
+} // end getPageName()
+
+/*
+ * isPageName
+ *
+ * parameter texture - const std::string&
+ * return - bool
+ */
+bool TextureAtlas::isPageName(const std::string& texture) {
+	return texture.compare(0, PAGE_PREFIX.size(), PAGE_PREFIX) == 0;
+} // end isPageName()
+
+/*
+ * countTextures - Number of distinct textures the groups reference, which is
+ * the number of texture binds per frame once batches sharing a texture are
+ * adjacent.
+ *
+ * parameter mesh - const ParkMesh&
+ * return - Uint32
+ */
+Uint32 TextureAtlas::countTextures(const ParkMesh& mesh) {
+	std::set<std::string> textures;
+	for (size_t g = 0; g < mesh.groups.size(); ++g) {
+		const std::string& texture =
+				mesh.materials[mesh.groups[g].material].texture;
+		if (!texture.empty())
+			textures.insert(texture);
+	}
+	return static_cast<Uint32> (textures.size());
+} // end countTextures()
@@ -0,0 +1,67 @@
+/*
+ * TextureAtlas.h - Post-load stage packing the park's small textures into a
+ * few shared atlas pages.
+ *
+ * Created: October 16, 2026
+ */
+
+#ifndef TEXTUREATLAS_H_
+#define TEXTUREATLAS_H_
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include <UTIL/Types.h>
+
+/* Begin Forward declarations: */
+class ParkMesh;
+/* End Forward declarations: */
+
+/*
+ * AtlasTile - Where one texture image landed: its texel rectangle inside an
+ * atlas page, gutter excluded.
+ */
+struct AtlasTile {
+	Uint32 page;
+	Uint32 x;
+	Uint32 y;
+	Uint32 width;
+	Uint32 height;
+};
+
+/*
+ * AtlasPage - Dimensions of one atlas page image.
+ */
+struct AtlasPage {
+	Uint32 width;
+	Uint32 height;
+};
+
+/*
+ * TextureAtlas - Packs the textures whose coordinates do not rely on repeat
+ * wrapping into atlas pages, rewrites the texture coordinates of the groups
+ * using them and moves those groups to one material per page and material
+ * properties, so MaterialMerger can draw them as a single batch. Only the
+ * layout is computed here; SceneBuilder composes the page images.
+ */
+class TextureAtlas {
+public:
+	/* Page width; page heights are trimmed to the next power of two */
+	static const Uint32 PAGE_SIZE = 2048;
+	/* Edge texels replicated around every tile; cells are aligned to it */
+	static const Uint32 GUTTER = 8;
+
+	/* Texture name to image width and height */
+	typedef std::map<std::string, std::pair<Uint32, Uint32> > SizeMap;
+	/* Texture name to its place in the atlas */
+	typedef std::map<std::string, AtlasTile> TileMap;
+
+	static void build(ParkMesh& mesh, const SizeMap& sizes, TileMap& tiles,
+			std::vector<AtlasPage>& pages);
+	static std::string getPageName(Uint32 page);
+	static bool isPageName(const std::string& texture);
+	static Uint32 countTextures(const ParkMesh& mesh);
+};
+
+#endif /* TEXTUREATLAS_H_ */
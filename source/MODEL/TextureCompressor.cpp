@@ -0,0 +1,666 @@
+/*
+ * TextureCompressor.cpp - Methods for transcoding park textures into BC1/BC3
+ * KTX files with precomputed mipmap chains.
+ *
+ * Created: October 16, 2026
+ */
+
+/* System headers */
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <unistd.h>
+
+/* Application headers */
+#include <MODEL/TextureCompressor.h>
+#include <UTIL/MappedFile.h>
+#include <UTIL/ResourceException.h>
+
+/* KTX 1.1 file identifier and the formats written and accepted */
+static const unsigned char KTX_IDENTIFIER[12] = { 0xAB, 'K', 'T', 'X', ' ',
+		'1', '1', 0xBB, '\r', '\n', 0x1A, '\n' };
+static const Uint32 KTX_ENDIANNESS = 0x04030201;
+/* GL_COMPRESSED_RGB_S3TC_DXT1_EXT and GL_COMPRESSED_RGBA_S3TC_DXT5_EXT */
+static const Uint32 FORMAT_BC1 = 0x83F0;
+static const Uint32 FORMAT_BC3 = 0x83F3;
+/* GL_RGB and GL_RGBA */
+static const Uint32 BASE_FORMAT_RGB = 0x1907;
+static const Uint32 BASE_FORMAT_RGBA = 0x1908;
+/* Subdirectory of the model directory holding the KTX files */
+static const std::string DIRECTORY("compressed");
+
+struct KtxHeader {
+	unsigned char identifier[12];
+	Uint32 endianness;
+	Uint32 glType;
+	Uint32 glTypeSize;
+	Uint32 glFormat;
+	Uint32 glInternalFormat;
+	Uint32 glBaseInternalFormat;
+	Uint32 pixelWidth;
+	Uint32 pixelHeight;
+	Uint32 pixelDepth;
+	Uint32 numberOfArrayElements;
+	Uint32 numberOfFaces;
+	Uint32 numberOfMipmapLevels;
+	Uint32 bytesOfKeyValueData;
+};
+
+/*
+ * ResampleTap - One source texel contributing to a resized texel.
+ */
+struct ResampleTap {
+	Uint32 source;
+	float weight;
+};
+
+/*
+ * computeTaps - Filter taps resizing one axis: a box filter when shrinking,
+ * linear interpolation when growing.
+ */
+static void computeTaps(Uint32 sourceSize, Uint32 targetSize,
+		std::vector<Uint32>& firstTap, std::vector<ResampleTap>& taps) {
+	const float scale = float(sourceSize) / float(targetSize);
+	firstTap.resize(targetSize + 1);
+	taps.clear();
+	for (Uint32 d = 0; d < targetSize; ++d) {
+		firstTap[d] = static_cast<Uint32> (taps.size());
+		ResampleTap tap;
+		if (scale > 1.0f) {
+			const float begin = d * scale;
+			const float end = (d + 1) * scale;
+			for (Uint32 s = Uint32(begin); s < sourceSize && float(s) < end; ++s) {
+				tap.source = s;
+				tap.weight = (std::min(end, s + 1.0f) - std::max(begin,
+						float(s))) / scale;
+				if (tap.weight > 0.0f)
+					taps.push_back(tap);
+			}
+		} else {
+			const float center = std::max((d + 0.5f) * scale - 0.5f, 0.0f);
+			const Uint32 s = std::min(Uint32(center), sourceSize - 1);
+			const float fraction = center - s;
+			tap.source = s;
+			tap.weight = 1.0f - fraction;
+			taps.push_back(tap);
+			tap.source = std::min(s + 1, sourceSize - 1);
+			tap.weight = fraction;
+			taps.push_back(tap);
+		}
+	}
+	firstTap[targetSize] = static_cast<Uint32> (taps.size());
+} // end computeTaps()
+
+/*
+ * downsample - Box-filters an RGBA level to the next smaller mipmap level.
+ */
+static void downsample(const std::vector<unsigned char>& level, Uint32 width,
+		Uint32 height, std::vector<unsigned char>& result) {
+	const Uint32 newWidth = std::max(width / 2, 1u);
+	const Uint32 newHeight = std::max(height / 2, 1u);
+	result.resize(newWidth * newHeight * 4);
+	for (Uint32 y = 0; y < newHeight; ++y) {
+		const Uint32 y0 = std::min(2 * y, height - 1);
+		const Uint32 y1 = std::min(2 * y + 1, height - 1);
+		for (Uint32 x = 0; x < newWidth; ++x) {
+			const Uint32 x0 = std::min(2 * x, width - 1);
+			const Uint32 x1 = std::min(2 * x + 1, width - 1);
+			for (int c = 0; c < 4; ++c) {
+				const Uint32 sum = level[(y0 * width + x0) * 4 + c] + level[(y0
+						* width + x1) * 4 + c] + level[(y1 * width + x0) * 4 + c]
+						+ level[(y1 * width + x1) * 4 + c];
+				result[(y * newWidth + x) * 4 + c] = (unsigned char) ((sum + 2)
+						/ 4);
+			}
+		}
+	}
+} // end downsample()
+
+/*
+ * pack565 - Quantizes an 8-bit color to 5:6:5.
+ */
+static Uint32 pack565(const float * color) {
+	const int r = std::min(std::max(int(color[0] * 31.0f / 255.0f + 0.5f), 0),
+			31);
+	const int g = std::min(std::max(int(color[1] * 63.0f / 255.0f + 0.5f), 0),
+			63);
+	const int b = std::min(std::max(int(color[2] * 31.0f / 255.0f + 0.5f), 0),
+			31);
+	return Uint32((r << 11) | (g << 5) | b);
+} // end pack565()
+
+/*
+ * colorPalette - The four colors a BC1 color block can select from. Only
+ * BC1 has the three-color mode; BC3 color blocks always use four.
+ */
+static void colorPalette(Uint32 color0, Uint32 color1, bool fourColors,
+		int palette[4][3]) {
+	const Uint32 colors[2] = { color0, color1 };
+	for (int i = 0; i < 2; ++i) {
+		const int r = (colors[i] >> 11) & 31;
+		const int g = (colors[i] >> 5) & 63;
+		const int b = colors[i] & 31;
+		palette[i][0] = (r << 3) | (r >> 2);
+		palette[i][1] = (g << 2) | (g >> 4);
+		palette[i][2] = (b << 3) | (b >> 2);
+	}
+	for (int c = 0; c < 3; ++c) {
+		if (fourColors) {
+			palette[2][c] = (2 * palette[0][c] + palette[1][c]) / 3;
+			palette[3][c] = (palette[0][c] + 2 * palette[1][c]) / 3;
+		} else {
+			palette[2][c] = (palette[0][c] + palette[1][c]) / 2;
+			palette[3][c] = 0;
+		}
+	}
+} // end colorPalette()
+
+/*
+ * encodeColor - Encodes the colors of 4x4 RGBA texels as a BC1 block. The
+ * end points are the extremes along the principal axis of the colors; they
+ * are always ordered for four-color mode, which BC3 requires.
+ */
+static void encodeColor(const unsigned char * texels, unsigned char * block) {
+	float mean[3] = { 0.0f, 0.0f, 0.0f };
+	for (int t = 0; t < 16; ++t) {
+		for (int c = 0; c < 3; ++c)
+			mean[c] += texels[4 * t + c] / 16.0f;
+	}
+	float covariance[6] = { 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f };
+	for (int t = 0; t < 16; ++t) {
+		const float r = texels[4 * t] - mean[0];
+		const float g = texels[4 * t + 1] - mean[1];
+		const float b = texels[4 * t + 2] - mean[2];
+		covariance[0] += r * r;
+		covariance[1] += r * g;
+		covariance[2] += r * b;
+		covariance[3] += g * g;
+		covariance[4] += g * b;
+		covariance[5] += b * b;
+	}
+	float axis[3] = { 1.0f, 1.0f, 1.0f };
+	for (int iteration = 0; iteration < 8; ++iteration) {
+		const float x = covariance[0] * axis[0] + covariance[1] * axis[1]
+				+ covariance[2] * axis[2];
+		const float y = covariance[1] * axis[0] + covariance[3] * axis[1]
+				+ covariance[4] * axis[2];
+		const float z = covariance[2] * axis[0] + covariance[4] * axis[1]
+				+ covariance[5] * axis[2];
+		const float largest = std::max(std::fabs(x), std::max(std::fabs(y),
+				std::fabs(z)));
+		if (largest < 1.0e-6f)
+			break;
+		axis[0] = x / largest;
+		axis[1] = y / largest;
+		axis[2] = z / largest;
+	}
+	const float length = std::sqrt(axis[0] * axis[0] + axis[1] * axis[1]
+			+ axis[2] * axis[2]);
+	for (int c = 0; c < 3; ++c)
+		axis[c] /= length;
+
+	float low = 0.0f;
+	float high = 0.0f;
+	for (int t = 0; t < 16; ++t) {
+		float projection = 0.0f;
+		for (int c = 0; c < 3; ++c)
+			projection += (texels[4 * t + c] - mean[c]) * axis[c];
+		low = std::min(low, projection);
+		high = std::max(high, projection);
+	}
+	float end0[3];
+	float end1[3];
+	for (int c = 0; c < 3; ++c) {
+		end0[c] = mean[c] + axis[c] * high;
+		end1[c] = mean[c] + axis[c] * low;
+	}
+	Uint32 color0 = pack565(end0);
+	Uint32 color1 = pack565(end1);
+	if (color0 < color1)
+		std::swap(color0, color1);
+
+	Uint32 indices = 0;
+	if (color0 != color1) {
+		int palette[4][3];
+		colorPalette(color0, color1, true, palette);
+		for (int t = 0; t < 16; ++t) {
+			int best = 0;
+			int bestDistance = 0x7fffffff;
+			for (int i = 0; i < 4; ++i) {
+				int distance = 0;
+				for (int c = 0; c < 3; ++c) {
+					const int delta = texels[4 * t + c] - palette[i][c];
+					distance += delta * delta;
+				}
+				if (distance < bestDistance) {
+					best = i;
+					bestDistance = distance;
+				}
+			}
+			indices |= Uint32(best) << (2 * t);
+		}
+	}
+
+	block[0] = (unsigned char) (color0 & 0xff);
+	block[1] = (unsigned char) (color0 >> 8);
+	block[2] = (unsigned char) (color1 & 0xff);
+	block[3] = (unsigned char) (color1 >> 8);
+	for (int i = 0; i < 4; ++i)
+		block[4 + i] = (unsigned char) ((indices >> (8 * i)) & 0xff);
+} // end encodeColor()
+
+/*
+ * alphaPalette - The eight alphas a BC3 alpha block can select from.
+ */
+static void alphaPalette(int alpha0, int alpha1, int palette[8]) {
+	palette[0] = alpha0;
+	palette[1] = alpha1;
+	for (int i = 2; i < 8; ++i) {
+		if (alpha0 > alpha1)
+			palette[i] = ((8 - i) * alpha0 + (i - 1) * alpha1) / 7;
+		else if (i < 6)
+			palette[i] = ((6 - i) * alpha0 + (i - 1) * alpha1) / 5;
+		else
+			palette[i] = i == 6 ? 0 : 255;
+	}
+} // end alphaPalette()
+
+/*
+ * encodeAlpha - Encodes the alphas of 4x4 RGBA texels as a BC3 alpha block
+ * in eight-alpha mode.
+ */
+static void encodeAlpha(const unsigned char * texels, unsigned char * block) {
+	int alpha0 = 0;
+	int alpha1 = 255;
+	for (int t = 0; t < 16; ++t) {
+		alpha0 = std::max(alpha0, int(texels[4 * t + 3]));
+		alpha1 = std::min(alpha1, int(texels[4 * t + 3]));
+	}
+
+	Uint64 indices = 0;
+	if (alpha0 != alpha1) {
+		int palette[8];
+		alphaPalette(alpha0, alpha1, palette);
+		for (int t = 0; t < 16; ++t) {
+			int best = 0;
+			for (int i = 1; i < 8; ++i) {
+				if (std::abs(texels[4 * t + 3] - palette[i]) < std::abs(
+						texels[4 * t + 3] - palette[best]))
+					best = i;
+			}
+			indices |= Uint64(best) << (3 * t);
+		}
+	}
+
+	block[0] = (unsigned char) alpha0;
+	block[1] = (unsigned char) alpha1;
+	for (int i = 0; i < 6; ++i)
+		block[2 + i] = (unsigned char) ((indices >> (8 * i)) & 0xff);
+} // end encodeAlpha()
+
+/*
+ * encodeLevel - Encodes one RGBA mipmap level block by block. Levels smaller
+ * than a block repeat their edge texels.
+ */
+static void encodeLevel(const unsigned char * rgba, Uint32 width,
+		Uint32 height, bool hasAlpha, unsigned char * blocks) {
+	unsigned char texels[64];
+	for (Uint32 by = 0; by < height; by += 4) {
+		for (Uint32 bx = 0; bx < width; bx += 4) {
+			for (Uint32 t = 0; t < 16; ++t) {
+				const Uint32 x = std::min(bx + t % 4, width - 1);
+				const Uint32 y = std::min(by + t / 4, height - 1);
+				std::memcpy(texels + 4 * t, rgba + (y * width + x) * 4, 4);
+			}
+			if (hasAlpha) {
+				encodeAlpha(texels, blocks);
+				blocks += 8;
+			}
+			encodeColor(texels, blocks);
+			blocks += 8;
+		}
+	}
+} // end encodeLevel()
+
+/*****************************************
+ Methods of struct CompressedImage:
+ *****************************************/
+/*
+ * CompressedImage constructor
+ */
+CompressedImage::CompressedImage(void) :
+	hasAlpha(false), width(0), height(0) {
+} // end CompressedImage()
+
+/*
+ * getNumLevels
+ *
+ * return - Uint32
+ */
+Uint32 CompressedImage::getNumLevels(void) const {
+	return static_cast<Uint32> (levelOffsets.size());
+} // end getNumLevels()
+
+/*
+ * getLevelSize - Bytes of one stored mipmap level.
+ *
+ * parameter level - Uint32
+ * return - Uint32
+ */
+Uint32 CompressedImage::getLevelSize(Uint32 level) const {
+	const size_t end = level + 1 < levelOffsets.size() ? levelOffsets[level
+			+ 1] : data.size();
+	return static_cast<Uint32> (end - levelOffsets[level]);
+} // end getLevelSize()
+
+/*
+ * getLevelSize - Bytes of a level of the given size: 8 (BC1) or 16 (BC3)
+ * per started 4x4 block.
+ *
+ * parameter width - Uint32
+ * parameter height - Uint32
+ * parameter hasAlpha - bool
+ * return - Uint32
+ */
+Uint32 CompressedImage::getLevelSize(Uint32 width, Uint32 height,
+		bool hasAlpha) {
+	return ((width + 3) / 4) * ((height + 3) / 4) * (hasAlpha ? 16 : 8);
+} // end getLevelSize()
+
+/*******************************
+ Methods of class TextureCompressor:
+ *******************************/
+
+/*
+ * getPowerOfTwo - The power of two nearest to an image extent, at most
+ * MAX_SIZE.
+ *
+ * parameter extent - Uint32
+ * return - Uint32
+ */
+Uint32 TextureCompressor::getPowerOfTwo(Uint32 extent) {
+	Uint32 power = 1;
+	while (power * 2 <= extent && power < MAX_SIZE)
+		power *= 2;
+	if (power < MAX_SIZE && extent > power && extent - power > power * 2
+			- extent)
+		power *= 2;
+	return power;
+} // end getPowerOfTwo()
+
+/*
+ * resize - Resamples an RGBA image, filtering each axis separately.
+ *
+ * parameter rgba - const unsigned char *, width * height texels
+ * parameter width - Uint32
+ * parameter height - Uint32
+ * parameter newWidth - Uint32
+ * parameter newHeight - Uint32
+ * parameter result - std::vector<unsigned char>&, receives the new texels
+ */
+void TextureCompressor::resize(const unsigned char * rgba, Uint32 width,
+		Uint32 height, Uint32 newWidth, Uint32 newHeight,
+		std::vector<unsigned char>& result) {
+	std::vector<Uint32> firstTap;
+	std::vector<ResampleTap> taps;
+
+	computeTaps(width, newWidth, firstTap, taps);
+	std::vector<float> rows(newWidth * height * 4, 0.0f);
+	for (Uint32 y = 0; y < height; ++y) {
+		for (Uint32 x = 0; x < newWidth; ++x) {
+			float * target = &rows[(y * newWidth + x) * 4];
+			for (Uint32 t = firstTap[x]; t < firstTap[x + 1]; ++t) {
+				const unsigned char * source = rgba + (y * width
+						+ taps[t].source) * 4;
+				for (int c = 0; c < 4; ++c)
+					target[c] += source[c] * taps[t].weight;
+			}
+		}
+	}
+
+	computeTaps(height, newHeight, firstTap, taps);
+	result.resize(newWidth * newHeight * 4);
+	for (Uint32 y = 0; y < newHeight; ++y) {
+		for (Uint32 x = 0; x < newWidth; ++x) {
+			float sum[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+			for (Uint32 t = firstTap[y]; t < firstTap[y + 1]; ++t) {
+				const float * source = &rows[(taps[t].source * newWidth + x)
+						* 4];
+				for (int c = 0; c < 4; ++c)
+					sum[c] += source[c] * taps[t].weight;
+			}
+			for (int c = 0; c < 4; ++c)
+				result[(y * newWidth + x) * 4 + c]
+						= (unsigned char) std::min(std::max(sum[c] + 0.5f,
+								0.0f), 255.0f);
+		}
+	}
+} // end resize()
+
+/*
+ * compress - Resizes an RGBA image to powers of two and encodes its complete
+ * mipmap chain. Images with any translucent texel become BC3, others BC1.
+ *
+ * parameter rgba - const unsigned char *, width * height texels
+ * parameter width - Uint32
+ * parameter height - Uint32
+ * parameter image - CompressedImage&
+ */
+void TextureCompressor::compress(const unsigned char * rgba, Uint32 width,
+		Uint32 height, CompressedImage& image) {
+	image.width = getPowerOfTwo(width);
+	image.height = getPowerOfTwo(height);
+	std::vector<unsigned char> level;
+	if (image.width != width || image.height != height)
+		resize(rgba, width, height, image.width, image.height, level);
+	else
+		level.assign(rgba, rgba + width * height * 4);
+
+	image.hasAlpha = false;
+	for (size_t t = 3; t < level.size() && !image.hasAlpha; t += 4)
+		image.hasAlpha = level[t] != 255;
+
+	image.levelOffsets.clear();
+	image.data.clear();
+	Uint32 levelWidth = image.width;
+	Uint32 levelHeight = image.height;
+	std::vector<unsigned char> nextLevel;
+	for (;;) {
+		const size_t offset = image.data.size();
+		image.levelOffsets.push_back(static_cast<Uint32> (offset));
+		image.data.resize(offset + CompressedImage::getLevelSize(levelWidth,
+				levelHeight, image.hasAlpha));
+		encodeLevel(&level[0], levelWidth, levelHeight, image.hasAlpha,
+				&image.data[offset]);
+		if (levelWidth == 1 && levelHeight == 1)
+			break;
+		downsample(level, levelWidth, levelHeight, nextLevel);
+		level.swap(nextLevel);
+		levelWidth = std::max(levelWidth / 2, 1u);
+		levelHeight = std::max(levelHeight / 2, 1u);
+	}
+} // end compress()
+
+/*
+ * decompress - Decodes one BC1 or BC3 level back to RGBA.
+ *
+ * parameter blocks - const unsigned char *
+ * parameter width - Uint32
+ * parameter height - Uint32
+ * parameter hasAlpha - bool, BC3 rather than BC1
+ * parameter rgba - unsigned char *, receives width * height texels
+ */
+void TextureCompressor::decompress(const unsigned char * blocks, Uint32 width,
+		Uint32 height, bool hasAlpha, unsigned char * rgba) {
+	for (Uint32 by = 0; by < height; by += 4) {
+		for (Uint32 bx = 0; bx < width; bx += 4) {
+			int alphas[8];
+			Uint64 alphaIndices = 0;
+			if (hasAlpha) {
+				alphaPalette(blocks[0], blocks[1], alphas);
+				for (int i = 0; i < 6; ++i)
+					alphaIndices |= Uint64(blocks[2 + i]) << (8 * i);
+				blocks += 8;
+			}
+			const Uint32 color0 = blocks[0] | (blocks[1] << 8);
+			const Uint32 color1 = blocks[2] | (blocks[3] << 8);
+			int palette[4][3];
+			colorPalette(color0, color1, hasAlpha || color0 > color1, palette);
+			const Uint32 indices = blocks[4] | (blocks[5] << 8) | (blocks[6]
+					<< 16) | (Uint32(blocks[7]) << 24);
+			blocks += 8;
+
+			for (Uint32 t = 0; t < 16; ++t) {
+				const Uint32 x = bx + t % 4;
+				const Uint32 y = by + t / 4;
+				if (x >= width || y >= height)
+					continue;
+				unsigned char * texel = rgba + (y * width + x) * 4;
+				const int index = (indices >> (2 * t)) & 3;
+				for (int c = 0; c < 3; ++c)
+					texel[c] = (unsigned char) palette[index][c];
+				texel[3] = hasAlpha ? (unsigned char) alphas[(alphaIndices
+						>> (3 * t)) & 7] : 255;
+			}
+		}
+	}
+} // end decompress()
+
+/*
+ * getDirectory - Where the KTX files of a model directory live.
+ *
+ * parameter modelDirectory - const std::string&
+ * return - std::string
+ */
+std::string TextureCompressor::getDirectory(const std::string& modelDirectory) {
+	return modelDirectory + "/" + DIRECTORY;
+} // end getDirectory()
+
+/*
+ * getPath - The KTX file for a content key.
+ *
+ * parameter modelDirectory - const std::string&
+ * parameter key - Uint64
+ * return - std::string
+ */
+std::string TextureCompressor::getPath(const std::string& modelDirectory,
+		Uint64 key) {
+	std::ostringstream path;
+	path << getDirectory(modelDirectory) << "/" << std::hex
+			<< std::setfill('0') << std::setw(16) << key << ".ktx";
+	return path.str();
+} // end getPath()
+
+/*
+ * load - Reads a KTX file written by save(). Missing, truncated or foreign
+ * files are rejected.
+ *
+ * parameter path - const std::string&
+ * parameter image - CompressedImage&
+ * return - bool
+ */
+bool TextureCompressor::load(const std::string& path, CompressedImage& image) {
+	if (!MappedFile::exists(path))
+		return false;
+
+	try {
+		MappedFile file(path);
+		const char * data = file.getData();
+		const Uint64 size = file.getSize();
+		if (size < sizeof(KtxHeader))
+			return false;
+
+		const KtxHeader * header = reinterpret_cast<const KtxHeader*> (data);
+		if (std::memcmp(header->identifier, KTX_IDENTIFIER,
+				sizeof(KTX_IDENTIFIER)) != 0 || header->endianness
+				!= KTX_ENDIANNESS || (header->glInternalFormat != FORMAT_BC1
+				&& header->glInternalFormat != FORMAT_BC3)
+				|| header->pixelWidth == 0 || header->pixelHeight == 0
+				|| header->pixelDepth != 0 || header->numberOfArrayElements
+				!= 0 || header->numberOfFaces != 1
+				|| header->numberOfMipmapLevels == 0)
+			return false;
+
+		image.hasAlpha = header->glInternalFormat == FORMAT_BC3;
+		image.width = header->pixelWidth;
+		image.height = header->pixelHeight;
+		image.levelOffsets.clear();
+		image.data.clear();
+		Uint64 offset = sizeof(KtxHeader) + header->bytesOfKeyValueData;
+		Uint32 levelWidth = image.width;
+		Uint32 levelHeight = image.height;
+		for (Uint32 level = 0; level < header->numberOfMipmapLevels; ++level) {
+			Uint32 levelSize;
+			if (offset + sizeof(levelSize) > size)
+				return false;
+			std::memcpy(&levelSize, data + offset, sizeof(levelSize));
+			offset += sizeof(levelSize);
+			if (levelSize != CompressedImage::getLevelSize(levelWidth,
+					levelHeight, image.hasAlpha) || offset + levelSize > size)
+				return false;
+			image.levelOffsets.push_back(static_cast<Uint32> (image.data.size()));
+			image.data.insert(image.data.end(), data + offset, data + offset
+					+ levelSize);
+			offset += (levelSize + 3) & ~3u;
+			levelWidth = std::max(levelWidth / 2, 1u);
+			levelHeight = std::max(levelHeight / 2, 1u);
+		}
+	} catch (ResourceException& err) {
+		std::cerr << "Ignoring compressed texture: " << err.getDescription()
+				<< std::endl;
+		return false;
+	}
+
+	return true;
+} // end load()
+
+/*
+ * save - Writes a KTX 1.1 file atomically, so a concurrent loader never maps
+ * half of it.
+ *
+ * parameter path - const std::string&
+ * parameter image - const CompressedImage&
+ */
+void TextureCompressor::save(const std::string& path,
+		const CompressedImage& image) {
+	KtxHeader header;
+	std::memset(&header, 0, sizeof(header));
+	std::memcpy(header.identifier, KTX_IDENTIFIER, sizeof(KTX_IDENTIFIER));
+	header.endianness = KTX_ENDIANNESS;
+	header.glTypeSize = 1;
+	header.glInternalFormat = image.hasAlpha ? FORMAT_BC3 : FORMAT_BC1;
+	header.glBaseInternalFormat = image.hasAlpha ? BASE_FORMAT_RGBA
+			: BASE_FORMAT_RGB;
+	header.pixelWidth = image.width;
+	header.pixelHeight = image.height;
+	header.numberOfFaces = 1;
+	header.numberOfMipmapLevels = image.getNumLevels();
+
+	std::ostringstream tempPath;
+	tempPath << path << ".tmp." << getpid();
+	FILE* file = std::fopen(tempPath.str().c_str(), "wb");
+	if (file == 0) {
+		throw ResourceException("Cannot create compressed texture "
+				+ tempPath.str(), LOCATION);
+	}
+	bool written = std::fwrite(&header, sizeof(header), 1, file) == 1;
+	for (Uint32 level = 0; level < image.getNumLevels() && written; ++level) {
+		/* Level sizes are multiples of 8, so no mipmap padding is needed: */
+		const Uint32 levelSize = image.getLevelSize(level);
+		written = std::fwrite(&levelSize, sizeof(levelSize), 1, file) == 1
+				&& std::fwrite(&image.data[image.levelOffsets[level]], 1,
+						levelSize, file) == levelSize;
+	}
+	const bool closed = std::fclose(file) == 0;
+	if (!written || !closed || std::rename(tempPath.str().c_str(),
+			path.c_str()) != 0) {
+		std::remove(tempPath.str().c_str());
+		throw ResourceException("Cannot write compressed texture " + path,
+				LOCATION);
+	}
+} // end save()
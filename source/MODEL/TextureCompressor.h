@@ -0,0 +1,60 @@
+/*
+ * TextureCompressor.h - BC1/BC3 transcoding of park textures into KTX files
+ * with precomputed mipmap chains.
+ *
+ * Created: October 16, 2026
+ */
+
+#ifndef TEXTURECOMPRESSOR_H_
+#define TEXTURECOMPRESSOR_H_
+
+#include <string>
+#include <vector>
+
+#include <UTIL/Types.h>
+
+/*
+ * CompressedImage - A block-compressed texture and its complete mipmap chain,
+ * level 0 first, as stored in a KTX file and uploaded to GL.
+ */
+struct CompressedImage {
+	/* BC3 (DXT5) when the image has alpha, BC1 (DXT1) otherwise */
+	bool hasAlpha;
+	/* Size of level 0, powers of two */
+	Uint32 width;
+	Uint32 height;
+	/* Start of each level in data */
+	std::vector<Uint32> levelOffsets;
+	std::vector<unsigned char> data;
+
+	CompressedImage(void);
+	Uint32 getNumLevels(void) const;
+	Uint32 getLevelSize(Uint32 level) const;
+	static Uint32 getLevelSize(Uint32 width, Uint32 height, bool hasAlpha);
+};
+
+/*
+ * TextureCompressor - Resizes RGBA images to powers of two, box-filters the
+ * mipmap chain and encodes every level as BC1 or BC3. The results are kept
+ * as KTX 1.1 files named after a content key, so a file can never go stale.
+ */
+class TextureCompressor {
+public:
+	/* Largest extent of a transcoded level 0 */
+	static const Uint32 MAX_SIZE = 2048;
+
+	static Uint32 getPowerOfTwo(Uint32 extent);
+	static void resize(const unsigned char * rgba, Uint32 width,
+			Uint32 height, Uint32 newWidth, Uint32 newHeight,
+			std::vector<unsigned char>& result);
+	static void compress(const unsigned char * rgba, Uint32 width,
+			Uint32 height, CompressedImage& image);
+	static void decompress(const unsigned char * blocks, Uint32 width,
+			Uint32 height, bool hasAlpha, unsigned char * rgba);
+	static std::string getDirectory(const std::string& modelDirectory);
+	static std::string getPath(const std::string& modelDirectory, Uint64 key);
+	static bool load(const std::string& path, CompressedImage& image);
+	static void save(const std::string& path, const CompressedImage& image);
+};
+
+#endif /* TEXTURECOMPRESSOR_H_ */
@@ -0,0 +1,297 @@
+/*
+ * TexturePack.cpp - Methods for the deduplicated park texture archive.
+ *
+ * Created: October 16, 2026
+ */
+
+/* System headers */
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <map>
+#include <sstream>
+#include <unistd.h>
+
+/* Application headers */
+#include <MODEL/TexturePack.h>
+#include <UTIL/Hash.h>
+#include <UTIL/MappedFile.h>
+#include <UTIL/ResourceException.h>
+
+/* On-disk layout; bump VERSION whenever a record changes. */
+static const char MAGIC[8] = { 'F', 'N', 'W', 'Y', 'T', 'E', 'X', '\0' };
+static const Uint32 VERSION = 1;
+static const Uint32 ENDIAN_MARKER = 0x01020304;
+/* Blobs start on page boundaries so each can be mapped on its own. */
+static const Uint64 BLOB_ALIGNMENT = 4096;
+
+struct PackHeader {
+	char magic[8];
+	Uint32 version;
+	Uint32 endianMarker;
+	Uint32 numNames;
+	Uint32 numBlobs;
+	Uint64 nameOffset;
+	Uint64 blobOffset;
+};
+
+/* Sorted by name for binary search. */
+struct PackName {
+	char name[120];
+	Uint32 blob;
+	Uint32 reserved;
+};
+
+struct PackBlob {
+	Uint64 contentHash;
+	Uint64 offset;
+	Uint64 size;
+	char extension[8];
+};
+
+/*
+ * alignOffset - Rounds an offset up to the given power of two.
+ */
+static Uint64 alignOffset(Uint64 offset, Uint64 alignment) {
+	return (offset + alignment - 1) & ~(alignment - 1);
+} // end alignOffset()
+
+/*
+ * NameOrder - Orders name records by name.
+ */
+struct NameOrder {
+	bool operator()(const PackName& a, const PackName& b) const {
+		return std::strncmp(a.name, b.name, sizeof(a.name)) < 0;
+	}
+};
+
+/****************************************************
+ Constructors and Destructors of class TexturePack:
+ ****************************************************/
+/*
+ * TexturePack constructor - Maps and validates an archive.
+ *
+ * parameter packPath - const std::string&
+ *
+ * throw ResourceException if the archive cannot be mapped or is invalid.
+ */
+TexturePack::TexturePack(const std::string& packPath) :
+	file(new MappedFile(packPath)) {
+	const PackHeader * header =
+			reinterpret_cast<const PackHeader*> (file->getData());
+	bool valid = file->getSize() >= sizeof(PackHeader)
+			&& std::memcmp(header->magic, MAGIC, sizeof(MAGIC)) == 0
+			&& header->version == VERSION && header->endianMarker
+			== ENDIAN_MARKER && header->nameOffset + Uint64(header->numNames)
+			* sizeof(PackName) <= file->getSize() && header->blobOffset
+			+ Uint64(header->numBlobs) * sizeof(PackBlob) <= file->getSize();
+
+	const PackBlob * blobs = valid ? reinterpret_cast<const PackBlob*> (
+			file->getData() + header->blobOffset) : 0;
+	for (Uint32 b = 0; valid && b < header->numBlobs; ++b)
+		valid = blobs[b].offset + blobs[b].size <= file->getSize();
+	const PackName * names = valid ? reinterpret_cast<const PackName*> (
+			file->getData() + header->nameOffset) : 0;
+	for (Uint32 n = 0; valid && n < header->numNames; ++n)
+		valid = names[n].blob < header->numBlobs;
+
+	if (!valid) {
+		delete file;
+		throw ResourceException("Invalid texture pack " + packPath, LOCATION);
+	}
+} // end TexturePack()
+
+/*
+ * ~TexturePack destructor
+ */
+TexturePack::~TexturePack(void) {
+	delete file;
+} // end ~TexturePack()
+
+/*******************************
+ Methods of class TexturePack:
+ *******************************/
+
+/*
+ * find - Looks up a texture by the file name a material references.
+ *
+ * parameter name - const std::string&
+ * parameter image - Image&, filled in if found
+ * return - bool
+ */
+bool TexturePack::find(const std::string& name, Image& image) const {
+	const PackHeader * header =
+			reinterpret_cast<const PackHeader*> (file->getData());
+	const PackName * names = reinterpret_cast<const PackName*> (file->getData()
+			+ header->nameOffset);
+	if (name.size() >= sizeof(names->name))
+		return false;
+
+	PackName key;
+	std::memset(&key, 0, sizeof(key));
+	std::memcpy(key.name, name.data(), name.size());
+	const PackName * found = std::lower_bound(names, names + header->numNames,
+			key, NameOrder());
+	if (found == names + header->numNames || std::strncmp(found->name,
+			key.name, sizeof(key.name)) != 0)
+		return false;
+
+	const PackBlob& blob = reinterpret_cast<const PackBlob*> (file->getData()
+			+ header->blobOffset)[found->blob];
+	image.data = file->getData() + blob.offset;
+	image.size = static_cast<size_t> (blob.size);
+	image.contentHash = blob.contentHash;
+	image.extension = std::string(blob.extension, strnlen(blob.extension,
+			sizeof(blob.extension)));
+	return true;
+} // end find()
+
+/*
+ * getNumNames
+ *
+ * return - Uint32
+ */
+Uint32 TexturePack::getNumNames(void) const {
+	return reinterpret_cast<const PackHeader*> (file->getData())->numNames;
+} // end getNumNames()
+
+/*
+ * getNumImages
+ *
+ * return - Uint32
+ */
+Uint32 TexturePack::getNumImages(void) const {
+	return reinterpret_cast<const PackHeader*> (file->getData())->numBlobs;
+} // end getNumImages()
+
+/*
+ * getExtension - Lower-case extension of a file name, without the dot.
+ *
+ * parameter name - const std::string&
+ * return - std::string
+ */
+std::string TexturePack::getExtension(const std::string& name) {
+	std::string::size_type dot = name.find_last_of('.');
+	if (dot == std::string::npos)
+		return std::string();
+	std::string extension = name.substr(dot + 1);
+	for (std::string::iterator cIt = extension.begin(); cIt != extension.end(); ++cIt)
+		if (*cIt >= 'A' && *cIt <= 'Z')
+			*cIt = *cIt - 'A' + 'a';
+	return extension;
+} // end getExtension()
+
+/*
+ * build - Writes an archive of the named images. Images with identical
+ * content are stored once; every name stays resolvable.
+ *
+ * parameter modelDirectory - const std::string&
+ * parameter names - const std::vector<std::string>&, relative to the directory
+ * parameter packPath - const std::string&
+ * return - Uint64, bytes saved by deduplication
+ *
+ * throw ResourceException if an image cannot be read or the pack written.
+ */
+Uint64 TexturePack::build(const std::string& modelDirectory,
+		const std::vector<std::string>& names, const std::string& packPath) {
+	std::vector<PackName> nameRecords;
+	std::vector<PackBlob> blobRecords;
+	std::vector<std::string> blobPaths;
+	std::multimap<Uint64, Uint32> blobsByHash;
+	Uint64 savedBytes = 0;
+
+	for (std::vector<std::string>::const_iterator nIt = names.begin(); nIt
+			!= names.end(); ++nIt) {
+		const std::string path = modelDirectory + "/" + *nIt;
+		MappedFile image(path);
+		const Uint64 hash = Hash::hashBytes(image.getData(), image.getSize());
+
+		/* A hash match only counts if the bytes agree as well: */
+		Uint32 blob = static_cast<Uint32> (blobRecords.size());
+		std::pair<std::multimap<Uint64, Uint32>::iterator, std::multimap<
+				Uint64, Uint32>::iterator> range = blobsByHash.equal_range(hash);
+		for (std::multimap<Uint64, Uint32>::iterator bIt = range.first; bIt
+				!= range.second; ++bIt) {
+			MappedFile other(blobPaths[bIt->second]);
+			if (other.getSize() == image.getSize() && std::memcmp(
+					other.getData(), image.getData(), image.getSize()) == 0) {
+				blob = bIt->second;
+				savedBytes += image.getSize();
+				break;
+			}
+		}
+
+		if (blob == blobRecords.size()) {
+			PackBlob record;
+			std::memset(&record, 0, sizeof(record));
+			record.contentHash = hash;
+			record.size = image.getSize();
+			const std::string extension = getExtension(*nIt);
+			std::strncpy(record.extension, extension.c_str(),
+					sizeof(record.extension) - 1);
+			blobRecords.push_back(record);
+			blobPaths.push_back(path);
+			blobsByHash.insert(std::make_pair(hash, blob));
+		}
+
+		PackName record;
+		std::memset(&record, 0, sizeof(record));
+		if (nIt->size() >= sizeof(record.name)) {
+			throw ResourceException("Texture name too long: " + *nIt,
+					LOCATION);
+		}
+		std::memcpy(record.name, nIt->data(), nIt->size());
+		record.blob = blob;
+		nameRecords.push_back(record);
+	}
+	std::sort(nameRecords.begin(), nameRecords.end(), NameOrder());
+
+	PackHeader header;
+	std::memset(&header, 0, sizeof(header));
+	std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+	header.version = VERSION;
+	header.endianMarker = ENDIAN_MARKER;
+	header.numNames = static_cast<Uint32> (nameRecords.size());
+	header.numBlobs = static_cast<Uint32> (blobRecords.size());
+	header.nameOffset = alignOffset(sizeof(PackHeader), 64);
+	header.blobOffset = alignOffset(header.nameOffset + nameRecords.size()
+			* sizeof(PackName), 64);
+	Uint64 offset = header.blobOffset + blobRecords.size() * sizeof(PackBlob);
+	for (std::vector<PackBlob>::iterator bIt = blobRecords.begin(); bIt
+			!= blobRecords.end(); ++bIt) {
+		bIt->offset = alignOffset(offset, BLOB_ALIGNMENT);
+		offset = bIt->offset + bIt->size;
+	}
+
+	std::ostringstream tempPath;
+	tempPath << packPath << ".tmp." << getpid();
+	FILE * out = std::fopen(tempPath.str().c_str(), "wb");
+	if (out == 0) {
+		throw ResourceException("Cannot create texture pack "
+				+ tempPath.str(), LOCATION);
+	}
+	bool written = std::fwrite(&header, sizeof(header), 1, out) == 1;
+	written = written && std::fseek(out, header.nameOffset, SEEK_SET) == 0
+			&& (nameRecords.empty() || std::fwrite(&nameRecords[0],
+					sizeof(PackName), nameRecords.size(), out)
+					== nameRecords.size());
+	written = written && std::fseek(out, header.blobOffset, SEEK_SET) == 0
+			&& (blobRecords.empty() || std::fwrite(&blobRecords[0],
+					sizeof(PackBlob), blobRecords.size(), out)
+					== blobRecords.size());
+	for (size_t b = 0; written && b < blobRecords.size(); ++b) {
+		MappedFile image(blobPaths[b]);
+		written = std::fseek(out, blobRecords[b].offset, SEEK_SET) == 0
+				&& std::fwrite(image.getData(), 1, image.getSize(), out)
+						== image.getSize();
+	}
+	const bool closed = std::fclose(out) == 0;
+	if (!written || !closed || std::rename(tempPath.str().c_str(),
+			packPath.c_str()) != 0) {
+		std::remove(tempPath.str().c_str());
+		throw ResourceException("Cannot write texture pack " + packPath,
+				LOCATION);
+	}
+
+	return savedBytes;
+} // end build()
@@ -0,0 +1,53 @@
+/*
+ * TexturePack.h - Class for the deduplicated park texture archive.
+ *
+ * Created: October 16, 2026
+ */
+
+#ifndef TEXTUREPACK_H_
+#define TEXTUREPACK_H_
+
+#include <string>
+#include <vector>
+
+/* Boost includes */
+#include <boost/noncopyable.hpp>
+
+#include <UTIL/Types.h>
+
+/* Begin Forward declarations: */
+class MappedFile;
+/* End Forward declarations: */
+
+/*
+ * TexturePack - Single archive holding each distinct texture image once,
+ * page-aligned so the encoded bytes can be decoded straight out of the
+ * mapping. A sorted name index maps every file name that had the content
+ * (e.g. both fenw115.bmp and fenwaypark_112.bmp) to the shared blob.
+ */
+class TexturePack: boost::noncopyable {
+public:
+	/*
+	 * Image - Encoded image bytes inside the mapping.
+	 */
+	struct Image {
+		const char * data;
+		size_t size;
+		Uint64 contentHash;
+		/* Lower-case file extension without the dot, e.g. "jpg" */
+		std::string extension;
+	};
+
+	TexturePack(const std::string& packPath);
+	~TexturePack(void);
+	bool find(const std::string& name, Image& image) const;
+	Uint32 getNumNames(void) const;
+	Uint32 getNumImages(void) const;
+	static Uint64 build(const std::string& modelDirectory,
+			const std::vector<std::string>& names, const std::string& packPath);
+	static std::string getExtension(const std::string& name);
+private:
+	MappedFile * file;
+};
+
+#endif /* TEXTUREPACK_H_ */
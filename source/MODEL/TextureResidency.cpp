@@ -0,0 +1,486 @@
+/*
+ * TextureResidency.cpp - Methods for decoding the park textures lazily and
+ * evicting their GL copies under a per-context budget.
+ *
+ * Created: October 17, 2026
+ */
+
+/* System headers */
+#include <algorithm>
+#include <iostream>
+#include <map>
+
+/* osg includes */
+#include <osg/FrameStamp>
+#include <osg/Geometry>
+#include <osg/StateSet>
+#include <osg/Texture2D>
+
+/* Application headers */
+#include <MODEL/ImageDecoder.h>
+#include <MODEL/ParkMesh.h>
+#include <MODEL/SceneBuilder.h>
+#include <MODEL/TextureResidency.h>
+#include <MODEL/TexturePack.h>
+#include <SYNC/Guard.h>
+#include <SYNC/ThreadPool.h>
+#include <UTIL/MappedFile.h>
+#include <UTIL/ResourceException.h>
+
+/*
+ * ResidentTexture - Park texture that asks the residency before it binds:
+ * textures the current view does not use, and textures still waiting for
+ * their image, bind nothing instead of being uploaded.
+ */
+class ResidentTexture: public osg::Texture2D {
+public:
+	ResidentTexture(const osg::Texture2D& texture,
+			TextureResidency * _residency, Uint32 _entry) :
+		osg::Texture2D(texture, osg::CopyOp::SHALLOW_COPY),
+				residency(_residency), entry(_entry) {
+	}
+
+	Uint32 getEntry(void) const {
+		return entry;
+	}
+
+	bool isManagedBy(const TextureResidency * _residency) const {
+		return residency == _residency;
+	}
+
+	/*
+	 * detach - Binds like any texture from now on.
+	 */
+	void detach(void) {
+		residency = 0;
+	}
+
+	virtual void apply(osg::State& state) const {
+		if (residency != 0 && !residency->prepareApply(entry,
+				state.getContextID())) {
+			glBindTexture(GL_TEXTURE_2D, 0);
+			return;
+		}
+		osg::Texture2D::apply(state);
+	}
+
+private:
+	TextureResidency * residency;
+	Uint32 entry;
+};
+
+/*
+ * TextureResidency::DecodeTask - Decodes one deferred image on the pool.
+ */
+class TextureResidency::DecodeTask: public ThreadPool::Task {
+public:
+	DecodeTask(TextureResidency * _residency, Uint32 _generation,
+			Uint32 _entry, const std::string& _name) :
+		residency(_residency), generation(_generation), entry(_entry),
+				name(_name) {
+	}
+
+	virtual void run(void) {
+		residency->decode(generation, entry, name);
+	}
+
+private:
+	TextureResidency * residency;
+	Uint32 generation;
+	Uint32 entry;
+	std::string name;
+};
+
+/*
+ * getTextureBytes - GL memory of a texture made from an image, counting the
+ * mipmaps GL builds for images that lack them.
+ */
+static Uint64 getTextureBytes(const osg::Image& image) {
+	Uint64 bytes = image.getTotalSizeInBytesIncludingMipmaps();
+	if (!image.isMipmap())
+		bytes += bytes / 3;
+	return bytes;
+} // end getTextureBytes()
+
+/****************************************************
+ Constructors and Destructors of struct TextureStatistics:
+ ****************************************************/
+/*
+ * TextureStatistics constructor
+ */
+TextureStatistics::TextureStatistics(void) :
+	numHits(0), numMisses(0), numEvicted(0), numTextures(0), numDecoded(0),
+			residentBytes(0) {
+} // end TextureStatistics()
+
+/****************************************************
+ Constructors and Destructors of class TextureResidency:
+ ****************************************************/
+/*
+ * ContextUse constructor - Never used, nothing uploaded.
+ */
+TextureResidency::ContextUse::ContextUse(void) :
+	lastUse(-1), lastCounted(-1), residentBytes(0) {
+} // end ContextUse()
+
+/*
+ * ContextState constructor - Before any view.
+ */
+TextureResidency::ContextState::ContextState(void) :
+	frameNumber(-2), residentBytes(0) {
+} // end ContextState()
+
+/*
+ * TextureResidency constructor - Opens the texture pack the deferred images
+ * may come from, if there is one.
+ *
+ * parameter modelDirectory - const std::string&
+ * parameter texturePackFile - const std::string&, relative to the model
+ * directory
+ * parameter contextBudget - Uint64, bytes of textures each context keeps
+ * uploaded beyond the ones its current view uses
+ */
+TextureResidency::TextureResidency(const std::string& _modelDirectory,
+		const std::string& texturePackFile, Uint64 _contextBudget) :
+	modelDirectory(_modelDirectory), texturePack(0),
+			contextBudget(_contextBudget), generation(0), cancelled(false),
+			decodePool(new ThreadPool()) {
+	const std::string packPath = modelDirectory + "/" + texturePackFile;
+	if (MappedFile::exists(packPath)) {
+		try {
+			texturePack = new TexturePack(packPath);
+		} catch (ResourceException& err) {
+			std::cerr << "Ignoring texture pack: " << err.getDescription()
+					<< std::endl;
+		}
+	}
+} // end TextureResidency()
+
+/*
+ * ~TextureResidency - Drops the queued decodes and leaves the textures to
+ * bind like any other.
+ */
+TextureResidency::~TextureResidency(void) {
+	{
+		Guard<MutexPosix> guard(lock);
+		cancelled = true;
+	}
+	delete decodePool;
+	for (size_t e = 0; e < entries.size(); ++e)
+		entries[e].texture->detach();
+	delete texturePack;
+} // end ~TextureResidency()
+
+/*******************************
+ Methods of class TextureResidency:
+ *******************************/
+
+/*
+ * manage - Puts the textures of a park geode under management, replacing
+ * them by resident copies. Calling it again for the same geode picks up the
+ * textures and images asset patches brought in; a new geode starts over.
+ * Called while no context draws.
+ *
+ * parameter newGeode - osg::Geode *, as returned by SceneBuilder::buildNode()
+ * parameter mesh - const ParkMesh&, drawn by the geode
+ */
+void TextureResidency::manage(osg::Geode * newGeode, const ParkMesh& mesh) {
+	Guard<MutexPosix> guard(lock);
+	if (newGeode != geode.get()) {
+		for (size_t e = 0; e < entries.size(); ++e)
+			entries[e].texture->detach();
+		entries.clear();
+		decoded.clear();
+		for (unsigned int c = 0; c < contexts.size(); ++c) {
+			contexts[c].uses.clear();
+			contexts[c].residentBytes = 0;
+		}
+		geode = newGeode;
+		++generation;
+	}
+
+	/* Wrap the textures not managed yet, once however many states share
+	 * them: */
+	std::map<const osg::Texture2D*, Uint32> wrapped;
+	for (unsigned int d = 0; d < geode->getNumDrawables(); ++d) {
+		osg::StateSet * stateSet = geode->getDrawable(d)->getStateSet();
+		if (stateSet == 0)
+			continue;
+		osg::Texture2D * texture = dynamic_cast<osg::Texture2D*> (
+				stateSet->getTextureAttribute(0, osg::StateAttribute::TEXTURE));
+		if (texture == 0 || texture->getImage() == 0)
+			continue;
+		ResidentTexture * resident = dynamic_cast<ResidentTexture*> (texture);
+		if (resident != 0 && resident->isManagedBy(this))
+			continue;
+
+		std::map<const osg::Texture2D*, Uint32>::const_iterator wIt =
+				wrapped.find(texture);
+		if (wIt == wrapped.end()) {
+			Entry entry;
+			entry.texture = new ResidentTexture(*texture, this,
+					static_cast<Uint32> (entries.size()));
+			entry.image = texture->getImage();
+			if (SceneBuilder::isDeferred(*entry.image))
+				entry.deferredName = entry.image->getFileName();
+			entry.decodeQueued = false;
+			entry.alwaysUsed = false;
+			wIt = wrapped.insert(std::make_pair(texture, static_cast<Uint32> (
+					entries.size()))).first;
+			entries.push_back(entry);
+		}
+		stateSet->setTextureAttribute(0, entries[wIt->second].texture.get());
+	}
+
+	/* Patched images have to be uploaded again, and are decoded already: */
+	for (size_t e = 0; e < entries.size(); ++e) {
+		Entry& entry = entries[e];
+		if (entry.texture->getImage() == entry.image)
+			continue;
+		entry.image = entry.texture->getImage();
+		entry.deferredName.clear();
+		for (unsigned int c = 0; c < contexts.size(); ++c) {
+			ContextState& context = contexts[c];
+			if (e < context.uses.size()) {
+				context.residentBytes -= context.uses[e].residentBytes;
+				context.uses[e].residentBytes = 0;
+			}
+		}
+	}
+
+	batchEntries.assign(mesh.batches.size(), -1);
+	for (unsigned int d = 0; d < geode->getNumDrawables(); ++d) {
+		const osg::StateSet * stateSet = geode->getDrawable(d)->getStateSet();
+		const ResidentTexture * resident = stateSet == 0 ? 0
+				: dynamic_cast<const ResidentTexture*> (
+						stateSet->getTextureAttribute(0,
+								osg::StateAttribute::TEXTURE));
+		if (resident == 0)
+			continue;
+		if (d < batchEntries.size())
+			batchEntries[d] = static_cast<int> (resident->getEntry());
+		else
+			entries[resident->getEntry()].alwaysUsed = true;
+	}
+} // end manage()
+
+/*
+ * update - Gives the textures the images decoded since the last call. Called
+ * while no context draws.
+ */
+void TextureResidency::update(void) {
+	Guard<MutexPosix> guard(lock);
+	for (size_t d = 0; d < decoded.size(); ++d) {
+		const DecodedImage& result = decoded[d];
+		if (result.generation != generation)
+			continue;
+		Entry& entry = entries[result.entry];
+		/* A failed decode stays queued, so it is not tried again, and a
+		 * patched image wins over the decoded one: */
+		if (!result.image.valid() || entry.deferredName.empty())
+			continue;
+		entry.texture->setImage(result.image.get());
+		entry.image = result.image.get();
+		entry.deferredName.clear();
+	}
+	decoded.clear();
+} // end update()
+
+/*
+ * use - Marks the textures of the clusters a context's view sees as used in
+ * the given frame. The context's textures not marked bind nothing. Called
+ * from the context's drawing thread.
+ *
+ * parameter contextID - unsigned int
+ * parameter frameNumber - int, counting up
+ * parameter clusters - const std::vector<Uint32>&, visible cluster indices
+ * parameter mesh - const ParkMesh&, the managed park
+ */
+void TextureResidency::use(unsigned int contextID, int frameNumber,
+		const std::vector<Uint32>& clusters, const ParkMesh& mesh) {
+	ContextState& context = getContextState(contextID);
+	context.frameNumber = frameNumber;
+	for (std::vector<Uint32>::const_iterator cIt = clusters.begin(); cIt
+			!= clusters.end(); ++cIt) {
+		const Uint32 batch = mesh.clusters[*cIt].batch;
+		if (batch < batchEntries.size() && batchEntries[batch] >= 0)
+			context.uses[batchEntries[batch]].lastUse = frameNumber;
+	}
+} // end use()
+
+/*
+ * useAll - Marks every texture as used by a context in the given frame, for
+ * views that were not culled. Called from the context's drawing thread.
+ *
+ * parameter contextID - unsigned int
+ * parameter frameNumber - int, counting up
+ */
+void TextureResidency::useAll(unsigned int contextID, int frameNumber) {
+	ContextState& context = getContextState(contextID);
+	context.frameNumber = frameNumber;
+	for (size_t e = 0; e < context.uses.size(); ++e)
+		context.uses[e].lastUse = frameNumber;
+} // end useAll()
+
+/*
+ * evict - Releases the context's least recently used textures until its
+ * uploads fit the budget. Textures used in the current frame are kept even
+ * over budget. Called with the context current, after use() or useAll().
+ *
+ * parameter state - osg::State&, of the context
+ */
+void TextureResidency::evict(osg::State& state) {
+	const unsigned int contextID = state.getContextID();
+	ContextState& context = getContextState(contextID);
+	std::vector<Uint32> released;
+	while (context.residentBytes > contextBudget) {
+		int oldest = context.frameNumber;
+		Uint32 victim = 0;
+		for (Uint32 e = 0; e < context.uses.size(); ++e) {
+			const ContextUse& use = context.uses[e];
+			if (use.residentBytes != 0 && use.lastUse < oldest) {
+				oldest = use.lastUse;
+				victim = e;
+			}
+		}
+		if (oldest == context.frameNumber)
+			break;
+		ContextUse& use = context.uses[victim];
+		context.residentBytes -= use.residentBytes;
+		use.residentBytes = 0;
+		++context.statistics.numEvicted;
+		released.push_back(victim);
+	}
+	if (released.empty())
+		return;
+
+	for (size_t r = 0; r < released.size(); ++r)
+		entries[released[r]].texture->releaseGLObjects(&state);
+	const osg::FrameStamp * frameStamp = state.getFrameStamp();
+	double availableTime = 1.0;
+	osg::Texture::flushDeletedTextureObjects(contextID, frameStamp != 0
+			? frameStamp->getReferenceTime() : 0.0, availableTime);
+} // end evict()
+
+/*
+ * getStatistics - Hands out the counts of the views drawn since the last
+ * call and restarts them. Called while no context draws.
+ *
+ * parameter newStatistics - TextureStatistics&
+ */
+void TextureResidency::getStatistics(TextureStatistics& newStatistics) {
+	newStatistics = TextureStatistics();
+	for (unsigned int c = 0; c < contexts.size(); ++c) {
+		ContextState& context = contexts[c];
+		newStatistics.numHits += context.statistics.numHits;
+		newStatistics.numMisses += context.statistics.numMisses;
+		newStatistics.numEvicted += context.statistics.numEvicted;
+		newStatistics.residentBytes = std::max(newStatistics.residentBytes,
+				context.residentBytes);
+		context.statistics = TextureStatistics();
+	}
+	newStatistics.numTextures = static_cast<Uint32> (entries.size());
+	for (size_t e = 0; e < entries.size(); ++e)
+		if (entries[e].deferredName.empty())
+			++newStatistics.numDecoded;
+} // end getStatistics()
+
+/*
+ * prepareApply - Decides whether a texture binds in a context, counting the
+ * upload it is about to make, or queueing the decode of its image. Called
+ * from the drawing threads.
+ *
+ * parameter entry - Uint32
+ * parameter contextID - unsigned int
+ * return - bool, false to bind nothing
+ */
+bool TextureResidency::prepareApply(Uint32 entry, unsigned int contextID) {
+	const Entry& managed = entries[entry];
+	ContextState& context = getContextState(contextID);
+	ContextUse& use = context.uses[entry];
+	if (managed.alwaysUsed)
+		use.lastUse = context.frameNumber;
+	if (use.lastUse != context.frameNumber)
+		return false;
+	const bool counted = use.lastCounted == context.frameNumber;
+	use.lastCounted = context.frameNumber;
+
+	if (!managed.deferredName.empty()) {
+		if (!counted) {
+			++context.statistics.numMisses;
+			queueDecode(entry);
+		}
+		return false;
+	}
+	if (use.residentBytes == 0) {
+		use.residentBytes = getTextureBytes(*managed.image);
+		context.residentBytes += use.residentBytes;
+		if (!counted)
+			++context.statistics.numMisses;
+	} else if (!counted)
+		++context.statistics.numHits;
+	return true;
+} // end prepareApply()
+
+/*
+ * queueDecode - Queues the decode of a deferred image, unless some context
+ * did so before.
+ *
+ * parameter entry - Uint32
+ */
+void TextureResidency::queueDecode(Uint32 entry) {
+	Guard<MutexPosix> guard(lock);
+	Entry& managed = entries[entry];
+	if (managed.decodeQueued)
+		return;
+	managed.decodeQueued = true;
+	decodePool->enqueue(new DecodeTask(this, generation, entry,
+			managed.deferredName));
+} // end queueDecode()
+
+/*
+ * decode - Decodes a deferred image and queues it for update(). Runs on the
+ * decode pool.
+ *
+ * parameter decodeGeneration - Uint32, of the geode the entry belongs to
+ * parameter entry - Uint32
+ * parameter name - const std::string&, texture name
+ */
+void TextureResidency::decode(Uint32 decodeGeneration, Uint32 entry,
+		const std::string& name) {
+	{
+		Guard<MutexPosix> guard(lock);
+		if (cancelled || decodeGeneration != generation)
+			return;
+	}
+	DecodedImage result;
+	result.generation = decodeGeneration;
+	result.entry = entry;
+	try {
+		result.image = ImageDecoder::load(name, modelDirectory, texturePack);
+	} catch (ResourceException& err) {
+		std::cerr << "Unreadable texture: " << err.getDescription()
+				<< std::endl;
+	}
+	if (result.image.valid())
+		result.image->setFileName(name);
+	else
+		std::cerr << "Texture " << name << " not decoded" << std::endl;
+	Guard<MutexPosix> guard(lock);
+	decoded.push_back(result);
+} // end decode()
+
+/*
+ * getContextState - A context's frame, uploads and counts, with a use for
+ * every entry.
+ *
+ * parameter contextID - unsigned int
+ * return - ContextState&
+ */
+TextureResidency::ContextState& TextureResidency::getContextState(
+		unsigned int contextID) {
+	ContextState& context = contexts[contextID];
+	if (context.uses.size() < entries.size())
+		context.uses.resize(entries.size());
+	return context;
+} // end getContextState()
@@ -0,0 +1,160 @@
+/*
+ * TextureResidency.h - Lazy decoding of the park textures and least recently
+ * used eviction of their GL copies under a per-context budget.
+ *
+ * Created: October 17, 2026
+ */
+
+#ifndef TEXTURERESIDENCY_H_
+#define TEXTURERESIDENCY_H_
+
+#include <string>
+#include <vector>
+
+/* Boost includes */
+#include <boost/noncopyable.hpp>
+
+/* osg includes */
+#include <osg/buffered_value>
+#include <osg/Geode>
+#include <osg/Image>
+#include <osg/State>
+
+#include <SYNC/MutexPosix.h>
+#include <UTIL/Types.h>
+
+/* Begin Forward declarations: */
+class ParkMesh;
+class ResidentTexture;
+class TexturePack;
+class ThreadPool;
+/* End Forward declarations: */
+
+/*
+ * TextureStatistics - Texture use of the views drawn since the last
+ * getStatistics(), summed over the contexts.
+ */
+struct TextureStatistics {
+	/* Textures drawn that were uploaded already */
+	Uint32 numHits;
+	/* Textures drawn that had to be uploaded, or waited for decoding */
+	Uint32 numMisses;
+	/* Textures whose GL copies were dropped to stay in budget */
+	Uint32 numEvicted;
+	/* Park textures, and of them those decoded so far */
+	Uint32 numTextures;
+	Uint32 numDecoded;
+	/* Largest GL memory of the park textures in any context */
+	Uint64 residentBytes;
+
+	TextureStatistics(void);
+};
+
+/*
+ * TextureResidency - Manages the textures of the displayed park. Textures
+ * loaded with deferred images are decoded on worker threads, one per
+ * processor, the first time a view sees a cluster drawing them, and drawn
+ * untextured until then; update() hands the decoded images to the textures,
+ * which the drawing threads then upload. Each
+ * context uploads only the textures its current view uses; when its uploads
+ * exceed the budget, the textures it used least recently, and not in the
+ * current frame, are released from it. The decoded images stay, so a texture
+ * seen again is only uploaded again. Contexts drawing concurrently keep
+ * their uses apart and share only the decode queue.
+ */
+class TextureResidency: boost::noncopyable {
+public:
+	TextureResidency(const std::string& modelDirectory,
+			const std::string& texturePackFile, Uint64 contextBudget);
+	~TextureResidency(void);
+	void manage(osg::Geode * newGeode, const ParkMesh& mesh);
+	void update(void);
+	void use(unsigned int contextID, int frameNumber,
+			const std::vector<Uint32>& clusters, const ParkMesh& mesh);
+	void useAll(unsigned int contextID, int frameNumber);
+	void evict(osg::State& state);
+	void getStatistics(TextureStatistics& statistics);
+
+private:
+	/*
+	 * ContextUse - What one context holds of a texture.
+	 */
+	struct ContextUse {
+		/* Frame of the last view using the texture, and of the last one
+		 * counted in the statistics */
+		int lastUse;
+		int lastCounted;
+		/* Memory of the GL copy, zero if there is none */
+		Uint64 residentBytes;
+
+		ContextUse(void);
+	};
+
+	/*
+	 * Entry - One managed texture.
+	 */
+	struct Entry {
+		osg::ref_ptr<ResidentTexture> texture;
+		/* Image the GL copies were made from */
+		const osg::Image * image;
+		/* Texture name to decode, empty once decoded */
+		std::string deferredName;
+		/* Guarded by the lock, as every context may queue the decode */
+		bool decodeQueued;
+		/* Drawn by instanced draws, which the cluster culling does not cover */
+		bool alwaysUsed;
+	};
+
+	/*
+	 * DecodedImage - A finished decode waiting for update().
+	 */
+	struct DecodedImage {
+		Uint32 generation;
+		Uint32 entry;
+		osg::ref_ptr<osg::Image> image;
+	};
+
+	/*
+	 * ContextState - One context's frame, uploads and counts. Only the
+	 * context's drawing thread touches it while drawing, so it takes no
+	 * lock; the frame thread reads and resets it while no context draws.
+	 */
+	struct ContextState {
+		int frameNumber;
+		Uint64 residentBytes;
+		/* Indexed by entry */
+		std::vector<ContextUse> uses;
+		TextureStatistics statistics;
+
+		ContextState(void);
+	};
+
+	class DecodeTask;
+	friend class DecodeTask;
+	friend class ResidentTexture;
+
+	std::string modelDirectory;
+	TexturePack * texturePack;
+	Uint64 contextBudget;
+	/* Managed textures, and the entry of each batch's texture or -1 */
+	std::vector<Entry> entries;
+	std::vector<int> batchEntries;
+	/* Counts up with every new geode; decodes for older ones are dropped */
+	Uint32 generation;
+	osg::buffered_object<ContextState> contexts;
+	/* Guards the queued decodes, their results and the generation */
+	mutable MutexPosix lock;
+	std::vector<DecodedImage> decoded;
+	bool cancelled;
+	/* Deleted first, so no decode outlives the rest */
+	ThreadPool * decodePool;
+	/* The geode whose textures are managed */
+	osg::ref_ptr<osg::Geode> geode;
+
+	bool prepareApply(Uint32 entry, unsigned int contextID);
+	void queueDecode(Uint32 entry);
+	void decode(Uint32 generation, Uint32 entry, const std::string& name);
+	ContextState& getContextState(unsigned int contextID);
+};
+
+#endif /* TEXTURERESIDENCY_H_ */
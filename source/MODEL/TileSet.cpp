@@ -0,0 +1,359 @@
+/*
+ * TileSet.cpp - Methods for the spatially tiled, compressed scene file.
+ *
+ * Created: October 17, 2026
+ */
+
+/* System headers */
+#include <cfloat>
+#include <cstdio>
+#include <cstring>
+#include <sstream>
+#include <unistd.h>
+#include <vector>
+#include <zlib.h>
+
+/* Application headers */
+#include <MODEL/ParkMesh.h>
+#include <MODEL/SceneCache.h>
+#include <MODEL/TileSet.h>
+#include <UTIL/MappedFile.h>
+#include <UTIL/ResourceException.h>
+
+/* On-disk layout; bump VERSION whenever a record changes. */
+static const char MAGIC[8] = { 'F', 'N', 'W', 'Y', 'T', 'I', 'L', '\0' };
+static const Uint32 VERSION = 1;
+static const Uint32 ENDIAN_MARKER = 0x01020304;
+/* Deepest quadtree split; stops cells of stacked triangles splitting forever */
+static const Uint32 MAX_DEPTH = 16;
+/* Marks vertices and materials not in the tile yet */
+static const Uint32 UNMAPPED = ~Uint32(0);
+
+struct TileHeader {
+	char magic[8];
+	Uint32 version;
+	Uint32 endianMarker;
+	Uint32 numTiles;
+	Uint32 reserved;
+	Uint64 tileOffset;
+	float boundsMin[3];
+	float boundsMax[3];
+};
+
+struct TileRecord {
+	float boundsMin[3];
+	float boundsMax[3];
+	Uint32 numTriangles;
+	Uint32 reserved;
+	Uint64 offset;
+	Uint64 compressedSize;
+	Uint64 size;
+};
+
+/*
+ * splitTiles - Splits the triangles into the quadrants of a cell by their
+ * centroids on the ground plane until each leaf holds at most maxTriangles.
+ * Triangles keep their order within a leaf.
+ *
+ * parameter centroids - const std::vector<float>&, x and y of each triangle
+ * parameter triangles - std::vector<Uint32>&, of the cell; emptied
+ * parameter cellMin - const float[2]
+ * parameter cellMax - const float[2]
+ * parameter depth - Uint32
+ * parameter maxTriangles - Uint32
+ * parameter leaves - std::vector<std::vector<Uint32> >&, appended to
+ */
+static void splitTiles(const std::vector<float>& centroids,
+		std::vector<Uint32>& triangles, const float cellMin[2],
+		const float cellMax[2], Uint32 depth, Uint32 maxTriangles,
+		std::vector<std::vector<Uint32> >& leaves) {
+	if (triangles.size() <= maxTriangles || depth == MAX_DEPTH) {
+		leaves.push_back(std::vector<Uint32>());
+		leaves.back().swap(triangles);
+		return;
+	}
+
+	const float center[2] = { 0.5f * (cellMin[0] + cellMax[0]), 0.5f
+			* (cellMin[1] + cellMax[1]) };
+	std::vector<Uint32> quadrants[4];
+	for (std::vector<Uint32>::const_iterator tIt = triangles.begin(); tIt
+			!= triangles.end(); ++tIt) {
+		const float * centroid = &centroids[2 * *tIt];
+		quadrants[(centroid[0] >= center[0] ? 1 : 0) + (centroid[1]
+				>= center[1] ? 2 : 0)].push_back(*tIt);
+	}
+	std::vector<Uint32>().swap(triangles);
+
+	for (int q = 0; q < 4; ++q) {
+		if (quadrants[q].empty())
+			continue;
+		const float quadrantMin[2] = { q & 1 ? center[0] : cellMin[0], q & 2
+				? center[1] : cellMin[1] };
+		const float quadrantMax[2] = { q & 1 ? cellMax[0] : center[0], q & 2
+				? cellMax[1] : center[1] };
+		splitTiles(centroids, quadrants[q], quadrantMin, quadrantMax, depth
+				+ 1, maxTriangles, leaves);
+	}
+} // end splitTiles()
+
+/*
+ * extractTile - Copies the given triangles into a mesh of their own, with
+ * only the vertices and materials they use. Runs of triangles from one group
+ * stay one group.
+ *
+ * parameter mesh - const ParkMesh&
+ * parameter triangleGroups - const std::vector<Uint32>&, group of each
+ * triangle
+ * parameter triangles - const std::vector<Uint32>&
+ * parameter vertexMap - std::vector<Uint32>&, all UNMAPPED; left so
+ * parameter tile - ParkMesh&, overwritten
+ */
+static void extractTile(const ParkMesh& mesh,
+		const std::vector<Uint32>& triangleGroups,
+		const std::vector<Uint32>& triangles, std::vector<Uint32>& vertexMap,
+		ParkMesh& tile) {
+	tile.clear();
+	std::vector<Uint32> materialMap(mesh.materials.size(), UNMAPPED);
+	Uint32 group = UNMAPPED;
+	for (std::vector<Uint32>::const_iterator tIt = triangles.begin(); tIt
+			!= triangles.end(); ++tIt) {
+		if (triangleGroups[*tIt] != group) {
+			group = triangleGroups[*tIt];
+			const Uint32 material = mesh.groups[group].material;
+			if (materialMap[material] == UNMAPPED) {
+				materialMap[material]
+						= static_cast<Uint32> (tile.materials.size());
+				tile.materials.push_back(mesh.materials[material]);
+			}
+			tile.groups.push_back(ParkGroup());
+			tile.groups.back().material = materialMap[material];
+			tile.groups.back().firstIndex
+					= static_cast<Uint32> (tile.indices.size());
+		}
+		for (int k = 0; k < 3; ++k) {
+			const Uint32 vertex = mesh.indices[3 * *tIt + k];
+			if (vertexMap[vertex] == UNMAPPED) {
+				vertexMap[vertex] = static_cast<Uint32> (tile.vertices.size());
+				tile.vertices.push_back(mesh.vertices[vertex]);
+			}
+			tile.indices.push_back(vertexMap[vertex]);
+		}
+		tile.groups.back().numIndices += 3;
+	}
+	for (std::vector<Uint32>::const_iterator tIt = triangles.begin(); tIt
+			!= triangles.end(); ++tIt)
+		for (int k = 0; k < 3; ++k)
+			vertexMap[mesh.indices[3 * *tIt + k]] = UNMAPPED;
+	tile.computeBounds();
+} // end extractTile()
+
+/****************************************************
+ Constructors and Destructors of class TileSet:
+ ****************************************************/
+/*
+ * TileSet constructor - Maps and validates a tile file.
+ *
+ * parameter tilePath - const std::string&
+ *
+ * throw ResourceException if the file cannot be mapped or is invalid.
+ */
+TileSet::TileSet(const std::string& tilePath) :
+	file(new MappedFile(tilePath)) {
+	const TileHeader * header =
+			reinterpret_cast<const TileHeader*> (file->getData());
+	bool valid = file->getSize() >= sizeof(TileHeader)
+			&& std::memcmp(header->magic, MAGIC, sizeof(MAGIC)) == 0
+			&& header->version == VERSION && header->endianMarker
+			== ENDIAN_MARKER && header->tileOffset + Uint64(header->numTiles)
+			* sizeof(TileRecord) <= file->getSize();
+
+	const TileRecord * tiles = valid ? reinterpret_cast<const TileRecord*> (
+			file->getData() + header->tileOffset) : 0;
+	for (Uint32 t = 0; valid && t < header->numTiles; ++t)
+		valid = tiles[t].offset + tiles[t].compressedSize <= file->getSize();
+
+	if (!valid) {
+		delete file;
+		throw ResourceException("Invalid tile file " + tilePath, LOCATION);
+	}
+} // end TileSet()
+
+/*
+ * ~TileSet destructor
+ */
+TileSet::~TileSet(void) {
+	delete file;
+} // end ~TileSet()
+
+/*******************************
+ Methods of class TileSet:
+ *******************************/
+
+/*
+ * getNumTiles
+ *
+ * return - Uint32
+ */
+Uint32 TileSet::getNumTiles(void) const {
+	return reinterpret_cast<const TileHeader*> (file->getData())->numTiles;
+} // end getNumTiles()
+
+/*
+ * getTile - Reads a tile's entry in the index.
+ *
+ * parameter tile - Uint32, less than getNumTiles()
+ * parameter info - TileInfo&, filled in
+ */
+void TileSet::getTile(Uint32 tile, TileInfo& info) const {
+	const TileHeader * header =
+			reinterpret_cast<const TileHeader*> (file->getData());
+	const TileRecord& record = reinterpret_cast<const TileRecord*> (
+			file->getData() + header->tileOffset)[tile];
+	std::memcpy(info.boundsMin, record.boundsMin, sizeof(info.boundsMin));
+	std::memcpy(info.boundsMax, record.boundsMax, sizeof(info.boundsMax));
+	info.numTriangles = record.numTriangles;
+	info.compressedSize = record.compressedSize;
+	info.size = record.size;
+} // end getTile()
+
+/*
+ * loadTile - Decompresses a tile and fills the mesh with it. The mesh has
+ * groups and materials but no batches yet.
+ *
+ * parameter tile - Uint32, less than getNumTiles()
+ * parameter mesh - ParkMesh&, overwritten
+ *
+ * throw ResourceException if the tile is corrupt.
+ */
+void TileSet::loadTile(Uint32 tile, ParkMesh& mesh) const {
+	const TileHeader * header =
+			reinterpret_cast<const TileHeader*> (file->getData());
+	const TileRecord& record = reinterpret_cast<const TileRecord*> (
+			file->getData() + header->tileOffset)[tile];
+
+	std::vector<char> image(static_cast<size_t> (record.size));
+	uLongf size = static_cast<uLongf> (record.size);
+	if (image.empty() || ::uncompress(reinterpret_cast<Bytef*> (&image[0]),
+			&size, reinterpret_cast<const Bytef*> (file->getData()
+					+ record.offset), static_cast<uLong> (record.compressedSize))
+			!= Z_OK || size != record.size || !SceneCache::decode(&image[0],
+			size, 0, mesh)) {
+		std::ostringstream msg_stream;
+		msg_stream << "Corrupt tile " << tile << " in " << file->getPath();
+		throw ResourceException(msg_stream.str(), LOCATION);
+	}
+} // end loadTile()
+
+/*
+ * build - Cuts a mesh into quadtree tiles of at most maxTriangles triangles
+ * each, unless more share one spot, and writes them compressed. Tiles are
+ * written as they are made, so only one is held besides the mesh.
+ *
+ * parameter mesh - const ParkMesh&, with groups but no batches
+ * parameter maxTriangles - Uint32
+ * parameter tilePath - const std::string&
+ * return - Uint32, number of tiles
+ *
+ * throw ResourceException if the file cannot be written.
+ */
+Uint32 TileSet::build(const ParkMesh& mesh, Uint32 maxTriangles,
+		const std::string& tilePath) {
+	const Uint32 numTriangles = mesh.getNumTriangles();
+	std::vector<Uint32> triangleGroups(numTriangles, 0);
+	for (Uint32 g = 0; g < mesh.groups.size(); ++g) {
+		const ParkGroup& group = mesh.groups[g];
+		for (Uint32 t = group.firstIndex / 3; t < (group.firstIndex
+				+ group.numIndices) / 3; ++t)
+			triangleGroups[t] = g;
+	}
+
+	std::vector<float> centroids(2 * numTriangles);
+	std::vector<Uint32> triangles(numTriangles);
+	float planeMin[2] = { FLT_MAX, FLT_MAX };
+	float planeMax[2] = { -FLT_MAX, -FLT_MAX };
+	for (Uint32 t = 0; t < numTriangles; ++t) {
+		triangles[t] = t;
+		for (int i = 0; i < 2; ++i) {
+			float sum = 0.0f;
+			for (int k = 0; k < 3; ++k)
+				sum += mesh.vertices[mesh.indices[3 * t + k]].position[i];
+			centroids[2 * t + i] = sum / 3.0f;
+			if (centroids[2 * t + i] < planeMin[i])
+				planeMin[i] = centroids[2 * t + i];
+			if (centroids[2 * t + i] > planeMax[i])
+				planeMax[i] = centroids[2 * t + i];
+		}
+	}
+	std::vector<std::vector<Uint32> > leaves;
+	if (numTriangles != 0)
+		splitTiles(centroids, triangles, planeMin, planeMax, 0, maxTriangles,
+				leaves);
+
+	TileHeader header;
+	std::memset(&header, 0, sizeof(header));
+	std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+	header.version = VERSION;
+	header.endianMarker = ENDIAN_MARKER;
+	header.numTiles = static_cast<Uint32> (leaves.size());
+	header.tileOffset = sizeof(TileHeader);
+	for (int i = 0; i < 3; ++i) {
+		header.boundsMin[i] = FLT_MAX;
+		header.boundsMax[i] = -FLT_MAX;
+	}
+	std::vector<TileRecord> records(leaves.size());
+
+	std::ostringstream tempPath;
+	tempPath << tilePath << ".tmp." << getpid();
+	FILE * out = std::fopen(tempPath.str().c_str(), "wb");
+	if (out == 0) {
+		throw ResourceException("Cannot create tile file " + tempPath.str(),
+				LOCATION);
+	}
+
+	/* The index goes in front once the tiles' places are known: */
+	Uint64 offset = header.tileOffset + records.size() * sizeof(TileRecord);
+	bool written = std::fseek(out, offset, SEEK_SET) == 0;
+	std::vector<Uint32> vertexMap(mesh.vertices.size(), UNMAPPED);
+	ParkMesh tile;
+	std::vector<char> image;
+	std::vector<Bytef> compressed;
+	for (size_t l = 0; written && l < leaves.size(); ++l) {
+		extractTile(mesh, triangleGroups, leaves[l], vertexMap, tile);
+		SceneCache::encode(0, tile, image);
+		uLongf compressedSize = ::compressBound(image.size());
+		compressed.resize(compressedSize);
+		written = ::compress2(&compressed[0], &compressedSize,
+				reinterpret_cast<const Bytef*> (&image[0]), image.size(),
+				Z_BEST_COMPRESSION) == Z_OK && std::fwrite(&compressed[0], 1,
+				compressedSize, out) == compressedSize;
+
+		TileRecord& record = records[l];
+		std::memset(&record, 0, sizeof(record));
+		for (int i = 0; i < 3; ++i) {
+			record.boundsMin[i] = tile.boundsMin[i];
+			record.boundsMax[i] = tile.boundsMax[i];
+			if (tile.boundsMin[i] < header.boundsMin[i])
+				header.boundsMin[i] = tile.boundsMin[i];
+			if (tile.boundsMax[i] > header.boundsMax[i])
+				header.boundsMax[i] = tile.boundsMax[i];
+		}
+		record.numTriangles = tile.getNumTriangles();
+		record.offset = offset;
+		record.compressedSize = compressedSize;
+		record.size = image.size();
+		offset += compressedSize;
+	}
+	written = written && std::fseek(out, 0, SEEK_SET) == 0 && std::fwrite(
+			&header, sizeof(header), 1, out) == 1 && (records.empty()
+			|| std::fwrite(&records[0], sizeof(TileRecord), records.size(),
+					out) == records.size());
+	const bool closed = std::fclose(out) == 0;
+	if (!written || !closed || std::rename(tempPath.str().c_str(),
+			tilePath.c_str()) != 0) {
+		std::remove(tempPath.str().c_str());
+		throw ResourceException("Cannot write tile file " + tilePath,
+				LOCATION);
+	}
+
+	return header.numTiles;
+} // end build()
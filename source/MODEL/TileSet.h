@@ -0,0 +1,54 @@
+/*
+ * TileSet.h - Class for the spatially tiled, compressed scene file.
+ *
+ * Created: October 17, 2026
+ */
+
+#ifndef TILESET_H_
+#define TILESET_H_
+
+#include <string>
+
+/* Boost includes */
+#include <boost/noncopyable.hpp>
+
+#include <UTIL/Types.h>
+
+/* Begin Forward declarations: */
+class MappedFile;
+class ParkMesh;
+/* End Forward declarations: */
+
+/*
+ * TileInfo - Where a tile lies and what loading it costs, without loading it.
+ */
+struct TileInfo {
+	float boundsMin[3];
+	float boundsMax[3];
+	Uint32 numTriangles;
+	/* Bytes in the file, and of the decompressed scene image */
+	Uint64 compressedSize;
+	Uint64 size;
+};
+
+/*
+ * TileSet - A model cut into the leaves of a quadtree over the ground plane,
+ * each stored as a zlib-compressed SceneCache image so that it loads on its
+ * own. Only the small tile index is touched when the file is opened; a tile's
+ * bytes are paged in from the mapping when it is loaded. Loading is safe
+ * from several threads at once.
+ */
+class TileSet: boost::noncopyable {
+public:
+	TileSet(const std::string& tilePath);
+	~TileSet(void);
+	Uint32 getNumTiles(void) const;
+	void getTile(Uint32 tile, TileInfo& info) const;
+	void loadTile(Uint32 tile, ParkMesh& mesh) const;
+	static Uint32 build(const ParkMesh& mesh, Uint32 maxTriangles,
+			const std::string& tilePath);
+private:
+	MappedFile * file;
+};
+
+#endif /* TILESET_H_ */
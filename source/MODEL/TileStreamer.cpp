@@ -0,0 +1,312 @@
+/*
+ * TileStreamer.cpp - Methods for keeping the tiles near the viewer loaded on
+ * worker threads.
+ *
+ * Created: October 17, 2026
+ */
+
+/* System headers */
+#include <cmath>
+#include <cstring>
+#include <exception>
+#include <iostream>
+#include <sstream>
+
+/* Application headers */
+#include <MODEL/MaterialMerger.h>
+#include <MODEL/ParkMesh.h>
+#include <MODEL/SceneBuilder.h>
+#include <MODEL/TileStreamer.h>
+#include <SYNC/Guard.h>
+#include <UTIL/ResourceException.h>
+
+const float TileStreamer::EVICT_MARGIN = 0.25f;
+
+/****************************************************
+ Constructors and Destructors of class TileStreamer:
+ ****************************************************/
+/*
+ * TileStreamer constructor - Opens the tile file; nothing is loaded before
+ * start() and the first viewpoint.
+ *
+ * parameter modelDirectory - const std::string&, where the textures are
+ * parameter tileFile - const std::string&, relative to the model directory
+ * parameter memoryBudget - Uint64, bytes of geometry and images
+ * parameter loadDistance - float, in model units
+ *
+ * throw ResourceException if the tile file cannot be opened.
+ */
+TileStreamer::TileStreamer(const std::string& _modelDirectory,
+		const std::string& tileFile, Uint64 _memoryBudget, float _loadDistance) :
+	modelDirectory(_modelDirectory), tileSet(_modelDirectory + "/" + tileFile),
+			memoryBudget(_memoryBudget), loadDistance(_loadDistance),
+			hasViewpoint(false), residentBytes(0), cancelled(false) {
+	const Uint32 numTiles = tileSet.getNumTiles();
+	tiles.resize(numTiles);
+	tileBytes.resize(numTiles);
+	for (Uint32 t = 0; t < numTiles; ++t) {
+		tileSet.getTile(t, tiles[t]);
+		tileBytes[t] = tiles[t].size;
+	}
+	states.assign(numTiles, ABSENT);
+	eye[0] = eye[1] = eye[2] = 0.0f;
+} // end TileStreamer()
+
+/*
+ * ~TileStreamer - Lets the workers finish the tiles they are building and
+ * joins them.
+ */
+TileStreamer::~TileStreamer(void) {
+	{
+		Guard<MutexPosix> guard(lock);
+		cancelled = true;
+		workAvailable.broadcast();
+	}
+	for (size_t t = 0; t < threads.size(); ++t)
+		pthread_join(threads[t], NULL);
+} // end ~TileStreamer()
+
+/*******************************
+ Methods of class TileStreamer:
+ *******************************/
+
+/*
+ * start - Starts the worker threads.
+ *
+ * @throw ResourceException is thrown if a thread cannot be created.
+ */
+void TileStreamer::start(void) {
+	for (unsigned int t = 0; t < NUM_THREADS; ++t) {
+		pthread_t thread;
+		const int result = pthread_create(&thread, NULL,
+				&TileStreamer::workerMain, this);
+		if (result != 0) {
+			std::ostringstream msg_stream;
+			msg_stream << "Tile streamer thread creation failed: "
+					<< std::strerror(result);
+			throw ResourceException(msg_stream.str(), LOCATION);
+		}
+		threads.push_back(thread);
+	}
+} // end start()
+
+/*
+ * setViewpoint - Moves the viewpoint the tiles are loaded around, drops the
+ * tiles left far behind and wakes the workers. Cheap enough to call every
+ * frame.
+ *
+ * parameter newEye - const float[3], in model coordinates
+ */
+void TileStreamer::setViewpoint(const float newEye[3]) {
+	Guard<MutexPosix> guard(lock);
+	for (int i = 0; i < 3; ++i)
+		eye[i] = newEye[i];
+	hasViewpoint = true;
+	const float evictDistance = loadDistance * (1.0f + EVICT_MARGIN);
+	for (Uint32 t = 0; t < states.size(); ++t)
+		if (states[t] == RESIDENT && getDistance(t) > evictDistance)
+			evict(t);
+	workAvailable.broadcast();
+} // end setViewpoint()
+
+/*
+ * takeChanges - Hands the tiles built and the tiles evicted since the last
+ * call to the caller. A tile evicted before it was taken is in neither.
+ *
+ * parameter newLoaded - std::vector<StreamedTile>&, overwritten
+ * parameter newEvicted - std::vector<Uint32>&, overwritten
+ */
+void TileStreamer::takeChanges(std::vector<StreamedTile>& newLoaded,
+		std::vector<Uint32>& newEvicted) {
+	newLoaded.clear();
+	newEvicted.clear();
+	Guard<MutexPosix> guard(lock);
+	newLoaded.swap(loaded);
+	newEvicted.swap(evicted);
+} // end takeChanges()
+
+/*
+ * getNumTiles
+ *
+ * return - Uint32
+ */
+Uint32 TileStreamer::getNumTiles(void) const {
+	return static_cast<Uint32> (tiles.size());
+} // end getNumTiles()
+
+/*
+ * getResidentBytes - Memory of the tiles resident or being loaded.
+ *
+ * return - Uint64
+ */
+Uint64 TileStreamer::getResidentBytes(void) const {
+	Guard<MutexPosix> guard(lock);
+	return residentBytes;
+} // end getResidentBytes()
+
+/*
+ * workerMain - Thread entry point.
+ */
+void * TileStreamer::workerMain(void * streamer) {
+	static_cast<TileStreamer*> (streamer)->work();
+	return NULL;
+} // end workerMain()
+
+/*
+ * work - Builds the tile selectTile() picks until cancelled, waiting for a
+ * new viewpoint whenever nothing needs loading.
+ */
+void TileStreamer::work(void) {
+	Guard<MutexPosix> guard(lock);
+	while (!cancelled) {
+		Uint32 tile;
+		if (!selectTile(tile)) {
+			workAvailable.wait(lock);
+			continue;
+		}
+
+		lock.release();
+		osg::ref_ptr<osg::Node> node;
+		Uint64 bytes = 0;
+		try {
+			node = buildTile(tile, bytes);
+		} catch (std::exception& err) {
+			std::cerr << "Tile " << tile << " not loaded: " << err.what()
+					<< std::endl;
+		}
+		lock.acquire();
+
+		residentBytes -= tileBytes[tile];
+		if (!node.valid()) {
+			states[tile] = FAILED;
+			continue;
+		}
+		tileBytes[tile] = bytes;
+		residentBytes += bytes;
+		states[tile] = RESIDENT;
+		StreamedTile streamed;
+		streamed.tile = tile;
+		streamed.node = node;
+		loaded.push_back(streamed);
+	}
+} // end work()
+
+/*
+ * selectTile - Picks the nearest absent tile within the load distance and
+ * reserves its memory, evicting resident tiles further away while the
+ * budget is short. Called with the lock held.
+ *
+ * parameter tile - Uint32&, the tile to load, marked LOADING
+ * return - bool, false if no tile can be loaded now
+ */
+bool TileStreamer::selectTile(Uint32& tile) {
+	if (!hasViewpoint)
+		return false;
+	float nearest = loadDistance;
+	bool found = false;
+	for (Uint32 t = 0; t < states.size(); ++t) {
+		if (states[t] != ABSENT)
+			continue;
+		const float distance = getDistance(t);
+		if (distance <= nearest) {
+			nearest = distance;
+			tile = t;
+			found = true;
+		}
+	}
+	if (!found)
+		return false;
+
+	while (residentBytes + tileBytes[tile] > memoryBudget) {
+		float furthest = nearest;
+		Uint32 victim = 0;
+		bool hasVictim = false;
+		for (Uint32 t = 0; t < states.size(); ++t) {
+			if (states[t] != RESIDENT)
+				continue;
+			const float distance = getDistance(t);
+			if (distance > furthest) {
+				furthest = distance;
+				victim = t;
+				hasVictim = true;
+			}
+		}
+		/* Everything resident is nearer; the budget is spent well: */
+		if (!hasVictim)
+			return false;
+		evict(victim);
+	}
+	states[tile] = LOADING;
+	residentBytes += tileBytes[tile];
+	return true;
+} // end selectTile()
+
+/*
+ * evict - Drops a resident tile, reporting it unless its graph was never
+ * taken. Called with the lock held.
+ *
+ * parameter tile - Uint32, RESIDENT
+ */
+void TileStreamer::evict(Uint32 tile) {
+	states[tile] = ABSENT;
+	residentBytes -= tileBytes[tile];
+	for (std::vector<StreamedTile>::iterator lIt = loaded.begin(); lIt
+			!= loaded.end(); ++lIt) {
+		if (lIt->tile == tile) {
+			loaded.erase(lIt);
+			return;
+		}
+	}
+	evicted.push_back(tile);
+} // end evict()
+
+/*
+ * getDistance - Distance of the viewpoint from a tile's bounds; zero inside.
+ * Called with the lock held.
+ *
+ * parameter tile - Uint32
+ * return - float
+ */
+float TileStreamer::getDistance(Uint32 tile) const {
+	const TileInfo& info = tiles[tile];
+	float squared = 0.0f;
+	for (int i = 0; i < 3; ++i) {
+		float outside = 0.0f;
+		if (eye[i] < info.boundsMin[i])
+			outside = info.boundsMin[i] - eye[i];
+		else if (eye[i] > info.boundsMax[i])
+			outside = eye[i] - info.boundsMax[i];
+		squared += outside * outside;
+	}
+	return std::sqrt(squared);
+} // end getDistance()
+
+/*
+ * buildTile - Decompresses a tile, decodes its textures and builds its
+ * scene graph. Called without the lock.
+ *
+ * parameter tile - Uint32
+ * parameter bytes - Uint64&, receives the memory of its geometry and images
+ * return - osg::Node *
+ *
+ * throw ResourceException if the tile is corrupt.
+ */
+osg::Node * TileStreamer::buildTile(Uint32 tile, Uint64& bytes) const {
+	ParkMesh mesh;
+	tileSet.loadTile(tile, mesh);
+	SceneBuilder::ImageMap images;
+	SceneBuilder::loadImages(mesh, modelDirectory, 0, images);
+	MaterialMerger::merge(mesh);
+
+	bytes = mesh.getGeometryBytes();
+	for (SceneBuilder::ImageMap::const_iterator it = images.begin(); it
+			!= images.end(); ++it)
+		if (it->second.image.valid())
+			bytes += it->second.image->getTotalSizeInBytesIncludingMipmaps();
+
+	osg::Geode * geode = SceneBuilder::buildNode(mesh, images);
+	std::ostringstream name;
+	name << "Tile " << tile;
+	geode->setName(name.str());
+	return geode;
+} // end buildTile()
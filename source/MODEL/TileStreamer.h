@@ -0,0 +1,91 @@
+/*
+ * TileStreamer.h - Worker threads keeping the tiles near the viewer loaded.
+ *
+ * Created: October 17, 2026
+ */
+
+#ifndef TILESTREAMER_H_
+#define TILESTREAMER_H_
+
+#include <string>
+#include <vector>
+#include <pthread.h>
+
+/* Boost includes */
+#include <boost/noncopyable.hpp>
+
+/* osg includes */
+#include <osg/Node>
+
+#include <MODEL/TileSet.h>
+#include <SYNC/CondVarPosix.h>
+#include <SYNC/MutexPosix.h>
+
+/*
+ * StreamedTile - A tile's scene graph, built and ready to attach.
+ */
+struct StreamedTile {
+	Uint32 tile;
+	osg::ref_ptr<osg::Node> node;
+};
+
+/*
+ * TileStreamer - Keeps the tiles of a TileSet within the load distance of
+ * the viewpoint resident, nearest first, without exceeding a memory budget:
+ * when the budget is full, the resident tile furthest away makes room for a
+ * nearer one. Tiles beyond the load distance by more than EVICT_MARGIN are
+ * dropped right away. Workers decompress the tiles, decode their textures
+ * and build their scene graphs; the frame thread only hands in the
+ * viewpoint and takes the finished graphs, and no lock is held across I/O.
+ */
+class TileStreamer: boost::noncopyable {
+public:
+	static const unsigned int NUM_THREADS = 2;
+	/* Fraction of the load distance a tile may fall behind before eviction */
+	static const float EVICT_MARGIN;
+
+	TileStreamer(const std::string& modelDirectory,
+			const std::string& tileFile, Uint64 memoryBudget,
+			float loadDistance);
+	~TileStreamer(void);
+	void start(void);
+	void setViewpoint(const float eye[3]);
+	void takeChanges(std::vector<StreamedTile>& loaded,
+			std::vector<Uint32>& evicted);
+	Uint32 getNumTiles(void) const;
+	Uint64 getResidentBytes(void) const;
+
+private:
+	enum TileState {
+		ABSENT, LOADING, RESIDENT, FAILED
+	};
+
+	std::string modelDirectory;
+	TileSet tileSet;
+	std::vector<TileInfo> tiles;
+	Uint64 memoryBudget;
+	float loadDistance;
+	std::vector<pthread_t> threads;
+	mutable MutexPosix lock;
+	CondVarPosix workAvailable;
+	float eye[3];
+	bool hasViewpoint;
+	std::vector<TileState> states;
+	/* Memory of each tile, estimated from its scene image until loaded */
+	std::vector<Uint64> tileBytes;
+	/* Of the tiles resident or loading */
+	Uint64 residentBytes;
+	/* Changes not taken yet */
+	std::vector<StreamedTile> loaded;
+	std::vector<Uint32> evicted;
+	bool cancelled;
+
+	static void * workerMain(void * streamer);
+	void work(void);
+	bool selectTile(Uint32& tile);
+	void evict(Uint32 tile);
+	float getDistance(Uint32 tile) const;
+	osg::Node * buildTile(Uint32 tile, Uint64& bytes) const;
+};
+
+#endif /* TILESTREAMER_H_ */
@@ -0,0 +1,1202 @@
+/*
+ * TriangleBvh.cpp - Methods for building and querying the triangle BVH.
+ *
+ * Created: October 16, 2026
+ */
+
+/* System headers */
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <cstring>
+#include <vector>
+
+/* Application headers */
+#include <MODEL/ParkMesh.h>
+#include <MODEL/TriangleBvh.h>
+#include <SYNC/ThreadPool.h>
+
+/* Deepest tree; also the size of the traversal stacks */
+static const Uint32 MAX_DEPTH = 64;
+/* Below this level nodes are split at the median, which bounds the depth */
+static const Uint32 MEDIAN_LEVEL = 32;
+/* Cost of visiting a node relative to testing a triangle */
+static const float TRAVERSAL_COST = 1.0f;
+/* Smallest subtree handed to a worker thread */
+static const Uint32 MIN_JOB_TRIANGLES = 1024;
+/* Count of a skeleton node standing in for a subtree built by a job */
+static const Uint32 JOB_NODE = 0xffffffffu;
+
+/*
+ * Floats4, Ints4, Floats8, Ints8 - SIMD registers of the packet traversal,
+ * SSE and AVX. Without AVX an 8 ray packet is traced as two 4 ray packets;
+ * GCC's emulation of the wide registers is slower than that.
+ */
+typedef float Floats4 __attribute__((vector_size(16)));
+typedef Int32 Ints4 __attribute__((vector_size(16)));
+#ifdef __AVX__
+typedef float Floats8 __attribute__((vector_size(32)));
+typedef Int32 Ints8 __attribute__((vector_size(32)));
+#endif
+
+/*
+ * BuildBox - Bounding box grown during the build.
+ */
+struct BuildBox {
+	float boundsMin[3];
+	float boundsMax[3];
+
+	BuildBox(void) {
+		for (int i = 0; i < 3; ++i) {
+			boundsMin[i] = FLT_MAX;
+			boundsMax[i] = -FLT_MAX;
+		}
+	}
+	void grow(const float low[3], const float high[3]) {
+		for (int i = 0; i < 3; ++i) {
+			boundsMin[i] = std::min(boundsMin[i], low[i]);
+			boundsMax[i] = std::max(boundsMax[i], high[i]);
+		}
+	}
+	float getArea(void) const {
+		if (boundsMin[0] > boundsMax[0])
+			return 0.0f;
+		const float x = boundsMax[0] - boundsMin[0];
+		const float y = boundsMax[1] - boundsMin[1];
+		const float z = boundsMax[2] - boundsMin[2];
+		return x * y + y * z + z * x;
+	}
+};
+
+/*
+ * BuildPrimitive - A triangle as the build sees it.
+ */
+struct BuildPrimitive {
+	float boundsMin[3];
+	float boundsMax[3];
+	float centroid[3];
+	Uint32 triangle;
+};
+
+/*
+ * BuildJob - A subtree left for a worker thread.
+ */
+struct BuildJob {
+	Uint32 begin;
+	Uint32 end;
+	Uint32 level;
+};
+
+/*
+ * BinOf - Which of the NUM_BINS bins along an axis a primitive falls in.
+ */
+struct BinOf {
+	int axis;
+	float low;
+	float scale;
+
+	Uint32 operator()(const BuildPrimitive& primitive) const {
+		const float bin = (primitive.centroid[axis] - low) * scale;
+		return std::min(TriangleBvh::NUM_BINS - 1, static_cast<Uint32> (
+				std::max(0.0f, bin)));
+	}
+};
+
+/*
+ * BinIsLeft - Whether a primitive falls left of a split plane between bins.
+ */
+struct BinIsLeft {
+	BinOf binOf;
+	Uint32 split;
+
+	bool operator()(const BuildPrimitive& primitive) const {
+		return binOf(primitive) <= split;
+	}
+};
+
+/*
+ * CentroidIsLess - Orders primitives along an axis for median splits.
+ */
+struct CentroidIsLess {
+	int axis;
+
+	bool operator()(const BuildPrimitive& a, const BuildPrimitive& b) const {
+		return a.centroid[axis] < b.centroid[axis];
+	}
+};
+
+/*
+ * splitPrimitives - Partitions a node's primitives at the cheapest binned
+ * SAH split, or at the median deep in the tree.
+ *
+ * parameter primitives - std::vector<BuildPrimitive>&
+ * parameter begin, end - Uint32, the node's primitives
+ * parameter level - Uint32, of the node
+ * parameter box - const BuildBox&, bounds of the primitives
+ * parameter centroids - const BuildBox&, bounds of their centroids
+ * parameter mid - Uint32&, first primitive of the right child
+ * return - bool, false to make a leaf
+ */
+static bool splitPrimitives(std::vector<BuildPrimitive>& primitives,
+		Uint32 begin, Uint32 end, Uint32 level, const BuildBox& box,
+		const BuildBox& centroids, Uint32& mid) {
+	const Uint32 count = end - begin;
+	if (count <= 1)
+		return false;
+	int widest = 0;
+	for (int i = 1; i < 3; ++i)
+		if (centroids.boundsMax[i] - centroids.boundsMin[i]
+				> centroids.boundsMax[widest] - centroids.boundsMin[widest])
+			widest = i;
+	if (centroids.boundsMax[widest] <= centroids.boundsMin[widest]) {
+		/* All centroids coincide; no plane separates them */
+		if (count <= TriangleBvh::MAX_LEAF_TRIANGLES)
+			return false;
+		mid = begin + count / 2;
+		return true;
+	}
+
+	if (level < MEDIAN_LEVEL) {
+		float bestCost = FLT_MAX;
+		BinIsLeft best;
+		for (int axis = 0; axis < 3; ++axis) {
+			const float extent = centroids.boundsMax[axis]
+					- centroids.boundsMin[axis];
+			if (extent <= 0.0f)
+				continue;
+			BinOf binOf;
+			binOf.axis = axis;
+			binOf.low = centroids.boundsMin[axis];
+			binOf.scale = TriangleBvh::NUM_BINS / extent;
+			BuildBox bins[TriangleBvh::NUM_BINS];
+			Uint32 binCounts[TriangleBvh::NUM_BINS] = { 0 };
+			for (Uint32 p = begin; p < end; ++p) {
+				const Uint32 bin = binOf(primitives[p]);
+				bins[bin].grow(primitives[p].boundsMin, primitives[p].boundsMax);
+				++binCounts[bin];
+			}
+
+			/* Sweep from the right, then from the left: */
+			float rightCosts[TriangleBvh::NUM_BINS];
+			BuildBox right;
+			Uint32 rightCount = 0;
+			for (Uint32 b = TriangleBvh::NUM_BINS - 1; b > 0; --b) {
+				right.grow(bins[b].boundsMin, bins[b].boundsMax);
+				rightCount += binCounts[b];
+				rightCosts[b - 1] = right.getArea() * rightCount;
+			}
+			BuildBox left;
+			Uint32 leftCount = 0;
+			for (Uint32 b = 0; b + 1 < TriangleBvh::NUM_BINS; ++b) {
+				left.grow(bins[b].boundsMin, bins[b].boundsMax);
+				leftCount += binCounts[b];
+				if (leftCount == 0 || leftCount == count)
+					continue;
+				const float cost = left.getArea() * leftCount + rightCosts[b];
+				if (cost < bestCost) {
+					bestCost = cost;
+					best.binOf = binOf;
+					best.split = b;
+				}
+			}
+		}
+
+		const float area = box.getArea();
+		if (bestCost < FLT_MAX) {
+			const float leafCost = area * count;
+			const float splitCost = TRAVERSAL_COST * area + bestCost;
+			if (count <= TriangleBvh::MAX_LEAF_TRIANGLES && splitCost
+					>= leafCost)
+				return false;
+			mid = static_cast<Uint32> (std::partition(primitives.begin()
+					+ begin, primitives.begin() + end, best)
+					- primitives.begin());
+			if (mid > begin && mid < end)
+				return true;
+		}
+	}
+
+	if (count <= TriangleBvh::MAX_LEAF_TRIANGLES && level >= MEDIAN_LEVEL)
+		return false;
+	CentroidIsLess isLess;
+	isLess.axis = widest;
+	mid = begin + count / 2;
+	std::nth_element(primitives.begin() + begin, primitives.begin() + mid,
+			primitives.begin() + end, isLess);
+	return true;
+} // end splitPrimitives()
+
+/*
+ * buildSubtree - Builds the nodes over a range of primitives depth first.
+ * With jobs given, ranges of at most jobTriangles become JOB_NODE
+ * placeholders instead.
+ *
+ * parameter primitives - std::vector<BuildPrimitive>&, reordered in range
+ * parameter begin, end - Uint32
+ * parameter level - Uint32, of the subtree root
+ * parameter nodes - std::vector<BvhNode>&, appended to
+ * parameter jobs - std::vector<BuildJob>*, 0 to build everything
+ * parameter jobTriangles - Uint32
+ * parameter depth - Uint32&, raised to the deepest level reached
+ * return - Uint32, index of the subtree root
+ */
+static Uint32 buildSubtree(std::vector<BuildPrimitive>& primitives,
+		Uint32 begin, Uint32 end, Uint32 level, std::vector<BvhNode>& nodes,
+		std::vector<BuildJob> * jobs, Uint32 jobTriangles, Uint32& depth) {
+	const Uint32 index = static_cast<Uint32> (nodes.size());
+	nodes.push_back(BvhNode());
+	depth = std::max(depth, level + 1);
+
+	BuildBox box;
+	BuildBox centroids;
+	for (Uint32 p = begin; p < end; ++p) {
+		box.grow(primitives[p].boundsMin, primitives[p].boundsMax);
+		centroids.grow(primitives[p].centroid, primitives[p].centroid);
+	}
+	for (int i = 0; i < 3; ++i) {
+		nodes[index].boundsMin[i] = box.boundsMin[i];
+		nodes[index].boundsMax[i] = box.boundsMax[i];
+	}
+
+	if (jobs != 0 && end - begin <= jobTriangles) {
+		BuildJob job;
+		job.begin = begin;
+		job.end = end;
+		job.level = level;
+		nodes[index].offset = static_cast<Uint32> (jobs->size());
+		nodes[index].count = JOB_NODE;
+		jobs->push_back(job);
+		return index;
+	}
+
+	Uint32 mid;
+	if (!splitPrimitives(primitives, begin, end, level, box, centroids, mid)) {
+		nodes[index].offset = begin;
+		nodes[index].count = end - begin;
+		return index;
+	}
+	buildSubtree(primitives, begin, mid, level + 1, nodes, jobs, jobTriangles,
+			depth);
+	const Uint32 right = buildSubtree(primitives, mid, end, level + 1, nodes,
+			jobs, jobTriangles, depth);
+	nodes[index].offset = right;
+	nodes[index].count = 0;
+	return index;
+} // end buildSubtree()
+
+/*
+ * BuildJobs - parallelFor body building the subtrees below the skeleton.
+ */
+struct BuildJobs {
+	std::vector<BuildPrimitive>& primitives;
+	const std::vector<BuildJob>& jobs;
+	std::vector<std::vector<BvhNode> > subtrees;
+	std::vector<Uint32> depths;
+
+	BuildJobs(std::vector<BuildPrimitive>& _primitives, const std::vector<
+			BuildJob>& _jobs) :
+		primitives(_primitives), jobs(_jobs), subtrees(_jobs.size()), depths(
+				_jobs.size(), 0) {
+	}
+	void operator()(unsigned int j) {
+		buildSubtree(primitives, jobs[j].begin, jobs[j].end, jobs[j].level,
+				subtrees[j], 0, 0, depths[j]);
+	}
+};
+
+/*
+ * stitchNodes - Copies the skeleton depth first into the final node array,
+ * splicing in the job subtrees.
+ *
+ * parameter skeleton - const std::vector<BvhNode>&
+ * parameter node - Uint32, in the skeleton
+ * parameter subtrees - const std::vector<std::vector<BvhNode> >&
+ * parameter nodes - std::vector<BvhNode>&, appended to
+ */
+static void stitchNodes(const std::vector<BvhNode>& skeleton, Uint32 node,
+		const std::vector<std::vector<BvhNode> >& subtrees,
+		std::vector<BvhNode>& nodes) {
+	const BvhNode& source = skeleton[node];
+	if (source.count == JOB_NODE) {
+		const std::vector<BvhNode>& subtree = subtrees[source.offset];
+		const Uint32 base = static_cast<Uint32> (nodes.size());
+		nodes.insert(nodes.end(), subtree.begin(), subtree.end());
+		for (size_t n = base; n < nodes.size(); ++n)
+			if (nodes[n].count == 0)
+				nodes[n].offset += base;
+		return;
+	}
+	const Uint32 index = static_cast<Uint32> (nodes.size());
+	nodes.push_back(source);
+	if (source.count != 0)
+		return;
+	stitchNodes(skeleton, node + 1, subtrees, nodes);
+	nodes[index].offset = static_cast<Uint32> (nodes.size());
+	stitchNodes(skeleton, source.offset, subtrees, nodes);
+} // end stitchNodes()
+
+/*
+ * rayHitsBox - Slab test of a ray against a node.
+ *
+ * parameter node - const BvhNode&
+ * parameter origin - const float[3]
+ * parameter inverse - const float[3], reciprocal direction
+ * parameter maxDistance - float
+ * parameter near - float&, entry distance if hit
+ * return - bool
+ */
+static inline bool rayHitsBox(const BvhNode& node, const float origin[3],
+		const float inverse[3], float maxDistance, float& near) {
+	float far = maxDistance;
+	near = 0.0f;
+	for (int i = 0; i < 3; ++i) {
+		const float t0 = (node.boundsMin[i] - origin[i]) * inverse[i];
+		const float t1 = (node.boundsMax[i] - origin[i]) * inverse[i];
+		near = std::max(near, std::min(t0, t1));
+		far = std::min(far, std::max(t0, t1));
+	}
+	return near <= far;
+} // end rayHitsBox()
+
+/*
+ * intersectTriangle - Moeller-Trumbore test, both sides. Updates hit when
+ * closer.
+ *
+ * parameter v - const float*, nine floats
+ * parameter origin - const float[3]
+ * parameter direction - const float[3]
+ * parameter triangle - Uint32
+ * parameter hit - BvhHit&
+ */
+static inline void intersectTriangle(const float * v, const float origin[3],
+		const float direction[3], Uint32 triangle, BvhHit& hit) {
+	const float e1[3] = { v[3] - v[0], v[4] - v[1], v[5] - v[2] };
+	const float e2[3] = { v[6] - v[0], v[7] - v[1], v[8] - v[2] };
+	const float p[3] = { direction[1] * e2[2] - direction[2] * e2[1],
+			direction[2] * e2[0] - direction[0] * e2[2], direction[0] * e2[1]
+					- direction[1] * e2[0] };
+	const float det = e1[0] * p[0] + e1[1] * p[1] + e1[2] * p[2];
+	if (det == 0.0f)
+		return;
+	const float inverse = 1.0f / det;
+	const float t[3] = { origin[0] - v[0], origin[1] - v[1], origin[2] - v[2] };
+	const float u = (t[0] * p[0] + t[1] * p[1] + t[2] * p[2]) * inverse;
+	if (u < 0.0f || u > 1.0f)
+		return;
+	const float q[3] = { t[1] * e1[2] - t[2] * e1[1], t[2] * e1[0] - t[0]
+			* e1[2], t[0] * e1[1] - t[1] * e1[0] };
+	const float w = (direction[0] * q[0] + direction[1] * q[1] + direction[2]
+			* q[2]) * inverse;
+	if (w < 0.0f || u + w > 1.0f)
+		return;
+	const float distance = (e2[0] * q[0] + e2[1] * q[1] + e2[2] * q[2])
+			* inverse;
+	if (distance > 0.0f && distance < hit.distance) {
+		hit.triangle = triangle;
+		hit.distance = distance;
+		hit.u = u;
+		hit.v = w;
+	}
+} // end intersectTriangle()
+
+/*
+ * boxesOverlap - Whether two closed boxes touch.
+ */
+static inline bool boxesOverlap(const float aMin[3], const float aMax[3],
+		const float bMin[3], const float bMax[3]) {
+	return aMin[0] <= bMax[0] && aMax[0] >= bMin[0] && aMin[1] <= bMax[1]
+			&& aMax[1] >= bMin[1] && aMin[2] <= bMax[2] && aMax[2] >= bMin[2];
+} // end boxesOverlap()
+
+/*
+ * triangleOverlapsBox - Separating axis test of a triangle against a box:
+ * the box faces, the triangle plane and the nine edge cross products.
+ *
+ * parameter v - const float*, nine floats
+ * parameter center - const float[3], of the box
+ * parameter half - const float[3], half extents of the box
+ * return - bool
+ */
+static bool triangleOverlapsBox(const float * v, const float center[3],
+		const float half[3]) {
+	float p[3][3];
+	for (int k = 0; k < 3; ++k)
+		for (int i = 0; i < 3; ++i)
+			p[k][i] = v[3 * k + i] - center[i];
+	for (int i = 0; i < 3; ++i) {
+		const float low = std::min(p[0][i], std::min(p[1][i], p[2][i]));
+		const float high = std::max(p[0][i], std::max(p[1][i], p[2][i]));
+		if (low > half[i] || high < -half[i])
+			return false;
+	}
+
+	float edges[3][3];
+	for (int i = 0; i < 3; ++i) {
+		edges[0][i] = p[1][i] - p[0][i];
+		edges[1][i] = p[2][i] - p[1][i];
+		edges[2][i] = p[0][i] - p[2][i];
+	}
+	for (int e = 0; e < 3; ++e) {
+		for (int a = 0; a < 3; ++a) {
+			/* Axis = unit vector a x edge e */
+			float axis[3] = { 0.0f, 0.0f, 0.0f };
+			const int b = (a + 1) % 3;
+			const int c = (a + 2) % 3;
+			axis[b] = -edges[e][c];
+			axis[c] = edges[e][b];
+			float low = FLT_MAX;
+			float high = -FLT_MAX;
+			for (int k = 0; k < 3; ++k) {
+				const float d = axis[b] * p[k][b] + axis[c] * p[k][c];
+				low = std::min(low, d);
+				high = std::max(high, d);
+			}
+			const float radius = half[b] * std::fabs(axis[b]) + half[c]
+					* std::fabs(axis[c]);
+			if (low > radius || high < -radius)
+				return false;
+		}
+	}
+
+	const float normal[3] = { edges[0][1] * edges[1][2] - edges[0][2]
+			* edges[1][1], edges[0][2] * edges[1][0] - edges[0][0]
+			* edges[1][2], edges[0][0] * edges[1][1] - edges[0][1]
+			* edges[1][0] };
+	const float distance = normal[0] * p[0][0] + normal[1] * p[0][1]
+			+ normal[2] * p[0][2];
+	const float radius = half[0] * std::fabs(normal[0]) + half[1] * std::fabs(
+			normal[1]) + half[2] * std::fabs(normal[2]);
+	return std::fabs(distance) <= radius;
+} // end triangleOverlapsBox()
+
+/*
+ * closestPointOnTriangle - Point of a triangle closest to a point, by the
+ * Voronoi region the point falls in.
+ *
+ * parameter v - const float*, nine floats
+ * parameter point - const float[3]
+ * parameter closest - float[3], result
+ */
+static void closestPointOnTriangle(const float * v, const float point[3],
+		float closest[3]) {
+	const float * a = v;
+	const float * b = v + 3;
+	const float * c = v + 6;
+	float ab[3], ac[3], ap[3], bp[3], cp[3];
+	for (int i = 0; i < 3; ++i) {
+		ab[i] = b[i] - a[i];
+		ac[i] = c[i] - a[i];
+		ap[i] = point[i] - a[i];
+		bp[i] = point[i] - b[i];
+		cp[i] = point[i] - c[i];
+	}
+	const float d1 = ab[0] * ap[0] + ab[1] * ap[1] + ab[2] * ap[2];
+	const float d2 = ac[0] * ap[0] + ac[1] * ap[1] + ac[2] * ap[2];
+	if (d1 <= 0.0f && d2 <= 0.0f) {
+		std::copy(a, a + 3, closest);
+		return;
+	}
+	const float d3 = ab[0] * bp[0] + ab[1] * bp[1] + ab[2] * bp[2];
+	const float d4 = ac[0] * bp[0] + ac[1] * bp[1] + ac[2] * bp[2];
+	if (d3 >= 0.0f && d4 <= d3) {
+		std::copy(b, b + 3, closest);
+		return;
+	}
+	const float vc = d1 * d4 - d3 * d2;
+	if (vc <= 0.0f && d1 >= 0.0f && d3 <= 0.0f) {
+		const float s = d1 / (d1 - d3);
+		for (int i = 0; i < 3; ++i)
+			closest[i] = a[i] + s * ab[i];
+		return;
+	}
+	const float d5 = ab[0] * cp[0] + ab[1] * cp[1] + ab[2] * cp[2];
+	const float d6 = ac[0] * cp[0] + ac[1] * cp[1] + ac[2] * cp[2];
+	if (d6 >= 0.0f && d5 <= d6) {
+		std::copy(c, c + 3, closest);
+		return;
+	}
+	const float vb = d5 * d2 - d1 * d6;
+	if (vb <= 0.0f && d2 >= 0.0f && d6 <= 0.0f) {
+		const float s = d2 / (d2 - d6);
+		for (int i = 0; i < 3; ++i)
+			closest[i] = a[i] + s * ac[i];
+		return;
+	}
+	const float va = d3 * d6 - d5 * d4;
+	if (va <= 0.0f && d4 - d3 >= 0.0f && d5 - d6 >= 0.0f) {
+		const float s = (d4 - d3) / ((d4 - d3) + (d5 - d6));
+		for (int i = 0; i < 3; ++i)
+			closest[i] = b[i] + s * (c[i] - b[i]);
+		return;
+	}
+	const float denominator = 1.0f / (va + vb + vc);
+	const float s = vb * denominator;
+	const float t = vc * denominator;
+	for (int i = 0; i < 3; ++i)
+		closest[i] = a[i] + s * ab[i] + t * ac[i];
+} // end closestPointOnTriangle()
+
+/*
+ * boxDistance2 - Squared distance from a point to a node, 0 inside.
+ */
+static inline float boxDistance2(const BvhNode& node, const float point[3]) {
+	float distance2 = 0.0f;
+	for (int i = 0; i < 3; ++i) {
+		const float d = std::max(0.0f, std::max(node.boundsMin[i] - point[i],
+				point[i] - node.boundsMax[i]));
+		distance2 += d * d;
+	}
+	return distance2;
+} // end boxDistance2()
+
+/*
+ * blend - Copies the lanes of a where mask is set into result.
+ */
+template<class FLOATS, class INTS>
+static inline void blend(const INTS& mask, const FLOATS& a, FLOATS& result) {
+	result = (FLOATS) (((INTS) a & mask) | ((INTS) result & ~mask));
+} // end blend()
+
+/*
+ * anyLane - Whether any lane of a mask is set.
+ */
+template<class INTS, unsigned int WIDTH>
+static inline bool anyLane(const INTS& mask) {
+	Int32 any = 0;
+	for (unsigned int i = 0; i < WIDTH; ++i)
+		any |= mask[i];
+	return any != 0;
+} // end anyLane()
+
+/*
+ * packetHitsBox - Slab test of a packet against a node. Sets the lanes of
+ * mask whose ray enters the node before its current hit.
+ */
+template<class FLOATS, class INTS>
+static inline void packetHitsBox(const BvhNode& node, const FLOATS origin[3],
+		const FLOATS inverse[3], const FLOATS& maxDistance, FLOATS& near,
+		INTS& mask) {
+	FLOATS far = maxDistance;
+	near = maxDistance - maxDistance;
+	for (int i = 0; i < 3; ++i) {
+		const FLOATS t0 = (node.boundsMin[i] - origin[i]) * inverse[i];
+		const FLOATS t1 = (node.boundsMax[i] - origin[i]) * inverse[i];
+		const INTS less = t0 < t1;
+		FLOATS low = t1;
+		FLOATS high = t0;
+		blend(less, t0, low);
+		blend(less, t1, high);
+		blend(low > near, low, near);
+		blend(high < far, high, far);
+	}
+	mask = near <= far;
+} // end packetHitsBox()
+
+/*
+ * nearestLane - Smallest entry distance among the lanes of a mask.
+ */
+template<class FLOATS, class INTS, unsigned int WIDTH>
+static inline float nearestLane(const INTS& mask, const FLOATS& near) {
+	float nearest = FLT_MAX;
+	for (unsigned int i = 0; i < WIDTH; ++i)
+		if (mask[i] && near[i] < nearest)
+			nearest = near[i];
+	return nearest;
+} // end nearestLane()
+
+/*******************************
+ Methods of class TriangleBvh:
+ *******************************/
+
+/*
+ * TriangleBvh constructor
+ */
+TriangleBvh::TriangleBvh(void) :
+	depth(0) {
+} // end TriangleBvh()
+
+/*
+ * ~TriangleBvh
+ */
+TriangleBvh::~TriangleBvh(void) {
+} // end ~TriangleBvh()
+
+/*
+ * build - Builds the hierarchy over the triangles of the mesh's groups,
+ * which are the level 0 triangles whether or not the mesh is merged.
+ *
+ * parameter mesh - const ParkMesh&
+ * parameter pool - ThreadPool*, 0 to build on the calling thread
+ */
+void TriangleBvh::build(const ParkMesh& mesh, ThreadPool * pool) {
+	clear();
+	std::vector<BuildPrimitive> primitives;
+	for (size_t g = 0; g < mesh.groups.size(); ++g) {
+		const ParkGroup& group = mesh.groups[g];
+		for (Uint32 i = group.firstIndex; i + 2 < group.firstIndex
+				+ group.numIndices; i += 3) {
+			BuildPrimitive primitive;
+			BuildBox box;
+			for (int k = 0; k < 3; ++k) {
+				const float * position =
+						mesh.vertices[mesh.indices[i + k]].position;
+				box.grow(position, position);
+			}
+			for (int k = 0; k < 3; ++k) {
+				primitive.boundsMin[k] = box.boundsMin[k];
+				primitive.boundsMax[k] = box.boundsMax[k];
+				primitive.centroid[k] = 0.5f * (box.boundsMin[k]
+						+ box.boundsMax[k]);
+			}
+			primitive.triangle = i / 3;
+			primitives.push_back(primitive);
+		}
+	}
+	const Uint32 numPrimitives = static_cast<Uint32> (primitives.size());
+	if (numPrimitives == 0)
+		return;
+
+	const unsigned int numThreads = pool == 0 ? 1 : pool->getNumThreads();
+	const Uint32 jobTriangles = std::max(MIN_JOB_TRIANGLES, numPrimitives
+			/ (4 * numThreads));
+	if (numThreads < 2 || numPrimitives <= jobTriangles)
+		buildSubtree(primitives, 0, numPrimitives, 0, nodes, 0, 0, depth);
+	else {
+		/* Split the top serially, then build the subtrees in parallel: */
+		std::vector<BvhNode> skeleton;
+		std::vector<BuildJob> jobs;
+		buildSubtree(primitives, 0, numPrimitives, 0, skeleton, &jobs,
+				jobTriangles, depth);
+		BuildJobs buildJobs(primitives, jobs);
+		pool->parallelFor(static_cast<unsigned int> (jobs.size()), buildJobs);
+		for (size_t j = 0; j < jobs.size(); ++j)
+			depth = std::max(depth, buildJobs.depths[j]);
+		nodes.reserve(skeleton.size() + 2 * numPrimitives);
+		stitchNodes(skeleton, 0, buildJobs.subtrees, nodes);
+	}
+	std::vector<BvhNode>(nodes).swap(nodes);
+
+	vertices.resize(9 * size_t(numPrimitives));
+	triangleNumbers.resize(numPrimitives);
+	for (Uint32 s = 0; s < numPrimitives; ++s) {
+		const Uint32 triangle = primitives[s].triangle;
+		triangleNumbers[s] = triangle;
+		for (int k = 0; k < 3; ++k)
+			std::copy(mesh.vertices[mesh.indices[3 * triangle + k]].position,
+					mesh.vertices[mesh.indices[3 * triangle + k]].position + 3,
+					&vertices[9 * size_t(s) + 3 * k]);
+	}
+} // end build()
+
+/*
+ * clear
+ */
+void TriangleBvh::clear(void) {
+	std::vector<BvhNode>().swap(nodes);
+	std::vector<float>().swap(vertices);
+	std::vector<Uint32>().swap(triangleNumbers);
+	depth = 0;
+} // end clear()
+
+/*
+ * swap - Exchanges the hierarchy with another one without copying it.
+ *
+ * parameter other - TriangleBvh&
+ */
+void TriangleBvh::swap(TriangleBvh& other) {
+	nodes.swap(other.nodes);
+	vertices.swap(other.vertices);
+	triangleNumbers.swap(other.triangleNumbers);
+	std::swap(depth, other.depth);
+} // end swap()
+
+/*
+ * getNumNodes
+ *
+ * return - Uint32
+ */
+Uint32 TriangleBvh::getNumNodes(void) const {
+	return static_cast<Uint32> (nodes.size());
+} // end getNumNodes()
+
+/*
+ * getNumTriangles
+ *
+ * return - Uint32
+ */
+Uint32 TriangleBvh::getNumTriangles(void) const {
+	return static_cast<Uint32> (triangleNumbers.size());
+} // end getNumTriangles()
+
+/*
+ * getDepth - Number of levels.
+ *
+ * return - Uint32
+ */
+Uint32 TriangleBvh::getDepth(void) const {
+	return depth;
+} // end getDepth()
+
+/*
+ * getBytes - Memory held by the nodes and triangles.
+ *
+ * return - size_t
+ */
+size_t TriangleBvh::getBytes(void) const {
+	return nodes.size() * sizeof(BvhNode) + vertices.size() * sizeof(float)
+			+ triangleNumbers.size() * sizeof(Uint32);
+} // end getBytes()
+
+/*
+ * getNode
+ *
+ * parameter node - Uint32, 0 is the root
+ * return - const BvhNode&
+ */
+const BvhNode& TriangleBvh::getNode(Uint32 node) const {
+	return nodes[node];
+} // end getNode()
+
+/*
+ * getTriangle - Vertex positions of a triangle slot of a leaf.
+ *
+ * parameter slot - Uint32
+ * return - const float*, nine floats
+ */
+const float * TriangleBvh::getTriangle(Uint32 slot) const {
+	return &vertices[9 * size_t(slot)];
+} // end getTriangle()
+
+/*
+ * getTriangleNumber - Mesh triangle of a triangle slot of a leaf.
+ *
+ * parameter slot - Uint32
+ * return - Uint32
+ */
+Uint32 TriangleBvh::getTriangleNumber(Uint32 slot) const {
+	return triangleNumbers[slot];
+} // end getTriangleNumber()
+
+/*
+ * intersectRay - Closest triangle along a ray, either side facing.
+ *
+ * parameter origin - const float[3]
+ * parameter direction - const float[3], need not be normalized
+ * parameter maxDistance - float, in units of direction
+ * parameter hit - BvhHit&, triangle is NO_TRIANGLE if none
+ * return - bool, whether a triangle was hit
+ */
+bool TriangleBvh::intersectRay(const float origin[3],
+		const float direction[3], float maxDistance, BvhHit& hit) const {
+	hit.triangle = NO_TRIANGLE;
+	hit.distance = maxDistance;
+	hit.u = hit.v = 0.0f;
+	const float inverse[3] = { 1.0f / direction[0], 1.0f / direction[1], 1.0f
+			/ direction[2] };
+	float near;
+	if (nodes.empty() || !rayHitsBox(nodes[0], origin, inverse, hit.distance,
+			near))
+		return false;
+
+	Uint32 stack[MAX_DEPTH];
+	float stackNear[MAX_DEPTH];
+	Uint32 stackSize = 0;
+	Uint32 node = 0;
+	while (true) {
+		const BvhNode& current = nodes[node];
+		if (current.count == 0) {
+			float leftNear;
+			float rightNear;
+			const bool left = rayHitsBox(nodes[node + 1], origin, inverse,
+					hit.distance, leftNear);
+			const bool right = rayHitsBox(nodes[current.offset], origin,
+					inverse, hit.distance, rightNear);
+			if (left && right) {
+				const bool leftFirst = leftNear <= rightNear;
+				stack[stackSize] = leftFirst ? current.offset : node + 1;
+				stackNear[stackSize++] = leftFirst ? rightNear : leftNear;
+				node = leftFirst ? node + 1 : current.offset;
+				continue;
+			} else if (left || right) {
+				node = left ? node + 1 : current.offset;
+				continue;
+			}
+		} else {
+			for (Uint32 s = current.offset; s < current.offset + current.count;
+					++s)
+				intersectTriangle(&vertices[9 * size_t(s)], origin, direction,
+						triangleNumbers[s], hit);
+		}
+
+		/* Pop the next node the ray still reaches: */
+		while (stackSize > 0 && stackNear[stackSize - 1] > hit.distance)
+			--stackSize;
+		if (stackSize == 0)
+			break;
+		node = stack[--stackSize];
+	}
+	return hit.triangle != NO_TRIANGLE;
+} // end intersectRay()
+
+/*
+ * intersectSegment - First triangle crossed going from start to end.
+ *
+ * parameter start - const float[3]
+ * parameter end - const float[3]
+ * parameter hit - BvhHit&, distance as a fraction of the segment
+ * return - bool
+ */
+bool TriangleBvh::intersectSegment(const float start[3], const float end[3],
+		BvhHit& hit) const {
+	const float direction[3] = { end[0] - start[0], end[1] - start[1], end[2]
+			- start[2] };
+	return intersectRay(start, direction, 1.0f, hit);
+} // end intersectSegment()
+
+/*
+ * intersectPacket - Closest hits of four coherent rays.
+ *
+ * parameter packet - const RayPacket<4>&
+ * parameter hits - BvhHit[4]
+ */
+void TriangleBvh::intersectPacket(const RayPacket<4>& packet,
+		BvhHit hits[4]) const {
+	tracePacket<Floats4, Ints4, 4> (packet, hits);
+} // end intersectPacket()
+
+/*
+ * intersectPacket - Closest hits of eight coherent rays.
+ *
+ * parameter packet - const RayPacket<8>&
+ * parameter hits - BvhHit[8]
+ */
+void TriangleBvh::intersectPacket(const RayPacket<8>& packet,
+		BvhHit hits[8]) const {
+#ifdef __AVX__
+	tracePacket<Floats8, Ints8, 8> (packet, hits);
+#else
+	for (int half = 0; half < 2; ++half) {
+		RayPacket<4> quarter;
+		for (int i = 0; i < 3; ++i) {
+			std::copy(packet.origin[i] + 4 * half, packet.origin[i] + 4 * half
+					+ 4, quarter.origin[i]);
+			std::copy(packet.direction[i] + 4 * half, packet.direction[i] + 4
+					* half + 4, quarter.direction[i]);
+		}
+		std::copy(packet.maxDistance + 4 * half, packet.maxDistance + 4 * half
+				+ 4, quarter.maxDistance);
+		tracePacket<Floats4, Ints4, 4> (quarter, hits + 4 * half);
+	}
+#endif
+} // end intersectPacket()
+
+/*
+ * tracePacket - Walks the tree once for a packet: a node is entered while any
+ * lane's ray reaches it before that lane's closest hit, and every triangle
+ * in a leaf is tested against all lanes at once.
+ *
+ * parameter packet - const RayPacket<WIDTH>&
+ * parameter hits - BvhHit*, WIDTH of them
+ */
+template<class FLOATS, class INTS, unsigned int WIDTH>
+void TriangleBvh::tracePacket(const RayPacket<WIDTH>& packet,
+		BvhHit * hits) const {
+	FLOATS origin[3];
+	FLOATS direction[3];
+	FLOATS inverse[3];
+	FLOATS hitDistance;
+	std::memcpy(&hitDistance, packet.maxDistance, sizeof(FLOATS));
+	const FLOATS zero = hitDistance - hitDistance;
+	for (int i = 0; i < 3; ++i) {
+		std::memcpy(&origin[i], packet.origin[i], sizeof(FLOATS));
+		std::memcpy(&direction[i], packet.direction[i], sizeof(FLOATS));
+		inverse[i] = (zero + 1.0f) / direction[i];
+	}
+	FLOATS hitU = zero;
+	FLOATS hitV = zero;
+	const INTS none = (INTS) zero - 1;
+	INTS hitTriangle = none;
+
+	FLOATS near;
+	INTS mask = none;
+	if (!nodes.empty())
+		packetHitsBox(nodes[0], origin, inverse, hitDistance, near, mask);
+	if (!nodes.empty() && anyLane<INTS, WIDTH> (mask)) {
+		Uint32 stack[MAX_DEPTH];
+		Uint32 stackSize = 0;
+		Uint32 node = 0;
+		while (true) {
+			const BvhNode& current = nodes[node];
+			if (current.count == 0) {
+				FLOATS leftNear;
+				FLOATS rightNear;
+				INTS left;
+				INTS right;
+				packetHitsBox(nodes[node + 1], origin, inverse, hitDistance,
+						leftNear, left);
+				packetHitsBox(nodes[current.offset], origin, inverse,
+						hitDistance, rightNear, right);
+				const bool anyLeft = anyLane<INTS, WIDTH> (left);
+				const bool anyRight = anyLane<INTS, WIDTH> (right);
+				if (anyLeft && anyRight) {
+					const bool leftFirst = nearestLane<FLOATS, INTS, WIDTH> (left,
+							leftNear) <= nearestLane<FLOATS, INTS, WIDTH> (right,
+							rightNear);
+					stack[stackSize++] = leftFirst ? current.offset : node + 1;
+					node = leftFirst ? node + 1 : current.offset;
+					continue;
+				} else if (anyLeft || anyRight) {
+					node = anyLeft ? node + 1 : current.offset;
+					continue;
+				}
+			} else {
+				for (Uint32 s = current.offset; s < current.offset
+						+ current.count; ++s) {
+					const float * v = &vertices[9 * size_t(s)];
+					const float e1[3] = { v[3] - v[0], v[4] - v[1], v[5] - v[2] };
+					const float e2[3] = { v[6] - v[0], v[7] - v[1], v[8] - v[2] };
+					const FLOATS p[3] = { direction[1] * e2[2] - direction[2]
+							* e2[1], direction[2] * e2[0] - direction[0] * e2[2],
+							direction[0] * e2[1] - direction[1] * e2[0] };
+					const FLOATS det = e1[0] * p[0] + e1[1] * p[1] + e1[2] * p[2];
+					const FLOATS inverseDet = (zero + 1.0f) / det;
+					const FLOATS t[3] = { origin[0] - v[0], origin[1] - v[1],
+							origin[2] - v[2] };
+					const FLOATS u = (t[0] * p[0] + t[1] * p[1] + t[2] * p[2])
+							* inverseDet;
+					const FLOATS q[3] = { t[1] * e1[2] - t[2] * e1[1], t[2]
+							* e1[0] - t[0] * e1[2], t[0] * e1[1] - t[1] * e1[0] };
+					const FLOATS w = (direction[0] * q[0] + direction[1] * q[1]
+							+ direction[2] * q[2]) * inverseDet;
+					const FLOATS distance = (e2[0] * q[0] + e2[1] * q[1] + e2[2]
+							* q[2]) * inverseDet;
+					const INTS hit = (det != zero) & (u >= zero) & (w >= zero)
+							& (u + w <= zero + 1.0f) & (distance > zero)
+							& (distance < hitDistance);
+					blend(hit, distance, hitDistance);
+					blend(hit, u, hitU);
+					blend(hit, w, hitV);
+					const INTS triangle = (INTS) zero
+							+ static_cast<Int32> (triangleNumbers[s]);
+					hitTriangle = (hit & triangle) | (~hit & hitTriangle);
+				}
+			}
+
+			if (stackSize == 0)
+				break;
+			node = stack[--stackSize];
+		}
+	}
+
+	for (unsigned int i = 0; i < WIDTH; ++i) {
+		hits[i].triangle = static_cast<Uint32> (hitTriangle[i]);
+		hits[i].distance = hitDistance[i];
+		hits[i].u = hitU[i];
+		hits[i].v = hitV[i];
+	}
+} // end tracePacket()
+
+/*
+ * queryBox - Every triangle touching a box.
+ *
+ * parameter boxMin - const float[3]
+ * parameter boxMax - const float[3]
+ * parameter triangles - std::vector<Uint32>&, mesh triangles, overwritten
+ */
+void TriangleBvh::queryBox(const float boxMin[3], const float boxMax[3],
+		std::vector<Uint32>& triangles) const {
+	triangles.clear();
+	if (nodes.empty())
+		return;
+	float center[3];
+	float half[3];
+	for (int i = 0; i < 3; ++i) {
+		center[i] = 0.5f * (boxMin[i] + boxMax[i]);
+		half[i] = 0.5f * (boxMax[i] - boxMin[i]);
+	}
+	Uint32 stack[MAX_DEPTH];
+	Uint32 stackSize = 0;
+	stack[stackSize++] = 0;
+	while (stackSize > 0) {
+		const Uint32 node = stack[--stackSize];
+		const BvhNode& current = nodes[node];
+		if (!boxesOverlap(current.boundsMin, current.boundsMax, boxMin, boxMax))
+			continue;
+		if (current.count == 0) {
+			stack[stackSize++] = current.offset;
+			stack[stackSize++] = node + 1;
+			continue;
+		}
+		for (Uint32 s = current.offset; s < current.offset + current.count;
+				++s)
+			if (triangleOverlapsBox(&vertices[9 * size_t(s)], center, half))
+				triangles.push_back(triangleNumbers[s]);
+	}
+} // end queryBox()
+
+/*
+ * queryPlane - Every triangle with vertices strictly on both sides of a
+ * plane, i.e. those the plane cuts through.
+ *
+ * parameter plane - const float[4], a, b, c, d of ax + by + cz + d = 0
+ * parameter triangles - std::vector<Uint32>&, mesh triangles, overwritten
+ */
+void TriangleBvh::queryPlane(const float plane[4],
+		std::vector<Uint32>& triangles) const {
+	triangles.clear();
+	if (nodes.empty())
+		return;
+	Uint32 stack[MAX_DEPTH];
+	Uint32 stackSize = 0;
+	stack[stackSize++] = 0;
+	while (stackSize > 0) {
+		const Uint32 node = stack[--stackSize];
+		const BvhNode& current = nodes[node];
+		float distance = plane[3];
+		float radius = 0.0f;
+		for (int i = 0; i < 3; ++i) {
+			distance += plane[i] * 0.5f * (current.boundsMin[i]
+					+ current.boundsMax[i]);
+			radius += std::fabs(plane[i]) * 0.5f * (current.boundsMax[i]
+					- current.boundsMin[i]);
+		}
+		if (distance >= radius || distance <= -radius)
+			continue;
+		if (current.count == 0) {
+			stack[stackSize++] = current.offset;
+			stack[stackSize++] = node + 1;
+			continue;
+		}
+		for (Uint32 s = current.offset; s < current.offset + current.count;
+				++s) {
+			const float * v = &vertices[9 * size_t(s)];
+			float low = FLT_MAX;
+			float high = -FLT_MAX;
+			for (int k = 0; k < 3; ++k) {
+				const float d = plane[0] * v[3 * k] + plane[1] * v[3 * k + 1]
+						+ plane[2] * v[3 * k + 2] + plane[3];
+				low = std::min(low, d);
+				high = std::max(high, d);
+			}
+			if (low < 0.0f && high > 0.0f)
+				triangles.push_back(triangleNumbers[s]);
+		}
+	}
+} // end queryPlane()
+
+/*
+ * querySlab - Every triangle slot reaching into the slab within a distance
+ * of a plane, including those the plane cuts through.
+ *
+ * parameter plane - const float[4], normalized
+ * parameter halfWidth - float, 0 for the triangles touching the plane
+ * parameter slots - std::vector<Uint32>&, see getTriangle(), overwritten
+ */
+void TriangleBvh::querySlab(const float plane[4], float halfWidth,
+		std::vector<Uint32>& slots) const {
+	slots.clear();
+	if (nodes.empty())
+		return;
+	Uint32 stack[MAX_DEPTH];
+	Uint32 stackSize = 0;
+	stack[stackSize++] = 0;
+	while (stackSize > 0) {
+		const Uint32 node = stack[--stackSize];
+		const BvhNode& current = nodes[node];
+		float distance = plane[3];
+		float radius = halfWidth;
+		for (int i = 0; i < 3; ++i) {
+			distance += plane[i] * 0.5f * (current.boundsMin[i]
+					+ current.boundsMax[i]);
+			radius += std::fabs(plane[i]) * 0.5f * (current.boundsMax[i]
+					- current.boundsMin[i]);
+		}
+		if (distance > radius || distance < -radius)
+			continue;
+		if (current.count == 0) {
+			stack[stackSize++] = current.offset;
+			stack[stackSize++] = node + 1;
+			continue;
+		}
+		for (Uint32 s = current.offset; s < current.offset + current.count;
+				++s) {
+			const float * v = &vertices[9 * size_t(s)];
+			float low = FLT_MAX;
+			float high = -FLT_MAX;
+			for (int k = 0; k < 3; ++k) {
+				const float d = plane[0] * v[3 * k] + plane[1] * v[3 * k + 1]
+						+ plane[2] * v[3 * k + 2] + plane[3];
+				low = std::min(low, d);
+				high = std::max(high, d);
+			}
+			if (low <= halfWidth && high >= -halfWidth)
+				slots.push_back(s);
+		}
+	}
+} // end querySlab()
+
+/*
+ * findNearest - Closest point of the park to a point, branch and bound.
+ *
+ * parameter point - const float[3]
+ * parameter maxDistance - float, search radius
+ * parameter nearest - BvhNearest&, triangle is NO_TRIANGLE if none
+ * return - bool, whether a triangle lies within maxDistance
+ */
+bool TriangleBvh::findNearest(const float point[3], float maxDistance,
+		BvhNearest& nearest) const {
+	nearest.triangle = NO_TRIANGLE;
+	nearest.distance = maxDistance;
+	float best2 = maxDistance * maxDistance;
+	if (nodes.empty() || boxDistance2(nodes[0], point) > best2)
+		return false;
+
+	Uint32 stack[MAX_DEPTH];
+	float stackDistance2[MAX_DEPTH];
+	Uint32 stackSize = 0;
+	Uint32 node = 0;
+	while (true) {
+		const BvhNode& current = nodes[node];
+		if (current.count == 0) {
+			const float left2 = boxDistance2(nodes[node + 1], point);
+			const float right2 = boxDistance2(nodes[current.offset], point);
+			const bool left = left2 <= best2;
+			const bool right = right2 <= best2;
+			if (left && right) {
+				const bool leftFirst = left2 <= right2;
+				stack[stackSize] = leftFirst ? current.offset : node + 1;
+				stackDistance2[stackSize++] = leftFirst ? right2 : left2;
+				node = leftFirst ? node + 1 : current.offset;
+				continue;
+			} else if (left || right) {
+				node = left ? node + 1 : current.offset;
+				continue;
+			}
+		} else {
+			for (Uint32 s = current.offset; s < current.offset + current.count;
+					++s) {
+				float closest[3];
+				closestPointOnTriangle(&vertices[9 * size_t(s)], point, closest);
+				float distance2 = 0.0f;
+				for (int i = 0; i < 3; ++i)
+					distance2 += (closest[i] - point[i]) * (closest[i]
+							- point[i]);
+				if (distance2 <= best2) {
+					best2 = distance2;
+					nearest.triangle = triangleNumbers[s];
+					std::copy(closest, closest + 3, nearest.point);
+				}
+			}
+		}
+
+		while (stackSize > 0 && stackDistance2[stackSize - 1] > best2)
+			--stackSize;
+		if (stackSize == 0)
+			break;
+		node = stack[--stackSize];
+	}
+	if (nearest.triangle == NO_TRIANGLE)
+		return false;
+	nearest.distance = std::sqrt(best2);
+	return true;
+} // end findNearest()
@@ -0,0 +1,123 @@
+/*
+ * TriangleBvh.h - Bounding volume hierarchy over the park triangles for ray,
+ * segment, box, plane and nearest point queries.
+ *
+ * Created: October 16, 2026
+ */
+
+#ifndef TRIANGLEBVH_H_
+#define TRIANGLEBVH_H_
+
+#include <cstddef>
+#include <vector>
+
+/* Boost includes */
+#include <boost/noncopyable.hpp>
+
+#include <UTIL/Types.h>
+
+/* Begin Forward declarations: */
+class ParkMesh;
+class ThreadPool;
+/* End Forward declarations: */
+
+/*
+ * BvhNode - One 32-byte node, two to a cache line. The nodes are stored depth
+ * first: the left child of an inner node directly follows it.
+ */
+struct BvhNode {
+	float boundsMin[3];
+	/* Inner node: index of the right child. Leaf: first triangle slot. */
+	Uint32 offset;
+	float boundsMax[3];
+	/* Number of triangles, 0 for an inner node */
+	Uint32 count;
+};
+
+/*
+ * BvhHit - Closest intersection along a ray. The point is
+ * (1 - u - v) * v0 + u * v1 + v * v2 of the triangle.
+ */
+struct BvhHit {
+	/* Triangle number in the mesh (index / 3), NO_TRIANGLE if none */
+	Uint32 triangle;
+	float distance;
+	float u;
+	float v;
+};
+
+/*
+ * BvhNearest - Point of the park closest to a query point.
+ */
+struct BvhNearest {
+	Uint32 triangle;
+	float point[3];
+	float distance;
+};
+
+/*
+ * RayPacket - WIDTH rays traced together, one array per component so each
+ * loads into a SIMD register. Directions need not be normalized; distances
+ * are in units of the direction.
+ */
+template<unsigned int WIDTH>
+struct RayPacket {
+	float origin[3][WIDTH];
+	float direction[3][WIDTH];
+	float maxDistance[WIDTH];
+};
+
+/*
+ * TriangleBvh - Binned surface area heuristic BVH over the level 0 triangles
+ * of a ParkMesh. The triangle vertices are copied in leaf order, so queries
+ * do not touch the mesh and stay valid while the mesh is rebuilt. The top of
+ * the tree is split serially; the subtrees below are built on a ThreadPool.
+ * Packets of 4 or 8 coherent rays share one traversal, with the ray and
+ * triangle tests done across the packet in SIMD registers.
+ */
+class TriangleBvh: boost::noncopyable {
+public:
+	static const Uint32 NO_TRIANGLE = 0xffffffffu;
+	/* Leaves are split while larger than this, whatever the cost */
+	static const Uint32 MAX_LEAF_TRIANGLES = 8;
+	static const Uint32 NUM_BINS = 16;
+
+	TriangleBvh(void);
+	~TriangleBvh(void);
+	void build(const ParkMesh& mesh, ThreadPool * pool = 0);
+	void clear(void);
+	void swap(TriangleBvh& other);
+	Uint32 getNumNodes(void) const;
+	Uint32 getNumTriangles(void) const;
+	Uint32 getDepth(void) const;
+	size_t getBytes(void) const;
+	const BvhNode& getNode(Uint32 node) const;
+	const float * getTriangle(Uint32 slot) const;
+	Uint32 getTriangleNumber(Uint32 slot) const;
+
+	bool intersectRay(const float origin[3], const float direction[3],
+			float maxDistance, BvhHit& hit) const;
+	bool intersectSegment(const float start[3], const float end[3],
+			BvhHit& hit) const;
+	void intersectPacket(const RayPacket<4>& packet, BvhHit hits[4]) const;
+	void intersectPacket(const RayPacket<8>& packet, BvhHit hits[8]) const;
+	void queryBox(const float boxMin[3], const float boxMax[3], std::vector<
+			Uint32>& triangles) const;
+	void queryPlane(const float plane[4], std::vector<Uint32>& triangles) const;
+	void querySlab(const float plane[4], float halfWidth,
+			std::vector<Uint32>& slots) const;
+	bool findNearest(const float point[3], float maxDistance,
+			BvhNearest& nearest) const;
+
+private:
+	template<class FLOATS, class INTS, unsigned int WIDTH>
+	void tracePacket(const RayPacket<WIDTH>& packet, BvhHit * hits) const;
+
+	std::vector<BvhNode> nodes;
+	/* Nine floats per triangle slot */
+	std::vector<float> vertices;
+	std::vector<Uint32> triangleNumbers;
+	Uint32 depth;
+};
+
+#endif /* TRIANGLEBVH_H_ */
@@ -0,0 +1,294 @@
+/*
+ * VertexQuantizer.cpp - Methods for quantizing the park vertices and
+ * checking the result against the mesh.
+ *
+ * Created: October 16, 2026
+ */
+
+/* System headers */
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <map>
+#include <utility>
+#include <vector>
+
+/* Application headers */
+#include <MODEL/ParkMesh.h>
+#include <MODEL/VertexQuantizer.h>
+
+const float VertexQuantizer::NORMAL_BOUND_DEGREES = 1.0f;
+
+/* Largest stored magnitude of a 16-bit component */
+static const double RANGE16 = 32767.0;
+/* Rounding slack allowed on top of half a step */
+static const double SLACK = 1.0e-3;
+
+static const Uint32 NONE = 0xffffffffu;
+
+/*
+ * IndexRange - A range of the index array drawn by one batch.
+ */
+struct IndexRange {
+	Uint32 batch;
+	Uint32 firstIndex;
+	Uint32 numIndices;
+};
+
+/*
+ * getIndexRanges - Every index range a batch draws: the batch itself and the
+ * coarser levels of its clusters.
+ */
+static void getIndexRanges(const ParkMesh& mesh,
+		std::vector<IndexRange>& ranges) {
+	ranges.clear();
+	for (size_t b = 0; b < mesh.batches.size(); ++b) {
+		IndexRange range;
+		range.batch = static_cast<Uint32> (b);
+		range.firstIndex = mesh.batches[b].firstIndex;
+		range.numIndices = mesh.batches[b].numIndices;
+		ranges.push_back(range);
+	}
+	for (size_t c = 0; c < mesh.clusters.size(); ++c) {
+		const ParkCluster& cluster = mesh.clusters[c];
+		for (Uint32 l = 1; l < cluster.numLevels; ++l) {
+			IndexRange range;
+			range.batch = cluster.batch;
+			range.firstIndex = cluster.firstIndex[l];
+			range.numIndices = cluster.numIndices[l];
+			ranges.push_back(range);
+		}
+	}
+} // end getIndexRanges()
+
+/*
+ * getBatchOfVertices - The batch drawing each vertex, NONE if unused.
+ */
+static void getBatchOfVertices(const ParkMesh& mesh,
+		std::vector<Uint32>& batchOfVertex) {
+	std::vector<IndexRange> ranges;
+	getIndexRanges(mesh, ranges);
+	batchOfVertex.assign(mesh.vertices.size(), NONE);
+	for (size_t r = 0; r < ranges.size(); ++r) {
+		for (Uint32 i = ranges[r].firstIndex; i < ranges[r].firstIndex
+				+ ranges[r].numIndices; ++i)
+			batchOfVertex[mesh.indices[i]] = ranges[r].batch;
+	}
+} // end getBatchOfVertices()
+
+/*
+ * quantize16 - Nearest 16-bit step of a value around a center.
+ */
+static Int16 quantize16(double value, double center, double scale) {
+	const double steps = std::floor((value - center) / scale + 0.5);
+	return static_cast<Int16> (std::max(-RANGE16, std::min(RANGE16, steps)));
+} // end quantize16()
+
+/*****************************************
+ Methods of struct QuantizedMesh:
+ *****************************************/
+
+/*
+ * getVertexBytes - Size of the three vertex arrays.
+ *
+ * return - size_t
+ */
+size_t QuantizedMesh::getVertexBytes(void) const {
+	return positions.size() * sizeof(Int16) + normals.size() * sizeof(Int8)
+			+ texCoords.size() * sizeof(Int16);
+} // end getVertexBytes()
+
+/*******************************
+ Methods of class VertexQuantizer:
+ *******************************/
+
+/*
+ * separateBatches - Gives every batch its own copy of the vertices it shares
+ * with an earlier batch, so each vertex can use its batch's texture
+ * coordinate box. Triangles keep their order.
+ *
+ * parameter mesh - ParkMesh&, merged, with or without cluster levels
+ * return - Uint32, number of vertices copied
+ */
+Uint32 VertexQuantizer::separateBatches(ParkMesh& mesh) {
+	std::vector<IndexRange> ranges;
+	getIndexRanges(mesh, ranges);
+	std::vector<Uint32> owner(mesh.vertices.size(), NONE);
+	std::map<std::pair<Uint32, Uint32>, Uint32> copies;
+	Uint32 numCopies = 0;
+	for (size_t r = 0; r < ranges.size(); ++r) {
+		const Uint32 batch = ranges[r].batch;
+		for (Uint32 i = ranges[r].firstIndex; i < ranges[r].firstIndex
+				+ ranges[r].numIndices; ++i) {
+			Uint32& index = mesh.indices[i];
+			if (owner[index] == NONE)
+				owner[index] = batch;
+			if (owner[index] == batch)
+				continue;
+			const std::pair<Uint32, Uint32> key(index, batch);
+			std::map<std::pair<Uint32, Uint32>, Uint32>::iterator cIt =
+					copies.find(key);
+			if (cIt == copies.end()) {
+				cIt = copies.insert(std::make_pair(key, Uint32(
+						mesh.vertices.size()))).first;
+				mesh.vertices.push_back(mesh.vertices[index]);
+				owner.push_back(batch);
+				++numCopies;
+			}
+			index = cIt->second;
+		}
+	}
+	return numCopies;
+} // end separateBatches()
+
+/*
+ * quantize - Stores the vertices of a mesh in fixed point: positions in the
+ * cube around the mesh, texture coordinates in the box of their batch.
+ *
+ * parameter mesh - const ParkMesh&, after separateBatches()
+ * parameter quantized - QuantizedMesh&, overwritten
+ */
+void VertexQuantizer::quantize(const ParkMesh& mesh, QuantizedMesh& quantized) {
+	const size_t numVertices = mesh.vertices.size();
+	double center[3];
+	double extent = 0.0;
+	for (int i = 0; i < 3; ++i) {
+		float low = FLT_MAX;
+		float high = -FLT_MAX;
+		for (size_t v = 0; v < numVertices; ++v) {
+			low = std::min(low, mesh.vertices[v].position[i]);
+			high = std::max(high, mesh.vertices[v].position[i]);
+		}
+		center[i] = numVertices == 0 ? 0.0 : 0.5 * (double(low) + high);
+		extent = std::max(extent, numVertices == 0 ? 0.0 : double(high) - low);
+	}
+	const double positionScale = extent > 0.0 ? extent / (2.0 * RANGE16) : 1.0;
+	for (int i = 0; i < 3; ++i)
+		quantized.positionOffset[i] = static_cast<float> (center[i]);
+	quantized.positionScale = static_cast<float> (positionScale);
+
+	/* Texture coordinate box of each batch: */
+	std::vector<Uint32> batchOfVertex;
+	getBatchOfVertices(mesh, batchOfVertex);
+	const size_t numBatches = mesh.batches.size();
+	std::vector<float> low(2 * numBatches, FLT_MAX);
+	std::vector<float> high(2 * numBatches, -FLT_MAX);
+	for (size_t v = 0; v < numVertices; ++v) {
+		if (batchOfVertex[v] == NONE)
+			continue;
+		for (int i = 0; i < 2; ++i) {
+			float& l = low[2 * batchOfVertex[v] + i];
+			float& h = high[2 * batchOfVertex[v] + i];
+			l = std::min(l, mesh.vertices[v].texCoord[i]);
+			h = std::max(h, mesh.vertices[v].texCoord[i]);
+		}
+	}
+	quantized.texCoordOffsets.assign(2 * numBatches, 0.0f);
+	quantized.texCoordScales.assign(2 * numBatches, 1.0f);
+	for (size_t i = 0; i < 2 * numBatches; ++i) {
+		if (low[i] > high[i])
+			continue;
+		quantized.texCoordOffsets[i] = 0.5f * (low[i] + high[i]);
+		if (high[i] > low[i])
+			quantized.texCoordScales[i] = static_cast<float> ((double(high[i])
+					- low[i]) / (2.0 * RANGE16));
+	}
+
+	quantized.positions.resize(4 * numVertices);
+	quantized.normals.resize(3 * numVertices);
+	quantized.texCoords.resize(2 * numVertices);
+	for (size_t v = 0; v < numVertices; ++v) {
+		const ParkVertex& vertex = mesh.vertices[v];
+		for (int i = 0; i < 3; ++i)
+			quantized.positions[4 * v + i] = quantize16(vertex.position[i],
+					quantized.positionOffset[i], quantized.positionScale);
+		quantized.positions[4 * v + 3] = 1;
+
+		const double length = std::sqrt(double(vertex.normal[0])
+				* vertex.normal[0] + double(vertex.normal[1]) * vertex.normal[1]
+				+ double(vertex.normal[2]) * vertex.normal[2]);
+		for (int i = 0; i < 3; ++i) {
+			const double n = length > 0.0 ? vertex.normal[i] / length : 0.0;
+			quantized.normals[3 * v + i] = static_cast<Int8> (std::floor(n
+					* 127.0 + 0.5));
+		}
+
+		const Uint32 batch = batchOfVertex[v] == NONE ? 0 : batchOfVertex[v];
+		for (int i = 0; i < 2; ++i)
+			quantized.texCoords[2 * v + i] = numBatches == 0 ? 0 : quantize16(
+					vertex.texCoord[i], quantized.texCoordOffsets[2 * batch + i],
+					quantized.texCoordScales[2 * batch + i]);
+	}
+} // end quantize()
+
+/*
+ * check - Restores every vertex the way GL does and measures its distance
+ * from the mesh vertex.
+ *
+ * parameter mesh - const ParkMesh&
+ * parameter quantized - const QuantizedMesh&, made from mesh
+ * return - QuantizationError
+ */
+QuantizationError VertexQuantizer::check(const ParkMesh& mesh,
+		const QuantizedMesh& quantized) {
+	QuantizationError error;
+	error.position = 0.0f;
+	error.normalDegrees = 0.0f;
+	error.texCoord = 0.0f;
+	error.withinBounds = quantized.positions.size() == 4
+			* mesh.vertices.size();
+	if (!error.withinBounds)
+		return error;
+
+	std::vector<Uint32> batchOfVertex;
+	getBatchOfVertices(mesh, batchOfVertex);
+	const double cosBound = std::cos(NORMAL_BOUND_DEGREES * M_PI / 180.0);
+	for (size_t v = 0; v < mesh.vertices.size(); ++v) {
+		const ParkVertex& vertex = mesh.vertices[v];
+		for (int i = 0; i < 3; ++i) {
+			const double restored = quantized.positionOffset[i]
+					+ double(quantized.positionScale)
+							* quantized.positions[4 * v + i];
+			const double deviation = std::fabs(restored - vertex.position[i]);
+			error.position = std::max(error.position, float(deviation));
+			if (deviation > (0.5 + SLACK) * quantized.positionScale + FLT_EPSILON
+					* std::fabs(vertex.position[i]))
+				error.withinBounds = false;
+		}
+
+		double dot = 0.0;
+		double restoredLength = 0.0;
+		double length = 0.0;
+		for (int i = 0; i < 3; ++i) {
+			const double n = quantized.normals[3 * v + i] / 127.0;
+			dot += n * vertex.normal[i];
+			restoredLength += n * n;
+			length += double(vertex.normal[i]) * vertex.normal[i];
+		}
+		if (length > 0.0) {
+			const double cosAngle = restoredLength > 0.0 ? std::min(1.0, dot
+					/ std::sqrt(restoredLength * length)) : -1.0;
+			error.normalDegrees = std::max(error.normalDegrees, float(std::acos(
+					cosAngle) * 180.0 / M_PI));
+			if (cosAngle < cosBound)
+				error.withinBounds = false;
+		}
+
+		if (batchOfVertex[v] == NONE)
+			continue;
+		for (int i = 0; i < 2; ++i) {
+			const float offset = quantized.texCoordOffsets[2 * batchOfVertex[v]
+					+ i];
+			const float scale = quantized.texCoordScales[2 * batchOfVertex[v]
+					+ i];
+			const double restored = offset + double(scale)
+					* quantized.texCoords[2 * v + i];
+			const double deviation = std::fabs(restored - vertex.texCoord[i]);
+			error.texCoord = std::max(error.texCoord, float(deviation));
+			if (deviation > (0.5 + SLACK) * scale + FLT_EPSILON * std::fabs(
+					vertex.texCoord[i]))
+				error.withinBounds = false;
+		}
+	}
+	return error;
+} // end check()
@@ -0,0 +1,70 @@
+/*
+ * VertexQuantizer.h - Compact fixed-point copy of the park vertex array.
+ *
+ * Created: October 16, 2026
+ */
+
+#ifndef VERTEXQUANTIZER_H_
+#define VERTEXQUANTIZER_H_
+
+#include <cstddef>
+#include <vector>
+
+#include <UTIL/Types.h>
+
+/* Begin Forward declarations: */
+class ParkMesh;
+/* End Forward declarations: */
+
+/*
+ * QuantizedMesh - The park vertices as 16-bit positions, 8-bit normals and
+ * 16-bit texture coordinates, 15 bytes instead of 32. The stored values are
+ * what GL reads; the fixed-function vertex stage restores them:
+ *   position = positionOffset + positionScale * stored  (modelview)
+ *   normal   = stored / 127                              (GL_BYTE normals)
+ *   texCoord = texCoordOffset + texCoordScale * stored   (texture matrix)
+ * The texture coordinate box is per batch, so no vertex may be used by two
+ * batches, see VertexQuantizer::separateBatches().
+ */
+struct QuantizedMesh {
+	/* x, y, z and w = 1 */
+	std::vector<Int16> positions;
+	/* x, y, z */
+	std::vector<Int8> normals;
+	/* s, t */
+	std::vector<Int16> texCoords;
+	float positionOffset[3];
+	/* Same step on all axes, so normals only need rescaling */
+	float positionScale;
+	/* Two per batch */
+	std::vector<float> texCoordOffsets;
+	std::vector<float> texCoordScales;
+
+	size_t getVertexBytes(void) const;
+};
+
+/*
+ * QuantizationError - Largest deviation of the restored vertices from the
+ * mesh, and whether each stays within half a quantization step.
+ */
+struct QuantizationError {
+	/* Model units */
+	float position;
+	float normalDegrees;
+	/* Texture coordinate units */
+	float texCoord;
+	bool withinBounds;
+};
+
+class VertexQuantizer {
+public:
+	/* Largest angle a restored normal may deviate by */
+	static const float NORMAL_BOUND_DEGREES;
+
+	static Uint32 separateBatches(ParkMesh& mesh);
+	static void quantize(const ParkMesh& mesh, QuantizedMesh& quantized);
+	static QuantizationError check(const ParkMesh& mesh,
+			const QuantizedMesh& quantized);
+};
+
+#endif /* VERTEXQUANTIZER_H_ */
@@ -0,0 +1,96 @@
+/*
+ * ViewClusters.cpp - Methods for the clusters each context is drawing.
+ *
+ * Created: October 16, 2026
+ */
+
+#include <MODEL/ViewClusters.h>
+
+/*******************************
+ Methods of class ViewClusters:
+ *******************************/
+
+/*
+ * ViewClusters constructor - Every cluster starts visible in every context.
+ */
+ViewClusters::ViewClusters(void) :
+	numClipPlanes(0) {
+} // end ViewClusters()
+
+/*
+ * ~ViewClusters
+ */
+ViewClusters::~ViewClusters(void) {
+} // end ~ViewClusters()
+
+/*
+ * setVisible - Makes a context draw the listed clusters only.
+ *
+ * parameter contextID - unsigned int
+ * parameter visible - const std::vector<Uint32>&, cluster indices
+ * parameter numClusters - Uint32
+ */
+void ViewClusters::setVisible(unsigned int contextID,
+		const std::vector<Uint32>& visible, Uint32 numClusters) {
+	std::vector<bool>& flags = visibility[contextID];
+	flags.assign(numClusters, false);
+	for (size_t v = 0; v < visible.size(); ++v)
+		flags[visible[v]] = true;
+} // end setVisible()
+
+/*
+ * setAllVisible - Makes a context draw every cluster.
+ *
+ * parameter contextID - unsigned int
+ */
+void ViewClusters::setAllVisible(unsigned int contextID) {
+	visibility[contextID].clear();
+} // end setAllVisible()
+
+/*
+ * isVisible
+ *
+ * parameter contextID - unsigned int
+ * parameter cluster - Uint32
+ * return - bool
+ */
+bool ViewClusters::isVisible(unsigned int contextID, Uint32 cluster) const {
+	if (contextID >= visibility.size())
+		return true;
+	const std::vector<bool>& flags = visibility[contextID];
+	return flags.empty() || (cluster < flags.size() && flags[cluster]);
+} // end isVisible()
+
+/*
+ * setClipping - Tells the cluster draws how many clipping planes are enabled
+ * and which clusters they cut; the others are drawn with the planes
+ * disabled. Only called between frames.
+ *
+ * parameter numPlanes - Uint32, enabled from GL_CLIP_PLANE0 on
+ * parameter _straddling - const std::vector<bool>&, indexed by cluster
+ */
+void ViewClusters::setClipping(Uint32 numPlanes,
+		const std::vector<bool>& _straddling) {
+	numClipPlanes = numPlanes;
+	straddling = _straddling;
+} // end setClipping()
+
+/*
+ * getNumClipPlanes
+ *
+ * return - Uint32
+ */
+Uint32 ViewClusters::getNumClipPlanes(void) const {
+	return numClipPlanes;
+} // end getNumClipPlanes()
+
+/*
+ * isStraddling - Whether a cluster needs the clipping planes. Clusters
+ * unknown to the last setClipping() call do.
+ *
+ * parameter cluster - Uint32
+ * return - bool
+ */
+bool ViewClusters::isStraddling(Uint32 cluster) const {
+	return cluster >= straddling.size() || straddling[cluster];
+} // end isStraddling()
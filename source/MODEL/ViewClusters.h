@@ -0,0 +1,49 @@
+/*
+ * ViewClusters.h - The park clusters each graphics context is drawing.
+ *
+ * Created: October 16, 2026
+ */
+
+#ifndef VIEWCLUSTERS_H_
+#define VIEWCLUSTERS_H_
+
+#include <vector>
+
+/* osg includes */
+#include <osg/buffered_value>
+#include <osg/Referenced>
+
+#include <UTIL/Types.h>
+
+/*
+ * ViewClusters - Per graphics context, the clusters visible in the view the
+ * context is about to render. The draw thread of a context sets its own
+ * entry before its rendering traversal, and the cluster draws of the park
+ * read it back, so contexts never share an entry. Which clusters the
+ * enabled GL clipping planes cut is the same for every context and only
+ * changes between frames.
+ */
+class ViewClusters: public osg::Referenced {
+public:
+	ViewClusters(void);
+	void setVisible(unsigned int contextID, const std::vector<Uint32>& visible,
+			Uint32 numClusters);
+	void setAllVisible(unsigned int contextID);
+	bool isVisible(unsigned int contextID, Uint32 cluster) const;
+	void setClipping(Uint32 numPlanes, const std::vector<bool>& straddling);
+	Uint32 getNumClipPlanes(void) const;
+	bool isStraddling(Uint32 cluster) const;
+
+protected:
+	virtual ~ViewClusters(void);
+
+private:
+	/* Indexed by cluster; empty when every cluster is visible */
+	osg::buffered_object<std::vector<bool> > visibility;
+	/* GL_CLIP_PLANE0 on that are enabled while the park is drawn */
+	Uint32 numClipPlanes;
+	/* Indexed by cluster: whether a clipping plane cuts it */
+	std::vector<bool> straddling;
+};
+
+#endif /* VIEWCLUSTERS_H_ */
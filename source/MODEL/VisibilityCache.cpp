@@ -0,0 +1,154 @@
+/*
+ * VisibilityCache.cpp - Methods for culling the views expected in a frame
+ * once for all of them.
+ *
+ * Created: October 17, 2026
+ */
+
+/* System headers */
+#include <algorithm>
+#include <cmath>
+
+/* Application headers */
+#include <MODEL/VisibilityCache.h>
+#include <UTIL/System.h>
+
+/* Largest difference, relative to the largest element, of the clip matrices
+ * of one view */
+static const float SAME_VIEW_TOLERANCE = 1.0e-5f;
+
+/*
+ * now - Wall clock in seconds.
+ */
+static double now(void) {
+	TimeVal time;
+	SystemPosix::gettimeofday(&time);
+	return time.tv_sec + time.tv_usec * 1.0e-6;
+} // end now()
+
+/****************************************************
+ Constructors and Destructors of class VisibilityCache:
+ ****************************************************/
+/*
+ * VisibilityCache constructor - No view expected.
+ */
+VisibilityCache::VisibilityCache(void) :
+	numClusters(0) {
+} // end VisibilityCache()
+
+/*******************************
+ Methods of class VisibilityCache:
+ *******************************/
+
+/*
+ * clear - Forgets the expected views.
+ */
+void VisibilityCache::clear(void) {
+	numClusters = 0;
+	views.clear();
+	clusters.clear();
+	clusterViews.clear();
+	viewClusters.clear();
+} // end clear()
+
+/*
+ * update - Culls the views expected in the coming frame, all in one walk.
+ * Views beyond ClusterCuller::MAX_VIEWS are left out. Called while no
+ * context draws.
+ *
+ * parameter culler - const ClusterCuller&, of the displayed park
+ * parameter clipMatrices - const std::vector<float>&, sixteen per view,
+ * mesh to clip coordinates, column major
+ */
+void VisibilityCache::update(const ClusterCuller& culler,
+		const std::vector<float>& clipMatrices) {
+	clear();
+	const Uint32 numViews = std::min(static_cast<Uint32> (clipMatrices.size()
+			/ 16), ClusterCuller::MAX_VIEWS);
+	if (numViews == 0 || culler.getNumClusters() == 0)
+		return;
+	numClusters = culler.getNumClusters();
+	views.assign(clipMatrices.begin(), clipMatrices.begin() + 16 * numViews);
+	CullStatistics statistics;
+	culler.cull(&views[0], numViews, clusters, clusterViews, statistics);
+	viewClusters.resize(numViews);
+	for (size_t c = 0; c < clusters.size(); ++c)
+		for (Uint32 v = 0; v < numViews; ++v)
+			if (clusterViews[c] & (1u << v))
+				viewClusters[v].push_back(clusters[c]);
+} // end update()
+
+/*
+ * getNumViews - Views expected in the coming frame.
+ *
+ * return - Uint32
+ */
+Uint32 VisibilityCache::getNumViews(void) const {
+	return static_cast<Uint32> (viewClusters.size());
+} // end getNumViews()
+
+/*
+ * lookup - Lists the clusters any of the given views sees, if every one of
+ * them was expected.
+ *
+ * parameter clipMatrices - const float *, sixteen per view, mesh to clip
+ * coordinates, column major
+ * parameter numViews - Uint32
+ * parameter visible - std::vector<Uint32>&, cluster indices, overwritten
+ * only if found
+ * parameter statistics - CullStatistics&, set only if found
+ * return - bool, false if some view was not expected
+ */
+bool VisibilityCache::lookup(const float * clipMatrices, Uint32 numViews,
+		std::vector<Uint32>& visible, CullStatistics& statistics) const {
+	const double start = now();
+	Uint32 wanted = 0;
+	int first = -1;
+	for (Uint32 v = 0; v < numViews; ++v) {
+		const int view = findView(clipMatrices + 16 * v);
+		if (view < 0)
+			return false;
+		wanted |= 1u << view;
+		if (first < 0)
+			first = view;
+	}
+	if (first < 0)
+		return false;
+
+	if (wanted == 1u << first)
+		visible = viewClusters[first];
+	else {
+		visible.clear();
+		for (size_t c = 0; c < clusters.size(); ++c)
+			if (clusterViews[c] & wanted)
+				visible.push_back(clusters[c]);
+	}
+	statistics.numVisible = static_cast<Uint32> (visible.size());
+	statistics.numCulled = numClusters - statistics.numVisible;
+	statistics.numNodes = 0;
+	statistics.cullTime = now() - start;
+	return true;
+} // end lookup()
+
+/*
+ * findView - The expected view a clip matrix is that of, up to rounding.
+ *
+ * parameter clipMatrix - const float[16]
+ * return - int, -1 if none
+ */
+int VisibilityCache::findView(const float clipMatrix[16]) const {
+	float largest = 0.0f;
+	for (int i = 0; i < 16; ++i)
+		largest = std::max(largest, std::fabs(clipMatrix[i]));
+	const Uint32 numViews = getNumViews();
+	for (Uint32 v = 0; v < numViews; ++v) {
+		const float * view = &views[16 * v];
+		int i = 0;
+		while (i < 16 && std::fabs(view[i] - clipMatrix[i])
+				<= SAME_VIEW_TOLERANCE * largest)
+			++i;
+		if (i == 16)
+			return static_cast<int> (v);
+	}
+	return -1;
+} // end findView()
@@ -0,0 +1,47 @@
+/*
+ * VisibilityCache.h - The park clusters the views expected in a frame see,
+ * culled once for all of them.
+ *
+ * Created: October 17, 2026
+ */
+
+#ifndef VISIBILITYCACHE_H_
+#define VISIBILITYCACHE_H_
+
+#include <vector>
+
+#include <MODEL/ClusterCuller.h>
+#include <UTIL/Types.h>
+
+/*
+ * VisibilityCache - The frustum culling of the views a frame is expected to
+ * draw: every CAVE wall and eye, predicted from the views of the frame
+ * before. update() culls them all in one walk of the cluster hierarchy
+ * before the frame is drawn, and a view drawn as expected then only looks
+ * its clusters up. Views not expected are culled on their own. The cache
+ * only changes between frames, so every context may look up concurrently.
+ */
+class VisibilityCache {
+public:
+	VisibilityCache(void);
+	void clear(void);
+	void update(const ClusterCuller& culler,
+			const std::vector<float>& clipMatrices);
+	Uint32 getNumViews(void) const;
+	bool lookup(const float * clipMatrices, Uint32 numViews,
+			std::vector<Uint32>& visible, CullStatistics& statistics) const;
+
+private:
+	int findView(const float clipMatrix[16]) const;
+
+	Uint32 numClusters;
+	/* Sixteen floats per expected view, mesh to clip coordinates */
+	std::vector<float> views;
+	/* Clusters any expected view sees, and a bit per view seeing each */
+	std::vector<Uint32> clusters;
+	std::vector<Uint32> clusterViews;
+	/* Clusters each expected view sees */
+	std::vector<std::vector<Uint32> > viewClusters;
+};
+
+#endif /* VISIBILITYCACHE_H_ */
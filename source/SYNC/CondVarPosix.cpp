@@ -0,0 +1,21 @@
+#include <cstring>
+#include <sstream>
+
+#include <SYNC/CondVarPosix.h>
+#include <UTIL/ResourceException.h>
+
+/**
+ * CondVarPosix - Constructor for CondVarPosix class.
+ *
+ * @throw ResourceException is thrown if the condition variable cannot be
+ *        allocated.
+ */
+CondVarPosix::CondVarPosix(void) {
+	const int result = pthread_cond_init(&condVar, NULL);
+	if (result != 0) {
+		std::ostringstream msg_stream;
+		msg_stream << "Condition variable allocation failed: "
+				<< std::strerror(result);
+		throw ResourceException(msg_stream.str(), LOCATION);
+	}
+} // end CondVarPosix()
@@ -0,0 +1,68 @@
+/*
+ * CondVarPosix
+ */
+
+#ifndef COND_VAR_POSIX_H_
+#define COND_VAR_POSIX_H_
+
+#include <pthread.h>
+#include <assert.h>
+
+/* Boost includes */
+#include <boost/noncopyable.hpp>
+#include <boost/concept_check.hpp>
+
+#include <SYNC/MutexPosix.h>
+
+/*
+ * CondVarPosix - Condition variable wrapper for POSIX-compliant systems using
+ * pthreads condition variables. It is always used together with a MutexPosix
+ * that the caller holds while waiting or changing the predicate.
+ */
+class CondVarPosix: boost::noncopyable {
+public:
+	CondVarPosix(void);
+
+	/*
+	 * ~CondVarPosix - destructor for CondVarPosix class.
+	 *
+	 * @pre No thread is waiting on the condition variable.
+	 */
+	~CondVarPosix(void) {
+		const int result = pthread_cond_destroy(&condVar);
+		assert(result == 0);
+		boost::ignore_unused_variable_warning(result);
+	} // end ~CondVarPosix()
+
+	/*
+	 * wait - Atomically releases the mutex and blocks until signaled. The
+	 * mutex is held again on return. Spurious wake-ups are possible, so the
+	 * caller re-checks its predicate in a loop.
+	 *
+	 * @pre The calling thread holds \p mutex.
+	 */
+	void wait(MutexPosix& mutex) {
+		const int result = pthread_cond_wait(&condVar, &mutex.mutex);
+		assert(result == 0);
+		boost::ignore_unused_variable_warning(result);
+	} // end wait()
+
+	/*
+	 * signal - Wakes up one waiting thread.
+	 */
+	void signal(void) {
+		pthread_cond_signal(&condVar);
+	} // end signal()
+
+	/*
+	 * broadcast - Wakes up all waiting threads.
+	 */
+	void broadcast(void) {
+		pthread_cond_broadcast(&condVar);
+	} // end broadcast()
+
+private:
+	pthread_cond_t condVar;
+};
+
+#endif /* COND_VAR_POSIX_H_ */
@@ -0,0 +1,129 @@
+#include <cstring>
+#include <iostream>
+#include <sstream>
+#include <unistd.h>
+
+#include <SYNC/Guard.h>
+#include <SYNC/ThreadPool.h>
+#include <UTIL/ResourceException.h>
+
+/**
+ * ThreadPool - Constructor for ThreadPool class.
+ *
+ * @param numThreads The number of workers; 0 selects one per online processor.
+ *
+ * @throw ResourceException is thrown if no worker thread can be started.
+ */
+ThreadPool::ThreadPool(unsigned int numThreads) :
+	numActive(0), shutdown(false) {
+	if (numThreads == 0)
+		numThreads = getNumProcessors();
+
+	for (unsigned int i = 0; i < numThreads; ++i) {
+		pthread_t thread;
+		const int result = pthread_create(&thread, NULL,
+				&ThreadPool::workerMain, this);
+		if (result != 0) {
+			if (threads.empty()) {
+				std::ostringstream msg_stream;
+				msg_stream << "Thread creation failed: " << std::strerror(result);
+				throw ResourceException(msg_stream.str(), LOCATION);
+			}
+			/* Run with the workers we got: */
+			break;
+		}
+		threads.push_back(thread);
+	}
+} // end ThreadPool()
+
+/*
+ * ~ThreadPool - Destructor for ThreadPool class. Runs all queued tasks, then
+ * joins the workers.
+ */
+ThreadPool::~ThreadPool(void) {
+	{
+		Guard<MutexPosix> guard(lock);
+		shutdown = true;
+		taskAvailable.broadcast();
+	}
+	for (std::vector<pthread_t>::iterator tIt = threads.begin(); tIt
+			!= threads.end(); ++tIt)
+		pthread_join(*tIt, NULL);
+} // end ~ThreadPool()
+
+/*
+ * enqueue - Queues a task. The pool takes ownership.
+ *
+ * @param task The task to run.
+ */
+void ThreadPool::enqueue(Task * task) {
+	Guard<MutexPosix> guard(lock);
+	tasks.push_back(task);
+	taskAvailable.signal();
+} // end enqueue()
+
+/*
+ * wait - Blocks until the queue is empty and no task is running.
+ */
+void ThreadPool::wait(void) {
+	Guard<MutexPosix> guard(lock);
+	while (!tasks.empty() || numActive > 0)
+		allDone.wait(lock);
+} // end wait()
+
+/*
+ * getNumThreads
+ *
+ * @return The number of worker threads.
+ */
+unsigned int ThreadPool::getNumThreads(void) const {
+	return static_cast<unsigned int> (threads.size());
+} // end getNumThreads()
+
+/*
+ * getNumProcessors
+ *
+ * @return The number of online processors, at least 1.
+ */
+unsigned int ThreadPool::getNumProcessors(void) {
+	const long processors = sysconf(_SC_NPROCESSORS_ONLN);
+	return processors > 0 ? static_cast<unsigned int> (processors) : 1;
+} // end getNumProcessors()
+
+/*
+ * workerMain - pthread entry point.
+ */
+void * ThreadPool::workerMain(void * pool) {
+	static_cast<ThreadPool*> (pool)->work();
+	return NULL;
+} // end workerMain()
+
+/*
+ * work - Worker loop: takes tasks until shut down and the queue is drained.
+ */
+void ThreadPool::work(void) {
+	Guard<MutexPosix> guard(lock);
+	while (true) {
+		while (tasks.empty() && !shutdown)
+			taskAvailable.wait(lock);
+		if (tasks.empty())
+			break;
+
+		Task * task = tasks.front();
+		tasks.pop_front();
+		++numActive;
+
+		guard.release();
+		try {
+			task->run();
+		} catch (std::exception& err) {
+			std::cerr << "Worker task failed: " << err.what() << std::endl;
+		}
+		delete task;
+		guard.acquire();
+
+		--numActive;
+		if (tasks.empty() && numActive == 0)
+			allDone.broadcast();
+	}
+} // end work()
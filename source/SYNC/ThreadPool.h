@@ -0,0 +1,141 @@
+/*
+ * ThreadPool
+ */
+
+#ifndef THREAD_POOL_H_
+#define THREAD_POOL_H_
+
+#include <deque>
+#include <exception>
+#include <string>
+#include <vector>
+#include <pthread.h>
+
+/* Boost includes */
+#include <boost/noncopyable.hpp>
+
+#include <SYNC/CondVarPosix.h>
+#include <SYNC/Guard.h>
+#include <SYNC/MutexPosix.h>
+#include <UTIL/ResourceException.h>
+
+/*
+ * ThreadPool - Fixed set of worker threads draining a FIFO of tasks. Tasks
+ * are handed over by pointer and deleted by the pool after they ran.
+ */
+class ThreadPool: boost::noncopyable {
+public:
+	/*
+	 * Task - Unit of work; derive and implement run().
+	 */
+	class Task {
+	public:
+		virtual ~Task(void) {
+		}
+		virtual void run(void) = 0;
+	};
+
+	ThreadPool(unsigned int numThreads = 0);
+	~ThreadPool(void);
+	void enqueue(Task * task);
+	void wait(void);
+	unsigned int getNumThreads(void) const;
+	static unsigned int getNumProcessors(void);
+
+	template<class BODY>
+	void parallelFor(unsigned int count, BODY& body);
+
+private:
+	std::vector<pthread_t> threads;
+	std::deque<Task*> tasks;
+	MutexPosix lock;
+	CondVarPosix taskAvailable;
+	CondVarPosix allDone;
+	unsigned int numActive;
+	bool shutdown;
+
+	static void * workerMain(void * pool);
+	void work(void);
+};
+
+/*
+ * ForGroup - Tasks of one parallelFor call still to finish, and the first
+ * failure among them.
+ */
+struct ForGroup {
+	MutexPosix lock;
+	CondVarPosix allDone;
+	unsigned int numLeft;
+	bool failed;
+	std::string failure;
+
+	ForGroup(unsigned int _numLeft) :
+		numLeft(_numLeft), failed(false) {
+	}
+
+	/*
+	 * finish - Counts one task as done, failed with the given message if it
+	 * is not null.
+	 */
+	void finish(const char * taskFailure) {
+		Guard<MutexPosix> guard(lock);
+		if (taskFailure != 0 && !failed) {
+			failed = true;
+			failure = taskFailure;
+		}
+		if (--numLeft == 0)
+			allDone.broadcast();
+	}
+};
+
+/*
+ * ForTask - Runs one index of a parallelFor body.
+ */
+template<class BODY>
+class ForTask: public ThreadPool::Task {
+public:
+	ForTask(BODY& _body, unsigned int _index, ForGroup& _group) :
+		body(_body), index(_index), group(_group) {
+	}
+	virtual void run(void) {
+		/* A body that throws still finishes, or parallelFor waits forever: */
+		try {
+			body(index);
+		} catch (std::exception& err) {
+			group.finish(err.what());
+			return;
+		} catch (...) {
+			group.finish("Unknown exception");
+			return;
+		}
+		group.finish(0);
+	}
+private:
+	BODY& body;
+	unsigned int index;
+	ForGroup& group;
+};
+
+/*
+ * parallelFor - Calls body(i) for every i in [0, count) on the workers and
+ * returns once all calls finished. The body must be safe to call
+ * concurrently for distinct indices. Only this call's tasks are waited for,
+ * so several threads may share the pool, each with its own parallelFor.
+ * If any call throws, the others still run, and a ResourceException with
+ * the first failure is thrown once all finished.
+ */
+template<class BODY>
+void ThreadPool::parallelFor(unsigned int count, BODY& body) {
+	if (count == 0)
+		return;
+	ForGroup group(count);
+	for (unsigned int i = 0; i < count; ++i)
+		enqueue(new ForTask<BODY> (body, i, group));
+	Guard<MutexPosix> guard(group.lock);
+	while (group.numLeft != 0)
+		group.allDone.wait(group.lock);
+	if (group.failed)
+		throw ResourceException(group.failure, LOCATION);
+} // end parallelFor()
+
+#endif /* THREAD_POOL_H_ */
@@ -0,0 +1,83 @@
+#include <cerrno>
+#include <climits>
+#include <cstring>
+#include <sstream>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/inotify.h>
+
+#include <UTIL/DirectoryWatcher.h>
+#include <UTIL/ResourceException.h>
+
+/**
+ * DirectoryWatcher - Constructor for DirectoryWatcher class.
+ *
+ * @param directory The directory to watch; its subdirectories are not.
+ *
+ * @throw ResourceException is thrown if the directory cannot be watched.
+ */
+DirectoryWatcher::DirectoryWatcher(const std::string& _directory) :
+	directory(_directory), descriptor(-1) {
+	descriptor = ::inotify_init();
+	if (descriptor < 0) {
+		std::ostringstream msg_stream;
+		msg_stream << "Cannot watch " << directory << ": " << std::strerror(
+				errno);
+		throw ResourceException(msg_stream.str(), LOCATION);
+	}
+	if (::inotify_add_watch(descriptor, directory.c_str(), IN_CLOSE_WRITE
+			| IN_MOVED_TO) < 0) {
+		const int error = errno;
+		::close(descriptor);
+		std::ostringstream msg_stream;
+		msg_stream << "Cannot watch " << directory << ": " << std::strerror(
+				error);
+		throw ResourceException(msg_stream.str(), LOCATION);
+	}
+} // end DirectoryWatcher()
+
+/*
+ * ~DirectoryWatcher - Destructor for DirectoryWatcher class.
+ */
+DirectoryWatcher::~DirectoryWatcher(void) {
+	::close(descriptor);
+} // end ~DirectoryWatcher()
+
+/*
+ * wait - Waits until files change or the time is up.
+ *
+ * @param milliseconds The longest wait.
+ * @param names Receives the names of the changed files, relative to the
+ *        directory, in the order of the changes; a file may repeat.
+ *
+ * @return Whether any file changed.
+ */
+bool DirectoryWatcher::wait(Uint32 milliseconds,
+		std::vector<std::string>& names) {
+	struct pollfd request;
+	request.fd = descriptor;
+	request.events = POLLIN;
+	request.revents = 0;
+	if (::poll(&request, 1, static_cast<int> (milliseconds)) <= 0)
+		return false;
+
+	/* Aligned for the events, and large enough for one with a full name: */
+	union {
+		struct inotify_event event;
+		char bytes[64 * (sizeof(struct inotify_event) + NAME_MAX + 1)];
+	} buffer;
+	const ssize_t size = ::read(descriptor, buffer.bytes, sizeof(buffer));
+	if (size <= 0)
+		return false;
+
+	const size_t numNames = names.size();
+	for (ssize_t offset = 0; offset < size;) {
+		const struct inotify_event * event =
+				reinterpret_cast<const struct inotify_event*> (buffer.bytes
+						+ offset);
+		if (event->len > 0)
+			names.push_back(event->name);
+		offset += sizeof(struct inotify_event) + event->len;
+	}
+	return names.size() != numNames;
+} // end wait()
@@ -0,0 +1,32 @@
+#ifndef DIRECTORY_WATCHER_H_
+#define DIRECTORY_WATCHER_H_
+
+#include <string>
+#include <vector>
+
+/* Boost includes */
+#include <boost/noncopyable.hpp>
+
+#include <UTIL/Types.h>
+
+/*
+ * DirectoryWatcher - Reports the files of one directory that were written
+ * and closed, or moved in, as editors do when saving. Uses inotify, so
+ * nothing is polled while the directory is quiet.
+ */
+class DirectoryWatcher: boost::noncopyable {
+public:
+	DirectoryWatcher(const std::string& directory);
+	~DirectoryWatcher(void);
+	bool wait(Uint32 milliseconds, std::vector<std::string>& names);
+
+	const std::string& getDirectory(void) const {
+		return directory;
+	} // end getDirectory()
+
+private:
+	std::string directory;
+	int descriptor;
+};
+
+#endif /* DIRECTORY_WATCHER_H_ */
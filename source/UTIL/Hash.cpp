@@ -0,0 +1,51 @@
+#include <cstring>
+
+#include <UTIL/Hash.h>
+#include <UTIL/MappedFile.h>
+
+const Uint64 Hash::SEED;
+
+/*
+ * hashBytes - Folds a block of memory into the hash. The bulk is consumed a
+ * word at a time, FNV-1a style, so multi-megabyte textures hash at memory
+ * speed; the tail is consumed byte by byte.
+ *
+ * @param data The bytes to hash.
+ * @param size The number of bytes.
+ * @param seed The hash to continue from.
+ */
+Uint64 Hash::hashBytes(const void* data, size_t size, Uint64 seed) {
+	const Uint64 prime = 1099511628211ULL;
+	const Uint8* bytes = static_cast<const Uint8*> (data);
+	Uint64 hash = seed;
+	size_t i = 0;
+	for (; i + sizeof(Uint64) <= size; i += sizeof(Uint64)) {
+		Uint64 word;
+		std::memcpy(&word, bytes + i, sizeof(Uint64));
+		hash ^= word;
+		hash *= prime;
+		hash ^= hash >> 32;
+	}
+	for (; i < size; ++i) {
+		hash ^= bytes[i];
+		hash *= prime;
+	}
+	return hash;
+} // end hashBytes()
+
+/*
+ * hashString - Folds a string into the hash.
+ */
+Uint64 Hash::hashString(const std::string& value, Uint64 seed) {
+	return hashBytes(value.data(), value.size(), seed);
+} // end hashString()
+
+/*
+ * hashFile - Folds the contents of a file into the hash.
+ *
+ * @throw ResourceException is thrown if the file cannot be mapped.
+ */
+Uint64 Hash::hashFile(const std::string& path, Uint64 seed) {
+	MappedFile file(path);
+	return hashBytes(file.getData(), file.getSize(), seed);
+} // end hashFile()
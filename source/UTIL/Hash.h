@@ -0,0 +1,22 @@
+#ifndef HASH_H_
+#define HASH_H_
+
+#include <string>
+#include <cstddef>
+
+#include <UTIL/Types.h>
+
+/*
+ * Hash - 64-bit FNV-1a style content hashing for asset identification. Hashes can be
+ * chained by passing a previous result as the seed.
+ */
+class Hash {
+public:
+	static const Uint64 SEED = 14695981039346656037ULL;
+
+	static Uint64 hashBytes(const void* data, size_t size, Uint64 seed = SEED);
+	static Uint64 hashString(const std::string& value, Uint64 seed = SEED);
+	static Uint64 hashFile(const std::string& path, Uint64 seed = SEED);
+};
+
+#endif /* HASH_H_ */
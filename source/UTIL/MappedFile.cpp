@@ -0,0 +1,73 @@
+#include <cerrno>
+#include <cstring>
+#include <sstream>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include <UTIL/MappedFile.h>
+#include <UTIL/ResourceException.h>
+
+/**
+ * MappedFile - Constructor for MappedFile class.
+ *
+ * @post The whole file is mapped read-only. An empty file yields an empty
+ *       mapping with a null data pointer.
+ *
+ * @throw ResourceException is thrown if the file cannot be opened or mapped.
+ */
+MappedFile::MappedFile(const std::string& _path) :
+	path(_path), data(0), size(0) {
+	const int fd = ::open(path.c_str(), O_RDONLY);
+	if (fd < 0) {
+		std::ostringstream msg_stream;
+		msg_stream << "Cannot open " << path << ": " << std::strerror(errno);
+		throw ResourceException(msg_stream.str(), LOCATION);
+	}
+
+	struct stat fileStat;
+	if (::fstat(fd, &fileStat) != 0) {
+		const int error = errno;
+		::close(fd);
+		std::ostringstream msg_stream;
+		msg_stream << "Cannot stat " << path << ": " << std::strerror(error);
+		throw ResourceException(msg_stream.str(), LOCATION);
+	}
+
+	size = static_cast<size_t> (fileStat.st_size);
+	if (size > 0) {
+		void* mapping = ::mmap(0, size, PROT_READ, MAP_PRIVATE, fd, 0);
+		if (mapping == MAP_FAILED) {
+			const int error = errno;
+			::close(fd);
+			std::ostringstream msg_stream;
+			msg_stream << "Cannot map " << path << ": " << std::strerror(error);
+			throw ResourceException(msg_stream.str(), LOCATION);
+		}
+		data = static_cast<const char*> (mapping);
+	}
+
+	// The mapping keeps its own reference to the file.
+	::close(fd);
+} // end MappedFile()
+
+/*
+ * ~MappedFile - Destructor for MappedFile class.
+ */
+MappedFile::~MappedFile(void) {
+	if (data != 0) {
+		::munmap(const_cast<char*> (data), size);
+	}
+} // end ~MappedFile()
+
+/*
+ * exists - Tells if the given path names a readable regular file.
+ *
+ * @param path The file to test.
+ */
+bool MappedFile::exists(const std::string& path) {
+	struct stat fileStat;
+	return ::stat(path.c_str(), &fileStat) == 0 && S_ISREG(fileStat.st_mode)
+			&& ::access(path.c_str(), R_OK) == 0;
+} // end exists()
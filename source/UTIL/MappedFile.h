@@ -0,0 +1,45 @@
+#ifndef MAPPED_FILE_H_
+#define MAPPED_FILE_H_
+
+#include <string>
+#include <cstddef>
+
+/* Boost includes */
+#include <boost/noncopyable.hpp>
+
+/*
+ * MappedFile - Read-only memory mapping of a whole file. The mapping lives as
+ * long as the object does; pages are faulted in on first access.
+ */
+class MappedFile: boost::noncopyable {
+public:
+	MappedFile(const std::string& path);
+	~MappedFile(void);
+
+	/*
+	 * getData - Returns the first byte of the mapping.
+	 */
+	const char* getData(void) const {
+		return data;
+	} // end getData()
+
+	/*
+	 * getSize - Returns the size of the mapping in bytes.
+	 */
+	size_t getSize(void) const {
+		return size;
+	} // end getSize()
+
+	const std::string& getPath(void) const {
+		return path;
+	} // end getPath()
+
+	static bool exists(const std::string& path);
+
+private:
+	std::string path;
+	const char* data;
+	size_t size;
+};
+
+#endif /* MAPPED_FILE_H_ */
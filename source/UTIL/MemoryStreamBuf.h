@@ -0,0 +1,48 @@
+#ifndef MEMORY_STREAM_BUF_H_
+#define MEMORY_STREAM_BUF_H_
+
+#include <cstddef>
+#include <streambuf>
+
+/*
+ * MemoryStreamBuf - Read-only stream buffer over memory the caller owns, e.g.
+ * a MappedFile, so readers taking a std::istream work without copying.
+ */
+class MemoryStreamBuf: public std::streambuf {
+public:
+	MemoryStreamBuf(const char* data, size_t size) {
+		char* begin = const_cast<char*> (data);
+		setg(begin, begin, begin + size);
+	} // end MemoryStreamBuf()
+
+protected:
+	/*
+	 * seekoff - Supports tellg() and relative seekg() on the input side.
+	 */
+	virtual pos_type seekoff(off_type offset, std::ios_base::seekdir direction,
+			std::ios_base::openmode mode = std::ios_base::in) {
+		if ((mode & std::ios_base::out) != 0)
+			return pos_type(off_type(-1));
+		char* target = gptr();
+		if (direction == std::ios_base::beg)
+			target = eback() + offset;
+		else if (direction == std::ios_base::cur)
+			target = gptr() + offset;
+		else
+			target = egptr() + offset;
+		if (target < eback() || target > egptr())
+			return pos_type(off_type(-1));
+		setg(eback(), target, egptr());
+		return pos_type(target - eback());
+	} // end seekoff()
+
+	/*
+	 * seekpos - Supports absolute seekg() on the input side.
+	 */
+	virtual pos_type seekpos(pos_type position, std::ios_base::openmode mode =
+			std::ios_base::in) {
+		return seekoff(off_type(position), std::ios_base::beg, mode);
+	} // end seekpos()
+};
+
+#endif /* MEMORY_STREAM_BUF_H_ */
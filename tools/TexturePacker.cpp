@@ -0,0 +1,65 @@
+/*
+ * TexturePacker.cpp - Offline builder for the park texture pack.
+ *
+ * Usage: bin/TexturePacker [modelDirectory] [packFile]
+ *
+ * Packs every image of the model directory into one archive, storing
+ * byte-identical images once. The default output is
+ * models/fenwaypark.texpack, which Fenway maps at start-up if present.
+ *
+ * Created: October 16, 2026
+ */
+
+/* System headers */
+#include <algorithm>
+#include <dirent.h>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+/* Application headers */
+#include <MODEL/TexturePack.h>
+
+/*
+ * isImage - Tells if a file name has an image extension OSG can read.
+ */
+static bool isImage(const std::string& name) {
+	const std::string extension = TexturePack::getExtension(name);
+	return extension == "jpg" || extension == "jpeg" || extension == "bmp"
+			|| extension == "png" || extension == "tga" || extension == "rgb";
+} // end isImage()
+
+/*
+ * main - The packer main method.
+ */
+int main(int argc, char* argv[]) {
+	const std::string directory = argc > 1 ? argv[1] : "models";
+	const std::string packPath = argc > 2 ? argv[2] : directory
+			+ "/fenwaypark.texpack";
+
+	DIR * dir = opendir(directory.c_str());
+	if (dir == 0) {
+		std::cerr << "Cannot open " << directory << std::endl;
+		return 1;
+	}
+	std::vector<std::string> names;
+	for (struct dirent * entry = readdir(dir); entry != 0; entry = readdir(dir)) {
+		if (entry->d_name[0] != '.' && isImage(entry->d_name))
+			names.push_back(entry->d_name);
+	}
+	closedir(dir);
+	std::sort(names.begin(), names.end());
+
+	try {
+		const Uint64 savedBytes = TexturePack::build(directory, names, packPath);
+		TexturePack pack(packPath);
+		std::cout << packPath << ": " << pack.getNumNames() << " names, "
+				<< pack.getNumImages() << " distinct images, " << savedBytes
+				/ 1024 << " KB of duplicates dropped" << std::endl;
+	} catch (std::runtime_error& err) {
+		std::cerr << "Caught exception " << err.what() << std::endl;
+		return 1;
+	}
+	return 0;
+} // end main()
@@ -0,0 +1,181 @@
+/*
+ * TextureTranscoder.cpp - Offline BC1/BC3 transcoder for the park textures.
+ *
+ * Usage: bin/TextureTranscoder [modelDirectory]
+ *
+ * Converts every texture of the park model, and every atlas page built from
+ * them, to a power-of-two KTX file with a complete mipmap chain in the
+ * compressed/ subdirectory of the model directory. Files are named after the
+ * content they were made from, so Fenway uses them at start-up and ignores
+ * them once the images change. Run TexturePacker first if a pack is used.
+ *
+ * Created: October 16, 2026
+ */
+
+/* System headers */
+#include <algorithm>
+#include <cerrno>
+#include <iostream>
+#include <map>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <sys/stat.h>
+#include <vector>
+
+/* osg includes */
+#include <osg/Image>
+
+/* Application headers */
+#include <MODEL/ObjParser.h>
+#include <MODEL/ParkMesh.h>
+#include <MODEL/SceneBuilder.h>
+#include <MODEL/SceneCache.h>
+#include <MODEL/TextureAtlas.h>
+#include <MODEL/TextureCompressor.h>
+#include <MODEL/TexturePack.h>
+#include <SYNC/ThreadPool.h>
+#include <UTIL/MappedFile.h>
+
+static const std::string PARK_MODEL("fenwaypark.obj");
+static const std::string PARK_CACHE("fenwaypark.cache");
+static const std::string TEXTURE_PACK("fenwaypark.texpack");
+
+/*
+ * TextureBytes - Memory one texture takes in a render context, as RGBA with
+ * generated mipmaps and as transcoded.
+ */
+struct TextureBytes {
+	Uint64 raw;
+	Uint64 compressed;
+};
+
+/*
+ * createRgbaImage - Wraps tightly packed RGBA texels in an OSG image.
+ */
+static osg::Image * createRgbaImage(const std::vector<unsigned char>& rgba,
+		Uint32 width, Uint32 height) {
+	osg::Image * image = new osg::Image();
+	image->allocateImage(width, height, 1, GL_RGBA, GL_UNSIGNED_BYTE);
+	std::copy(rgba.begin(), rgba.end(), image->data());
+	return image;
+} // end createRgbaImage()
+
+/*
+ * main - The transcoder main method.
+ */
+int main(int argc, char* argv[]) {
+	const std::string directory = argc > 1 ? argv[1] : "models";
+	const std::string outputDirectory = TextureCompressor::getDirectory(
+			directory);
+	if (mkdir(outputDirectory.c_str(), 0755) != 0 && errno != EEXIST) {
+		std::cerr << "Cannot create " << outputDirectory << std::endl;
+		return 1;
+	}
+
+	try {
+		ThreadPool pool;
+		ParkMesh mesh;
+		SceneCache sceneCache(directory + "/" + PARK_CACHE);
+		if (!sceneCache.load(SceneCache::hashAssets(directory, PARK_MODEL),
+				mesh))
+			ObjParser::parse(directory, PARK_MODEL, mesh, pool);
+
+		TexturePack * texturePack = 0;
+		if (MappedFile::exists(directory + "/" + TEXTURE_PACK))
+			texturePack = new TexturePack(directory + "/" + TEXTURE_PACK);
+		SceneBuilder::ImageMap images;
+		SceneBuilder::loadImages(mesh, directory, texturePack, images, false,
+				false, &pool);
+		delete texturePack;
+
+		/* Transcode each distinct image once, and hand the atlas the same
+		 * power-of-two sizes the loader will see in the KTX files: */
+		std::map<Uint64, TextureBytes> bytes;
+		std::map<const osg::Image*, osg::ref_ptr<osg::Image> > resized;
+		std::vector<unsigned char> rgba;
+		std::vector<unsigned char> level;
+		for (SceneBuilder::ImageMap::iterator it = images.begin(); it
+				!= images.end(); ++it) {
+			SceneBuilder::SceneImage& entry = it->second;
+			if (!entry.image.valid())
+				continue;
+			osg::ref_ptr<osg::Image>& replacement = resized[entry.image.get()];
+			if (!replacement.valid()) {
+				replacement = entry.image;
+				if (!SceneBuilder::readRgba(*entry.image, rgba)) {
+					std::cerr << "Skipping " << it->first
+							<< ": unsupported pixel format" << std::endl;
+					continue;
+				}
+				const Uint32 width = entry.image->s();
+				const Uint32 height = entry.image->t();
+				const Uint32 newWidth = TextureCompressor::getPowerOfTwo(width);
+				const Uint32 newHeight =
+						TextureCompressor::getPowerOfTwo(height);
+				TextureCompressor::resize(&rgba[0], width, height, newWidth,
+						newHeight, level);
+
+				CompressedImage compressed;
+				TextureCompressor::compress(&level[0], newWidth, newHeight,
+						compressed);
+				TextureCompressor::save(TextureCompressor::getPath(directory,
+						entry.contentHash), compressed);
+				bytes[entry.contentHash].raw
+						= entry.image->getTotalSizeInBytes() * 4 / 3;
+				bytes[entry.contentHash].compressed = compressed.data.size();
+				replacement = createRgbaImage(level, newWidth, newHeight);
+			}
+			entry.image = replacement;
+		}
+
+		const Uint32 numPages = SceneBuilder::buildAtlases(mesh, images,
+				directory, 0, 0, &pool);
+		for (Uint32 p = 0; p < numPages; ++p) {
+			const SceneBuilder::SceneImage& page =
+					images[TextureAtlas::getPageName(p)];
+			TextureBytes& pageBytes = bytes[page.contentHash];
+			pageBytes.raw = Uint64(page.image->s()) * page.image->t() * 4 * 4
+					/ 3;
+			if (page.image->isCompressed()) {
+				pageBytes.compressed
+						= page.image->getTotalSizeInBytesIncludingMipmaps();
+				continue;
+			}
+			SceneBuilder::readRgba(*page.image, rgba);
+			CompressedImage compressed;
+			TextureCompressor::compress(&rgba[0], page.image->s(),
+					page.image->t(), compressed);
+			TextureCompressor::save(TextureCompressor::getPath(directory,
+					page.contentHash), compressed);
+			pageBytes.compressed = compressed.data.size();
+		}
+
+		/* What a render context holds: the textures the groups still use */
+		std::set<Uint64> bound;
+		Uint64 rawBytes = 0;
+		Uint64 compressedBytes = 0;
+		for (size_t g = 0; g < mesh.groups.size(); ++g) {
+			const std::string& texture =
+					mesh.materials[mesh.groups[g].material].texture;
+			if (texture.empty() || !images[texture].image.valid())
+				continue;
+			const Uint64 contentHash = images[texture].contentHash;
+			if (bound.insert(contentHash).second && bytes.count(contentHash)
+					!= 0) {
+				rawBytes += bytes[contentHash].raw;
+				compressedBytes += bytes[contentHash].compressed;
+			}
+		}
+		std::cout << outputDirectory << ": " << resized.size()
+				<< " images and " << numPages << " atlas pages transcoded"
+				<< std::endl;
+		std::cout << "Texture memory per context: " << rawBytes / 1024
+				<< " KB uncompressed with mipmaps, " << compressedBytes / 1024
+				<< " KB transcoded" << std::endl;
+	} catch (std::runtime_error& err) {
+		std::cerr << "Caught exception " << err.what() << std::endl;
+		return 1;
+	}
+	return 0;
+} // end main()
@@ -0,0 +1,73 @@
+/*
+ * TileBuilder.cpp - Offline builder for streamed model tiles.
+ *
+ * Usage: bin/TileBuilder [modelDirectory] [objFile] [tileFile] [maxTriangles]
+ *
+ * Cuts an OBJ model into quadtree tiles over the ground plane and writes
+ * them, each compressed on its own, to one tile file. The default input is
+ * models/neighborhood.obj and the default output models/neighborhood.tiles,
+ * which Fenway streams around the viewer if present. Textures stay in the
+ * model directory and are read when a tile is loaded.
+ *
+ * Created: October 17, 2026
+ */
+
+/* System headers */
+#include <cstdlib>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+
+/* Application headers */
+#include <MODEL/ObjParser.h>
+#include <MODEL/ParkMesh.h>
+#include <MODEL/TileSet.h>
+#include <SYNC/ThreadPool.h>
+
+/* Triangles per tile unless given; about a megabyte of scene image */
+static const Uint32 DEFAULT_MAX_TRIANGLES = 20000;
+
+/*
+ * main - The tile builder main method.
+ */
+int main(int argc, char* argv[]) {
+	const std::string directory = argc > 1 ? argv[1] : "models";
+	const std::string objFile = argc > 2 ? argv[2] : "neighborhood.obj";
+	std::string tileFile = argc > 3 ? argv[3] : "";
+	if (tileFile.empty()) {
+		const std::string::size_type dot = objFile.find_last_of('.');
+		tileFile = objFile.substr(0, dot) + ".tiles";
+	}
+	const std::string tilePath = directory + "/" + tileFile;
+	const Uint32 maxTriangles = argc > 4 ? static_cast<Uint32> (std::strtoul(
+			argv[4], 0, 10)) : DEFAULT_MAX_TRIANGLES;
+	if (maxTriangles == 0) {
+		std::cerr << "Invalid triangle count " << argv[4] << std::endl;
+		return 1;
+	}
+
+	try {
+		ThreadPool pool;
+		ParkMesh mesh;
+		ObjParser::parse(directory, objFile, mesh, pool);
+
+		const Uint32 numTiles = TileSet::build(mesh, maxTriangles, tilePath);
+		TileSet tileSet(tilePath);
+		Uint64 compressedSize = 0;
+		Uint64 size = 0;
+		for (Uint32 t = 0; t < numTiles; ++t) {
+			TileInfo info;
+			tileSet.getTile(t, info);
+			compressedSize += info.compressedSize;
+			size += info.size;
+		}
+		std::cout << tilePath << ": " << numTiles << " tiles of "
+				<< mesh.getNumTriangles() << " triangles, " << size / 1024
+				<< " KB compressed to " << compressedSize / 1024 << " KB"
+				<< std::endl;
+	} catch (std::runtime_error& err) {
+		std::cerr << "Caught exception " << err.what() << std::endl;
+		return 1;
+	}
+	return 0;
+} // end main()